@@ -97,6 +97,7 @@ CORE_API extern FGlobalPlatform*		GSystem;
 CORE_API extern FTransactionTracker*	GUndo;
 CORE_API extern FMemCache				GCache;
 CORE_API extern FMemStack				GMem;
+CORE_API extern class FJobSystem		GJobs;
 CORE_API extern FOutputDevice*			GLogHook;
 CORE_API extern FExec*					GExecHook;
 CORE_API extern USystem*				GSys;
@@ -153,6 +154,9 @@ extern "C" DLL_EXPORT char THIS_PACKAGE[];
 #include "UnCId.h"			// Cache ID's.
 #include "UnConfig.h"		// Config cache.
 #include "UnThread.h"		// Multithreading.
+#include "UnJob.h"			// Job system.
+#include "UnProfiler.h"		// Script profiler.
+#include "UnLoadBench.h"		// Package loading benchmark.
 #include "UnStaticExports.h"	// Package exports for static builds.
 
 /*-----------------------------------------------------------------------------
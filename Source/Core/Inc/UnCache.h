@@ -56,22 +56,25 @@ public:
 		{
 			Extra = B;
 		}
-		typedef _WORD TCacheTime;
+		typedef INT TCacheTime;
 	private:
-		// Private variables: Note 32-byte alignment.
+		// Private variables.
 		QWORD		Id;				// This item's cache id, 0=unused.
 		BYTE*		Data;			// Pointer to the item's data.
 		TCacheTime	Time;			// Last Get() time.
+		INT			Cost;			// Cost to flush this item, as of Time.
 		BYTE		Segment;		// Number of the segment this item resides in.
 		BYTE		Extra;			// Extra space for use.
-		INT			Cost;			// Cost to flush this item.
+		BYTE		FreeBin;		// Free list this item is in, or FREE_NONE.
 		FCacheItem*	LinearNext;		// Next cache item in linear list, or NULL if last.
 		FCacheItem*	LinearPrev;		// Previous cache item in linear list, or NULL if first.
 		FCacheItem*	HashNext;		// Next cache item in hash table, or NULL if last.
+		FCacheItem*	FreeNext;		// Next free space item in the same free list.
+		FCacheItem*	FreePrev;		// Previous free space item in the same free list.
 	};
 
 	// FMemCache interface.
-	FMemCache() {Initialized=0;}
+	FMemCache() {Initialized=0; FullScan=0; Record=NULL;}
     void Init( INT BytesToAllocate, INT MaxItems, void* Start=NULL, INT SegSize=0 );
 	void Exit( INT FreeMemory );
 	void Flush( QWORD Id=0, DWORD Mask=~0, UBOOL IgnoreLocked=0 );
@@ -102,12 +105,15 @@ public:
 		{
 			if( HashItem->Id == Id )
 			{
-				// Set the item, lock it, and return its data.
+				// Set the item, bring its cost up to date, lock it, and return its data.
 				MruId			= Id;
 				MruItem			= HashItem;
 				Item            = HashItem;
+				HashItem->Cost  = AgedCost( HashItem );
 				HashItem->Time  = Time;
 				HashItem->Cost += COST_INFINITE;
+				if( Record )
+					RecordOp( Id, 0, 0, 0 );
 				unclockSlow(GetCycles);
 				return Align( HashItem->Data, Alignment );
 			}
@@ -122,12 +128,17 @@ private:
 	enum {COST_INFINITE=0x1000000};
 	enum {HASH_COUNT=16384};
 	enum {IGNORE_SIZE=256};
+	enum {FREE_BINS=32};
+	enum {FREE_NONE=255};
+	enum {EVICT_RUNS=64};
+	enum {DECAY_STEPS=256};
 
 	// Variables.
 	INT Initialized;
 	INT Time;
 	QWORD MruId;
 	FCacheItem* MruItem;
+	UBOOL FullScan;
 
 	// Stats.
 	INT NumGets,NumCreates,CreateCycles,GetCycles,TickCycles;
@@ -145,6 +156,30 @@ private:
 	// memory). Linked via LinearNext in FIFO order.
 	FCacheItem* UnusedItems;
 
+	// Free space items by size, linked via FreeNext and FreePrev. Bin i holds
+	// the free spaces of at least 2^i bytes and less than 2^(i+1).
+	FCacheItem* FreeBins[FREE_BINS];
+	void FreeUnlink( FCacheItem* Item );
+	void FreeRelink( FCacheItem* Item );
+	FCacheItem* FindFreeSpace( INT Size, INT Alignment );
+
+	// Where the next search for items to evict starts.
+	FCacheItem* Hand;
+	INT ScanRuns( FCacheItem* Start, INT Size, INT Alignment, INT Limit, SQWORD& BestCost, FCacheItem*& BestFirst, FCacheItem*& BestLast );
+
+	// Aging. Rather than visiting every item each tick, an item's cost is
+	// brought up to date from the time it was last used when it's needed.
+	static INT DecayTable[DECAY_STEPS];
+	static INT DecayCost( INT Cost, INT Ticks );
+	INT AgedCost( FCacheItem* Item )
+	{
+		// Cost drops to 1/4 on the first tick an item is stale, then by 1/32 each tick.
+		INT Age = Time - Item->Time;
+		if( Age<=1 || Item->Cost>=COST_INFINITE )
+			return Item->Cost;
+		return DecayCost( Item->Cost>>2, Age-2 );
+	}
+
 	// The hash table.
 	FCacheItem* HashItems[HASH_COUNT];
 	void Unhash( QWORD Id )
@@ -170,6 +205,16 @@ private:
 	FCacheItem *UnusedItemMemory;
 	BYTE       *CacheMemory;
 
+	// Recording calls for CACHEBENCH. Size is 0 for a Get and -1 for a Tick.
+	struct FCacheOp
+	{
+		QWORD Id;
+		INT   Size, Alignment, SafetyPad;
+	};
+	TArray<FCacheOp>* Record;
+	void RecordOp( QWORD Id, INT Size, INT Alignment, INT SafetyPad );
+	void Replay( UBOOL InFullScan, INT& NumCreated, DOUBLE& TotalMs, DOUBLE& CreateMs, DOUBLE& TickMs );
+
 	// State checking.
 	void ConditionalCheckState()
 	{
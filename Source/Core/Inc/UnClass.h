@@ -252,6 +252,15 @@ protected:
 	UFunction.
 -----------------------------------------------------------------------------*/
 
+//
+// Function frame flags, computed when a function is loaded. Not saved.
+//
+enum EFunctionFrameFlags
+{
+	FRAME_Linked		= 0x01,	// The flags below are valid.
+	FRAME_OutParms		= 0x02,	// Has out parameters or a return value to copy back.
+};
+
 //
 // An UnrealScript function.
 //
@@ -271,6 +280,7 @@ class CORE_API UFunction : public UStruct
 	_WORD ReturnValueOffset;
 	BYTE  NumParms;
 	BYTE  OperPrecedence;
+	BYTE  FrameFlags;
 	void (UObject::*Func)( FFrame& Stack, BYTE*& Result );
 
 	// Constructors.
@@ -296,6 +306,10 @@ class CORE_API UFunction : public UStruct
 		unguardSlow;
 	}
 	UProperty* GetReturnProperty();
+	UBOOL NeedsCopyBack() const
+	{
+		return (FrameFlags & (FRAME_Linked|FRAME_OutParms)) != FRAME_Linked;
+	}
 };
 
 /*-----------------------------------------------------------------------------
@@ -144,6 +144,7 @@ class CORE_API USystem : public USubsystem
 	char CacheExt[32];
 	FName Suppress[16];
 	INT PurgeCacheDays;
+	INT JobThreads;
 
 	// Constructors.
 	static void InternalClassInitializer( UClass* Class );
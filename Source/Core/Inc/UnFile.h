@@ -206,6 +206,7 @@ CORE_API void SetLanguage( const char* LanguageExt );
 -----------------------------------------------------------------------------*/
 
 CORE_API FILE* appFopen( const char* Filename, const char* Mode );
+CORE_API void appResetFileIndex();
 CORE_API INT appFclose( FILE* Stream );
 CORE_API INT appFseek( FILE* Stream, INT Offset, INT Origin );
 CORE_API INT appFtell( FILE* Stream );
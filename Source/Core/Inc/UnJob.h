@@ -0,0 +1,150 @@
+/*=============================================================================
+	UnJob.h: Job system.
+
+	A fixed pool of worker threads, each with its own job queue. Workers pop
+	their own queue LIFO and steal from the others FIFO when they run dry.
+	The game thread (and any thread that isn't a worker) submits into queue 0
+	and helps execute jobs while waiting on a counter.
+
+	Jobs needing temporary memory should use GetThreadMem() rather than
+	GMem, since a job may run on any worker or on the game thread.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	Job types.
+-----------------------------------------------------------------------------*/
+
+// Job entry point.
+typedef void ( *JOB_FUNC )( void* Arg );
+
+// ParallelFor body, called with consecutive [Start,End) ranges.
+typedef void ( *PARALLEL_FUNC )( void* Arg, INT Start, INT End );
+
+// Maximum number of threads, including the game thread.
+enum {MAX_JOB_THREADS = 32};
+
+//
+// A queued job.
+//
+struct FJob
+{
+	JOB_FUNC			Func;
+	void*				Arg;
+	class FJobCounter*	Counter;
+	FJob*				Next;
+};
+
+//
+// Completion counter. Dispatching a job against a counter increments it and
+// finishing the job decrements it. Jobs can depend on a counter, in which
+// case they are held back until it drops to zero.
+//
+class CORE_API FJobCounter
+{
+public:
+	FJobCounter()
+	:	Count( 0 )
+	,	Waiters( NULL )
+	{}
+	UBOOL IsDone() const
+	{
+		return Count==0;
+	}
+private:
+	volatile INT Count;
+	FJob* Waiters;
+	friend class FJobSystem;
+};
+
+/*-----------------------------------------------------------------------------
+	FJobSystem.
+-----------------------------------------------------------------------------*/
+
+//
+// The job system. With one thread configured everything runs inline on
+// the calling thread.
+//
+class CORE_API FJobSystem
+{
+public:
+	// Constructor.
+	FJobSystem();
+
+	// Init/exit. NumThreads counts the game thread; 0 picks one per processor.
+	void Init( INT InNumThreads );
+	void Exit();
+
+	// Queue Func(Arg) to run once Dependency (if any) is done.
+	void Dispatch( JOB_FUNC Func, void* Arg, FJobCounter* Counter=NULL, FJobCounter* Dependency=NULL );
+
+	// Wait for a counter to drop to zero, executing jobs in the meantime.
+	void Wait( FJobCounter& Counter );
+
+	// Run Func over [0,Count) in batches of at least Granularity and wait for it.
+	void ParallelFor( INT Count, INT Granularity, PARALLEL_FUNC Func, void* Arg );
+
+	// Accessors.
+	INT GetNumThreads() const
+	{
+		return NumWorkers + 1;
+	}
+	INT GetThreadIndex() const;
+
+	// Memory stack for temporaries on the calling thread: GMem on the game
+	// thread, a private stack on each worker.
+	FMemStack& GetThreadMem()
+	{
+		INT Index = GetThreadIndex();
+		return Index ? Workers[Index].Mem : GMem;
+	}
+	FMemStack& GetThreadMem( INT Index )
+	{
+		check(Index>=0 && Index<=NumWorkers);
+		return Index ? Workers[Index].Mem : GMem;
+	}
+
+private:
+	// Per-thread queue.
+	struct FJobQueue
+	{
+		enum {MAX_JOBS = 1024};
+		UMUTEX	Mutex;
+		volatile INT Head;
+		volatile INT Tail;
+		FJob	Jobs[MAX_JOBS];
+	};
+
+	// Worker thread startup info.
+	struct FWorker
+	{
+		FJobSystem*	System;
+		INT			Index;
+		UTHREAD		Thread;
+		FMemStack	Mem;
+	};
+
+	// Variables.
+	INT			NumWorkers;
+	UBOOL		Initialized;
+	volatile INT Exiting;
+	UTLS		ThreadSlot;
+	USEMAPHORE	WakeSemaphore;
+	UMUTEX		DependencyMutex;
+	FWorker		Workers[MAX_JOB_THREADS];
+	FJobQueue*	Queues;
+
+	// Internal functions.
+	void Queue( const FJob& Job );
+	UBOOL GetJob( INT Index, FJob& Job );
+	void Execute( const FJob& Job );
+	void Finish( FJobCounter* Counter );
+	static THREAD_RET
+#ifdef PLATFORM_WIN32
+	__stdcall
+#endif
+	WorkerThreadProc( void* Arg );
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
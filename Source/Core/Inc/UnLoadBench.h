@@ -0,0 +1,69 @@
+/*=============================================================================
+	UnLoadBench.h: Package loading benchmark.
+
+	Records the reads and seeks that package loaders make, then replays them
+	through the file loader with and without its read-ahead buffer and logs
+	the wall time and file calls of each. Toggled at runtime with
+	LOADBENCH START|STOP; -LOADBENCH records from startup until the first
+	map after Entry has loaded.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FLoadBenchmark.
+-----------------------------------------------------------------------------*/
+
+//
+// The package loading benchmark. Packages only load on the game thread, so
+// it isn't thread safe.
+//
+class CORE_API FLoadBenchmark
+{
+public:
+	// Whether loads are being recorded, and whether to stop once a map has.
+	UBOOL Recording;
+	UBOOL UntilMapLoaded;
+
+	// Calls the file loaders have made to the file system.
+	INT FileReads;
+	INT FileSeeks;
+
+	// Constructor.
+	FLoadBenchmark();
+
+	// Start/stop. Stop replays what was recorded and logs the results.
+	void Start( UBOOL InUntilMapLoaded=0 );
+	void Stop( FOutputDevice* Out );
+	void NoteMapLoaded( FOutputDevice* Out );
+
+	// Record a file being opened, and a seek or read in it.
+	INT NoteFile( const char* Filename );
+	void NoteSeek( INT File, INT Pos );
+	void NoteRead( INT File, INT Pos, INT Length );
+
+	// Console commands.
+	UBOOL Exec( const char* Cmd, FOutputDevice* Out );
+
+private:
+	// A recorded seek (Length<0) or read.
+	struct FOp
+	{
+		INT File;
+		INT Pos;
+		INT Length;
+	};
+
+	// Variables.
+	TArray<FString>	Files;
+	TArray<FOp>		Ops;
+	DOUBLE			StartTime;
+
+	// Internal functions.
+	UBOOL Replay( UBOOL Buffered, DOUBLE& Seconds, INT& Reads, INT& Seeks, FOutputDevice* Out );
+};
+
+// The global load benchmark.
+CORE_API extern FLoadBenchmark GLoadBenchmark;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -23,6 +23,10 @@ enum EMemOned   {MEM_Oned  =1};
 // Items are allocated via PushBytes() or the specialized operator new()s.
 // Items are freed en masse by using FMemMark to Pop() them.
 //
+// A memory stack belongs to the thread that called Init() and must only be
+// used from that thread. Freed chunks are kept on a per-stack list; surplus
+// chunks go back to a pool shared by all stacks.
+//
 class CORE_API FMemStack
 {
 public:
@@ -55,7 +59,8 @@ public:
 	void Init( INT DefaultChunkSize );
 	void Exit();
 	void Tick();
-	int  GetByteCount();
+	INT  GetByteCount();
+	UBOOL IsOwnerThread() const;
 
 	// Friends.
 	friend class FMemMark;
@@ -66,6 +71,7 @@ public:
 private:
 	// Constants.
 	enum {MAX_CHUNKS=1024};
+	enum {MAX_UNUSED_CHUNKS=8};
 
 	// Types.
 	struct FTaggedMemory
@@ -81,13 +87,18 @@ private:
 	BYTE*			End;				// End of current chunk.
 	INT				DefaultChunkSize;	// Maximum chunk size to allocate.
 	FTaggedMemory*	TopChunk;			// Only chunks 0..ActiveChunks-1 are valid.
+	FTaggedMemory*	UnusedChunks;		// Chunks freed by this stack.
+	INT				NumUnusedChunks;	// Length of UnusedChunks.
+	DWORD			OwnerThread;		// appThreadId() of the thread using this stack.
 
 	// Static.
-	static FTaggedMemory* UnusedChunks;
+	static FTaggedMemory* volatile SharedUnusedChunks;
 
 	// Functions.
 	BYTE* AllocateNewChunk( INT MinSize );
 	void FreeChunks( FTaggedMemory* NewTopChunk );
+	static void ReleaseSharedChunk( FTaggedMemory* Chunk );
+	static FTaggedMemory* GrabSharedChunks();
 };
 
 /*-----------------------------------------------------------------------------
@@ -160,6 +171,7 @@ public:
 	FMemMark( FMemStack& InMem )
 	{
 		guardSlow(FMemMark::FMemMark);
+		debug(InMem.IsOwnerThread());
 		Mem          = &InMem;
 		Top          = Mem->Top;
 		SavedChunk   = Mem->TopChunk;
@@ -171,6 +183,7 @@ public:
 	{
 		// Check state.
 		guardSlow(FMemMark::Pop);
+		debug(Mem->IsOwnerThread());
 
 		// Unlock any new chunks that were allocated.
 		if( SavedChunk != Mem->TopChunk )
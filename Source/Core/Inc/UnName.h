@@ -158,6 +158,10 @@ private:
 	static INT					Duplicate;       // Duplicate name, if any.
 	static UBOOL				Initialized;     // Set by InitTables.
 };
+inline DWORD GetTypeHash( const FName N )
+{
+	return N.GetIndex();
+}
 
 /*----------------------------------------------------------------------------
 	The End.
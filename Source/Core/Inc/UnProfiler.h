@@ -0,0 +1,129 @@
+/*=============================================================================
+	UnProfiler.h: UnrealScript profiler.
+
+	Records inclusive and exclusive time, call counts and the caller/callee
+	graph of script functions, intrinsic functions, ProcessEvent entry points
+	and state code while it's running. Toggled at runtime with
+	SCRIPTPROFILE START|STOP|DUMP; costs one flag test per call when off.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FScriptProfiler.
+-----------------------------------------------------------------------------*/
+
+//
+// The script profiler. Only the game thread runs script, so it isn't
+// thread safe.
+//
+class CORE_API FScriptProfiler
+{
+public:
+	// Kinds of profiled nodes.
+	enum EKind
+	{
+		KIND_Root		= 0,	// Calls made from C++.
+		KIND_Script		= 1,	// Script function.
+		KIND_Intrinsic	= 2,	// Intrinsic (C++) function.
+		KIND_State		= 3,	// State code.
+	};
+
+	// Whether calls are being recorded.
+	UBOOL Active;
+
+	// Constructor.
+	FScriptProfiler();
+
+	// Start/stop.
+	void Start( INT InMaxEvents );
+	void Stop();
+	void Reset();
+
+	// Record entering and leaving a function or state. Callers should only
+	// call Leave if they called Enter, whatever Active is by then.
+	void Enter( UStruct* Node, UBOOL IsEvent=0 );
+	void Leave();
+
+	// Forget object pointers, which may be reused after garbage collection.
+	void NoteGarbageCollect();
+
+	// Reports.
+	void DumpReport( const char* Filename, INT SortBy, FOutputDevice* Out );
+	void DumpChromeTrace( const char* Filename );
+
+	// Console commands.
+	UBOOL Exec( const char* Cmd, FOutputDevice* Out );
+
+private:
+	// A profiled function or state.
+	struct FNode
+	{
+		char	Name[192];
+		INT		Kind;
+		INT		Calls;
+		INT		EventCalls;
+		INT		Recursion;
+		QWORD	Inclusive;
+		QWORD	Exclusive;
+	};
+
+	// A caller->callee edge.
+	struct FEdge
+	{
+		INT		Caller;
+		INT		Callee;
+		INT		Calls;
+		QWORD	Inclusive;
+	};
+
+	// An open call.
+	struct FCall
+	{
+		INT		Node;
+		QWORD	Start;
+		QWORD	Children;
+	};
+
+	// A finished call, for the Chrome trace.
+	struct FEvent
+	{
+		INT		Node;
+		INT		Depth;
+		QWORD	Start;
+		QWORD	Duration;
+	};
+
+	enum {MAX_DEPTH=256};
+
+	// Variables.
+	TArray<FNode>		Nodes;
+	TArray<FEdge>		Edges;
+	TArray<FEvent>		Events;
+	TMap<UStruct*,INT>	NodeMap;
+	TMap<QWORD,INT>		EdgeMap;
+	FCall				Stack[MAX_DEPTH];
+	INT					Depth;
+	INT					Overflow;
+	INT					MaxEvents;
+	DWORD				LastCycles;
+	QWORD				Clock;
+	QWORD				StartClock;
+	QWORD				TotalClock;
+
+	// Internal functions.
+	QWORD Now()
+	{
+		DWORD Cycles = appCycles();
+		Clock += (DWORD)(Cycles - LastCycles);
+		LastCycles = Cycles;
+		return Clock;
+	}
+	INT GetNode( UStruct* Node );
+	INT GetEdge( INT Caller, INT Callee );
+};
+
+// The global script profiler.
+CORE_API extern FScriptProfiler GScriptProfiler;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
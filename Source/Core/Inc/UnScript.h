@@ -312,6 +312,94 @@ inline const char* FMainFrame::Describe()
 	return Node ? Node->GetFullName() : "None";
 }
 
+/*-----------------------------------------------------------------------------
+	FScriptCallCache.
+-----------------------------------------------------------------------------*/
+
+//
+// Inline cache for the function lookups of EX_VirtualFunction and
+// EX_GlobalFunction call sites, so that hot calls skip the VfHash chain
+// walks of FindFunctionChecked.
+//
+// Entries are direct mapped on call site and class, and also remember the
+// name and state they were looked up with, so a GotoState or new code at a
+// reused address just makes the next lookup miss. Flush must be called
+// whenever cached pointers may go stale: when structs are loaded, after
+// scripts are compiled and after garbage collection.
+//
+class CORE_API FScriptCallCache
+{
+public:
+	enum {CACHE_SIZE=4096};
+
+	// Statistics.
+	DWORD Hits, Misses, Flushes;
+
+	// Constructor.
+	FScriptCallCache()
+	:	Hits		( 0 )
+	,	Misses		( 0 )
+	,	Flushes		( 0 )
+	,	Generation	( 1 )
+	{
+		appMemset( Entries, 0, sizeof(Entries) );
+	}
+
+	// Invalidate all entries.
+	void Flush()
+	{
+		Generation++;
+		Flushes++;
+	}
+
+	// Find the function called at the code position of Stack, reading its name.
+	UFunction* FindFunction( UObject* Object, FFrame& Stack, UBOOL Global )
+	{
+		BYTE*       Site  = Stack.Code;
+		FName       Name  = Stack.ReadName();
+		UClass*     Class = Object->GetClass();
+		FMainFrame* Main  = Object->GetMainFrame();
+		UState*     State = (Main && !Global) ? Main->StateNode : NULL;
+		FEntry&     Entry = Entries[(GetTypeHash(Site) ^ (GetTypeHash(Class) * 7)) & (CACHE_SIZE-1)];
+		if( Entry.Site==Site && Entry.Class==Class && Entry.State==State && Entry.Name==Name && Entry.Generation==Generation )
+		{
+			Hits++;
+			return Entry.Function;
+		}
+		Misses++;
+		UFunction* Function = Object->FindFunctionChecked( Name, Global );
+		if( Function )
+		{
+			Entry.Site       = Site;
+			Entry.Class      = Class;
+			Entry.State      = State;
+			Entry.Name       = Name;
+			Entry.Function   = Function;
+			Entry.Generation = Generation;
+		}
+		return Function;
+	}
+
+private:
+	// A cached lookup.
+	struct FEntry
+	{
+		BYTE*		Site;
+		UClass*		Class;
+		UState*		State;
+		FName		Name;
+		UFunction*	Function;
+		DWORD		Generation;
+	};
+
+	// Variables.
+	FEntry	Entries[CACHE_SIZE];
+	DWORD	Generation;
+};
+
+// The global script call cache.
+CORE_API extern FScriptCallCache GScriptCallCache;
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -162,6 +162,15 @@ public:
 		Remove( 0, ArrayNum );
 		unguardSlow;
 	}
+	void Reset()
+	{
+		// Empty the array but keep its memory for reuse.
+		guardSlow(TArray::Reset);
+		for( INT i=0; i<ArrayNum; i++ )
+			(&(*this)(i))->~T();
+		ArrayNum = 0;
+		unguardSlow;
+	}
 	void Shrink()
 	{
 		guardSlow(TArray::Shrink);
@@ -377,6 +386,10 @@ public:
 	{
 		return Ar << (TArray<char>&) S;
 	}
+	friend DWORD GetTypeHash( const FString& S )
+	{
+		return appStrihash( *S );
+	}
 };
 
 /*-------------------------------------------------------------------------------
@@ -435,6 +448,73 @@ private:
 	INT Index;
 };
 
+/*----------------------------------------------------------------------------
+	FRainbowPtr.
+----------------------------------------------------------------------------*/
+
+//
+// A union of pointers of all base types.
+//
+union CORE_API FRainbowPtr
+{
+	// All pointers.
+	void*  PtrVOID;
+	BYTE*  PtrBYTE;
+	_WORD* PtrWORD;
+	DWORD* PtrDWORD;
+	QWORD* PtrQWORD;
+	FLOAT* PtrFLOAT;
+
+	// Conversion constructors.
+	FRainbowPtr() {}
+	FRainbowPtr( void* Ptr ) : PtrVOID(Ptr) {};
+};
+
+/*----------------------------------------------------------------------------
+	Global constants.
+----------------------------------------------------------------------------*/
+
+enum {MAXBYTE		= 0xff       };
+enum {MAXWORD		= 0xffffU    };
+enum {MAXDWORD		= 0xffffffffU};
+enum {MAXSBYTE		= 0x7f       };
+enum {MAXSWORD		= 0x7fff     };
+enum {MAXINT		= 0x7fffffff };
+enum {INDEX_NONE	= -1         };
+
+/*----------------------------------------------------------------------------
+	Type hashing.
+----------------------------------------------------------------------------*/
+
+//
+// Hash functions used by TMap. Class types (FName, FString) provide their
+// own overloads next to their definitions.
+//
+inline DWORD GetTypeHash( const BYTE A )
+{
+	return A;
+}
+inline DWORD GetTypeHash( const _WORD A )
+{
+	return A;
+}
+inline DWORD GetTypeHash( const INT A )
+{
+	return A;
+}
+inline DWORD GetTypeHash( const DWORD A )
+{
+	return A;
+}
+inline DWORD GetTypeHash( const QWORD A )
+{
+	return (DWORD)A + ((DWORD)(A>>32) * 23);
+}
+template< class T > inline DWORD GetTypeHash( const T* A )
+{
+	return (DWORD)(size_t)A >> 2;
+}
+
 /*----------------------------------------------------------------------------
 	TMap.
 ----------------------------------------------------------------------------*/
@@ -442,12 +522,20 @@ private:
 //
 // Maps unique keys to values.
 //
+// Pairs are stored contiguously so they can be iterated by index, and are
+// chained into a power-of-two hash table by index, so Add, Find and Remove
+// don't depend on the number of pairs. Removing a pair moves the last pair
+// into its slot. As with TArray, Add and Remove invalidate pointers to values.
+//
 template< class TK, class TI > class TMap
 {
 public:
-	INT Size()
+	TMap()
+	:	HashBits( 0 )
+	{}
+	INT Size() const
 	{
-		return Pairs.ArrayNum;
+		return Pairs.Num();
 	}
 	TI&operator[](INT i)
 	{
@@ -457,97 +545,126 @@ public:
 	{
 		return Pairs(i).Value;
 	}
+	const TK& GetKey( INT i ) const
+	{
+		return Pairs(i).Key;
+	}
 	TI* Add( const TK& Key, const TI& Value )
 	{
-		INT i;
-		for( i=0; i<Pairs.Num(); i++ )
-			if( Pairs(i).Key==Key )
-				break;
-		if( i==Pairs.Num() )
+		INT i = FindIndex( Key );
+		if( i==INDEX_NONE )
+		{
 			new(Pairs)FPair;
-		Pairs(i).Key   = Key;
+			i = Pairs.Num()-1;
+			Pairs(i).Key = Key;
+			if( Pairs.Num() > Hash.Num() )
+			{
+				Rehash();
+			}
+			else
+			{
+				DWORD iHash      = HashIndex( Key );
+				Pairs(i).HashNext = Hash(iHash);
+				Hash(iHash)       = i;
+			}
+		}
 		Pairs(i).Value = Value;
 		return & Pairs(i).Value;
 	}
+	INT Remove( const TK& Key )
+	{
+		INT i = FindIndex( Key );
+		if( i==INDEX_NONE )
+			return 0;
+		Unlink( i );
+		INT iLast = Pairs.Num()-1;
+		if( i != iLast )
+		{
+			// Move the last pair into the hole and relink it.
+			Unlink( iLast );
+			Pairs(i).Key      = Pairs(iLast).Key;
+			Pairs(i).Value    = Pairs(iLast).Value;
+			DWORD iHash       = HashIndex( Pairs(i).Key );
+			Pairs(i).HashNext = Hash(iHash);
+			Hash(iHash)       = i;
+		}
+		Pairs.Remove( iLast );
+		return 1;
+	}
 	void Empty()
 	{
 		Pairs.Empty();
+		Hash.Empty();
+		HashBits = 0;
 	}
 	UBOOL Find( const TK& Key, TI& Value ) const
 	{
-		INT i;
-		for( i=0; i<Pairs.Num(); i++ )
-			if( Pairs(i).Key==Key )
-				break;
-		if( i<Pairs.Num() )
+		INT i = FindIndex( Key );
+		if( i!=INDEX_NONE )
 			Value = Pairs(i).Value;
-		return i<Pairs.Num();
+		return i!=INDEX_NONE;
 	}
 	UBOOL Find(const TK& Key, TI*& Value) 
 	{
-		INT i;
-		for (i = 0; i < Pairs.Num(); i++)
-			if (Pairs(i).Key == Key)
-				break;
-		if (i < Pairs.Num())
-			Value = &Pairs(i).Value;
-		else
-			Value = 0;
-		return i < Pairs.Num();
+		INT i = FindIndex( Key );
+		Value = i!=INDEX_NONE ? &Pairs(i).Value : 0;
+		return i!=INDEX_NONE;
 	}
 	TI* Find(const TK& Key) 
 	{
-		INT i;
-		for (i = 0; i < Pairs.Num(); i++)
-			if (Pairs(i).Key == Key)
-				break;
-		if (i < Pairs.Num())
-			return & Pairs(i).Value;
-		return 0;
+		INT i = FindIndex( Key );
+		return i!=INDEX_NONE ? &Pairs(i).Value : 0;
+	}
+	INT FindIndex( const TK& Key ) const
+	{
+		if( HashBits )
+			for( INT i=Hash(HashIndex(Key)); i!=INDEX_NONE; i=Pairs(i).HashNext )
+				if( Pairs(i).Key==Key )
+					return i;
+		return INDEX_NONE;
 	}
 private:
 	struct FPair
 	{
+		INT HashNext;
 		TK Key;
 		TI Value;
 	};
 	TArray<FPair> Pairs;
-};
-
-/*----------------------------------------------------------------------------
-	FRainbowPtr.
-----------------------------------------------------------------------------*/
-
-//
-// A union of pointers of all base types.
-//
-union CORE_API FRainbowPtr
-{
-	// All pointers.
-	void*  PtrVOID;
-	BYTE*  PtrBYTE;
-	_WORD* PtrWORD;
-	DWORD* PtrDWORD;
-	QWORD* PtrQWORD;
-	FLOAT* PtrFLOAT;
+	TArray<INT> Hash;
+	INT HashBits;
 
-	// Conversion constructors.
-	FRainbowPtr() {}
-	FRainbowPtr( void* Ptr ) : PtrVOID(Ptr) {};
+	DWORD HashIndex( const TK& Key ) const
+	{
+		// Fibonacci hashing, so keys with constant low bits (cache ID's) still spread.
+		return (GetTypeHash(Key) * 0x9E3779B9U) >> (32 - HashBits);
+	}
+	void Unlink( INT i )
+	{
+		for( INT* Link=&Hash(HashIndex(Pairs(i).Key)); *Link!=INDEX_NONE; Link=&Pairs(*Link).HashNext )
+		{
+			if( *Link==i )
+			{
+				*Link = Pairs(i).HashNext;
+				return;
+			}
+		}
+	}
+	void Rehash()
+	{
+		do HashBits++; while( (1<<HashBits) < Pairs.Num() || HashBits < 3 );
+		Hash.SetNum( 1<<HashBits );
+		for( INT i=0; i<Hash.Num(); i++ )
+			Hash(i) = INDEX_NONE;
+		for( INT i=0; i<Pairs.Num(); i++ )
+		{
+			DWORD iHash      = HashIndex( Pairs(i).Key );
+			Pairs(i).HashNext = Hash(iHash);
+			Hash(iHash)       = i;
+		}
+	}
 };
 
-/*----------------------------------------------------------------------------
-	Global constants.
-----------------------------------------------------------------------------*/
-
-enum {MAXBYTE		= 0xff       };
-enum {MAXWORD		= 0xffffU    };
-enum {MAXDWORD		= 0xffffffffU};
-enum {MAXSBYTE		= 0x7f       };
-enum {MAXSWORD		= 0x7fff     };
-enum {MAXINT		= 0x7fffffff };
-enum {INDEX_NONE	= -1         };
-
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -9,6 +9,8 @@
 
 typedef void* UTHREAD;
 typedef void* UMUTEX;
+typedef void* USEMAPHORE;
+typedef DWORD UTLS;
 
 #ifdef PLATFORM_WIN32
 typedef DWORD THREAD_RET;
@@ -21,6 +23,7 @@ typedef THREAD_RET ( *THREAD_FUNC )( void* Arg );
 // Thread operations.
 CORE_API UTHREAD appThreadSpawn( THREAD_FUNC Func, void* Arg, const char* Name, UBOOL bDetach, DWORD* OutThreadId );
 CORE_API THREAD_RET appThreadJoin( UTHREAD Thread );
+CORE_API DWORD appThreadId();
 
 // Recursive mutex operations.
 CORE_API UMUTEX appMutexCreate( const char* Name );
@@ -28,6 +31,26 @@ CORE_API UBOOL appMutexLock( UMUTEX Mutex );
 CORE_API UBOOL appMutexUnlock( UMUTEX Mutex );
 CORE_API void appMutexFree( UMUTEX Mutex );
 
+// Counting semaphore operations.
+CORE_API USEMAPHORE appSemaphoreCreate( const char* Name, INT InitialCount );
+CORE_API void appSemaphorePost( USEMAPHORE Semaphore, INT Count );
+CORE_API void appSemaphoreWait( USEMAPHORE Semaphore );
+CORE_API void appSemaphoreFree( USEMAPHORE Semaphore );
+
+// Thread local storage. Slots hold one pointer per thread, initially NULL.
+CORE_API UTLS appTlsAlloc();
+CORE_API void* appTlsGet( UTLS Slot );
+CORE_API void appTlsSet( UTLS Slot, void* Value );
+CORE_API void appTlsFree( UTLS Slot );
+
+// Atomic operations with full barriers. Arithmetic ones return the new value,
+// compare-exchange returns the old value.
+CORE_API INT appInterlockedIncrement( volatile INT* Value );
+CORE_API INT appInterlockedDecrement( volatile INT* Value );
+CORE_API INT appInterlockedAdd( volatile INT* Value, INT Amount );
+CORE_API INT appInterlockedCompareExchange( volatile INT* Dest, INT Exchange, INT Comparand );
+CORE_API void* appInterlockedCompareExchangePointer( void* volatile* Dest, void* Exchange, void* Comparand );
+
 // Mutex object.
 class CORE_API FMutex
 {
@@ -13,6 +13,7 @@
 CORE_API FObjectManager GObj;
 CORE_API FMemCache GCache;
 CORE_API FMemStack GMem;
+CORE_API FJobSystem GJobs;
 
 // Global subsystems outside the core.
 CORE_API USystem* GSys=NULL;
@@ -12,6 +12,97 @@ Revision history:
 
 #include "CorePrivate.h"
 
+/*-----------------------------------------------------------------------------
+	Aging.
+-----------------------------------------------------------------------------*/
+
+// (31/32)^i in 8.24 fixed point.
+INT FMemCache::DecayTable[DECAY_STEPS];
+
+//
+// Take 1/32 off a cost Ticks times over. As with repeatedly subtracting
+// Cost>>5, costs under 32 don't decay any further.
+//
+INT FMemCache::DecayCost( INT Cost, INT Ticks )
+{
+	guardSlow(FMemCache::DecayCost);
+	INT Floor = Min( Cost, 31 );
+	while( Ticks>0 && Cost>Floor )
+	{
+		INT Steps = Min( Ticks, (INT)DECAY_STEPS-1 );
+		Cost      = (INT)(((QWORD)Cost * DecayTable[Steps]) >> 24);
+		Ticks    -= Steps;
+	}
+	return Max( Cost, Floor );
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	Free lists.
+-----------------------------------------------------------------------------*/
+
+static inline INT FloorLog2( DWORD Value )
+{
+	INT Result = 0;
+	while( Value >>= 1 )
+		Result++;
+	return Result;
+}
+
+//
+// Take an item out of its free list, if it's in one.
+//
+void FMemCache::FreeUnlink( FCacheItem* Item )
+{
+	guardSlow(FMemCache::FreeUnlink);
+	if( Item->FreeBin != FREE_NONE )
+	{
+		if( Item->FreePrev )
+			Item->FreePrev->FreeNext = Item->FreeNext;
+		else
+			FreeBins[Item->FreeBin] = Item->FreeNext;
+		if( Item->FreeNext )
+			Item->FreeNext->FreePrev = Item->FreePrev;
+		Item->FreeBin = FREE_NONE;
+	}
+	unguardSlow;
+}
+
+//
+// Put an item in the free list for its size if it's free space, after its
+// size or use may have changed.
+//
+void FMemCache::FreeRelink( FCacheItem* Item )
+{
+	guardSlow(FMemCache::FreeRelink);
+	FreeUnlink( Item );
+	if( Item->Id==0 && Item->LinearNext && Item->LinearNext->Data > Item->Data )
+	{
+		INT Bin         = FloorLog2( Item->LinearNext->Data - Item->Data );
+		Item->FreeBin   = Bin;
+		Item->FreePrev  = NULL;
+		Item->FreeNext  = FreeBins[Bin];
+		if( FreeBins[Bin] )
+			FreeBins[Bin]->FreePrev = Item;
+		FreeBins[Bin]   = Item;
+	}
+	unguardSlow;
+}
+
+//
+// Find free space with room for Size bytes at an alignment, or NULL.
+//
+FMemCache::FCacheItem* FMemCache::FindFreeSpace( INT Size, INT Alignment )
+{
+	guardSlow(FMemCache::FindFreeSpace);
+	for( INT Bin=FloorLog2(Size); Bin<FREE_BINS; Bin++ )
+		for( FCacheItem* Item=FreeBins[Bin]; Item; Item=Item->FreeNext )
+			if( Item->LinearNext->Data - Align(Item->Data,Alignment) >= Size )
+				return Item;
+	return NULL;
+	unguardSlow;
+}
+
 /*-----------------------------------------------------------------------------
 	Init & Exit.
 -----------------------------------------------------------------------------*/
@@ -35,6 +126,15 @@ void FMemCache::Init
 	ItemsTotal = MaxItems;
 	MruId      = 0;
 	MruItem    = NULL;
+	Time       = 0;
+	NumGets = GetCycles = NumCreates = CreateCycles = TickCycles = 0;
+	for( INT i=0; i<FREE_BINS; i++ )
+		FreeBins[i] = NULL;
+
+	// Build the decay table.
+	DecayTable[0] = 1<<24;
+	for( INT i=1; i<DECAY_STEPS; i++ )
+		DecayTable[i] = DecayTable[i-1] - (DecayTable[i-1]>>5);
 
 	// Allocate cache memory.
 	if( Start ) CacheMemory = (BYTE *)Start;
@@ -102,6 +202,11 @@ void FMemCache::Init
 	for(int i=0; i<HASH_COUNT; i++ )
 		HashItems[i] = NULL;
 
+	// File the free space, now the segments are all linked.
+	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
+		FreeRelink( Item );
+	Hand = CacheItems;
+
 	// Success.
 	Initialized=1;
 	CheckState();
@@ -119,6 +224,11 @@ void FMemCache::Exit( int FreeMemory )
 	// Release all memory.
 	appFree( ItemMemory );
 	if( FreeMemory ) appFree( CacheMemory );
+	if( Record )
+	{
+		delete Record;
+		Record = NULL;
+	}
 
 	// Success.
 	Initialized = 0;
@@ -150,8 +260,12 @@ inline FMemCache::FCacheItem* FMemCache::MergeWithNext( FCacheItem* First )
 	debug( First->Segment == Second->Segment );
 
 	// Absorb the second item into the first.
+	FreeUnlink( Second );
 	First->LinearNext             = Second->LinearNext;
 	First->LinearNext->LinearPrev = First;
+	FreeRelink( First );
+	if( Hand == Second )
+		Hand = First;
 
 	// Stick the second item at the head of the unused list.
 	Second->LinearNext            = UnusedItems;
@@ -185,6 +299,8 @@ FMemCache::FCacheItem* FMemCache::FlushItem( FCacheItem* Item, UBOOL IgnoreLocke
 		// If next item is free space, merge with it.
 		if( Item->LinearNext && Item->LinearNext->Id==0 && Item->Segment==Item->LinearNext->Segment )
 			Item = MergeWithNext( Item );
+
+		FreeRelink( Item );
 	}
 	else if( !IgnoreLocked )
 	{
@@ -209,7 +325,7 @@ void FMemCache::CheckState()
 	check( CacheItems != NULL );
 
 	// Init stats.
-	INT ItemCount=0, UsedItemCount=0, WasFree=0, HashCount=0, MemoryCount=0, PrevSegment=-1;
+	INT ItemCount=0, UsedItemCount=0, WasFree=0, HashCount=0, MemoryCount=0, PrevSegment=-1, FreeCount=0, FiledCount=0;
 	BYTE* ExpectedPointer = CacheMemory;
 
 	// Traverse all cache items.
@@ -236,6 +352,14 @@ void FMemCache::CheckState()
 		WasFree     = (Item->Id == 0);
 		PrevSegment = Item->Segment;
 
+		// Make sure free space is filed by size, and nothing else is.
+		if( Item->Id==0 && Size>0 )
+		{
+			FreeCount++;
+			check( Item->FreeBin==FloorLog2(Size) );
+		}
+		else check( Item->FreeBin==FREE_NONE );
+
 		// Verify previous link.
 		if( Item != CacheItems )
 		{
@@ -286,6 +410,20 @@ void FMemCache::CheckState()
 	check( HashCount == UsedItemCount );
 	unguard;
 
+	// Make sure the free lists hold exactly the free space.
+	guard(4);
+	for( INT i=0; i<FREE_BINS; i++ )
+	{
+		for( FCacheItem* Item=FreeBins[i]; Item; Item=Item->FreeNext )
+		{
+			FiledCount++;
+			check( Item->FreeBin==i );
+			check( Item->FreePrev ? Item->FreePrev->FreeNext==Item : FreeBins[i]==Item );
+		}
+	}
+	check( FiledCount == FreeCount );
+	unguard;
+
 	// Success.
 	unguard;
 }
@@ -319,6 +457,7 @@ void FMemCache::CreateNewFreeSpace
 	{
 		// The next item is free space, so merge with it.
 		Next->Data = Start;
+		FreeRelink( Next );
 	}
 	else
 	{
@@ -338,6 +477,9 @@ void FMemCache::CreateNewFreeSpace
 		Item->LinearNext	= Next;
 		Item->LinearPrev	= Prev;
 		Item->HashNext		= NULL;
+		Item->FreeBin		= FREE_NONE;
+		Item->FreeNext		= NULL;
+		Item->FreePrev		= NULL;
 
 		// Link it in.
 		if( Prev )
@@ -346,7 +488,10 @@ void FMemCache::CreateNewFreeSpace
 			CacheItems = Item;
 
 		if( Next )
+		{
 			Next->LinearPrev = Item;
+			FreeRelink( Item );
+		}
 	}
 	unguard;
 }
@@ -429,65 +574,106 @@ void FMemCache::Flush( QWORD Id, DWORD Mask, UBOOL IgnoreLocked )
 -----------------------------------------------------------------------------*/
 
 //
-// Create an element in the cache.
+// Find the cheapest run of contiguous items from Start on with room for
+// Size bytes at an alignment, giving up once Limit usable runs have been
+// seen. Returns the number of usable runs seen.
 //
-// This is O(num_items_in_cache), sacrificing some speed in the
-// name of better cache efficiency. However there aren't any really
-// good algorithms for priority queues where most priorities change
-// every iteration this that I'm aware of.
-//
-BYTE* FMemCache::Create
+INT FMemCache::ScanRuns
 (
-	QWORD			Id, 
-	FCacheItem*&	Item, 
-	INT				CreateSize, 
+	FCacheItem*		Start,
+	INT				Size,
 	INT				Alignment,
-	INT				SafetyPad
+	INT				Limit,
+	SQWORD&			BestCost,
+	FCacheItem*&	BestFirst,
+	FCacheItem*&	BestLast
 )
 {
-	guard(FMemCache::Create);
-	uclock(CreateCycles);
-	check( Initialized );
-	check( CreateSize > 0 );
-	check( Id != 0 );
-	NumCreates++;
-
-	// Best cost and starting element found thus far.
-	SQWORD	    BestCost  = COST_INFINITE;
-	FCacheItem* BestFirst = NULL;
-	FCacheItem* BestLast  = NULL;
+	guard(FMemCache::ScanRuns);
+	INT Runs=0;
 
 	// Iterate through items. Find shortest contiguous sets of items
 	// which contain enough space for this entry. Evaluate the sum cost
 	// for each set, remembering the best cost.
 	SQWORD Cost=0;
-	FCacheItem* First=CacheItems;
-	for( FCacheItem* Last=CacheItems; Last!=LastItem; Last=Last->LinearNext )
+	FCacheItem* First=Start;
+	for( FCacheItem* Last=Start; Last!=LastItem && Runs<Limit; Last=Last->LinearNext )
 	{
 		// Add the cost and size of new Last element to our accumulator.
-		Cost += Last->Cost;
+		Cost += AgedCost( Last );
 
 		// While the interval from First to Last (inclusive) contains
 		// enough space for the item we're creating, consider it as a
 		// candidate, and go to the next First.
-		while( First && (Last->LinearNext->Data - Align(First->Data,Alignment) >= (CreateSize+SafetyPad)) )
+		while( First && (Last->LinearNext->Data - Align(First->Data,Alignment) >= Size) )
 		{
 			// Is this the best solution so far?
-			if( Cost<BestCost && First->Segment==Last->Segment )
+			if( Cost<COST_INFINITE && First->Segment==Last->Segment )
 			{
-				BestCost  = Cost;
-				BestFirst = First;
-				BestLast  = Last;
+				Runs++;
+				if( Cost<BestCost )
+				{
+					BestCost  = Cost;
+					BestFirst = First;
+					BestLast  = Last;
+				}
 			}
 
 			// Subtract the cost and size from the element we're passing:
-			Cost -= First->Cost;
+			Cost -= AgedCost( First );
 			debug(Cost>=0);
 
 			// Go to next First.
 			First = First->LinearNext;
 		}
 	}
+	return Runs;
+	unguard;
+}
+
+//
+// Create an element in the cache.
+//
+// Free space that fits is taken from the free lists by size. Otherwise the
+// cheapest run of items to evict is chosen from the next EVICT_RUNS
+// candidates past the last allocation, clock style, rather than from the
+// whole cache.
+//
+BYTE* FMemCache::Create
+(
+	QWORD			Id, 
+	FCacheItem*&	Item, 
+	INT				CreateSize, 
+	INT				Alignment,
+	INT				SafetyPad
+)
+{
+	guard(FMemCache::Create);
+	uclock(CreateCycles);
+	check( Initialized );
+	check( CreateSize > 0 );
+	check( Id != 0 );
+	NumCreates++;
+	if( Record )
+		RecordOp( Id, CreateSize, Alignment, SafetyPad );
+
+	// Best cost and starting element found thus far.
+	SQWORD	    BestCost  = COST_INFINITE;
+	FCacheItem* BestFirst = NULL;
+	FCacheItem* BestLast  = NULL;
+
+	if( FullScan )
+	{
+		// Consider every run in the cache.
+		ScanRuns( CacheItems, CreateSize+SafetyPad, Alignment, MAXINT, BestCost, BestFirst, BestLast );
+	}
+	else if( (BestFirst = BestLast = FindFreeSpace( CreateSize+SafetyPad, Alignment ))==NULL )
+	{
+		// Evict from the hand onwards, wrapping around to the start if need be.
+		INT Runs = ScanRuns( Hand, CreateSize+SafetyPad, Alignment, EVICT_RUNS, BestCost, BestFirst, BestLast );
+		if( Runs<EVICT_RUNS && Hand!=CacheItems )
+			ScanRuns( CacheItems, CreateSize+SafetyPad, Alignment, EVICT_RUNS-Runs, BestCost, BestFirst, BestLast );
+	}
 
 	// See if we found a suitable place to put the item.
 	if( BestFirst == NULL )
@@ -524,7 +710,8 @@ BYTE* FMemCache::Create
 	debug( ((INT)Result & (Alignment-1)) == 0 );
 
 	// Claim BestFirst for the block we're creating, and lock it.
-	BestFirst->Time = (FCacheItem::TCacheTime)Time;
+	FreeUnlink( BestFirst );
+	BestFirst->Time = Time;
 	BestFirst->Id   = Id;
 	BestFirst->Cost = CreateSize + COST_INFINITE;
 
@@ -562,8 +749,9 @@ BYTE* FMemCache::Create
 		BestFirst->Data = Result;
 	}
 
-	// Set the resulting Item.
+	// Set the resulting Item, and continue evicting after it.
 	Item = BestFirst;
+	Hand = BestFirst->LinearNext!=LastItem ? BestFirst->LinearNext : CacheItems;
 
 	ConditionalCheckState();
 	uunclock(CreateCycles);
@@ -577,7 +765,8 @@ BYTE* FMemCache::Create
 -----------------------------------------------------------------------------*/
 
 //
-// Handle time passing.
+// Handle time passing. Items age when their cost is next needed, so this
+// doesn't visit them.
 //
 void FMemCache::Tick()
 {
@@ -586,44 +775,84 @@ void FMemCache::Tick()
 	ConditionalCheckState();
 	MruId     = 0;
 	MruItem   = NULL;
+	if( Record )
+		RecordOp( 0, -1, 0, 0 );
 
-	// Init memory stats.
-	MemFresh = MemStale = 0;
-	ItemsFresh = ItemsStale = ItemGaps = 0;
-
-	// Check each item.
+#if CHECK_ALL || defined(_DEBUG)
 	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
-	{
-		if( Item->Id == 0 )
-		{
-			ItemGaps++;
-		}
-		else if( Item->Cost >= COST_INFINITE )
-		{
+		if( Item->Id!=0 && Item->Cost>=COST_INFINITE )
 			appErrorf( "Cache item %08X still locked in call to Tick", Item->Id );
-		}
-		else if( Time - Item->Time > 1)
+#endif
+
+	// Update the cache's time.
+	Time++;
+	uunclock(TickCycles);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Cache benchmark.
+-----------------------------------------------------------------------------*/
+
+void FMemCache::RecordOp( QWORD Id, INT Size, INT Alignment, INT SafetyPad )
+{
+	guardSlow(FMemCache::RecordOp);
+	FCacheOp& Op  = (*Record)( Record->Add() );
+	Op.Id         = Id;
+	Op.Size       = Size;
+	Op.Alignment  = Alignment;
+	Op.SafetyPad  = SafetyPad;
+	unguardSlow;
+}
+
+//
+// Replay the recorded calls through a new cache the same size as this one,
+// which unlocks each item straight away. An item that was found in the
+// recording but is missing here is created again with its recorded size.
+//
+void FMemCache::Replay( UBOOL InFullScan, INT& NumCreated, DOUBLE& TotalMs, DOUBLE& CreateMs, DOUBLE& TickMs )
+{
+	guard(FMemCache::Replay);
+	FMemCache* Test = new FMemCache;
+	Test->FullScan  = InFullScan;
+	Test->Init( MemTotal, ItemsTotal );
+
+	// Index of the last create of each Id, for its size.
+	TMap<QWORD,INT> Creates;
+	DOUBLE CreateCycles=0.0, TickCycles=0.0, Start=appSeconds();
+	DWORD  OpStart;
+	for( INT i=0; i<Record->Num(); i++ )
+	{
+		FCacheOp&   Op = (*Record)(i);
+		FCacheItem* Item;
+		INT         iCreate;
+		if( Op.Size>0 )
+			Creates.Add( Op.Id, i );
+		if( Op.Size<0 )
 		{
-			// Exponentially decrease Cost for stale items.
-			Item->Cost -= Item->Cost >> 5;
-			MemStale   += Item->LinearNext->Data - Item->Data;
-			ItemsStale++;
+			OpStart     = appCycles();
+			Test->Tick();
+			TickCycles += appCycles() - OpStart;
 		}
-		else if( Time - Item->Time == 1)
+		else if( Test->Get( Op.Id, Item ) )
 		{
-			// Cut Cost by 1/4th as soon as it first becomes stale.
-			Item->Cost = Item->Cost >> 2;
+			Item->Unlock();
 		}
-		else
+		else if( Creates.Find( Op.Id, iCreate ) )
 		{
-			MemFresh += Item->LinearNext->Data - Item->Data;
-			ItemsFresh++;
+			FCacheOp& Create = (*Record)(iCreate);
+			OpStart       = appCycles();
+			Test->Create( Op.Id, Item, Create.Size, Create.Alignment, Create.SafetyPad );
+			CreateCycles += appCycles() - OpStart;
+			Item->Unlock();
 		}
 	}
-
-	// Update the cache's time.
-	Time++;
-	uunclock(TickCycles);
+	TotalMs    = (appSeconds() - Start) * 1000.0;
+	NumCreated = Test->NumCreates;
+	CreateMs   = CreateCycles * GSecondsPerCycle * 1000.0;
+	TickMs     = TickCycles * GSecondsPerCycle * 1000.0;
+	Test->Exit( 1 );
+	delete Test;
 	unguard;
 }
 
@@ -651,6 +880,57 @@ UBOOL FMemCache::Exec( const char* Cmd, FOutputDevice* Out )
 		}
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,"CACHEBENCH") )
+	{
+		if( ParseCommand(&Cmd,"START") )
+		{
+			if( !Record )
+				Record = new TArray<FCacheOp>;
+			Record->Empty();
+			Out->Log( "Cache benchmark started" );
+		}
+		else if( ParseCommand(&Cmd,"STOP") )
+		{
+			if( !Record )
+			{
+				Out->Log( NAME_ExecWarning, "Cache benchmark isn't recording" );
+				return 1;
+			}
+			INT Gets=0, Creates=0, Ticks=0;
+			for( INT i=0; i<Record->Num(); i++ )
+			{
+				if( (*Record)(i).Size<0 )
+					Ticks++;
+				else if( (*Record)(i).Size==0 )
+					Gets++;
+				else
+					Creates++;
+			}
+			Out->Logf( "Cache benchmark: %i gets, %i creates, %i ticks, %iK cache", Gets, Creates, Ticks, MemTotal/1024 );
+
+			// Replay with and without the free lists and bounded eviction search.
+			static const char* ModeNames[] = { "bounded", "full scan" };
+			for( INT Mode=0; Mode<2; Mode++ )
+			{
+				INT    ReplayCreates;
+				DOUBLE TotalMs, CreateMs, TickMs;
+				Replay( Mode, ReplayCreates, TotalMs, CreateMs, TickMs );
+				Out->Logf
+				(
+					"   %-9s: %8.2f ms, %6i creates in %8.2f ms, ticks %6.2f ms",
+					ModeNames[Mode],
+					TotalMs,
+					ReplayCreates,
+					CreateMs,
+					TickMs
+				);
+			}
+			delete Record;
+			Record = NULL;
+		}
+		else Out->Log( "Usage: CACHEBENCH START | STOP" );
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
@@ -664,6 +944,28 @@ UBOOL FMemCache::Exec( const char* Cmd, FOutputDevice* Out )
 //
 void FMemCache::Status( char *StatusText )
 {
+	// Count fresh and stale memory, which Tick doesn't.
+	MemFresh = MemStale = 0;
+	ItemsFresh = ItemsStale = ItemGaps = 0;
+	for( FCacheItem* Item=CacheItems; Item!=LastItem; Item=Item->LinearNext )
+	{
+		INT Size = Item->LinearNext->Data - Item->Data;
+		if( Item->Id == 0 )
+		{
+			ItemGaps++;
+		}
+		else if( Time - Item->Time >= 1 )
+		{
+			MemStale += Size;
+			ItemsStale++;
+		}
+		else
+		{
+			MemFresh += Size;
+			ItemsFresh++;
+		}
+	}
+
 	// Display stats.
 	appSprintf
 	(
@@ -1349,6 +1349,7 @@ void UStruct::PostLoad()
 	UField::PostLoad();
 	if( !GIsEditor )
 		BuildVfHashes( this );
+	GScriptCallCache.Flush();
 	unguard;
 }
 
@@ -1379,6 +1380,13 @@ void UFunction::PostLoad()
 {
 	guard(UFunction::PostLoad);
 	UStruct::PostLoad();
+
+	// Precompute frame flags.
+	FrameFlags = FRAME_Linked;
+	for( TFieldIterator<UProperty> It(this); It && (It->PropertyFlags & CPF_Parm); ++It )
+		if( It->PropertyFlags & (CPF_OutParm|CPF_ReturnParm) )
+			FrameFlags |= FRAME_OutParms;
+
 	unguard;
 }
 UProperty* UFunction::GetReturnProperty()
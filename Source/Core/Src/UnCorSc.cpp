@@ -18,6 +18,7 @@ Revision history:
 
 CORE_API void (UObject::*GIntrinsics[EX_Max])( FFrame &Stack, BYTE *&Result );
 CORE_API int GIntrinsicDuplicate=0;
+CORE_API FScriptCallCache GScriptCallCache;
 
 #if DO_SLOW_GUARD
 	static int Runaway=0;
@@ -32,6 +33,15 @@ CORE_API int GIntrinsicDuplicate=0;
 	FFrame implementation.
 -----------------------------------------------------------------------------*/
 
+//
+// Allocate the locals of a script function call from the current thread's
+// memory stack. Not zeroed: callers fill in the parameters and zero the rest.
+//
+static inline BYTE* NewScriptFrame( UFunction* Function )
+{
+	return New<BYTE>( GMem, Function->GetPropertiesSize() );
+}
+
 void CDECL FFrame::ScriptWarn( UBOOL Critical, char* Fmt, ... )
 {
 	char TempStr[4096];
@@ -537,7 +547,7 @@ void UObject::execVirtualFunction( FFrame& Stack, BYTE*& Result )
 	guardSlow(UObject::execVirtualFunction);
 
 	// Call the virtual function.
-	CallFunction( Stack, Result, FindFunctionChecked(Stack.ReadName()) );
+	CallFunction( Stack, Result, GScriptCallCache.FindFunction(this,Stack,0) );
 
 	unguardexecSlow;
 }
@@ -559,7 +569,7 @@ void UObject::execGlobalFunction( FFrame& Stack, BYTE*& Result )
 	guardSlow(UObject::execGlobalFunction);
 
 	// Call global version of virtual function.
-	CallFunction( Stack, Result, FindFunctionChecked(Stack.ReadName(),1) );
+	CallFunction( Stack, Result, GScriptCallCache.FindFunction(this,Stack,1) );
 
 	unguardexecSlow;
 }
@@ -2747,6 +2757,9 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 #if DO_SLOW_GUARD
 	DWORD Cycles=0; uclock(Cycles);
 #endif
+	UBOOL Profiled = GScriptProfiler.Active;
+	if( Profiled )
+		GScriptProfiler.Enter( Function );
 
 	// Found it.
 	if( Function->iIntrinsic )
@@ -2773,9 +2786,10 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 	}
 	else
 	{
-		// Make new stack frame in the current context.
+		// Make new stack frame in the current context. Parameters are evaluated
+		// straight into it, so only skipped ones and the locals need zeroing.
 		FMemMark Mark(GMem);
-		FFrame NewStack( this, Function, 0, NewZeroed<BYTE>(GMem,Function->GetPropertiesSize()) );
+		FFrame NewStack( this, Function, 0, NewScriptFrame(Function) );
 		debug(*NewStack.Code==EX_BeginFunction);
 		NewStack.Code++;
 		BYTE* Dest = NewStack.Locals;
@@ -2784,6 +2798,8 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 		{
 			debug(*NewStack.Code==0 || *NewStack.Code==1);
 			Out->Src = Out->Dest = Dest;
+			if( *Stack.Code == EX_Nothing )
+				appMemset( Dest, 0, Out->Size );
 			Stack.Step( Stack.Object, Out->Dest );
 			if( Out->Dest != Dest )
 				appMemcpy( Dest, Out->Dest, Out->Size );
@@ -2792,6 +2808,7 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 		}
 		debug(*Stack.Code==EX_EndFunctionParms);
 		Stack.Code++;
+		appMemset( Dest, 0, NewStack.Locals + Function->GetPropertiesSize() - Dest );
 
 		// Execute the code.
 		ProcessInternal( NewStack );
@@ -2806,6 +2823,8 @@ void UObject::CallFunction( FFrame& Stack, BYTE*& Result, UFunction* Function )
 		// Release temp memory.
 		Mark.Pop();
 	}
+	if( Profiled )
+		GScriptProfiler.Leave();
 #if DO_SLOW_GUARD
 	uunclock(Cycles);
 	Function->Cycles += Cycles;
@@ -2862,6 +2881,9 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 	debug(Function->ParmsSize==0 || Parms!=NULL);
 	if( ++GScriptEntryTag == 1 )
 		uclock(GScriptCycles);
+	UBOOL Profiled = GScriptProfiler.Active;
+	if( Profiled )
+		GScriptProfiler.Enter( Function, 1 );
 
 	// Call the function.
 	if
@@ -2870,8 +2892,9 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 	{
 		// Create a new local execution stack.
 		FMemMark Mark(GMem);
-		FFrame NewStack( this, Function, 0, new(GMem,MEM_Zeroed,Function->GetPropertiesSize())BYTE );
+		FFrame NewStack( this, Function, 0, NewScriptFrame(Function) );
 		appMemcpy( NewStack.Locals, Parms, Function->ParmsSize );
+		appMemset( NewStack.Locals + Function->ParmsSize, 0, Function->GetPropertiesSize() - Function->ParmsSize );
 		if( !(Function->FunctionFlags & FUNC_Intrinsic) )
 		{
 			// Skip the parm info in the script code.
@@ -2890,12 +2913,15 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms )
 				appMemcpy( Dest, Result, Function->ParmsSize - Function->ReturnValueOffset );
 		}
 
-		// Copy everything back.
-		appMemcpy( Parms, NewStack.Locals, Function->ParmsSize );
+		// Copy out parameters and the return value back.
+		if( Function->NeedsCopyBack() )
+			appMemcpy( Parms, NewStack.Locals, Function->ParmsSize );
 
 		// Restore locals bin.
 		Mark.Pop();
 	}
+	if( Profiled )
+		GScriptProfiler.Leave();
 	if( --GScriptEntryTag == 0 )
 		uunclock(GScriptCycles);
 	unguardf(( "(%s, %s)", GetFullName(), Function->GetFullName() ));
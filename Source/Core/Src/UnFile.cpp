@@ -489,7 +489,6 @@ CORE_API TArray<FString> appFindFiles( const char* Spec )
 		appSprintf( Path, "./" );
 
 	// Open directory, get first entry.
-	printf("%s\n", Path);
 	Dirp = opendir( Path );
 	if (Dirp == NULL)
 			return Result;
@@ -567,71 +566,129 @@ CORE_API TArray<FString> appFindFiles( const char* Spec )
 	unguard;
 }
 
+#ifdef PLATFORM_CASE_SENSITIVE_FS
+
 //
-// Standard file functions.
+// Index for opening files whose names are in the wrong case. Each path that
+// a lookup has gone through is keyed by its name, which FString compares and
+// hashes without case, and maps to the name as spelled on disk. A directory
+// is read the first time a lookup goes through it. The engine drops the index
+// whenever it creates, moves or deletes files; a file renamed behind its back
+// may not be found in the wrong case until then.
 //
-CORE_API FILE* appFopen( const char* Path, const char* Mode )
+static TMap<FString,FString> GFileIndex;
+static TMap<FString,UBOOL>   GIndexedDirs;
+
+static FMutex& FileIndexMutex()
 {
-	FILE* F = fopen( Path, Mode );
-	printf("%s\n", Path);
-#ifdef PLATFORM_CASE_SENSITIVE_FS
-	if( F ) return F;
+	static FMutex Mutex( "FileIndex" );
+	return Mutex;
+}
 
-	// Don't search if we're creating the file.
-	if( Mode[0] != 'r' )
-		return F;
+static void JoinPath( char* Result, INT MaxLen, const char* Dir, const char* Name )
+{
+	INT Len = appStrlen( Dir );
+	snprintf( Result, MaxLen, "%s%s%s", Dir, (Len && Dir[Len-1]!='/') ? "/" : "", Name );
+}
 
-	// Case-insensitive search.
-	char DirNameBuf[1024], TmpName[1024];
-	appStrncpy( DirNameBuf, Path, sizeof(DirNameBuf) - 1 );
+//
+// Add a directory's entries to the index, if they aren't there already.
+// Dir is spelled as on disk; an empty one is the current directory.
+//
+static void IndexDirectory( const char* Dir )
+{
+	FString Key( Dir );
+	if( GIndexedDirs.FindIndex( Key )!=INDEX_NONE )
+		return;
+	GIndexedDirs.Add( Key, 1 );
 
-	// Fixup slashes.
-	for( char* Ch = DirNameBuf; *Ch; ++Ch )
+	DIR* D = opendir( *Dir ? Dir : "." );
+	if( !D )
+		return;
+	char Name[1024];
+	for( struct dirent* Ent=readdir(D); Ent; Ent=readdir(D) )
 	{
+		// If names differ only in case, the first one read wins.
+		JoinPath( Name, sizeof(Name), Dir, Ent->d_name );
+		FString Real( Name );
+		if( GFileIndex.FindIndex( Real )==INDEX_NONE )
+			GFileIndex.Add( Real, Real );
+	}
+	closedir( D );
+}
+
+//
+// Find the on-disk spelling of a path in any case. Returns 0 if some part of
+// it doesn't exist.
+//
+static UBOOL ResolvePath( const char* Path, char* Result, INT MaxLen )
+{
+	char Temp[1024], Real[1024], Next[1024];
+	appStrncpy( Temp, Path, sizeof(Temp) );
+	for( char* Ch=Temp; *Ch; Ch++ )
 		if( *Ch == '\\' )
 			*Ch = '/';
-	}
 
-	// Find the directory path by terminating path at the last slash, if any.
-	const char* DirName = NULL;
-	const char* FileName = NULL;
-	char* Slash = (char*)strrchr( DirNameBuf, '/' );
-	if( Slash )
+	// Walk the path a component at a time, so directories may be in the wrong case too.
+	char* Comp = Temp;
+	appStrcpy( Real, *Comp=='/' ? "/" : "" );
+	while( *Comp )
 	{
-		*Slash = '\0';
-		DirName = DirNameBuf;
-		FileName = Slash + 1;
-		// HACK: Canonicalize the first char of the directory name (e.g. ../maps -> ../Maps).
-		char* DirStart = DirNameBuf;
-		if( *DirStart == '.' )
+		char* End = appStrchr( Comp, '/' );
+		if( End )
+			*End = '\0';
+		if( *Comp )
 		{
-			while( *DirStart == '/' || *DirStart == '.' )
-				DirStart++;
-			if( *DirStart )
-				*DirStart = toupper( *DirStart );
+			IndexDirectory( Real );
+			JoinPath( Next, sizeof(Next), Real, Comp );
+			FString* Found = GFileIndex.Find( FString(Next) );
+			if( !Found )
+				return 0;
+			appStrncpy( Real, **Found, sizeof(Real) );
 		}
+		if( !End )
+			break;
+		Comp = End + 1;
 	}
-	else
-	{
-		DirName = "./";
-		FileName = DirNameBuf;
-	}
-printf("open%s\n", DirName);
-	// Scan the directory.
-	DIR* Dir = opendir( DirName );
-	if( !Dir ) return F;
-	struct dirent* Ent = readdir( Dir );
-	while( Ent )
+	appStrncpy( Result, Real, MaxLen );
+	return 1;
+}
+
+#endif
+
+//
+// Forget which files exist. Called when the engine changes the file system.
+//
+CORE_API void appResetFileIndex()
+{
+#ifdef PLATFORM_CASE_SENSITIVE_FS
+	FScopedLock Lock( FileIndexMutex() );
+	GFileIndex.Empty();
+	GIndexedDirs.Empty();
+#endif
+}
+
+//
+// Standard file functions.
+//
+CORE_API FILE* appFopen( const char* Path, const char* Mode )
+{
+	FILE* F = fopen( Path, Mode );
+#ifdef PLATFORM_CASE_SENSITIVE_FS
+	// Don't search if we're creating the file, but its directory must be read again.
+	if( Mode[0] != 'r' )
 	{
-		if( appStricmp( Ent->d_name, FileName ) == 0 )
-		{
-			snprintf( TmpName, sizeof(TmpName), "%s/%s", DirName, Ent->d_name );
-			F = fopen( TmpName, Mode );
-			break;
-		}
-		Ent = readdir( Dir );
+		appResetFileIndex();
+		return F;
 	}
-	closedir( Dir );
+	if( F )
+		return F;
+
+	// Case-insensitive search.
+	char RealPath[1024];
+	FScopedLock Lock( FileIndexMutex() );
+	if( ResolvePath( Path, RealPath, sizeof(RealPath) ) )
+		F = fopen( RealPath, Mode );
 #endif
 
 	return F;
@@ -654,6 +711,7 @@ CORE_API INT appFwrite( const void* Buffer, INT Size, INT Count, FILE* Stream )
 }
 CORE_API INT appUnlink( const char* Filename )
 {
+	appResetFileIndex();
 	return unlink(Filename);
 }
 CORE_API INT appFread( void* Buffer, INT Size, INT Count, FILE* Stream )
@@ -666,6 +724,7 @@ CORE_API INT appFerror( FILE* F )
 }
 CORE_API INT appMkdir( const char* Dirname )
 {
+	appResetFileIndex();
 #ifdef PLATFORM_WIN32
 	return mkdir( Dirname );
 #else
@@ -678,6 +737,7 @@ CORE_API char* appGetcwd( char* Buffer, INT MaxLen )
 }
 CORE_API INT appChdir( const char* Dirname )
 {
+	appResetFileIndex();
 	return chdir( Dirname );
 }
 CORE_API INT appFprintf( FILE* F, const char* Fmt, ... )
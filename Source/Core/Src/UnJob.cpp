@@ -0,0 +1,364 @@
+/*=============================================================================
+	UnJob.cpp: Job system.
+=============================================================================*/
+
+#include "CorePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	ParallelFor support.
+-----------------------------------------------------------------------------*/
+
+//
+// Shared state of one ParallelFor call. Every participant grabs batches
+// off NextIndex until the range is exhausted.
+//
+struct FParallelForTask
+{
+	PARALLEL_FUNC	Func;
+	void*			Arg;
+	INT				Count;
+	INT				BatchSize;
+	volatile INT	NextIndex;
+};
+
+static void ParallelForRun( FParallelForTask* Task )
+{
+	for( ; ; )
+	{
+		INT End = appInterlockedAdd( &Task->NextIndex, Task->BatchSize );
+		INT Start = End - Task->BatchSize;
+		if( Start >= Task->Count )
+			break;
+		Task->Func( Task->Arg, Start, Min( End, Task->Count ) );
+	}
+}
+
+static void ParallelForJob( void* Arg )
+{
+	ParallelForRun( (FParallelForTask*)Arg );
+}
+
+/*-----------------------------------------------------------------------------
+	FJobSystem init/exit.
+-----------------------------------------------------------------------------*/
+
+FJobSystem::FJobSystem()
+:	NumWorkers		( 0 )
+,	Initialized		( 0 )
+,	Exiting			( 0 )
+,	ThreadSlot		( 0 )
+,	WakeSemaphore	( NULL )
+,	DependencyMutex	( NULL )
+,	Queues			( NULL )
+{}
+
+void FJobSystem::Init( INT InNumThreads )
+{
+	guard(FJobSystem::Init);
+	check(!Initialized);
+
+	if( InNumThreads <= 0 )
+		InNumThreads = GProcessorCount;
+	Parse( appCmdLine(), "JOBTHREADS=", InNumThreads );
+	NumWorkers  = Clamp( InNumThreads, 1, (INT)MAX_JOB_THREADS ) - 1;
+	Exiting     = 0;
+	Initialized = 1;
+
+	if( NumWorkers > 0 )
+	{
+		ThreadSlot      = appTlsAlloc();
+		WakeSemaphore   = appSemaphoreCreate( "JobWake", 0 );
+		DependencyMutex = appMutexCreate( "JobDependency" );
+		check(WakeSemaphore);
+		check(DependencyMutex);
+
+		// Queue 0 belongs to the game thread and any other non-worker thread.
+		Queues = (FJobQueue*)appMalloc( (NumWorkers+1) * sizeof(FJobQueue), "JobQueues" );
+		for( INT i=0; i<=NumWorkers; i++ )
+		{
+			Queues[i].Mutex = appMutexCreate( "JobQueue" );
+			Queues[i].Head  = 0;
+			Queues[i].Tail  = 0;
+			check(Queues[i].Mutex);
+		}
+
+		for( INT i=1; i<=NumWorkers; i++ )
+		{
+			Workers[i].System = this;
+			Workers[i].Index  = i;
+			Workers[i].Thread = appThreadSpawn( WorkerThreadProc, &Workers[i], "JobWorker", 0, NULL );
+			if( !Workers[i].Thread )
+				appErrorf( "Failed to spawn job worker thread %i", i );
+		}
+	}
+
+	debugf( NAME_Init, "Job system: %i thread(s)", NumWorkers+1 );
+	unguard;
+}
+
+void FJobSystem::Exit()
+{
+	guard(FJobSystem::Exit);
+	if( !Initialized )
+		return;
+
+	if( NumWorkers > 0 )
+	{
+		// Let the workers drain their queues and leave.
+		appInterlockedIncrement( &Exiting );
+		appSemaphorePost( WakeSemaphore, NumWorkers );
+		for( INT i=1; i<=NumWorkers; i++ )
+			appThreadJoin( Workers[i].Thread );
+
+		for( INT i=0; i<=NumWorkers; i++ )
+			appMutexFree( Queues[i].Mutex );
+		appFree( Queues );
+		Queues = NULL;
+		appMutexFree( DependencyMutex );
+		DependencyMutex = NULL;
+		appSemaphoreFree( WakeSemaphore );
+		WakeSemaphore = NULL;
+		appTlsFree( ThreadSlot );
+	}
+
+	NumWorkers  = 0;
+	Initialized = 0;
+	debugf( NAME_Exit, "Job system shut down" );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FJobSystem interface.
+-----------------------------------------------------------------------------*/
+
+//
+// Index of the calling thread: 0 for the game thread or any other thread
+// that isn't a worker, 1..NumWorkers for workers.
+//
+INT FJobSystem::GetThreadIndex() const
+{
+	return NumWorkers ? (INT)(size_t)appTlsGet( ThreadSlot ) : 0;
+}
+
+void FJobSystem::Dispatch( JOB_FUNC Func, void* Arg, FJobCounter* Counter, FJobCounter* Dependency )
+{
+	guardSlow(FJobSystem::Dispatch);
+	check(Func);
+
+	FJob Job;
+	Job.Func    = Func;
+	Job.Arg     = Arg;
+	Job.Counter = Counter;
+	Job.Next    = NULL;
+
+	if( Counter )
+		appInterlockedIncrement( &Counter->Count );
+
+	// Inline mode: everything dispatched earlier already ran, so any
+	// dependency is already satisfied.
+	if( NumWorkers == 0 )
+	{
+		Execute( Job );
+		return;
+	}
+
+	if( Dependency )
+	{
+		appMutexLock( DependencyMutex );
+		if( !Dependency->IsDone() )
+		{
+			FJob* Waiter = (FJob*)appMalloc( sizeof(FJob), "JobWaiter" );
+			*Waiter = Job;
+			Waiter->Next = Dependency->Waiters;
+			Dependency->Waiters = Waiter;
+			appMutexUnlock( DependencyMutex );
+			return;
+		}
+		appMutexUnlock( DependencyMutex );
+	}
+
+	Queue( Job );
+	unguardSlow;
+}
+
+void FJobSystem::Wait( FJobCounter& Counter )
+{
+	guard(FJobSystem::Wait);
+	INT Index = GetThreadIndex();
+	FJob Job;
+	while( !Counter.IsDone() )
+	{
+		if( GetJob( Index, Job ) )
+			Execute( Job );
+		else
+			appSleep( 0.f );
+	}
+	if( NumWorkers > 0 )
+	{
+		// Synchronize with the Finish that zeroed the counter.
+		appMutexLock( DependencyMutex );
+		appMutexUnlock( DependencyMutex );
+	}
+	unguard;
+}
+
+void FJobSystem::ParallelFor( INT Count, INT Granularity, PARALLEL_FUNC Func, void* Arg )
+{
+	guard(FJobSystem::ParallelFor);
+	if( Count <= 0 )
+		return;
+	Granularity = Max( Granularity, 1 );
+	if( NumWorkers == 0 || Count <= Granularity )
+	{
+		Func( Arg, 0, Count );
+		return;
+	}
+
+	// Aim for a few batches per thread so uneven work still balances.
+	FParallelForTask Task;
+	Task.Func      = Func;
+	Task.Arg       = Arg;
+	Task.Count     = Count;
+	Task.BatchSize = Max( Granularity, Count / ((NumWorkers+1)*4) );
+	Task.NextIndex = 0;
+
+	INT NumBatches = (Count + Task.BatchSize - 1) / Task.BatchSize;
+	INT NumHelpers = Min( NumWorkers, NumBatches-1 );
+	FJobCounter Counter;
+	for( INT i=0; i<NumHelpers; i++ )
+		Dispatch( ParallelForJob, &Task, &Counter );
+	ParallelForRun( &Task );
+	Wait( Counter );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FJobSystem internals.
+-----------------------------------------------------------------------------*/
+
+//
+// Push a job onto the calling thread's queue and wake a worker.
+//
+void FJobSystem::Queue( const FJob& Job )
+{
+	FJobQueue& Q = Queues[GetThreadIndex()];
+	appMutexLock( Q.Mutex );
+	if( Q.Tail == Q.Head )
+		Q.Tail = Q.Head = 0;
+	if( Q.Tail - Q.Head >= FJobQueue::MAX_JOBS )
+	{
+		// Full, so run it here rather than block.
+		appMutexUnlock( Q.Mutex );
+		Execute( Job );
+		return;
+	}
+	Q.Jobs[Q.Tail++ % FJobQueue::MAX_JOBS] = Job;
+	appMutexUnlock( Q.Mutex );
+	appSemaphorePost( WakeSemaphore, 1 );
+}
+
+//
+// Pop the newest job off our own queue, or steal the oldest one off another.
+//
+UBOOL FJobSystem::GetJob( INT Index, FJob& Job )
+{
+	FJobQueue& Own = Queues[Index];
+	appMutexLock( Own.Mutex );
+	if( Own.Tail != Own.Head )
+	{
+		Job = Own.Jobs[--Own.Tail % FJobQueue::MAX_JOBS];
+		appMutexUnlock( Own.Mutex );
+		return 1;
+	}
+	appMutexUnlock( Own.Mutex );
+
+	for( INT i=1; i<=NumWorkers; i++ )
+	{
+		FJobQueue& Victim = Queues[(Index+i) % (NumWorkers+1)];
+		if( Victim.Tail == Victim.Head )
+			continue;
+		appMutexLock( Victim.Mutex );
+		if( Victim.Tail != Victim.Head )
+		{
+			Job = Victim.Jobs[Victim.Head++ % FJobQueue::MAX_JOBS];
+			appMutexUnlock( Victim.Mutex );
+			return 1;
+		}
+		appMutexUnlock( Victim.Mutex );
+	}
+	return 0;
+}
+
+void FJobSystem::Execute( const FJob& Job )
+{
+	Job.Func( Job.Arg );
+	if( Job.Counter )
+		Finish( Job.Counter );
+}
+
+//
+// Retire one job of a counter and release its dependents once it hits zero.
+// The decrement happens under DependencyMutex so that Wait can't return (and
+// the counter go out of scope) while we're still looking at it.
+//
+void FJobSystem::Finish( FJobCounter* Counter )
+{
+	if( NumWorkers == 0 )
+	{
+		appInterlockedDecrement( &Counter->Count );
+		return;
+	}
+
+	FJob* Waiters = NULL;
+	appMutexLock( DependencyMutex );
+	if( appInterlockedDecrement( &Counter->Count ) == 0 )
+	{
+		Waiters = Counter->Waiters;
+		Counter->Waiters = NULL;
+	}
+	appMutexUnlock( DependencyMutex );
+
+	while( Waiters )
+	{
+		FJob* Next = Waiters->Next;
+		Waiters->Next = NULL;
+		Queue( *Waiters );
+		appFree( Waiters );
+		Waiters = Next;
+	}
+}
+
+THREAD_RET
+#ifdef PLATFORM_WIN32
+__stdcall
+#endif
+FJobSystem::WorkerThreadProc( void* Arg )
+{
+	FWorker* Worker = (FWorker*)Arg;
+	FJobSystem* System = Worker->System;
+	appTlsSet( System->ThreadSlot, (void*)(size_t)Worker->Index );
+	Worker->Mem.Init( 65536 );
+
+	FJob Job;
+	for( ; ; )
+	{
+		if( System->GetJob( Worker->Index, Job ) )
+		{
+			System->Execute( Job );
+		}
+		else if( System->Exiting )
+		{
+			break;
+		}
+		else
+		{
+			appSemaphoreWait( System->WakeSemaphore );
+		}
+	}
+	Worker->Mem.Exit();
+	return 0;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -225,16 +225,26 @@ struct FFileStatus
 };
 
 //
-// Ansi file loader.
+// Ansi file loader. Reads go through a read-ahead buffer, so the many small
+// reads and seeks of loading an export's properties only reach the file
+// when they leave the buffer; reads bigger than the buffer go straight to
+// the caller. -NOREADAHEAD reads and seeks the file for every call.
 //
+enum {LOADER_BUFFER_SIZE=65536};
 class FArchiveFileLoad : public FArchive
 {
 public:
 	char Filename[256];
 	INT Pos;
-	FArchiveFileLoad( const char* InFilename )
-	: File(NULL)
-	, Pos(0)
+	FArchiveFileLoad( const char* InFilename, UBOOL InBuffered=1 )
+	: Pos(0)
+	, File(NULL)
+	, Buffered(InBuffered)
+	, Buffer(NULL)
+	, BufferBase(0)
+	, BufferCount(0)
+	, FilePos(0)
+	, BenchFile(INDEX_NONE)
 	{
 		guard(FArchiveFileLoad::FArchiveFileLoad);
 		appStrcpy( Filename, InFilename );
@@ -244,10 +254,15 @@ public:
 		appFseek( File, 0, USEEK_END );
 		Eof = appFtell( File );
 		appFseek( File, 0, USEEK_SET );
+		if( Buffered )
+			Buffer = (BYTE*)appMalloc( LOADER_BUFFER_SIZE, "FArchiveFileLoad" );
+		if( GLoadBenchmark.Recording )
+			BenchFile = GLoadBenchmark.NoteFile( Filename );
 		unguard;
 	}
 	FArchiveFileLoad()
 	: File(NULL)
+	, Buffer(NULL)
 	{}
 	~FArchiveFileLoad()
 	{
@@ -255,6 +270,9 @@ public:
 		if( File )
 			appFclose( File );
 		File = NULL;
+		if( Buffer )
+			appFree( Buffer );
+		Buffer = NULL;
 		unguard;
 	}
 	void Seek( INT InPos, INT InReadAhead=0 )
@@ -262,41 +280,97 @@ public:
 		guard(FArchiveFileLoad::Seek);
 		check(InPos>=0);
 		check(InPos<=Eof);
-		INT Result = appFseek(File,InPos,USEEK_SET);
-		if( Result!=0 )
-			appErrorf( "Seek Failed %i/%i (%i): %i %i", InPos, Eof, Pos, Result, appFerror(File) );
+		if( BenchFile!=INDEX_NONE && GLoadBenchmark.Recording )
+			GLoadBenchmark.NoteSeek( BenchFile, InPos );
+		if( !Buffered )
+			SeekFile( InPos );
 		unguard;
 		Pos = InPos;
 	}
 	INT Tell()
 	{
-		return appFtell( File );
+		return Pos;
 	}
 	void Push( FFileStatus& St, BYTE* NewBuffer )
 	{
-		St.SavedPos = appFtell( File );
+		St.SavedPos = Pos;
 	}
 	void Pop( FFileStatus& St )
 	{
 		guardSlow(FArchiveFileLoad::Pop);
-		INT Result = appFseek( File, St.SavedPos, USEEK_SET );
-		if( Result!=0 )
-			appErrorf( "Seek Failed %i/%i (%i): %i %i", St.SavedPos, Eof, Pos, Result, appFerror(File) );
-		Pos = St.SavedPos;
+		Seek( St.SavedPos );
 		unguardSlow;
 	}
 	FArchive& Serialize( void* V, INT Length )
 	{
-		INT Count = appFread( V, Length, 1, File );
-		if( Count!=1 && Length!=0 )
-			appErrorf( "appFread failed: Count=%i Length=%i Error=%i", Count, Length, appFerror(File) );
-		Pos += Length;
+		if( BenchFile!=INDEX_NONE && GLoadBenchmark.Recording )
+			GLoadBenchmark.NoteRead( BenchFile, Pos, Length );
+		if( !Buffered )
+		{
+			ReadFile( Pos, V, Length );
+			Pos += Length;
+			check(Pos<=Eof);
+			return *this;
+		}
+		while( Length > 0 )
+		{
+			INT Offset = Pos - BufferBase;
+			if( Offset>=0 && Offset<BufferCount )
+			{
+				// Copy what the buffer has.
+				INT Copy = Min( Length, BufferCount-Offset );
+				appMemcpy( V, Buffer+Offset, Copy );
+				Pos    += Copy;
+				Length -= Copy;
+				V       = (BYTE*)V + Copy;
+			}
+			else if( Length >= LOADER_BUFFER_SIZE )
+			{
+				// Too big to be worth buffering.
+				ReadFile( Pos, V, Length );
+				Pos   += Length;
+				Length = 0;
+			}
+			else
+			{
+				// Refill the buffer from here.
+				BufferBase  = Pos;
+				BufferCount = Min<INT>( LOADER_BUFFER_SIZE, Eof-Pos );
+				if( BufferCount < Length )
+					appErrorf( "Read past end of file: Pos=%i Length=%i Eof=%i", Pos, Length, Eof );
+				ReadFile( Pos, Buffer, BufferCount );
+			}
+		}
 		check(Pos<=Eof);
 		return *this;
 	}
 //!!private:
+	void SeekFile( INT InPos )
+	{
+		INT Result = appFseek( File, InPos, USEEK_SET );
+		if( Result!=0 )
+			appErrorf( "Seek Failed %i/%i (%i): %i %i", InPos, Eof, Pos, Result, appFerror(File) );
+		FilePos = InPos;
+		GLoadBenchmark.FileSeeks++;
+	}
+	void ReadFile( INT At, void* V, INT Length )
+	{
+		if( At != FilePos )
+			SeekFile( At );
+		INT Count = appFread( V, Length, 1, File );
+		if( Count!=1 && Length!=0 )
+			appErrorf( "appFread failed: Count=%i Length=%i Error=%i", Count, Length, appFerror(File) );
+		FilePos += Length;
+		GLoadBenchmark.FileReads++;
+	}
 	FILE* File;
 	INT Eof;
+	UBOOL Buffered;
+	BYTE* Buffer;
+	INT BufferBase;
+	INT BufferCount;
+	INT FilePos;
+	INT BenchFile;
 };
 
 /*----------------------------------------------------------------------------
@@ -430,11 +504,13 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 	DWORD LoadFlags;
 	INT FileSize;
 	CHAR Status[256];
+	TArray<INT> ExportHash;		// First export in each bucket of the export hash.
+	TArray<INT> ExportHashNext;	// Next export in the same bucket, in ExportMap order.
 
 	// Constructor; all errors here throw exceptions which are fully recoverable.
 	ULinkerLoad( UObject* InParent, const char* InFilename, DWORD InLoadFlags )
 	:	ULinker( InParent, InFilename )
-	,	FArchiveFileLoad( InFilename )
+	,	FArchiveFileLoad( InFilename, !ParseParam(appCmdLine(),"NOREADAHEAD") )
 	,	LoadFlags( InLoadFlags )
 	{
 		guard(ULinkerLoad::ULinkerLoad);
@@ -572,6 +648,24 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 		}
 		unguard;
 
+		// Hash the exports by name and class, before other linkers can import from them.
+		guard(HashExports);
+		INT NumBuckets = 1;
+		while( NumBuckets < Summary.ExportCount )
+			NumBuckets *= 2;
+		ExportHash.Add( NumBuckets );
+		ExportHashNext.Add( Summary.ExportCount );
+		for( INT i=0; i<NumBuckets; i++ )
+			ExportHash(i) = INDEX_NONE;
+		for( INT i=Summary.ExportCount-1; i>=0; i-- )
+		{
+			FObjectExport& Export = ExportMap(i);
+			INT iBucket           = HashExport( Export.ObjectName, Export.ClassName, Export.ClassPackage );
+			ExportHashNext(i)     = ExportHash(iBucket);
+			ExportHash(iBucket)   = i;
+		}
+		unguard;
+
 		// Add this linker to the object manager's linker array.
 		GObj.Loaders.AddItem( this );
 		try
@@ -594,6 +688,33 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 		unguard;
 	}
 
+	// Export hash bucket of a name and class.
+	INT HashExport( FName ObjectName, FName ClassName, FName ClassPackage )
+	{
+		return (GetTypeHash(ObjectName) ^ GetTypeHash(ClassName)*31 ^ GetTypeHash(ClassPackage)*961) & (ExportHash.Num()-1);
+	}
+
+	// Find the next export with a name and class after iAfter, in ExportMap
+	// order, or INDEX_NONE if there isn't one.
+	INT FindExport( FName ObjectName, FName ClassName, FName ClassPackage, INT iAfter=INDEX_NONE )
+	{
+		guardSlow(ULinkerLoad::FindExport);
+		if( !ExportHash.Num() )
+			return INDEX_NONE;
+		INT i = iAfter==INDEX_NONE ? ExportHash(HashExport(ObjectName,ClassName,ClassPackage)) : ExportHashNext(iAfter);
+		for( ; i!=INDEX_NONE; i=ExportHashNext(i) )
+		{
+			FObjectExport& Export = ExportMap(i);
+			if
+			(	Export.ObjectName	== ObjectName
+			&&	Export.ClassName	== ClassName
+			&&	Export.ClassPackage	== ClassPackage )
+				return i;
+		}
+		return INDEX_NONE;
+		unguardSlow;
+	}
+
 	// Safely verify an import.
 	void VerifyImport( INT i )
 	{
@@ -641,42 +762,38 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 				Import.SourceLinker = GObj.GetPackageLinker( Pkg, NULL, LOAD_Throw | (LoadFlags & LOAD_Propagate), NULL, NULL );
 			}
 
-			//caveat: Fast enough, but could be much faster with hashing.
 			UBOOL SafeReplace = 0;
-			for( INT j=0; j<Import.SourceLinker->ExportMap.Num(); j++ )
+			for
+			(	INT j = Import.SourceLinker->FindExport( Import.ObjectName, Import.ClassName, Import.ClassPackage )
+			;	j != INDEX_NONE
+			;	j = Import.SourceLinker->FindExport( Import.ObjectName, Import.ClassName, Import.ClassPackage, j ) )
 			{
 				FObjectExport& Source = Import.SourceLinker->ExportMap( j );
-				if
-				(	Source.ObjectName	== Import.ObjectName
-				&&	Source.ClassName	== Import.ClassName
-				&&	Source.ClassPackage	== Import.ClassPackage )
+				if( Ver()>=50 && Import.SourceLinker->Ver()>=50 && Import.PackageIndex<0 )
 				{
-					if( Ver()>=50 && Import.SourceLinker->Ver()>=50 && Import.PackageIndex<0 )
+					FObjectImport& ParentImport = ImportMap(-Import.PackageIndex-1);
+					if( ParentImport.SourceLinker )
 					{
-						FObjectImport& ParentImport = ImportMap(-Import.PackageIndex-1);
-						if( ParentImport.SourceLinker )
+						if( ParentImport.SourceIndex==-1 )
 						{
-							if( ParentImport.SourceIndex==-1 )
+							if( Source.PackageIndex!=0 )
 							{
-								if( Source.PackageIndex!=0 )
-								{
-									continue;
-								}
+								continue;
 							}
-							else if( ParentImport.SourceIndex+1 != Source.PackageIndex )
+						}
+						else if( ParentImport.SourceIndex+1 != Source.PackageIndex )
+						{
+							if( Source.PackageIndex!=0 )
 							{
-								if( Source.PackageIndex!=0 )
-								{
-									continue;
-								}
+								continue;
 							}
 						}
 					}
-					if( !(Source.ObjectFlags & RF_Public) )
-						appThrowf( LocalizeError("FailedImportPrivate"), *Source.ClassName, Import.SourceLinker->LinkerRoot->GetClassName(), *Source.ObjectName );
-					Import.SourceIndex = j;
-					break;
 				}
+				if( !(Source.ObjectFlags & RF_Public) )
+					appThrowf( LocalizeError("FailedImportPrivate"), *Source.ClassName, Import.SourceLinker->LinkerRoot->GetClassName(), *Source.ObjectName );
+				Import.SourceIndex = j;
+				break;
 			}
 			if
 			(	Import.SourceIndex==-1
@@ -690,18 +807,7 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 				||	Import.ClassName==NAME_WetTexture ) )//oldver
 			{
 				// See if there's a match without the proper package.
-				for( INT j=0; j<Import.SourceLinker->ExportMap.Num(); j++ )
-				{
-					FObjectExport& Source = Import.SourceLinker->ExportMap( j );
-					if
-					(	Source.ObjectName	== Import.ObjectName
-					&&	Source.ClassName	== Import.ClassName
-					&&	Source.ClassPackage	== Import.ClassPackage )
-					{
-						Import.SourceIndex = j;
-						break;
-					}
-				}
+				Import.SourceIndex = Import.SourceLinker->FindExport( Import.ObjectName, Import.ClassName, Import.ClassPackage );
 			}
 			if( Import.SourceIndex==-1 && (Ver()<50 || Pkg!=NULL) )
 			{
@@ -765,20 +871,14 @@ class ULinkerLoad : public ULinker, public FArchiveFileLoad
 	UObject* Create( UClass* ObjectClass, FName ObjectName, DWORD LoadFlags, UBOOL Checked )
 	{
 		guard(ULinkerLoad::Create);
-		//caveat: Fast enough, but could be much faster with hashing.
-		for( INT i=0; i<ExportMap.Num(); i++ )
+		INT i = FindExport( ObjectName, ObjectClass->GetFName(), ObjectClass->GetParent()->GetFName() );
+		if( i != INDEX_NONE )
 		{
-			if
-			(	ExportMap(i).ObjectName   == ObjectName
-			&&	ExportMap(i).ClassPackage == ObjectClass->GetParent()->GetFName()
-			&&	ExportMap(i).ClassName    == ObjectClass->GetFName() )
-			{
-				// Found it.
-				if( !(LoadFlags & LOAD_Verify) )
-					return CreateExport( i );
-				else
-					return (UObject*)-1;
-			}
+			// Found it.
+			if( !(LoadFlags & LOAD_Verify) )
+				return CreateExport( i );
+			else
+				return (UObject*)-1;
 		}
 		if( Checked )
 			appThrowf( LocalizeError("FailedCreate"), ObjectClass->GetName(), *ObjectName );
@@ -0,0 +1,221 @@
+/*=============================================================================
+	UnLoadBench.cpp: Package loading benchmark.
+=============================================================================*/
+
+#include "CorePrivate.h"
+#include "UnLinker.h"
+
+/*-----------------------------------------------------------------------------
+	Globals.
+-----------------------------------------------------------------------------*/
+
+CORE_API FLoadBenchmark GLoadBenchmark;
+
+// Times each mode is replayed; the fastest is reported.
+enum {LOADBENCH_PASSES=2};
+
+/*-----------------------------------------------------------------------------
+	FLoadBenchmark recording.
+-----------------------------------------------------------------------------*/
+
+FLoadBenchmark::FLoadBenchmark()
+:	Recording		( 0 )
+,	UntilMapLoaded	( 0 )
+,	FileReads		( 0 )
+,	FileSeeks		( 0 )
+,	StartTime		( 0.0 )
+{}
+
+void FLoadBenchmark::Start( UBOOL InUntilMapLoaded )
+{
+	guard(FLoadBenchmark::Start);
+	Files.Empty();
+	Ops.Empty();
+	Recording      = 1;
+	UntilMapLoaded = InUntilMapLoaded;
+	StartTime      = appSeconds();
+	unguard;
+}
+
+void FLoadBenchmark::NoteMapLoaded( FOutputDevice* Out )
+{
+	guard(FLoadBenchmark::NoteMapLoaded);
+	if( Recording && UntilMapLoaded )
+		Stop( Out );
+	unguard;
+}
+
+INT FLoadBenchmark::NoteFile( const char* Filename )
+{
+	guard(FLoadBenchmark::NoteFile);
+	new(Files)FString( Filename );
+	return Files.Num() - 1;
+	unguard;
+}
+
+void FLoadBenchmark::NoteSeek( INT File, INT Pos )
+{
+	guardSlow(FLoadBenchmark::NoteSeek);
+	FOp& Op  = Ops( Ops.Add() );
+	Op.File   = File;
+	Op.Pos    = Pos;
+	Op.Length = -1;
+	unguardSlow;
+}
+
+void FLoadBenchmark::NoteRead( INT File, INT Pos, INT Length )
+{
+	guardSlow(FLoadBenchmark::NoteRead);
+	FOp& Op  = Ops( Ops.Add() );
+	Op.File   = File;
+	Op.Pos    = Pos;
+	Op.Length = Length;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FLoadBenchmark replay.
+-----------------------------------------------------------------------------*/
+
+//
+// Replay the recorded calls through file loaders of one kind. Returns 0 if
+// a file can't be opened any more.
+//
+UBOOL FLoadBenchmark::Replay( UBOOL Buffered, DOUBLE& Seconds, INT& Reads, INT& Seeks, FOutputDevice* Out )
+{
+	guard(FLoadBenchmark::Replay);
+	INT MaxLength=0, i;
+	for( i=0; i<Ops.Num(); i++ )
+		MaxLength = Max( MaxLength, Ops(i).Length );
+	BYTE* Temp = (BYTE*)appMalloc( Max(MaxLength,1), "LoadBenchmark" );
+
+	TArray<FArchiveFileLoad*> Loaders;
+	Loaders.AddZeroed( Files.Num() );
+	UBOOL Ok      = 1;
+	INT   OldReads = FileReads;
+	INT   OldSeeks = FileSeeks;
+	DOUBLE Start  = appSeconds();
+	try
+	{
+		for( i=0; i<Files.Num(); i++ )
+			Loaders(i) = new FArchiveFileLoad( *Files(i), Buffered );
+		for( i=0; i<Ops.Num(); i++ )
+		{
+			FOp& Op = Ops(i);
+			if( Op.Length<0 )
+				Loaders(Op.File)->Seek( Op.Pos );
+			else
+				Loaders(Op.File)->Serialize( Temp, Op.Length );
+		}
+	}
+	catch( char* Error )
+	{
+		Out->Logf( NAME_ExecWarning, "Load benchmark replay failed: %s", Error );
+		Ok = 0;
+	}
+	for( i=0; i<Loaders.Num(); i++ )
+		if( Loaders(i) )
+			delete Loaders(i);
+	Seconds = appSeconds() - Start;
+	Reads   = FileReads - OldReads;
+	Seeks   = FileSeeks - OldSeeks;
+	appFree( Temp );
+	return Ok;
+	unguard;
+}
+
+//
+// Stop recording and compare the two loaders on what was recorded.
+//
+void FLoadBenchmark::Stop( FOutputDevice* Out )
+{
+	guard(FLoadBenchmark::Stop);
+	if( !Recording )
+	{
+		Out->Log( NAME_ExecWarning, "Load benchmark isn't recording" );
+		return;
+	}
+	Recording = 0;
+	QWORD Bytes=0;
+	INT   NumReads=0, NumSeeks=0;
+	for( INT i=0; i<Ops.Num(); i++ )
+	{
+		if( Ops(i).Length<0 )
+			NumSeeks++;
+		else
+		{
+			NumReads++;
+			Bytes += Ops(i).Length;
+		}
+	}
+	Out->Logf
+	(
+		"Load benchmark: %i files, %i reads, %i seeks, %.1f MB in %.2f sec",
+		Files.Num(),
+		NumReads,
+		NumSeeks,
+		Bytes / (1024.0*1024.0),
+		appSeconds() - StartTime
+	);
+
+	// Replay each way a few times, alternating, and keep the fastest.
+	static const char* ModeNames[] = { "unbuffered", "read-ahead" };
+	DOUBLE Best[2]  = { 0.0, 0.0 };
+	INT    Reads[2] = { 0, 0 };
+	INT    Seeks[2] = { 0, 0 };
+	for( INT Pass=0; Pass<LOADBENCH_PASSES; Pass++ )
+	{
+		for( INT Mode=0; Mode<2; Mode++ )
+		{
+			DOUBLE Seconds;
+			if( !Replay( Mode, Seconds, Reads[Mode], Seeks[Mode], Out ) )
+			{
+				Files.Empty();
+				Ops.Empty();
+				return;
+			}
+			if( Pass==0 || Seconds<Best[Mode] )
+				Best[Mode] = Seconds;
+		}
+	}
+	for( INT Mode=0; Mode<2; Mode++ )
+		Out->Logf
+		(
+			"   %-10s: %8.2f ms, %7i freads, %7i fseeks",
+			ModeNames[Mode],
+			Best[Mode] * 1000.0,
+			Reads[Mode],
+			Seeks[Mode]
+		);
+	Files.Empty();
+	Ops.Empty();
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FLoadBenchmark console commands.
+-----------------------------------------------------------------------------*/
+
+UBOOL FLoadBenchmark::Exec( const char* Cmd, FOutputDevice* Out )
+{
+	guard(FLoadBenchmark::Exec);
+	const char* Str = Cmd;
+	if( ParseCommand(&Str,"START") )
+	{
+		Start();
+		Out->Log( "Load benchmark started" );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"STOP") )
+	{
+		Stop( Out );
+		return 1;
+	}
+	Out->Log( "Usage: LOADBENCH START | STOP" );
+	return 1;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -12,7 +12,7 @@ Revision history:
 	FMemStack statics.
 -----------------------------------------------------------------------------*/
 
-FMemStack::FTaggedMemory* FMemStack::UnusedChunks = NULL;
+FMemStack::FTaggedMemory* volatile FMemStack::SharedUnusedChunks = NULL;
 
 /*-----------------------------------------------------------------------------
 	FMemStack implementation.
@@ -29,6 +29,9 @@ void FMemStack::Init( INT InDefaultChunkSize )
 	TopChunk = NULL;
 	End      = NULL;
 	Top		 = NULL;
+	UnusedChunks    = NULL;
+	NumUnusedChunks = 0;
+	OwnerThread     = appThreadId();
 
 	unguard;
 }
@@ -56,6 +59,13 @@ void FMemStack::Exit()
 		UnusedChunks = UnusedChunks->Next;
 		appFree( Old );
 	}
+	NumUnusedChunks = 0;
+	for( FTaggedMemory* Chunk=GrabSharedChunks(); Chunk; )
+	{
+		void* Old = Chunk;
+		Chunk = Chunk->Next;
+		appFree( Old );
+	}
 	unguard;
 }
 
@@ -78,6 +88,14 @@ INT FMemStack::GetByteCount()
 	unguard;
 }
 
+//
+// Return whether the calling thread is the one this stack belongs to.
+//
+UBOOL FMemStack::IsOwnerThread() const
+{
+	return OwnerThread==appThreadId();
+}
+
 /*-----------------------------------------------------------------------------
 	Chunk functions.
 -----------------------------------------------------------------------------*/
@@ -90,6 +108,7 @@ INT FMemStack::GetByteCount()
 BYTE* FMemStack::AllocateNewChunk( INT MinSize )
 {
 	guard(FMemStack::AllocateNewChunk);
+	debug(IsOwnerThread());
 
 	FTaggedMemory* Chunk=NULL;
 	for( FTaggedMemory** Link=&UnusedChunks; *Link; Link=&(*Link)->Next )
@@ -99,10 +118,30 @@ BYTE* FMemStack::AllocateNewChunk( INT MinSize )
 		{
 			Chunk = *Link;
 			*Link = (*Link)->Next;
+			NumUnusedChunks--;
 			break;
 		}
 	}
 	if( !Chunk )
+	{
+		// Take over the shared pool, keeping the first chunk that fits.
+		for( FTaggedMemory* Shared=GrabSharedChunks(); Shared; )
+		{
+			FTaggedMemory* Next = Shared->Next;
+			if( !Chunk && Shared->DataSize >= MinSize )
+			{
+				Chunk = Shared;
+			}
+			else
+			{
+				Shared->Next = UnusedChunks;
+				UnusedChunks = Shared;
+				NumUnusedChunks++;
+			}
+			Shared = Next;
+		}
+	}
+	if( !Chunk )
 	{
 		// Create new chunk.
 		INT DataSize    = Max(MinSize,DefaultChunkSize);
@@ -125,8 +164,13 @@ void FMemStack::FreeChunks( FTaggedMemory* NewTopChunk )
 	{
 		FTaggedMemory* RemoveChunk = TopChunk;
 		TopChunk                   = TopChunk->Next;
-		RemoveChunk->Next          = UnusedChunks;
-		UnusedChunks               = RemoveChunk;
+		if( NumUnusedChunks < MAX_UNUSED_CHUNKS )
+		{
+			RemoveChunk->Next = UnusedChunks;
+			UnusedChunks      = RemoveChunk;
+			NumUnusedChunks++;
+		}
+		else ReleaseSharedChunk( RemoveChunk );
 	}
 	Top = NULL;
 	End = NULL;
@@ -138,6 +182,41 @@ void FMemStack::FreeChunks( FTaggedMemory* NewTopChunk )
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Shared chunk pool.
+-----------------------------------------------------------------------------*/
+
+//
+// Push a chunk onto the shared pool. Lock-free; safe from any thread.
+//
+void FMemStack::ReleaseSharedChunk( FTaggedMemory* Chunk )
+{
+	FTaggedMemory* Old;
+	do
+	{
+		Old         = SharedUnusedChunks;
+		Chunk->Next = Old;
+	}
+	while( appInterlockedCompareExchangePointer( (void* volatile*)&SharedUnusedChunks, Chunk, Old ) != Old );
+}
+
+//
+// Detach the whole shared pool and return it. Taking everything at once
+// (rather than popping single chunks) keeps this free of ABA problems.
+//
+FMemStack::FTaggedMemory* FMemStack::GrabSharedChunks()
+{
+	FTaggedMemory* Old;
+	do
+	{
+		Old = SharedUnusedChunks;
+		if( !Old )
+			return NULL;
+	}
+	while( appInterlockedCompareExchangePointer( (void* volatile*)&SharedUnusedChunks, NULL, Old ) != Old );
+	return Old;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
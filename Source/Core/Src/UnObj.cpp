@@ -1351,6 +1351,115 @@ static void ShowClasses( UClass* Class, FOutputDevice* Out, int Indent )
 			ShowClasses( *It, Out, Indent+2 );
 }
 
+//
+// Time TMap's Add, Find and Remove against the linear walk it replaced,
+// and check that both give the same answers.
+//
+struct FMapBenchPair
+{
+	DWORD Key;
+	INT   Value;
+};
+static INT LinearMapFind( TArray<FMapBenchPair>& Pairs, DWORD Key )
+{
+	for( INT i=0; i<Pairs.Num(); i++ )
+		if( Pairs(i).Key==Key )
+			return i;
+	return INDEX_NONE;
+}
+static void MapBenchmark( INT Count, FOutputDevice* Out )
+{
+	guard(MapBenchmark);
+
+	// Keys with random high and low bits, kept unique by the index in the
+	// middle. The first half are added and the rest are only looked up.
+	TArray<DWORD> Keys;
+	for( INT i=0; i<Count*2; i++ )
+		Keys.AddItem( ((DWORD)appRand() << 24) | ((DWORD)i << 8) | (appRand() & 0xff) );
+
+	// Repeat small maps so the times are measurable.
+	INT    Reps = Max( 10000/Count, 1 );
+	DOUBLE MapTime[3]={0,0,0}, LinearTime[3]={0,0,0};
+	INT    Mismatches=0;
+	for( INT Rep=0; Rep<Reps; Rep++ )
+	{
+		TMap<DWORD,INT> Map;
+		TArray<FMapBenchPair> Linear;
+		INT MapFound=0, LinearFound=0;
+
+		// Add.
+		DOUBLE StartTime = appSeconds();
+		for( INT i=0; i<Count; i++ )
+			Map.Add( Keys(i), i );
+		MapTime[0] += appSeconds() - StartTime;
+		StartTime = appSeconds();
+		for( INT i=0; i<Count; i++ )
+		{
+			INT j = LinearMapFind( Linear, Keys(i) );
+			if( j==INDEX_NONE )
+				j = Linear.Add();
+			Linear(j).Key   = Keys(i);
+			Linear(j).Value = i;
+		}
+		LinearTime[0] += appSeconds() - StartTime;
+
+		// Find every key, present or not.
+		StartTime = appSeconds();
+		for( INT i=0; i<Keys.Num(); i++ )
+		{
+			INT* Value = Map.Find( Keys(i) );
+			MapFound += Value ? *Value : -1;
+		}
+		MapTime[1] += appSeconds() - StartTime;
+		StartTime = appSeconds();
+		for( INT i=0; i<Keys.Num(); i++ )
+		{
+			INT j = LinearMapFind( Linear, Keys(i) );
+			LinearFound += j!=INDEX_NONE ? Linear(j).Value : -1;
+		}
+		LinearTime[1] += appSeconds() - StartTime;
+		Mismatches += MapFound!=LinearFound;
+
+		// Remove every other key.
+		StartTime = appSeconds();
+		for( INT i=0; i<Count; i+=2 )
+			Map.Remove( Keys(i) );
+		MapTime[2] += appSeconds() - StartTime;
+		StartTime = appSeconds();
+		for( INT i=0; i<Count; i+=2 )
+		{
+			INT j = LinearMapFind( Linear, Keys(i) );
+			if( j!=INDEX_NONE )
+			{
+				Linear(j) = Linear(Linear.Num()-1);
+				Linear.Remove( Linear.Num()-1 );
+			}
+		}
+		LinearTime[2] += appSeconds() - StartTime;
+
+		// Check what is left.
+		Mismatches += Map.Size()!=Linear.Num();
+		for( INT i=0; i<Count; i++ )
+		{
+			INT* Value = Map.Find( Keys(i) );
+			INT  j     = LinearMapFind( Linear, Keys(i) );
+			if( (Value!=NULL)!=(j!=INDEX_NONE) || (Value && *Value!=Linear(j).Value) )
+				Mismatches++;
+		}
+	}
+	DOUBLE Ops[3] = { (DOUBLE)Count*Reps, (DOUBLE)Keys.Num()*Reps, (DOUBLE)((Count+1)/2)*Reps };
+	Out->Logf
+	(
+		"%i entries: TMap add %.0f ns, find %.0f ns, remove %.0f ns; linear add %.0f ns, find %.0f ns, remove %.0f ns",
+		Count,
+		MapTime[0]*1e9/Ops[0], MapTime[1]*1e9/Ops[1], MapTime[2]*1e9/Ops[2],
+		LinearTime[0]*1e9/Ops[0], LinearTime[1]*1e9/Ops[1], LinearTime[2]*1e9/Ops[2]
+	);
+	if( Mismatches )
+		Out->Logf( NAME_ExecWarning, "TMap disagrees with the linear walk %i times with %i entries", Mismatches, Count );
+	unguard;
+}
+
 UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 {
 	guard(FObjectManager::Exec);
@@ -1360,6 +1469,71 @@ UBOOL FObjectManager::Exec( const char* Cmd, FOutputDevice* Out )
 		appDumpAllocs( Out );
 		return 1;
 	}
+	else if( ParseCommand(&Str,"SCRIPTCACHE") )
+	{
+		if( ParseCommand(&Str,"RESET") )
+			GScriptCallCache.Hits = GScriptCallCache.Misses = GScriptCallCache.Flushes = 0;
+		DWORD Total = GScriptCallCache.Hits + GScriptCallCache.Misses;
+		Out->Logf
+		(
+			"Script call cache: %u hits, %u misses (%.1f%% hit rate), %u flushes",
+			GScriptCallCache.Hits,
+			GScriptCallCache.Misses,
+			Total ? 100.0 * GScriptCallCache.Hits / Total : 0.0,
+			GScriptCallCache.Flushes
+		);
+		return 1;
+	}
+	else if( ParseCommand(&Str,"SCRIPTBENCH") )
+	{
+		// Measure the event dispatch rate of the script VM.
+		char ObjectName[256]="", EventName[256]="";
+		INT Count=100000;
+		UObject* Object;
+		UFunction* Function;
+		Parse( Str, "OBJECT=", ObjectName, ARRAY_COUNT(ObjectName) );
+		Parse( Str, "EVENT=", EventName, ARRAY_COUNT(EventName) );
+		Parse( Str, "COUNT=", Count );
+		if( (Object=::FindObject<UObject>( ANY_PACKAGE, ObjectName ))==NULL )
+			Out->Logf( NAME_ExecWarning, "Unrecognized object %s", ObjectName );
+		else if( (Function=Object->FindFunction( FName(EventName,FNAME_Find) ))==NULL )
+			Out->Logf( NAME_ExecWarning, "Unrecognized function %s in %s", EventName, Object->GetFullName() );
+		else
+		{
+			FMemMark Mark(GMem);
+			BYTE* Parms = NewZeroed<BYTE>( GMem, Function->ParmsSize );
+			DOUBLE StartTime = appSeconds();
+			for( INT i=0; i<Count; i++ )
+				Object->ProcessEvent( Function, Parms );
+			DOUBLE Seconds = Max( appSeconds() - StartTime, 1e-9 );
+			Mark.Pop();
+			Out->Logf
+			(
+				"%s: %i calls in %.2f ms, %.3f us/call, %.0f calls/sec",
+				Function->GetFullName(),
+				Count,
+				Seconds * 1000.0,
+				Seconds * 1000000.0 / Max(Count,1),
+				Count / Seconds
+			);
+		}
+		return 1;
+	}
+	else if( ParseCommand(&Str,"SCRIPTPROFILE") )
+	{
+		return GScriptProfiler.Exec( Str, Out );
+	}
+	else if( ParseCommand(&Str,"LOADBENCH") )
+	{
+		return GLoadBenchmark.Exec( Str, Out );
+	}
+	else if( ParseCommand(&Str,"MAPBENCH") )
+	{
+		MapBenchmark( 100, Out );
+		MapBenchmark( 1000, Out );
+		MapBenchmark( 10000, Out );
+		return 1;
+	}
 	else if( ParseCommand(&Str,"DUMPINTRINSICS") )
 	{
 		for( INT i=0; i<EX_Max; i++ )
@@ -2733,6 +2907,8 @@ void FObjectManager::PurgeGarbage( FOutputDevice* Out )
 		return;
 	}
 	debugf( NAME_Log, "Purging garbage" );
+	GScriptProfiler.NoteGarbageCollect();
+	GScriptCallCache.Flush();
 
 	// Dispatch all Destroy messages.
 	guard(DispatchDestroys);
@@ -87,6 +87,7 @@ void USystem::InternalClassInitializer( UClass* Class )
 	if( appStricmp(Class->GetName(),"System")==0 )
 	{
 		(new(Class,"PurgeCacheDays",      RF_Public)UIntProperty   (CPP_PROPERTY(PurgeCacheDays    ), "Options", CPF_Config ));
+		(new(Class,"JobThreads",          RF_Public)UIntProperty   (CPP_PROPERTY(JobThreads        ), "Options", CPF_Config ));
 		(new(Class,"Suppress",            RF_Public)UNameProperty  (CPP_PROPERTY(Suppress          ), "Options", CPF_Config ))->ArrayDim = 16;
 		(new(Class,"Paths",               RF_Public)UStringProperty(CPP_PROPERTY(Paths             ), "Options", CPF_Config, 96 ))->ArrayDim = 16;
 		(new(Class,"SavePath",            RF_Public)UStringProperty(CPP_PROPERTY(SavePath          ), "Options", CPF_Config, 96 ));
@@ -549,6 +550,13 @@ void appInit()
 	// FPU.
 	appEnableFastMath( 0 );
 
+	// Worker threads.
+	GJobs.Init( GSys->JobThreads );
+
+	// Record package loads for -LOADBENCH.
+	if( ParseParam( appCmdLine(), "LOADBENCH" ) )
+		GLoadBenchmark.Start( 1 );
+
 	// Handle operator new allocation errors.
 	std::set_new_handler( UnrealAllocationErrorHandler );
 
@@ -973,7 +981,7 @@ CORE_API UBOOL appMoveFile( const char* Src, const char* Dest )
 {
 	guard(appMoveFile);
 
-	unlink( Dest );
+	appUnlink( Dest );
 
 #ifdef PLATFORM_WIN32
 	//warning: MoveFileEx is broken on Windows 95 (Microsoft bug).
@@ -982,6 +990,7 @@ CORE_API UBOOL appMoveFile( const char* Src, const char* Dest )
 	UBOOL Success = rename( Src, Dest )==0;
 #endif
 
+	appResetFileIndex();
 	if( !Success )
 		debugf( NAME_Warning, "Error moving file '%s' to '%s'", Src, Dest );
 
@@ -1522,6 +1531,7 @@ CORE_API void appSetCmdLine( INT Argc, const char** Argv )
 	guard(appSetCmdLine);
 
 	CmdLine = CmdLineBuf;
+	CmdLineBuf[0] = 0;
 	for( INT i = 1; i < Argc; ++i )
 	{
 		appStrncat( CmdLineBuf, Argv[i], sizeof(CmdLineBuf) - 1 );
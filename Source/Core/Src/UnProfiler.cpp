@@ -0,0 +1,406 @@
+/*=============================================================================
+	UnProfiler.cpp: UnrealScript profiler.
+=============================================================================*/
+
+#include "CorePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	Globals.
+-----------------------------------------------------------------------------*/
+
+CORE_API FScriptProfiler GScriptProfiler;
+
+// Report sort orders.
+enum EProfileSort
+{
+	PROFSORT_Exclusive	= 0,
+	PROFSORT_Inclusive	= 1,
+	PROFSORT_Calls		= 2,
+};
+
+//
+// Report line, sorted by descending key.
+//
+struct FProfileSortItem
+{
+	INT		Index;
+	QWORD	Key;
+};
+static inline INT Compare( const FProfileSortItem& A, const FProfileSortItem& B )
+{
+	return A.Key<B.Key ? 1 : A.Key>B.Key ? -1 : 0;
+}
+
+static const char* KindNames[] = { "native", "script", "intrinsic", "state" };
+
+/*-----------------------------------------------------------------------------
+	FScriptProfiler recording.
+-----------------------------------------------------------------------------*/
+
+FScriptProfiler::FScriptProfiler()
+:	Active		( 0 )
+,	Depth		( 0 )
+,	Overflow	( 0 )
+,	MaxEvents	( 0 )
+,	LastCycles	( 0 )
+,	Clock		( 0 )
+,	StartClock	( 0 )
+,	TotalClock	( 0 )
+{}
+
+void FScriptProfiler::Reset()
+{
+	guard(FScriptProfiler::Reset);
+
+	Nodes.Empty();
+	Edges.Empty();
+	Events.Empty();
+	NodeMap.Empty();
+	EdgeMap.Empty();
+	Depth      = 0;
+	Overflow   = 0;
+	Clock      = 0;
+	TotalClock = 0;
+
+	// Node 0 stands for whatever C++ code called into script.
+	FNode& Root = Nodes( Nodes.Add() );
+	appMemset( &Root, 0, sizeof(Root) );
+	appStrcpy( Root.Name, "(native)" );
+	Root.Kind = KIND_Root;
+
+	unguard;
+}
+
+void FScriptProfiler::Start( INT InMaxEvents )
+{
+	guard(FScriptProfiler::Start);
+	Reset();
+	MaxEvents  = Max( InMaxEvents, 0 );
+	LastCycles = appCycles();
+	StartClock = Now();
+	Active     = 1;
+	unguard;
+}
+
+void FScriptProfiler::Stop()
+{
+	guard(FScriptProfiler::Stop);
+	if( Active )
+		TotalClock += Now() - StartClock;
+	Active = 0;
+	unguard;
+}
+
+void FScriptProfiler::NoteGarbageCollect()
+{
+	NodeMap.Empty();
+}
+
+INT FScriptProfiler::GetNode( UStruct* Node )
+{
+	INT* Found = NodeMap.Find( Node );
+	if( Found )
+		return *Found;
+
+	// Seen before garbage collection under another pointer?
+	char Name[ARRAY_COUNT(((FNode*)NULL)->Name)];
+	appStrncpy( Name, Node->GetPathName(), ARRAY_COUNT(Name) );
+	INT Index;
+	for( Index=1; Index<Nodes.Num(); Index++ )
+		if( appStrcmp( Nodes(Index).Name, Name )==0 )
+			break;
+	if( Index==Nodes.Num() )
+	{
+		FNode& New = Nodes( Nodes.Add() );
+		appMemset( &New, 0, sizeof(New) );
+		appStrcpy( New.Name, Name );
+		if( !Node->IsA(UFunction::StaticClass) )
+			New.Kind = KIND_State;
+		else if( ((UFunction*)Node)->iIntrinsic || (((UFunction*)Node)->FunctionFlags & FUNC_Intrinsic) )
+			New.Kind = KIND_Intrinsic;
+		else
+			New.Kind = KIND_Script;
+	}
+	NodeMap.Add( Node, Index );
+	return Index;
+}
+
+INT FScriptProfiler::GetEdge( INT Caller, INT Callee )
+{
+	QWORD Key = ((QWORD)Caller << 32) | (DWORD)Callee;
+	INT* Found = EdgeMap.Find( Key );
+	if( Found )
+		return *Found;
+	INT Index = Edges.Add();
+	FEdge& New = Edges(Index);
+	New.Caller    = Caller;
+	New.Callee    = Callee;
+	New.Calls     = 0;
+	New.Inclusive = 0;
+	EdgeMap.Add( Key, Index );
+	return Index;
+}
+
+void FScriptProfiler::Enter( UStruct* Node, UBOOL IsEvent )
+{
+	if( Depth >= MAX_DEPTH )
+	{
+		Overflow++;
+		return;
+	}
+	INT Index  = GetNode( Node );
+	FNode& N   = Nodes(Index);
+	N.Calls++;
+	N.EventCalls += IsEvent;
+	N.Recursion++;
+	FCall& Call = Stack[Depth++];
+	Call.Node     = Index;
+	Call.Children = 0;
+	Call.Start    = Now();
+}
+
+void FScriptProfiler::Leave()
+{
+	if( Overflow )
+	{
+		Overflow--;
+		return;
+	}
+	if( !Depth )
+		return;
+
+	FCall& Call   = Stack[--Depth];
+	QWORD Elapsed = Now() - Call.Start;
+	FNode& N      = Nodes(Call.Node);
+
+	// Only the outermost of a set of recursive calls counts towards inclusive time.
+	if( --N.Recursion == 0 )
+		N.Inclusive += Elapsed;
+	N.Exclusive += Elapsed - Call.Children;
+
+	INT Caller = 0;
+	if( Depth )
+	{
+		Caller = Stack[Depth-1].Node;
+		Stack[Depth-1].Children += Elapsed;
+	}
+	FEdge& Edge = Edges( GetEdge( Caller, Call.Node ) );
+	Edge.Calls++;
+	Edge.Inclusive += Elapsed;
+
+	if( Events.Num() < MaxEvents )
+	{
+		FEvent& Event  = Events( Events.Add() );
+		Event.Node     = Call.Node;
+		Event.Depth    = Depth;
+		Event.Start    = Call.Start;
+		Event.Duration = Elapsed;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	FScriptProfiler reports.
+-----------------------------------------------------------------------------*/
+
+//
+// Write the flat profile and call graph as text.
+//
+void FScriptProfiler::DumpReport( const char* Filename, INT SortBy, FOutputDevice* Out )
+{
+	guard(FScriptProfiler::DumpReport);
+
+	FILE* F = appFopen( Filename, "wt" );
+	if( !F )
+	{
+		Out->Logf( NAME_ExecWarning, "Couldn't open %s", Filename );
+		return;
+	}
+
+	const DOUBLE MsPerCycle = GSecondsPerCycle * 1000.0;
+	QWORD Total = TotalClock + (Active ? Now() - StartClock : 0);
+	QWORD ScriptTotal = 0;
+	for( INT i=1; i<Nodes.Num(); i++ )
+		ScriptTotal += Nodes(i).Exclusive;
+
+	// Sort the nodes.
+	TArray<FProfileSortItem> Sorted;
+	for( INT i=1; i<Nodes.Num(); i++ )
+	{
+		FProfileSortItem& Item = Sorted( Sorted.Add() );
+		Item.Index = i;
+		Item.Key
+		=	SortBy==PROFSORT_Inclusive ? Nodes(i).Inclusive
+		:	SortBy==PROFSORT_Calls     ? (QWORD)Nodes(i).Calls
+		:	                             Nodes(i).Exclusive;
+	}
+	if( Sorted.Num() )
+		appSort( &Sorted(0), Sorted.Num() );
+
+	// Flat profile.
+	static const char* SortNames[] = { "exclusive time", "inclusive time", "calls" };
+	appFprintf( F, "Script profile: %.3f ms profiled, %.3f ms in script, %i functions, %i events\n\n",
+		MsPerCycle * Total, MsPerCycle * ScriptTotal, Nodes.Num()-1, Events.Num() );
+	appFprintf( F, "Flat profile, sorted by %s:\n\n", SortNames[Clamp(SortBy,0,2)] );
+	appFprintf( F, "  Excl ms  Excl%%    Incl ms     Calls  Events   us/call  Kind       Function\n" );
+	appFprintf( F, "---------  -----  ---------  --------  ------  --------  ---------  --------\n" );
+	for( INT i=0; i<Sorted.Num(); i++ )
+	{
+		FNode& N = Nodes(Sorted(i).Index);
+		appFprintf
+		(
+			F,
+			"%9.3f  %5.1f  %9.3f  %8i  %6i  %8.2f  %-9s  %s\n",
+			MsPerCycle * N.Exclusive,
+			ScriptTotal ? 100.0 * N.Exclusive / ScriptTotal : 0.0,
+			MsPerCycle * N.Inclusive,
+			N.Calls,
+			N.EventCalls,
+			N.Calls ? 1000.0 * MsPerCycle * N.Inclusive / N.Calls : 0.0,
+			KindNames[N.Kind],
+			N.Name
+		);
+	}
+
+	// Call graph, in the same order, with each node's callers and callees.
+	TArray<FProfileSortItem> SortedEdges;
+	for( INT i=0; i<Edges.Num(); i++ )
+	{
+		FProfileSortItem& Item = SortedEdges( SortedEdges.Add() );
+		Item.Index = i;
+		Item.Key   = Edges(i).Inclusive;
+	}
+	if( SortedEdges.Num() )
+		appSort( &SortedEdges(0), SortedEdges.Num() );
+	appFprintf( F, "\nCall graph (callers above, callees below each function):\n\n" );
+	appFprintf( F, "    Calls    Incl ms  Function\n" );
+	appFprintf( F, "---------  ---------  --------\n" );
+	for( INT i=0; i<Sorted.Num(); i++ )
+	{
+		INT iNode = Sorted(i).Index;
+		FNode& N = Nodes(iNode);
+		for( INT j=0; j<SortedEdges.Num(); j++ )
+		{
+			FEdge& E = Edges(SortedEdges(j).Index);
+			if( E.Callee==iNode )
+				appFprintf( F, "%9i  %9.3f      %s\n", E.Calls, MsPerCycle * E.Inclusive, Nodes(E.Caller).Name );
+		}
+		appFprintf( F, "%9i  %9.3f  %s (excl %.3f)\n", N.Calls, MsPerCycle * N.Inclusive, N.Name, MsPerCycle * N.Exclusive );
+		for( INT j=0; j<SortedEdges.Num(); j++ )
+		{
+			FEdge& E = Edges(SortedEdges(j).Index);
+			if( E.Caller==iNode )
+				appFprintf( F, "%9i  %9.3f      %s\n", E.Calls, MsPerCycle * E.Inclusive, Nodes(E.Callee).Name );
+		}
+		appFprintf( F, "\n" );
+	}
+	appFclose( F );
+
+	// Summary.
+	Out->Logf( "Script profile: %.3f ms in script over %.3f ms, written to %s", MsPerCycle * ScriptTotal, MsPerCycle * Total, Filename );
+	for( INT i=0; i<Min(Sorted.Num(),10); i++ )
+	{
+		FNode& N = Nodes(Sorted(i).Index);
+		Out->Logf( "  %9.3f ms excl %9.3f ms incl %8i calls  %s", MsPerCycle * N.Exclusive, MsPerCycle * N.Inclusive, N.Calls, N.Name );
+	}
+
+	unguard;
+}
+
+//
+// Write the recorded calls in Chrome's trace event format.
+//
+void FScriptProfiler::DumpChromeTrace( const char* Filename )
+{
+	guard(FScriptProfiler::DumpChromeTrace);
+
+	FILE* F = appFopen( Filename, "wt" );
+	if( !F )
+	{
+		debugf( NAME_Warning, "Couldn't open %s", Filename );
+		return;
+	}
+
+	const DOUBLE UsPerCycle = GSecondsPerCycle * 1000000.0;
+	appFprintf( F, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	for( INT i=0; i<Events.Num(); i++ )
+	{
+		FEvent& E = Events(i);
+		FNode& N  = Nodes(E.Node);
+		appFprintf
+		(
+			F,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+			N.Name,
+			KindNames[N.Kind],
+			UsPerCycle * (E.Start - StartClock),
+			UsPerCycle * E.Duration,
+			i<Events.Num()-1 ? "," : ""
+		);
+	}
+	appFprintf( F, "]}\n" );
+	appFclose( F );
+
+	if( Events.Num() >= MaxEvents )
+		debugf( NAME_Warning, "Script profile trace is truncated at %i events", MaxEvents );
+
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FScriptProfiler command line.
+-----------------------------------------------------------------------------*/
+
+UBOOL FScriptProfiler::Exec( const char* Cmd, FOutputDevice* Out )
+{
+	guard(FScriptProfiler::Exec);
+	const char* Str = Cmd;
+	if( ParseCommand(&Str,"START") )
+	{
+		if( Depth )
+		{
+			Out->Log( NAME_ExecWarning, "Script profiler is still unwinding the last run" );
+			return 1;
+		}
+		INT NewMaxEvents = 1000000;
+		Parse( Str, "MAXEVENTS=", NewMaxEvents );
+		Start( NewMaxEvents );
+		Out->Logf( "Script profiler started (up to %i trace events)", MaxEvents );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"STOP") )
+	{
+		Stop();
+		Out->Log( "Script profiler stopped" );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"DUMP") )
+	{
+		if( Nodes.Num() == 0 )
+		{
+			Out->Log( NAME_ExecWarning, "No script profile recorded" );
+			return 1;
+		}
+		char Sort[32]="", BaseName[256]="ScriptProfile", Filename[256];
+		INT SortBy = PROFSORT_Exclusive;
+		if( Parse( Str, "SORT=", Sort, ARRAY_COUNT(Sort) ) )
+		{
+			if( appStricmp( Sort, "INCL" )==0 )
+				SortBy = PROFSORT_Inclusive;
+			else if( appStricmp( Sort, "CALLS" )==0 )
+				SortBy = PROFSORT_Calls;
+		}
+		Parse( Str, "FILE=", BaseName, ARRAY_COUNT(BaseName) );
+		appSprintf( Filename, "%s.txt", BaseName );
+		DumpReport( Filename, SortBy, Out );
+		appSprintf( Filename, "%s.json", BaseName );
+		DumpChromeTrace( Filename );
+		return 1;
+	}
+	Out->Log( "Usage: SCRIPTPROFILE START [MAXEVENTS=n] | STOP | DUMP [SORT=EXCL|INCL|CALLS] [FILE=name]" );
+	return 1;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
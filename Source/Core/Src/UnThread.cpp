@@ -72,6 +72,36 @@ CORE_API THREAD_RET appThreadJoin( UTHREAD Thread )
 	unguard;
 }
 
+//
+// Small nonzero id, unique per thread for the lifetime of the process.
+//
+static UTLS GThreadIdSlot;
+static volatile INT GThreadIdState = 0;
+static volatile INT GThreadIdCount = 0;
+
+CORE_API DWORD appThreadId()
+{
+	if( GThreadIdState != 2 )
+	{
+		if( appInterlockedCompareExchange( &GThreadIdState, 1, 0 ) == 0 )
+		{
+			GThreadIdSlot = appTlsAlloc();
+			appInterlockedIncrement( &GThreadIdState );
+		}
+		else while( GThreadIdState != 2 )
+		{
+			appSleep( 0.f );
+		}
+	}
+	DWORD Id = (DWORD)(size_t)appTlsGet( GThreadIdSlot );
+	if( !Id )
+	{
+		Id = appInterlockedIncrement( &GThreadIdCount );
+		appTlsSet( GThreadIdSlot, (void*)(size_t)Id );
+	}
+	return Id;
+}
+
 CORE_API UMUTEX appMutexCreate( const char* Name )
 {
 	guard(appMutexCreate);
@@ -139,3 +169,180 @@ CORE_API void appMutexFree( UMUTEX Mutex )
 
 	unguard;
 }
+
+#ifndef PLATFORM_WIN32
+struct FPosixSemaphore
+{
+	pthread_mutex_t Mutex;
+	pthread_cond_t Cond;
+	INT Count;
+};
+#endif
+
+CORE_API USEMAPHORE appSemaphoreCreate( const char* Name, INT InitialCount )
+{
+	guard(appSemaphoreCreate);
+
+#ifdef PLATFORM_WIN32
+	return (USEMAPHORE)CreateSemaphore( NULL, InitialCount, MAXINT, NULL );
+#else
+	FPosixSemaphore* Sem = (FPosixSemaphore*)appMalloc( sizeof(FPosixSemaphore), Name );
+	check(Sem);
+	appMemset( (void*)Sem, 0, sizeof(*Sem) );
+	if( pthread_mutex_init( &Sem->Mutex, NULL ) != 0 )
+	{
+		appFree( (void*)Sem );
+		return nullptr;
+	}
+	if( pthread_cond_init( &Sem->Cond, NULL ) != 0 )
+	{
+		pthread_mutex_destroy( &Sem->Mutex );
+		appFree( (void*)Sem );
+		return nullptr;
+	}
+	Sem->Count = InitialCount;
+	return (USEMAPHORE)Sem;
+#endif
+
+	unguard;
+}
+
+CORE_API void appSemaphorePost( USEMAPHORE Semaphore, INT Count )
+{
+	check(Semaphore);
+
+#ifdef PLATFORM_WIN32
+	ReleaseSemaphore( (HANDLE)Semaphore, Count, NULL );
+#else
+	FPosixSemaphore* Sem = (FPosixSemaphore*)Semaphore;
+	pthread_mutex_lock( &Sem->Mutex );
+	Sem->Count += Count;
+	if( Count > 1 )
+		pthread_cond_broadcast( &Sem->Cond );
+	else
+		pthread_cond_signal( &Sem->Cond );
+	pthread_mutex_unlock( &Sem->Mutex );
+#endif
+}
+
+CORE_API void appSemaphoreWait( USEMAPHORE Semaphore )
+{
+	check(Semaphore);
+
+#ifdef PLATFORM_WIN32
+	WaitForSingleObject( (HANDLE)Semaphore, INFINITE );
+#else
+	FPosixSemaphore* Sem = (FPosixSemaphore*)Semaphore;
+	pthread_mutex_lock( &Sem->Mutex );
+	while( Sem->Count <= 0 )
+		pthread_cond_wait( &Sem->Cond, &Sem->Mutex );
+	Sem->Count--;
+	pthread_mutex_unlock( &Sem->Mutex );
+#endif
+}
+
+CORE_API void appSemaphoreFree( USEMAPHORE Semaphore )
+{
+	guard(appSemaphoreFree);
+	check(Semaphore);
+
+#ifdef PLATFORM_WIN32
+	CloseHandle( (HANDLE)Semaphore );
+#else
+	FPosixSemaphore* Sem = (FPosixSemaphore*)Semaphore;
+	pthread_cond_destroy( &Sem->Cond );
+	pthread_mutex_destroy( &Sem->Mutex );
+	appFree( (void*)Sem );
+#endif
+
+	unguard;
+}
+
+CORE_API UTLS appTlsAlloc()
+{
+	guard(appTlsAlloc);
+
+#ifdef PLATFORM_WIN32
+	DWORD Slot = TlsAlloc();
+	check(Slot!=TLS_OUT_OF_INDEXES);
+	return (UTLS)Slot;
+#else
+	pthread_key_t Key;
+	verify( pthread_key_create( &Key, NULL ) == 0 );
+	return (UTLS)Key;
+#endif
+
+	unguard;
+}
+
+CORE_API void* appTlsGet( UTLS Slot )
+{
+#ifdef PLATFORM_WIN32
+	return TlsGetValue( (DWORD)Slot );
+#else
+	return pthread_getspecific( (pthread_key_t)Slot );
+#endif
+}
+
+CORE_API void appTlsSet( UTLS Slot, void* Value )
+{
+#ifdef PLATFORM_WIN32
+	TlsSetValue( (DWORD)Slot, Value );
+#else
+	pthread_setspecific( (pthread_key_t)Slot, Value );
+#endif
+}
+
+CORE_API void appTlsFree( UTLS Slot )
+{
+#ifdef PLATFORM_WIN32
+	TlsFree( (DWORD)Slot );
+#else
+	pthread_key_delete( (pthread_key_t)Slot );
+#endif
+}
+
+CORE_API INT appInterlockedIncrement( volatile INT* Value )
+{
+#ifdef PLATFORM_MSVC
+	return (INT)InterlockedIncrement( (volatile LONG*)Value );
+#else
+	return __sync_add_and_fetch( Value, 1 );
+#endif
+}
+
+CORE_API INT appInterlockedDecrement( volatile INT* Value )
+{
+#ifdef PLATFORM_MSVC
+	return (INT)InterlockedDecrement( (volatile LONG*)Value );
+#else
+	return __sync_sub_and_fetch( Value, 1 );
+#endif
+}
+
+CORE_API INT appInterlockedAdd( volatile INT* Value, INT Amount )
+{
+#ifdef PLATFORM_MSVC
+	return (INT)InterlockedExchangeAdd( (volatile LONG*)Value, Amount ) + Amount;
+#else
+	return __sync_add_and_fetch( Value, Amount );
+#endif
+}
+
+CORE_API INT appInterlockedCompareExchange( volatile INT* Dest, INT Exchange, INT Comparand )
+{
+#ifdef PLATFORM_MSVC
+	return (INT)InterlockedCompareExchange( (volatile LONG*)Dest, Exchange, Comparand );
+#else
+	return __sync_val_compare_and_swap( Dest, Comparand, Exchange );
+#endif
+}
+
+CORE_API void* appInterlockedCompareExchangePointer( void* volatile* Dest, void* Exchange, void* Comparand )
+{
+#ifdef PLATFORM_MSVC
+	return InterlockedCompareExchangePointer( Dest, Exchange, Comparand );
+#else
+	return __sync_val_compare_and_swap( Dest, Comparand, Exchange );
+#endif
+}
@@ -5479,6 +5479,9 @@ UBOOL UEditorEngine::MakeScripts( UBOOL MakeAll, UBOOL Booting )
 		// Restore all classes after compile fails.
 		Transaction.Restore();
 	}
+
+	// Compiled or restored code may reuse the addresses of old call sites.
+	GScriptCallCache.Flush();
 	guard(CleanupPropText);
 	for( TPtrIterator<UClass> It(AllClasses); It; ++It )
 	{
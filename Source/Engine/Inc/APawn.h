@@ -41,7 +41,7 @@
 	FLOAT findPathTowardBestInventory(AActor *&bestPath, INT bClearPaths, FLOAT MinWeight, INT bPredictRespawns);
 	int findRandomDest(AActor *&bestPath);
 	int TraverseFrom(AActor *startnode, int moveFlags);
-	int breadthPathFrom(AActor *startnode, AActor *&bestPath, int bSinglePath, int moveFlags);
+	int breadthPathFrom(AActor *startnode, AActor *&bestPath, int bSinglePath, int moveFlags, class FSortedPathList *AltPoints = NULL);
 	FLOAT breadthPathToInventory(AActor *startnode, AActor *&bestPath, int moveFlags, FLOAT bestInventoryWeight, INT bPredictRespawns);
 	inline int calcMoveFlags();
 	void clearPaths();
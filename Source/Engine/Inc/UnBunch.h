@@ -80,7 +80,9 @@ public:
 	FBunch			Header;
 	UNetConnection*	Connection;
 	UBOOL			Overflowed;
-	INT				InPosition;
+	INT				InPosition;		// Read position, in bits if Packed.
+	UBOOL			Packed;			// Data is a packed bit stream, see FOutBunch.
+	INT				PartEnd;		// Bit position where the packed part being read ends.
 
 	// Bunch data.
 	BYTE Data[UNetConnection::MAX_PACKET_SIZE];
@@ -91,11 +93,14 @@ public:
 	,	Connection  ( InConnection )
 	,	Overflowed  ( 0 )
 	,	InPosition  ( 0 )
+	,	PartEnd		( 0 )
 	{
 		guard(FInBunch::FBunch);
 		check(Header.DataSize<=sizeof(Data));
 		ArIsNet = 1;
 
+		FChannel* Channel = Connection->Channels[Header.ChIndex & CHF_Mask];
+		Packed = Connection->ProtocolVersion>=2 && Channel && Channel->ChType==CHTYPE_Actor;
 		appMemcpy( Data, BunchData, Header.DataSize );
 
 		unguard;
@@ -118,7 +123,12 @@ public:
 	FArchive& Serialize( void *V, int Length )
 	{
 		guardSlow(FInBunch::Serialize);
-		if( InPosition+Length<=Header.DataSize && !Overflowed )
+		if( Packed )
+		{
+			for( INT i=0; i<Length; i++ )
+				((BYTE*)V)[i] = ReadBits( 8 );
+		}
+		else if( InPosition+Length<=Header.DataSize && !Overflowed )
 		{
 			appMemcpy( V, &Data[InPosition], Length );
 			InPosition += Length;
@@ -128,6 +138,10 @@ public:
 		unguardSlow;
 	}
 
+	// Packed bit stream reading.
+	DWORD ReadBits( INT Count );
+	INT ReadInt();
+
 	// Other archivers.
 	UBOOL ReceiveProperty( UProperty* Property, BYTE* Data, BYTE* Recent );
 	FArchive& operator<<( FName& Name );
@@ -141,6 +155,12 @@ public:
 //
 // A bunch of data to send.
 //
+// Actor channels on connections using protocol version 2 or later write a
+// packed bit stream instead of bytes: a _WORD holding the number of bits
+// that follow, then the bits, padded to a byte. Merged bunches are several
+// such parts back to back. Properties are written with type-aware
+// encodings by SendProperty.
+//
 class FOutBunch : public FArchive
 {
 public:
@@ -149,6 +169,8 @@ public:
 	FChannel*	Channel;
 	UBOOL       Overflowed;
 	INT			MaxDataSize;
+	UBOOL		Packed;			// Write a packed bit stream.
+	INT			OutBits;		// Bits written, if Packed.
 
 	// Bunch data.
 	BYTE Data[UNetConnection::MAX_PACKET_SIZE];
@@ -169,6 +191,11 @@ public:
 		unguard;
 	}
 
+	// Packed bit stream writing.
+	void WriteBits( DWORD Value, INT Count );
+	void WriteInt( INT Value );
+	void SetBits( INT NewBits );
+
 	// Archivers.
 	UBOOL SendProperty( UProperty* Property, INT ArrayIndex, BYTE* Data, BYTE* Defaults, UBOOL Named );
 	UBOOL SendObject( UObject* Object );
@@ -177,6 +204,71 @@ public:
 	FArchive& Serialize( void* V, int Length );
 };
 
+/*-----------------------------------------------------------------------------
+	FNetBenchmark.
+-----------------------------------------------------------------------------*/
+
+//
+// Records the actor updates a server sends for a number of ticks, then
+// replays them through both property encodings and logs the bytes per
+// update of each. Started with NETBENCH [FRAMES=N].
+//
+class ENGINE_API FNetBenchmark
+{
+public:
+	// Whether updates are being recorded.
+	UBOOL Recording;
+
+	// Constructor.
+	FNetBenchmark();
+
+	// Interface.
+	void Start( ULevel* InLevel, INT NumFrames, FOutputDevice* Out );
+	void Tick( ULevel* InLevel );
+	void NoteProperty( UProperty* Property, INT Index, BYTE* Data );
+	void NoteUpdate( FActorChannel* Channel, UBOOL Sent );
+
+private:
+	// A recorded actor update.
+	struct FUpdate
+	{
+		UNetConnection*	Connection;
+		UClass*			Class;
+		INT				Stream;
+		INT				Snapshot;		// Actor, or Recent if Seed, when the stream starts.
+		UBOOL			Seed;			// Stream was open before recording started.
+		INT				FirstProperty;
+		INT				NumProperties;
+	};
+
+	// A property value sent in an update.
+	struct FSentProperty
+	{
+		UProperty*		Property;
+		INT				Index;
+		INT				Value;
+	};
+
+	// Variables.
+	ULevel*						Level;
+	INT							FramesLeft;
+	INT							NumFrames;
+	INT							NumStreams;
+	INT							NumPending;
+	TArray<FUpdate>				Updates;
+	TArray<FSentProperty>		Properties;
+	TArray<BYTE>				Snapshots;
+	TMap<FActorChannel*,INT>	Streams;
+
+	// Internal functions.
+	INT AddSnapshot( BYTE* Data, INT Size );
+	void Replay();
+	void Reset();
+};
+
+// The global network benchmark.
+ENGINE_API extern FNetBenchmark GNetBenchmark;
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -146,6 +146,66 @@ class ENGINE_API FControlChannel : public FChannel
 	char* Describe( char* String256 );
 };
 
+/*-----------------------------------------------------------------------------
+	FActorShadows.
+-----------------------------------------------------------------------------*/
+
+//
+// A server's copy of an actor's replicated properties as of the last net
+// tick. Bits number the replicated property elements of the actor's class in
+// ReplicateActor order, and links number its FRepLinks the same way.
+//
+struct FActorShadow
+{
+	UClass*		Class;			// Class the layout was made for.
+	INT			Frame;			// Last frame the actor was replicable.
+	INT			NumBits;		// Replicated property elements.
+	INT			NumLinks;		// Replicated properties.
+	BYTE*		Values;			// Property values at the last net tick.
+	INT*		ChangeFrame;	// Frame each element last changed in.
+	INT			ConditionFrame;	// Frame the condition results are for.
+	DWORD*		ConditionKnown;	// Per link, net variants evaluated this frame.
+	DWORD*		ConditionTrue;	// Per link, net variants whose condition was true.
+};
+
+//
+// Finds which replicated properties of each actor have changed once per net
+// tick, so actor channels only compare those with what they last sent
+// rather than every property for every connection. Replication conditions
+// are also cached per actor for the frame, keyed by the variables that
+// ReplicateActor sets for each connection.
+//
+class ENGINE_API FActorShadows
+{
+public:
+	// Variables.
+	INT Frame;
+
+	// Constructor.
+	FActorShadows( ULevel* InLevel );
+	~FActorShadows();
+
+	// FActorShadows interface.
+	void Update();
+	FActorShadow* Find( AActor* Actor )
+	{
+		FActorShadow** Shadow = Map.Find( Actor );
+		return Shadow && (*Shadow)->Class==Actor->GetClass() ? *Shadow : NULL;
+	}
+	static DWORD GetNetVariant( AActor* Actor )
+	{
+		return 1 << (Actor->bNetOwner + Actor->bNetInitial*2 + Actor->RemoteRole*4);
+	}
+
+private:
+	// Variables.
+	ULevel*						Level;
+	TMap<AActor*,FActorShadow*>	Map;
+
+	// Internal functions.
+	FActorShadow* CreateShadow( AActor* Actor );
+};
+
 /*-----------------------------------------------------------------------------
 	FActorChannel.
 -----------------------------------------------------------------------------*/
@@ -163,6 +223,9 @@ class ENGINE_API FActorChannel : public FChannel
 	BYTE*	Recent;			// Most recently sent values.
 	DOUBLE	RelevantTime;	// Last time this actor was relevant to client.
 	DOUBLE	LastUpdateTime;	// Last time this actor was replicated.
+	DWORD*	Changed;		// Replicated properties found to differ from Recent this tick, NULL=compare when replicating.
+	DWORD*	Pending;		// Replicated properties that differed from Recent when last compared.
+	INT		CheckedFrame;	// FActorShadows frame Pending is for, 0=compare everything.
 
 	// Constructor.
 	FActorChannel( UNetConnection* InConnection, INT InChannelIndex, INT InOpenedLocally );
@@ -175,6 +238,8 @@ class ENGINE_API FActorChannel : public FChannel
 	// FActorChannel interface.
 	char* Describe( char* String256 );
 	void ReplicateActor( UBOOL FullReplication );
+	void FindChangedProperties();
+	static INT CountRepProperties( UClass* Class );
 };
 
 /*-----------------------------------------------------------------------------
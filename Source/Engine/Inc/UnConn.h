@@ -33,7 +33,7 @@ class ENGINE_API UNetConnection : public UPlayer
 	NO_DEFAULT_CONSTRUCTOR(UNetConnection)
 
 	// Constants.
-	enum{ MAX_PROTOCOL_VERSION = 1     }; // Maximum protocol version supported.
+	enum{ MAX_PROTOCOL_VERSION = 2     }; // Maximum protocol version supported, 2=bit-packed actor channels.
 	enum{ MIN_PROTOCOL_VERSION = 1     }; // Minimum protocol version supported.
 	enum{ MAX_PACKET_SIZE      = 512   }; // Absolute maximum size of a packet.
 	enum{ IDEAL_PACKET_SIZE    = 192   }; // Ideal size of a packet.
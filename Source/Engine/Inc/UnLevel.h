@@ -55,7 +55,110 @@ public:
 	virtual void CheckActorNotReferenced( AActor* Actor )=0;
 };
 
+//
+// Actor collision structures. The default one is picked with
+// -COLLISIONHASH=HASH|GRID or CollisionHash= in [Engine.Engine].
+//
+enum ECollisionHashType
+{
+	COLHASH_Hash	= 0,	// FCollisionHash: hashed 256-unit cells with linked fragments.
+	COLHASH_Grid	= 1,	// FCollisionGrid: sparse grid with per-cell actor arrays.
+};
 ENGINE_API FCollisionHashBase* GNewCollisionHash();
+ENGINE_API FCollisionHashBase* GNewCollisionHash( ECollisionHashType Type );
+ENGINE_API FCollisionHashBase* GNewCollisionGrid();
+ENGINE_API void GCollisionBenchmark( ULevel* Level, INT NumActors, INT NumFrames, FOutputDevice* Out );
+ENGINE_API void GTraceBenchmark( ULevel* Level, INT NumRays, FOutputDevice* Out );
+
+/*-----------------------------------------------------------------------------
+	FRelevancyPVS.
+-----------------------------------------------------------------------------*/
+
+//
+// Potentially visible set used to cull network relevancy checks. The level's
+// leaves are grouped into clusters, and each cluster has a row of bits
+// saying which clusters may be visible from it. Actors are bucketed by the
+// cluster of their leaf once per tick, so a viewer only has to trace to the
+// actors in clusters its row allows.
+//
+// The set comes from UModel::LeafLeaf when the map has it. Otherwise it is
+// sampled with line traces between points in each cluster, in the
+// background when a server loads the level, and cached in CachePath.
+// Relevancy checks every actor until the set is ready. -NOPVS disables it.
+//
+class ENGINE_API FRelevancyPVS
+{
+public:
+	// Visibility.
+	INT				NumClusters;	// Number of clusters, 0=no PVS.
+	INT				RowDwords;		// DWORDs in a row of visibility bits.
+	TArray<INT>		LeafCluster;	// Cluster of each leaf, INDEX_NONE=none.
+	TArray<DWORD>	Bits;			// NumClusters rows of RowDwords.
+	UBOOL			Conservative;	// Never misses a view, so safe for culling.
+
+	// Actors by cluster, rebuilt once per tick.
+	TArray<INT>		ClusterFirst;	// Index into ClusterActors of each cluster's actors.
+	TArray<AActor*>	ClusterActors;	// Actors sorted by cluster.
+	TArray<AActor*>	OtherActors;	// Actors that must always be checked.
+
+	// Constructor.
+	FRelevancyPVS( ULevel* InLevel );
+	~FRelevancyPVS();
+
+	// FRelevancyPVS interface.
+	void Update();
+	void UpdateActorLists();
+	INT GetCluster( INT iLeaf ) const
+	{
+		return iLeaf>=0 && iLeaf<LeafCluster.Num() ? LeafCluster(iLeaf) : INDEX_NONE;
+	}
+	const DWORD* GetRow( INT iCluster ) const
+	{
+		return &Bits(iCluster * RowDwords);
+	}
+
+private:
+	// Variables.
+	ULevel*			Level;
+	FLOAT			ListTime;
+	INT				ListNum;
+
+	// Background build of a sampled set.
+	FJobCounter		Counter;
+	UBOOL			Building;
+	DWORD			Key;
+	char			Filename[256];
+	DOUBLE			StartTime;
+	INT				BuiltClusters;
+	INT				BuiltRowDwords;
+	INT				BuiltTraces;
+	TArray<INT>		BuiltLeafCluster;
+	TArray<DWORD>	BuiltBits;
+
+	// Internal functions.
+	static void BuildJob( void* Arg );
+	DWORD GetKey();
+	UBOOL Load( const char* Filename, DWORD Key );
+	void Save( const char* Filename, DWORD Key );
+	void BuildFromLeafLeaf();
+	void BuildSampled();
+};
+
+/*-----------------------------------------------------------------------------
+	FNetViewer.
+-----------------------------------------------------------------------------*/
+
+//
+// Where a network player is viewing from, for relevancy.
+//
+struct FNetViewer
+{
+	APlayerPawn*	InViewer;	// The connection's player.
+	AActor*			Viewer;		// The actor it's viewing from.
+	FVector			Location;	// View location.
+	FVector			Ahead;		// Predicted view location.
+	DWORD			Seed;		// Random seed for this connection and net frame.
+};
 
 /*-----------------------------------------------------------------------------
 	ULevel base.
@@ -142,15 +245,19 @@ class ENGINE_API ULevel : public ULevelBase
 
 	// Only valid in memory.
 	FCollisionHashBase* Hash;
+	FRelevancyPVS* RelevancyPVS;
+	class FActorShadows* ActorShadows;
+	class FNavGraph* NavGraph;
 	class FMovingBrushTrackerBase* BrushTracker;
 	AActor* FirstDeleted;
 	struct FActorLink* NewlySpawned;
 	UBOOL InTick, Ticked;
-	INT iFirstDynamicActor, NetTag;
+	INT iFirstDynamicActor, NetTag, NetFrame;
 	BYTE ZoneDist[64][64];
 
 	// Temporary stats.
-	INT NetTickCycles, ActorTickCycles, AudioTickCycles, FindPathCycles, MoveCycles, NumMoves, NumReps, NumPV, GetRelevantCycles, NumRPC, SeePlayer, Spawning, Unused;
+	INT NetTickCycles, ActorTickCycles, AudioTickCycles, FindPathCycles, MoveCycles, NumMoves, NumReps, NumPV, GetRelevantCycles, NumRPC, SeePlayer, Spawning, CollisionCycles, Unused;
+	INT NetPrepCycles, NetDiffCycles, NetSendCycles;
 
 	// Constructor.
 	ULevel( UEngine* InEngine, UBOOL RootOutside );
@@ -167,12 +274,16 @@ class ENGINE_API ULevel : public ULevelBase
 	virtual void TickNetClient( FLOAT DeltaSeconds );
 	virtual void TickNetServer( FLOAT DeltaSeconds );
 	virtual INT ServerTickClient( UNetConnection* Conn, FLOAT DeltaSeconds );
+	virtual INT ServerTickClientsParallel( FLOAT DeltaSeconds );
 	virtual void ReconcileActors();
 	virtual void RememberActors();
 	virtual UBOOL Exec( const char* Cmd, FOutputDevice* Out=GSystem );
 	virtual void ShrinkLevel();
 	virtual void ModifyAllItems();
 	virtual INT GetRelevantActors( APlayerPawn* Pawn, AActor** List, INT Max );
+	virtual void GetNetViewer( APlayerPawn* Pawn, FNetViewer& View );
+	virtual void PrepareRelevancy();
+	virtual INT CollectRelevantActors( const FNetViewer& View, AActor** List, INT Max );
 	virtual void CompactActors();
 	virtual UBOOL Listen( char* Error256 );
 	virtual UBOOL IsServer();
@@ -190,6 +301,8 @@ class ENGINE_API ULevel : public ULevelBase
 	virtual void AdjustSpot( FVector &Adjusted, FVector TraceDest, FLOAT TraceLen, FCheckResult &Hit );
 	virtual UBOOL CheckEncroachment( AActor* Actor, FVector TestLocation, FRotator TestRotation, UBOOL bTouchNotify );
 	virtual FPackageMap* GetSandbox();
+	class FNavGraph* GetNavGraph();
+	void PrepareRouteTables();
 	virtual UBOOL SinglePointCheck( FCheckResult& Hit, FVector Location, FVector Extent, DWORD ExtraNodeFlags, ALevelInfo* Level, UBOOL bActors );
 	virtual UBOOL SingleLineCheck( FCheckResult& Hit, AActor* SourceActor, const FVector& End, const FVector& Start, DWORD TraceFlags, FVector Extent=FVector(0,0,0), BYTE NodeFlags=0 );
 	virtual FCheckResult* MultiPointCheck( FMemStack& Mem, FVector Location, FVector Extent, DWORD ExtraNodeFlags, ALevelInfo* Level, UBOOL bActors );
@@ -69,6 +69,19 @@ class ENGINE_API UModel : public UPrimitive
 	FBox GetCollisionBoundingBox( const AActor *Owner ) const;
 	FBox GetRenderBoundingBox( const AActor* Owner, UBOOL Exact ) const;
 
+	// UModel batched collision.
+	INT LineCheckBatch
+	(
+		FCheckResult*	Hits,
+		const FVector*	Starts,
+		const FVector*	Ends,
+		INT				Count,
+		UBOOL*			Results,
+		AActor*			Owner=NULL,
+		FVector			Extent=FVector(0,0,0),
+		DWORD			ExtraNodeFlags=0
+	);
+
 	// UModel interface.
 	void AllocDatabases( UBOOL AllocPolys );
 	void Modify();
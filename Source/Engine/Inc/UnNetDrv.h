@@ -35,6 +35,7 @@ class ENGINE_API UNetDriver : public USubsystem
 	INT						MaxClientByteLimit;
 	INT						MaxTicksPerSecond;
 	UBOOL					DuplicateClientMoves;
+	UBOOL					ParallelReplication;
 
 	// Constructors.
 	UNetDriver();
@@ -47,6 +48,7 @@ class ENGINE_API UNetDriver : public USubsystem
 	// FNetworkDriver interface.
 	virtual UBOOL Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, char* Error256 );
 	virtual void Tick()=0;
+	virtual void TickFlush() {}
 	virtual UBOOL Exec( const char* Cmd, FOutputDevice* Out=GSystem )=0;
 	virtual UBOOL IsInternet()=0;
 };
@@ -66,3 +66,197 @@ public:
 	int findBestReachable(FVector &Start, FVector &Destination, APawn * Scout);
 };
 
+/*-----------------------------------------------------------------------------
+	FNavGraph.
+-----------------------------------------------------------------------------*/
+
+// Weight of a navigation point that a search hasn't reached.
+enum {NAV_UNREACHED=10000000};
+
+// Size of the cells of the navigation point grid.
+enum {NAV_GRID_CELL=512};
+
+//
+// A path search through an FNavGraph. Everything the search changes is in
+// the caller's arrays and the memory stack it's given, so any number of
+// searches can run at once on different threads.
+//
+struct FNavQuery
+{
+	// Inputs.
+	INT			Start;			// Node the search starts from.
+	INT			StartWeight;	// Weight the start node starts with.
+	INT			Radius;			// Collision radius the reach specs must support.
+	INT			Height;			// Collision height the reach specs must support.
+	INT			MoveFlags;		// Movement flags the reach specs must support.
+	INT			MaxExpand;		// Give up after expanding this many nodes, 0=never.
+	const INT*	Costs;			// Extra cost of passing through each node.
+	const INT*	EndWeights;		// Weight added on reaching each end point, -1=not an end point.
+	const BYTE*	NoExpand;		// Nodes that can't be passed through, except the start, or NULL.
+	const INT*	Nearby;			// Nodes whose weight the caller needs if less than the end's, or NULL.
+	INT			NumNearby;
+
+	// Outputs.
+	INT*		Weights;		// Weight of each node reached, NAV_UNREACHED=not reached.
+};
+
+//
+// A node found near a point by FNavGraph::FindNear.
+//
+struct FNavNear
+{
+	INT		Node;
+	FLOAT	DistSquared;
+};
+
+//
+// The navigation network in compact arrays, for path searches. Nodes are
+// the level's NavigationPointList in order, and each node's upstream reach
+// specs are stored contiguously (CSR) in the order of its upstreamPaths.
+// Built when a level is first searched and rebuilt if its paths change.
+//
+// Nodes are also bucketed in a hashed grid of NAV_GRID_CELL sized cells,
+// so finding the nodes near a point only looks at the cells around it.
+// Nodes that can move, such as LiftCenters, aren't in the grid and are
+// always checked at their current location.
+//
+class ENGINE_API FNavGraph
+{
+	friend class FRouteTable;
+public:
+	// An upstream reach spec: the path from From to the node it's stored with.
+	struct FEdge
+	{
+		INT		From;
+		INT		To;
+		INT		Distance;
+		INT		Radius;
+		INT		Height;
+		INT		ReachFlags;
+	};
+
+	// Variables.
+	TArray<ANavigationPoint*>	Nodes;
+	TArray<FVector>				Positions;
+	TArray<INT>					FirstEdge;		// Nodes.Num()+1 indices into Edges.
+	TArray<FEdge>				Edges;
+	TArray<INT>					PathEdges;		// Edge of each node's Paths[16], INDEX_NONE=none.
+	FLOAT						MinSpeed;		// Least reach spec distance per unit of straight-line distance.
+
+	// Constructor/destructor.
+	FNavGraph( ULevel* InLevel );
+	~FNavGraph();
+
+	// FNavGraph interface.
+	UBOOL IsCurrent( ULevel* InLevel ) const;
+	INT FindNode( AActor* Actor )
+	{
+		INT* Index = NodeMap.Find( Actor );
+		return Index ? *Index : INDEX_NONE;
+	}
+	INT FindPath( const FNavQuery& Query, FMemStack& Mem ) const;
+	INT FindNear( const FVector& Point, FLOAT Radius, FNavNear* Out, INT MaxOut, const class FRelevancyPVS* PVS=NULL, const DWORD* Visible=NULL ) const;
+	class FRouteTable* GetRouteTable( INT Radius, INT Height, INT MoveFlags );
+	void DumpRouteTables( FOutputDevice* Out );
+
+private:
+	// A node in the grid.
+	struct FGridNode
+	{
+		INT		Node;
+		INT		X, Y, Z;
+	};
+
+	// Variables.
+	TArray<INT>			GridFirst;		// NumBuckets+1 indices into GridNodes.
+	TArray<FGridNode>	GridNodes;		// Static nodes sorted by bucket.
+	TArray<INT>			LooseNodes;		// Nodes that aren't in the grid.
+	TArray<INT>			Leaves;			// Bsp leaf of each node.
+	INT					BucketMask;
+	TMap<AActor*,INT>	NodeMap;
+	TArray<INT>			SpecRadii;		// Distinct reach spec collision radii.
+	TArray<INT>			SpecHeights;	// Distinct reach spec collision heights.
+	TArray<class FRouteTable*> RouteTables;
+	UBOOL				UseRouteTables;
+	ULevel*				Level;
+	ANavigationPoint*	FirstNav;
+	INT					NumSpecs;
+};
+
+/*-----------------------------------------------------------------------------
+	FRouteTable.
+-----------------------------------------------------------------------------*/
+
+// Most navigation points a level can have for route tables to be built.
+enum {MAX_ROUTE_NODES=4096};
+
+// FRouteTable::NextHop of a node with no route to the destination.
+enum {ROUTE_NO_HOP=255};
+
+//
+// Shortest routes between every pair of nodes in an FNavGraph, for pawns
+// of one size and set of movement flags. Each pair stores only which of
+// the first node's Paths[] to take next, so a table is a byte per pair,
+// and distances are summed along the route when they are needed.
+//
+// Tables are built on the job system's worker threads in the background,
+// a few destinations per job, and cached in CachePath. Enabled with
+// -ROUTETABLES or RouteTables=True in [Engine.Engine].
+//
+class ENGINE_API FRouteTable
+{
+public:
+	// The pawns this table is for.
+	INT		Radius;
+	INT		Height;
+	INT		MoveFlags;
+
+	// Stats.
+	INT		Lookups;
+	FLOAT	BuildTime;
+	UBOOL	Loaded;
+
+	// Constructor/destructor.
+	FRouteTable( FNavGraph* InGraph, INT InRadius, INT InHeight, INT InMoveFlags );
+	~FRouteTable();
+
+	// FRouteTable interface.
+	UBOOL IsReady();
+	INT NextHop( INT From, INT To ) const
+	{
+		return Hops( To*Graph->Nodes.Num() + From );
+	}
+	INT Distance( INT From, INT To ) const;
+	INT GetMemory() const
+	{
+		return Hops.Num();
+	}
+
+private:
+	// A batch of destinations built by one job.
+	struct FBatch
+	{
+		FRouteTable*	Table;
+		INT				First;
+		INT				Last;
+	};
+
+	// Variables.
+	FNavGraph*		Graph;
+	TArray<BYTE>	Hops;			// Paths[] index of the next hop for each To*Nodes+From.
+	TArray<INT>		NoCosts;		// Zero extra cost for every node.
+	TArray<INT>		NoEnds;			// No end points.
+	TArray<BYTE>	NoExpand;		// Nodes these pawns can't pass through.
+	TArray<FBatch>	Batches;
+	FJobCounter		Counter;
+	DOUBLE			StartTime;
+	UBOOL			Ready;
+
+	// Internal functions.
+	static void BuildJob( void* Arg );
+	void Build( INT First, INT Last );
+	void GetFilename( char* Result );
+	DWORD GetKey();
+	UBOOL Load();
+	void Save();
+};
@@ -296,6 +296,18 @@ enum ELineFlags
 	LINE_DepthCued
 };
 
+//
+// Cycle counts for the last rendered frame, for benchmarking.
+//
+struct FRenderTimes
+{
+	INT RenderCycles;		// Everything between PreRender and PostRender.
+	INT OcclusionCycles;	// BSP traversal and occlusion.
+	INT SpanCycles;			// Span buffer maintenance.
+	INT IllumCycles;		// Surface lighting.
+	INT MeshCycles;			// Mesh setup, lighting and drawing.
+};
+
 //
 // Pure virtual base class of the rendering subsytem.
 //
@@ -329,6 +341,7 @@ class ENGINE_API URenderBase : public USubsystem
 	virtual UBOOL BoundVisible( FSceneNode* Frame, FBox* Bound, FSpanBuffer* SpanBuffer, FScreenBounds& Results )=0;
 	virtual void GetVisibleSurfs( UViewport* Viewport, TArray<INT>& iSurfs )=0;
 	virtual void GlobalLighting( UBOOL Realtime, AActor* Owner, FLOAT& Brightness, FPlane& Color )=0;
+	virtual void GetRenderTimes( FRenderTimes& Times ) {appMemset( &Times, 0, sizeof(Times) );}
 
 	// High level primitive drawing.
 	virtual void Draw2DClippedLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 )=0;
@@ -81,13 +81,25 @@ public:
 	}
 };
 
-ENGINE_API FCollisionHashBase* GNewCollisionHash()
+ENGINE_API FCollisionHashBase* GNewCollisionHash( ECollisionHashType Type )
 {
 	guard(GNewCollisionHash);
+	if( Type==COLHASH_Grid )
+		return GNewCollisionGrid();
 	return new FCollisionHash;
 	unguard;
 }
 
+ENGINE_API FCollisionHashBase* GNewCollisionHash()
+{
+	guard(GNewCollisionHash);
+	char Type[64]="";
+	if( !Parse( appCmdLine(), "COLLISIONHASH=", Type, ARRAY_COUNT(Type) ) )
+		GetConfigString( "Engine.Engine", "CollisionHash", Type, ARRAY_COUNT(Type) );
+	return GNewCollisionHash( appStricmp(Type,"Grid")==0 ? COLHASH_Grid : COLHASH_Hash );
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	FCollisionHash statics.
 -----------------------------------------------------------------------------*/
@@ -552,6 +564,155 @@ void FCollisionHash::CheckActorNotReferenced( AActor* Actor )
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+	Benchmark.
+-----------------------------------------------------------------------------*/
+
+// Results of one benchmark run.
+struct FCollisionBenchResult
+{
+	DOUBLE	MoveTime;
+	DOUBLE	QueryTime;
+	INT		Queries;
+	INT		Hits;
+	DWORD	Checksum;
+};
+
+//
+// Move a set of actors through a collision structure and query around each
+// of them every frame.
+//
+static void RunCollisionBenchmark
+(
+	FCollisionHashBase*		Hash,
+	TArray<AActor*>&		Actors,
+	TArray<FVector>&		Velocities,
+	INT						NumFrames,
+	FCollisionBenchResult&	Result
+)
+{
+	guard(RunCollisionBenchmark);
+	appMemset( &Result, 0, sizeof(Result) );
+
+	TArray<FVector> Starts;
+	for( INT i=0; i<Actors.Num(); i++ )
+	{
+		Starts.AddItem( Actors(i)->Location );
+		Hash->AddActor( Actors(i) );
+	}
+	for( INT Frame=1; Frame<=NumFrames; Frame++ )
+	{
+		// Move everything, as ULevel::MoveActor would.
+		DOUBLE StartTime = appSeconds();
+		for( INT i=0; i<Actors.Num(); i++ )
+		{
+			Hash->RemoveActor( Actors(i) );
+			Actors(i)->Location = Starts(i) + Velocities(i) * (Frame / 30.0);
+			Hash->AddActor( Actors(i) );
+		}
+		Hash->Tick();
+		Result.MoveTime += appSeconds() - StartTime;
+
+		// Query around everything. Results are summed order-independently,
+		// since the structures may return hits in different orders.
+		StartTime = appSeconds();
+		for( INT i=0; i<Actors.Num(); i++ )
+		{
+			FMemMark Mark(GMem);
+			AActor* Actor = Actors(i);
+			FCheckResult* Lists[4];
+			Lists[0] = Hash->ActorPointCheck( GMem, Actor->Location, Actor->GetCylinderExtent(), 0 );
+			Lists[1] = Hash->ActorLineCheck( GMem, Actor->Location + Velocities(i), Actor->Location, FVector(0,0,0), 0 );
+			Lists[2] = Hash->ActorRadiusCheck( GMem, Actor->Location, 256.0, 0 );
+			Lists[3] = Hash->ActorEncroachmentCheck( GMem, Actor, Actor->Location, Actor->Rotation, 0 );
+			for( INT j=0; j<ARRAY_COUNT(Lists); j++ )
+			{
+				for( FCheckResult* Hit=Lists[j]; Hit; Hit=Hit->GetNext() )
+				{
+					Result.Hits++;
+					Result.Checksum += GetTypeHash( Hit->Actor ) * (j+1);
+				}
+			}
+			Result.Queries += ARRAY_COUNT(Lists);
+			Mark.Pop();
+		}
+		Result.QueryTime += appSeconds() - StartTime;
+	}
+	for( INT i=0; i<Actors.Num(); i++ )
+		Hash->RemoveActor( Actors(i) );
+	Hash->Tick();
+
+	// Put everything back where the level's own hash expects it.
+	for( INT i=0; i<Actors.Num(); i++ )
+		Actors(i)->Location = Actors(i)->ColLocation = Starts(i);
+
+	unguard;
+}
+
+//
+// Compare the collision structures with a swarm of projectiles.
+//
+ENGINE_API void GCollisionBenchmark( ULevel* Level, INT NumActors, INT NumFrames, FOutputDevice* Out )
+{
+	guard(GCollisionBenchmark);
+
+	// Center the swarm on a pawn if there is one.
+	FVector Center(0,0,0);
+	for( INT i=0; i<Level->Num(); i++ )
+	{
+		if( Level->Actors(i) && Level->Actors(i)->IsA(APawn::StaticClass) )
+		{
+			Center = Level->Actors(i)->Location;
+			break;
+		}
+	}
+
+	// Spawn the projectiles.
+	TArray<AActor*> Actors;
+	TArray<FVector> Velocities;
+	for( INT i=0; i<NumActors; i++ )
+	{
+		FVector Location = Center + FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ) * 8192.0;
+		AActor* Actor = Level->SpawnActor( AProjectile::StaticClass, NAME_None, NULL, NULL, Location, FRotator(0,0,0), NULL, 0, 1 );
+		if( !Actor )
+			break;
+		Actor->SetCollision( 1, 0, 0 );
+		Actor->SetCollisionSize( 8.0, 8.0 );
+		Actors.AddItem( Actor );
+		Velocities.AddItem( FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ).SafeNormal() * 1000.0 );
+	}
+
+	// Run both structures over the same motion.
+	static const char* Names[] = { "Hash", "Grid" };
+	FCollisionBenchResult Results[2];
+	for( INT Type=0; Type<2; Type++ )
+	{
+		FCollisionHashBase* Hash = GNewCollisionHash( (ECollisionHashType)Type );
+		RunCollisionBenchmark( Hash, Actors, Velocities, NumFrames, Results[Type] );
+		delete Hash;
+		Out->Logf
+		(
+			"%s: %i actors, %i frames: move %.2f ms/frame, query %.2f ms/frame (%i queries, %i hits)",
+			Names[Type],
+			Actors.Num(),
+			NumFrames,
+			Results[Type].MoveTime * 1000.0 / Max(NumFrames,1),
+			Results[Type].QueryTime * 1000.0 / Max(NumFrames,1),
+			Results[Type].Queries,
+			Results[Type].Hits
+		);
+	}
+	if( Results[0].Hits!=Results[1].Hits || Results[0].Checksum!=Results[1].Checksum )
+		Out->Logf( NAME_ExecWarning, "Collision structures disagree: %i/%08X hits vs %i/%08X", Results[0].Hits, Results[0].Checksum, Results[1].Hits, Results[1].Checksum );
+	else
+		Out->Logf( "Collision structures agree" );
+
+	for( INT i=0; i<Actors.Num(); i++ )
+		Level->DestroyActor( Actors(i) );
+
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -0,0 +1,646 @@
+/*=============================================================================
+	UnActGrid.cpp: Sparse grid actor collision structure.
+
+Design goal:
+	A drop-in alternative to FCollisionHash for levels with many moving
+	actors. Cells are stored sparsely with contiguous actor arrays, and an
+	actor that moves without changing the cells it covers costs no cell
+	work at all.
+
+	Removing an actor only detaches it; its cells are updated when it is
+	added back, and actors that never come back are purged in Tick.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid.
+-----------------------------------------------------------------------------*/
+
+//
+// A sparse uniform grid of actors.
+//
+class FCollisionGrid : public FCollisionHashBase
+{
+public:
+	// FCollisionHashBase interface.
+	FCollisionGrid();
+	~FCollisionGrid();
+	void Tick();
+	void AddActor( AActor *Actor );
+	void RemoveActor( AActor *Actor );
+	FCheckResult* ActorLineCheck( FMemStack& Mem, FVector End, FVector Start, FVector Extent, BYTE ExtraNodeFlags );
+	FCheckResult* ActorPointCheck( FMemStack& Mem, FVector Location, FVector Extent, DWORD ExtraNodeFlags );
+	FCheckResult* ActorRadiusCheck( FMemStack& Mem, FVector Location, FLOAT Radius, DWORD ExtraNodeFlags );
+	FCheckResult* ActorEncroachmentCheck( FMemStack& Mem, AActor* Actor, FVector Location, FRotator Rotation, DWORD ExtraNodeFlags );
+	void CheckActorNotReferenced( AActor* Actor );
+
+	// Constants.
+	enum { GRAN            = 256                };	// Cell size.
+	enum { WORLD_OFS       = 65536              };	// World to cell offset.
+	enum { GRID_BITS       = 10                 };	// Bits per cell coordinate.
+	enum { GRID_SIZE       = 1<<GRID_BITS       };	// Cells per axis.
+	enum { MAX_ACTOR_CELLS = 64                 };	// Bigger actors aren't put in cells.
+
+	// A box of cells.
+	struct FCellBox
+	{
+		INT X0, Y0, Z0, X1, Y1, Z1;
+		INT Count() const
+		{
+			return (X1-X0+1) * (Y1-Y0+1) * (Z1-Z0+1);
+		}
+		UBOOL Contains( INT X, INT Y, INT Z ) const
+		{
+			return X>=X0 && X<=X1 && Y>=Y0 && Y<=Y1 && Z>=Z0 && Z<=Z1;
+		}
+		UBOOL Intersects( const FCellBox& B ) const
+		{
+			return X0<=B.X1 && X1>=B.X0 && Y0<=B.Y1 && Y1>=B.Y0 && Z0<=B.Z1 && Z1>=B.Z0;
+		}
+		UBOOL operator==( const FCellBox& B ) const
+		{
+			return X0==B.X0 && Y0==B.Y0 && Z0==B.Z0 && X1==B.X1 && Y1==B.Y1 && Z1==B.Z1;
+		}
+	};
+
+	// An actor in the grid.
+	struct FGridActor
+	{
+		AActor*		Actor;
+		FCellBox	Cells;		// Cells it's linked into.
+		UBOOL		Attached;	// Whether queries see it.
+		UBOOL		Large;		// In LargeActors rather than cells.
+		UBOOL		Pending;	// In Detached.
+		INT			Tag;		// Last query that saw it.
+	};
+
+	// A grid cell.
+	struct FGridCell
+	{
+		INT					X, Y, Z;
+		TArray<FGridActor*>	Actors;
+	};
+
+	// Variables.
+	TMap<DWORD,INT>				CellMap;		// Cell key -> index in Cells.
+	TArray<FGridCell*>			Cells;
+	TMap<AActor*,FGridActor*>	ActorMap;
+	TArray<FGridActor*>			LargeActors;
+	TArray<FGridActor*>			Detached;
+	TArray<FGridActor*>			FreeActors;
+	TArray<FGridActor*>			Candidates;
+	INT							QueryTag;
+
+	// Implementation.
+	static INT GetCellIndex( FLOAT Value )
+	{
+		return Clamp( appFloor( (Value + WORLD_OFS) * (1.0/GRAN) ), 0, (INT)GRID_SIZE-1 );
+	}
+	static DWORD GetCellKey( INT X, INT Y, INT Z )
+	{
+		return X + (Y << GRID_BITS) + (Z << (GRID_BITS*2));
+	}
+	static FCellBox GetCellBox( FVector Min, FVector Max )
+	{
+		FCellBox Result;
+		Result.X0 = GetCellIndex( Min.X ); Result.X1 = GetCellIndex( Max.X );
+		Result.Y0 = GetCellIndex( Min.Y ); Result.Y1 = GetCellIndex( Max.Y );
+		Result.Z0 = GetCellIndex( Min.Z ); Result.Z1 = GetCellIndex( Max.Z );
+		return Result;
+	}
+	FCellBox GetActorCells( AActor* Actor )
+	{
+		FBox Box = Actor->GetPrimitive()->GetCollisionBoundingBox( Actor );
+		return GetCellBox( Box.Min, Box.Max );
+	}
+	FGridCell* FindCell( INT X, INT Y, INT Z )
+	{
+		INT* Index = CellMap.Find( GetCellKey( X, Y, Z ) );
+		return Index ? Cells(*Index) : NULL;
+	}
+	FGridCell* GetCell( INT X, INT Y, INT Z );
+	void LinkActor( FGridActor* Entry );
+	void UnlinkActor( FGridActor* Entry );
+	void GatherCell( FGridCell* Cell );
+	void GatherLarge( const FCellBox& Box );
+	void GatherBox( const FCellBox& Box );
+	void GatherLine( const FCellBox& Box, FVector Start, FVector End, FVector Extent );
+};
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid init/exit.
+-----------------------------------------------------------------------------*/
+
+FCollisionGrid::FCollisionGrid()
+:	QueryTag	( 0 )
+{}
+
+FCollisionGrid::~FCollisionGrid()
+{
+	guard(FCollisionGrid::~FCollisionGrid);
+	for( INT i=0; i<Cells.Num(); i++ )
+		delete Cells(i);
+	for( INT i=0; i<ActorMap.Size(); i++ )
+		delete ActorMap[i];
+	for( INT i=0; i<FreeActors.Num(); i++ )
+		delete FreeActors(i);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid tick.
+-----------------------------------------------------------------------------*/
+
+//
+// Purge actors which were removed and never added back.
+//
+void FCollisionGrid::Tick()
+{
+	guard(FCollisionGrid::Tick);
+
+	for( INT i=0; i<Detached.Num(); i++ )
+	{
+		FGridActor* Entry = Detached(i);
+		Entry->Pending = 0;
+		if( !Entry->Attached )
+		{
+			UnlinkActor( Entry );
+			ActorMap.Remove( Entry->Actor );
+			FreeActors.AddItem( Entry );
+		}
+	}
+	Detached.Empty();
+
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid linking.
+-----------------------------------------------------------------------------*/
+
+//
+// Find or create a cell.
+//
+FCollisionGrid::FGridCell* FCollisionGrid::GetCell( INT X, INT Y, INT Z )
+{
+	guardSlow(FCollisionGrid::GetCell);
+	DWORD Key = GetCellKey( X, Y, Z );
+	INT* Index = CellMap.Find( Key );
+	if( Index )
+		return Cells(*Index);
+	FGridCell* Cell = new FGridCell;
+	Cell->X = X;
+	Cell->Y = Y;
+	Cell->Z = Z;
+	CellMap.Add( Key, Cells.AddItem( Cell ) );
+	return Cell;
+	unguardSlow;
+}
+
+//
+// Link an actor into the cells in Entry->Cells.
+//
+void FCollisionGrid::LinkActor( FGridActor* Entry )
+{
+	guardSlow(FCollisionGrid::LinkActor);
+	const FCellBox& B = Entry->Cells;
+	Entry->Large = B.Count() > MAX_ACTOR_CELLS;
+	if( Entry->Large )
+	{
+		LargeActors.AddItem( Entry );
+		return;
+	}
+	for( INT X=B.X0; X<=B.X1; X++ ) for( INT Y=B.Y0; Y<=B.Y1; Y++ ) for( INT Z=B.Z0; Z<=B.Z1; Z++ )
+		GetCell( X, Y, Z )->Actors.AddItem( Entry );
+	unguardSlow;
+}
+
+//
+// Unlink an actor from its cells.
+//
+void FCollisionGrid::UnlinkActor( FGridActor* Entry )
+{
+	guardSlow(FCollisionGrid::UnlinkActor);
+	if( Entry->Large )
+	{
+		LargeActors.RemoveItem( Entry );
+		return;
+	}
+	const FCellBox& B = Entry->Cells;
+	for( INT X=B.X0; X<=B.X1; X++ ) for( INT Y=B.Y0; Y<=B.Y1; Y++ ) for( INT Z=B.Z0; Z<=B.Z1; Z++ )
+	{
+		FGridCell* Cell = FindCell( X, Y, Z );
+		check(Cell);
+		TArray<FGridActor*>& Actors = Cell->Actors;
+		for( INT i=0; i<Actors.Num(); i++ )
+		{
+			if( Actors(i)==Entry )
+			{
+				// Order doesn't matter, so swap the last one in. Keep the
+				// memory of cells that empty, since actors pass through often.
+				Actors(i) = Actors(Actors.Num()-1);
+				if( Actors.Num()==1 )
+					Actors.Reset();
+				else
+					Actors.Remove( Actors.Num()-1 );
+				break;
+			}
+		}
+	}
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid adding/removing.
+-----------------------------------------------------------------------------*/
+
+//
+// Add an actor to the collision info.
+//
+void FCollisionGrid::AddActor( AActor *Actor )
+{
+	guard(FCollisionGrid::AddActor);
+	check(Actor->bCollideActors);
+	if( Actor->bDeleteMe )
+		return;
+	CheckActorNotReferenced( Actor );
+
+	FCellBox NewCells = GetActorCells( Actor );
+	FGridActor** Found = ActorMap.Find( Actor );
+	if( Found )
+	{
+		// Moved since it was removed; only relink if it changed cells.
+		FGridActor* Entry = *Found;
+		if( !(NewCells == Entry->Cells) )
+		{
+			UnlinkActor( Entry );
+			Entry->Cells = NewCells;
+			LinkActor( Entry );
+		}
+		Entry->Attached = 1;
+	}
+	else
+	{
+		// New actor.
+		FGridActor* Entry;
+		if( FreeActors.Num() )
+		{
+			Entry = FreeActors(FreeActors.Num()-1);
+			FreeActors.Remove( FreeActors.Num()-1 );
+		}
+		else Entry = new FGridActor;
+		Entry->Actor    = Actor;
+		Entry->Cells    = NewCells;
+		Entry->Attached = 1;
+		Entry->Pending  = 0;
+		Entry->Tag      = QueryTag;
+		LinkActor( Entry );
+		ActorMap.Add( Actor, Entry );
+	}
+	Actor->ColLocation = Actor->Location;
+
+	unguard;
+}
+
+//
+// Remove an actor from the collision info.
+//
+void FCollisionGrid::RemoveActor( AActor* Actor )
+{
+	guard(FCollisionGrid::RemoveActor);
+	check(Actor->bCollideActors);
+	if( Actor->bDeleteMe )
+		return;
+	if( Actor->Location!=Actor->ColLocation )
+		appErrorf( "%s moved without proper hashing", Actor->GetFullName() );
+
+	// Detach it, leaving it in its cells until it's added back or purged.
+	FGridActor** Found = ActorMap.Find( Actor );
+	if( Found && (*Found)->Attached )
+	{
+		FGridActor* Entry = *Found;
+		Entry->Attached = 0;
+		if( !Entry->Pending )
+		{
+			Entry->Pending = 1;
+			Detached.AddItem( Entry );
+		}
+	}
+
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid candidate gathering.
+-----------------------------------------------------------------------------*/
+
+//
+// Add the attached actors of a cell to Candidates, once per query.
+//
+inline void FCollisionGrid::GatherCell( FGridCell* Cell )
+{
+	for( INT i=0; i<Cell->Actors.Num(); i++ )
+	{
+		FGridActor* Entry = Cell->Actors(i);
+		if( Entry->Attached && Entry->Tag!=QueryTag )
+		{
+			Entry->Tag = QueryTag;
+			Candidates.AddItem( Entry );
+		}
+	}
+}
+
+//
+// Add the large actors overlapping a box of cells to Candidates.
+//
+void FCollisionGrid::GatherLarge( const FCellBox& Box )
+{
+	for( INT i=0; i<LargeActors.Num(); i++ )
+	{
+		FGridActor* Entry = LargeActors(i);
+		if( Entry->Attached && Entry->Tag!=QueryTag && Entry->Cells.Intersects(Box) )
+		{
+			Entry->Tag = QueryTag;
+			Candidates.AddItem( Entry );
+		}
+	}
+}
+
+//
+// Gather all actors in a box of cells.
+//
+void FCollisionGrid::GatherBox( const FCellBox& Box )
+{
+	guardSlow(FCollisionGrid::GatherBox);
+	Candidates.Reset();
+	QueryTag++;
+	if( Box.Count() > Cells.Num() )
+	{
+		// Cheaper to walk the cells that exist.
+		for( INT i=0; i<Cells.Num(); i++ )
+			if( Box.Contains( Cells(i)->X, Cells(i)->Y, Cells(i)->Z ) )
+				GatherCell( Cells(i) );
+	}
+	else
+	{
+		for( INT X=Box.X0; X<=Box.X1; X++ ) for( INT Y=Box.Y0; Y<=Box.Y1; Y++ ) for( INT Z=Box.Z0; Z<=Box.Z1; Z++ )
+		{
+			FGridCell* Cell = FindCell( X, Y, Z );
+			if( Cell )
+				GatherCell( Cell );
+		}
+	}
+	GatherLarge( Box );
+	unguardSlow;
+}
+
+//
+// Whether the segment Start-End, swept by Extent, touches a cell. Edge
+// cells extend to infinity, because everything outside the grid is
+// clamped into them.
+//
+static UBOOL SweptLineTouchesCell( INT X, INT Y, INT Z, const FVector& Start, const FVector& Dir, const FVector& Extent )
+{
+	INT   C[3] = { X, Y, Z };
+	FLOAT TMin = 0.0, TMax = 1.0;
+	for( INT Axis=0; Axis<3; Axis++ )
+	{
+		if( C[Axis]==0 || C[Axis]==FCollisionGrid::GRID_SIZE-1 )
+			continue;
+		FLOAT S  = (&Start.X)[Axis];
+		FLOAT D  = (&Dir.X)[Axis];
+		FLOAT E  = (&Extent.X)[Axis] + 1.0;
+		FLOAT Lo = C[Axis]*(FLOAT)FCollisionGrid::GRAN - FCollisionGrid::WORLD_OFS - E;
+		FLOAT Hi = Lo + FCollisionGrid::GRAN + 2.0*E;
+		if( Abs(D) < 0.0001 )
+		{
+			if( S<Lo || S>Hi )
+				return 0;
+		}
+		else
+		{
+			FLOAT T0 = (Lo - S) / D;
+			FLOAT T1 = (Hi - S) / D;
+			if( T0 > T1 )
+				Exchange( T0, T1 );
+			TMin = Max( TMin, T0 );
+			TMax = Min( TMax, T1 );
+			if( TMin > TMax )
+				return 0;
+		}
+	}
+	return 1;
+}
+
+//
+// Gather the actors in the cells that a swept line passes through. An
+// actor is contained in the union of its cells, so any actor the line
+// hits is in one of them.
+//
+void FCollisionGrid::GatherLine( const FCellBox& Box, FVector Start, FVector End, FVector Extent )
+{
+	guardSlow(FCollisionGrid::GatherLine);
+	Candidates.Reset();
+	QueryTag++;
+	FVector Dir = End - Start;
+	if( Box.Count() > Cells.Num() )
+	{
+		for( INT i=0; i<Cells.Num(); i++ )
+		{
+			FGridCell* Cell = Cells(i);
+			if( Box.Contains( Cell->X, Cell->Y, Cell->Z ) && SweptLineTouchesCell( Cell->X, Cell->Y, Cell->Z, Start, Dir, Extent ) )
+				GatherCell( Cell );
+		}
+	}
+	else
+	{
+		for( INT X=Box.X0; X<=Box.X1; X++ ) for( INT Y=Box.Y0; Y<=Box.Y1; Y++ ) for( INT Z=Box.Z0; Z<=Box.Z1; Z++ )
+		{
+			FGridCell* Cell = FindCell( X, Y, Z );
+			if( Cell && SweptLineTouchesCell( X, Y, Z, Start, Dir, Extent ) )
+				GatherCell( Cell );
+		}
+	}
+	GatherLarge( Box );
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FCollisionGrid collision checking.
+-----------------------------------------------------------------------------*/
+
+//
+// Make a list of all actors which overlap with a cylinder at Location
+// with the given collision size.
+//
+FCheckResult* FCollisionGrid::ActorPointCheck
+(
+	FMemStack&		Mem,
+	FVector			Location,
+	FVector			Extent,
+	DWORD			ExtraNodeFlags
+)
+{
+	guard(FCollisionGrid::ActorPointCheck);
+	FCheckResult* Result=NULL;
+
+	GatherBox( GetCellBox( Location - Extent, Location + Extent ) );
+	for( INT i=0; i<Candidates.Num(); i++ )
+	{
+		AActor* Actor = Candidates(i)->Actor;
+		FCheckResult TestHit(1.0);
+		if( Actor->GetPrimitive()->PointCheck( TestHit, Actor, Location, Extent, 0 )==0 )
+		{
+			check(TestHit.Actor==Actor);
+			FCheckResult* New = new(GMem)FCheckResult;
+			*New = TestHit;
+			New->GetNext() = Result;
+			Result = New;
+		}
+	}
+	return Result;
+	unguard;
+}
+
+//
+// Make a list of all actors which are within a given radius.
+//
+FCheckResult* FCollisionGrid::ActorRadiusCheck
+(
+	FMemStack&		Mem,
+	FVector			Location,
+	FLOAT			Radius,
+	DWORD			ExtraNodeFlags
+)
+{
+	guard(FCollisionGrid::ActorRadiusCheck);
+	FCheckResult* Result=NULL;
+	FLOAT RadiusSq = Radius * Radius;
+
+	GatherBox( GetCellBox( Location - FVector(Radius,Radius,Radius), Location + FVector(Radius,Radius,Radius) ) );
+	for( INT i=0; i<Candidates.Num(); i++ )
+	{
+		AActor* Actor = Candidates(i)->Actor;
+		if( (Actor->Location - Location).SizeSquared() < RadiusSq )
+		{
+			FCheckResult* New = new(GMem)FCheckResult;
+			New->Actor = Actor;
+			New->GetNext() = Result;
+			Result = New;
+		}
+	}
+	return Result;
+	unguard;
+}
+
+//
+// Check for encroached actors.
+//
+FCheckResult* FCollisionGrid::ActorEncroachmentCheck
+(
+	FMemStack&		Mem,
+	AActor*			Actor,
+	FVector			Location,
+	FRotator		Rotation,
+	DWORD			ExtraNodeFlags
+)
+{
+	guard(FCollisionGrid::ActorEncroachmentCheck);
+	check(Actor!=NULL);
+
+	// Save actor's location and rotation.
+	Exchange( Location, Actor->Location );
+	Exchange( Rotation, Actor->Rotation );
+
+	FCheckResult *Result, **PrevLink = &Result;
+	GatherBox( GetActorCells( Actor ) );
+	for( INT i=0; i<Candidates.Num(); i++ )
+	{
+		AActor* Other = Candidates(i)->Actor;
+		FCheckResult TestHit(1.0);
+		if
+		(	!Other->IsMovingBrush()
+		&&	Other!=Actor
+		&&	Actor->GetPrimitive()->PointCheck( TestHit, Actor, Other->Location, Other->GetCylinderExtent(), 0 )==0 )
+		{
+			TestHit.Actor     = Other;
+			TestHit.Primitive = NULL;
+			*PrevLink         = new(GMem)FCheckResult;
+			**PrevLink        = TestHit;
+			PrevLink          = &(*PrevLink)->GetNext();
+		}
+	}
+
+	// Restore actor's location and rotation.
+	Exchange( Location, Actor->Location );
+	Exchange( Rotation, Actor->Rotation );
+
+	*PrevLink = NULL;
+	return Result;
+	unguard;
+}
+
+//
+// Make a list of all actors which overlap a cylinder moving along a line
+// from Start to End. Only the cells the swept line passes through are
+// checked, so long traces don't test every actor in their bounding box.
+//
+FCheckResult* FCollisionGrid::ActorLineCheck
+(
+	FMemStack&		Mem,
+	FVector			End,
+	FVector			Start,
+	FVector			Size,
+	BYTE			ExtraNodeFlags
+)
+{
+	guard(FCollisionGrid::ActorLineCheck);
+	FCheckResult* Result=NULL;
+
+	FBox Box( FBox(0) + Start + End );
+	GatherLine( GetCellBox( Box.Min - Size, Box.Max + Size ), Start, End, Size );
+	for( INT i=0; i<Candidates.Num(); i++ )
+	{
+		AActor* Actor = Candidates(i)->Actor;
+		FCheckResult Hit(0);
+		if( Actor->GetPrimitive()->LineCheck( Hit, Actor, End, Start, Size, ExtraNodeFlags )==0 )
+		{
+			FCheckResult* Link = new(Mem)FCheckResult(Hit);
+			Link->GetNext() = Result;
+			Result = Link;
+		}
+	}
+	return Result;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Checks.
+-----------------------------------------------------------------------------*/
+
+void FCollisionGrid::CheckActorNotReferenced( AActor* Actor )
+{
+#if CHECK_ALL
+	guard(FCollisionGrid::CheckActorNotReferenced);
+	FGridActor** Found;
+	if( !GIsEditor && (Found=ActorMap.Find( Actor ))!=NULL && (*Found)->Attached )
+		appErrorf( "%s has collision grid entries", Actor->GetFullName() );
+	unguard;
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+	Factory.
+-----------------------------------------------------------------------------*/
+
+ENGINE_API FCollisionHashBase* GNewCollisionGrid()
+{
+	guard(GNewCollisionGrid);
+	return new FCollisionGrid;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
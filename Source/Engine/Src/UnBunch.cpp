@@ -37,6 +37,171 @@ ENGINE_API void* AllocPooledBunch()
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Packed bit streams.
+-----------------------------------------------------------------------------*/
+
+// Bits per value for each size class of packed ints and vector components.
+static const INT IntBits[4]       = { 5, 10, 20, 32 };
+static const INT ComponentBits[4] = { 0,  5, 10, 16 };
+
+// Bits per component of Location deltas, by window.
+static const INT DeltaBits[4]     = { 0,  9, 12, 14 };
+
+//
+// Number of bits needed for values 0..Max-1.
+//
+static INT BitsFor( INT Max )
+{
+	INT Bits=0;
+	while( (1<<Bits) < Max )
+		Bits++;
+	return Bits;
+}
+
+//
+// Whether a property is the actor Location, which is delta-encoded
+// against the values last sent.
+//
+static UBOOL IsDeltaLocation( UProperty* Property )
+{
+	return Property->Offset==STRUCT_OFFSET(AActor,Location) && Property->GetOwnerClass()==AActor::StaticClass;
+}
+
+//
+// Write bits, least significant first.
+//
+void FOutBunch::WriteBits( DWORD Value, INT Count )
+{
+	guardSlow(FOutBunch::WriteBits);
+	if( Overflowed || 16+OutBits+Count>MaxDataSize*8 )
+	{
+		Overflowed = 1;
+		return;
+	}
+	for( INT Pos=16+OutBits, End=Pos+Count; Pos<End; )
+	{
+		INT  Shift = Pos & 7;
+		INT  Num   = Min( 8-Shift, End-Pos );
+		BYTE Mask  = ((1<<Num)-1) << Shift;
+		Data[Pos>>3] = (Data[Pos>>3] & ~Mask) | ((Value<<Shift) & Mask);
+		Value >>= Num;
+		Pos    += Num;
+	}
+	SetBits( OutBits+Count );
+	unguardSlow;
+}
+
+//
+// Set the number of bits written, truncating the stream if it's less.
+//
+void FOutBunch::SetBits( INT NewBits )
+{
+	guardSlow(FOutBunch::SetBits);
+	OutBits         = NewBits;
+	Data[0]         = OutBits & 255;
+	Data[1]         = OutBits >> 8;
+	Header.DataSize = OutBits ? 2 + (OutBits+7)/8 : 0;
+	unguardSlow;
+}
+
+//
+// Write an int, zigzag encoded in the smallest size class that holds it.
+//
+void FOutBunch::WriteInt( INT Value )
+{
+	guardSlow(FOutBunch::WriteInt);
+	DWORD Zig  = ((DWORD)Value << 1) ^ (DWORD)(Value >> 31);
+	INT   Size = 0;
+	while( Size<3 && Zig>=(1U<<IntBits[Size]) )
+		Size++;
+	WriteBits( Size, 2 );
+	WriteBits( Zig, IntBits[Size] );
+	unguardSlow;
+}
+
+//
+// Read bits, least significant first. Steps to the next part when the
+// current one is used up.
+//
+DWORD FInBunch::ReadBits( INT Count )
+{
+	guardSlow(FInBunch::ReadBits);
+	while( InPosition==PartEnd && Count && !Overflowed )
+	{
+		INT Start = (PartEnd+7) & ~7;
+		if( Start+16 > Header.DataSize*8 )
+		{
+			Overflowed = 1;
+			break;
+		}
+		InPosition = Start + 16;
+		PartEnd    = InPosition + (Data[Start>>3] | (Data[(Start>>3)+1]<<8));
+		if( PartEnd > Header.DataSize*8 )
+			Overflowed = 1;
+	}
+	if( Overflowed || InPosition+Count>PartEnd )
+	{
+		Overflowed = 1;
+		return 0;
+	}
+	DWORD Result=0;
+	for( INT Done=0; Done<Count; )
+	{
+		INT Shift = InPosition & 7;
+		INT Num   = Min( 8-Shift, Count-Done );
+		Result     |= (DWORD)((Data[InPosition>>3] >> Shift) & ((1<<Num)-1)) << Done;
+		Done       += Num;
+		InPosition += Num;
+	}
+	return Result;
+	unguardSlow;
+}
+
+//
+// Read an int written by FOutBunch::WriteInt.
+//
+INT FInBunch::ReadInt()
+{
+	guardSlow(FInBunch::ReadInt);
+	DWORD Zig = ReadBits( IntBits[ReadBits(2)] );
+	return (INT)(Zig >> 1) ^ -(INT)(Zig & 1);
+	unguardSlow;
+}
+
+//
+// Write quantized vector components, all in the smallest size class that
+// holds the largest.
+//
+static void WriteComponents( FOutBunch& Bunch, SWORD* Components, INT Num )
+{
+	DWORD Zig[4], Largest=0;
+	INT i, Size=0;
+	for( i=0; i<Num; i++ )
+	{
+		Zig[i]  = ((DWORD)(INT)Components[i] << 1) ^ (DWORD)((INT)Components[i] >> 31);
+		Largest = Max( Largest, Zig[i] );
+	}
+	while( Size<3 && Largest>=(1U<<ComponentBits[Size]) )
+		Size++;
+	Bunch.WriteBits( Size, 2 );
+	for( i=0; i<Num; i++ )
+		Bunch.WriteBits( Zig[i], ComponentBits[Size] );
+}
+
+//
+// Read vector components written by WriteComponents.
+//
+static void ReadComponents( FInBunch& Bunch, SWORD* Components, INT Num )
+{
+	INT Bits = ComponentBits[Bunch.ReadBits(2)];
+	for( INT i=0; i<Num; i++ )
+	{
+		DWORD Zig = Bunch.ReadBits( Bits );
+		Components[i] = (INT)(Zig >> 1) ^ -(INT)(Zig & 1);
+	}
+}
+
 /*-----------------------------------------------------------------------------
 	Name exchange.
 -----------------------------------------------------------------------------*/
@@ -174,7 +339,14 @@ UBOOL FInBunch::ReceiveProperty( UProperty* Property, BYTE* InData, BYTE* Recent
 	// Receive array dimension.
 	BYTE Element=0;
 	if( Property->ArrayDim != 1 )
-		*this << Element;
+	{
+		if( Packed )
+			Element = ReadBits( BitsFor(Property->ArrayDim) );
+		else
+			*this << Element;
+	}
+	if( Element >= Property->ArrayDim )
+		return 0;
 
 	// Receive property data.
 	INT Offset = Property->Offset + Element*Property->GetElementSize();
@@ -182,20 +354,32 @@ UBOOL FInBunch::ReceiveProperty( UProperty* Property, BYTE* InData, BYTE* Recent
 	if( Property->GetClass()==UByteProperty::StaticClass )
 	{
 		guard(Byte);
-		*this << *(BYTE*)Data;
+		UEnum* Enum = ((UByteProperty*)Property)->Enum;
+		if( !Packed )
+			*this << *(BYTE*)Data;
+		else if( Enum && ReadBits(1) )
+			*(BYTE*)Data = ReadBits( BitsFor(Enum->Names.Num()) );
+		else
+			*(BYTE*)Data = ReadBits( 8 );
 		unguard;
 	}
 	else if( Property->GetClass()==UIntProperty::StaticClass )
 	{
 		guard(Int);
-		*this << *(INT*)Data;
+		if( Packed )
+			*(INT*)Data = ReadInt();
+		else
+			*this << *(INT*)Data;
 		unguard;
 	}
 	else if( Property->GetClass()==UBoolProperty::StaticClass )
 	{
 		guard(Bool);
 		BYTE BoolValue;
-		*this << BoolValue;
+		if( Packed )
+			BoolValue = ReadBits( 1 );
+		else
+			*this << BoolValue;
 		if( BoolValue )
 			*(DWORD*)Data |= CastChecked<UBoolProperty>(Property)->BitMask;
 		else
@@ -205,13 +389,18 @@ UBOOL FInBunch::ReceiveProperty( UProperty* Property, BYTE* InData, BYTE* Recent
 	else if( Property->GetClass()==UFloatProperty::StaticClass )
 	{
 		guard(Float);
-		*this << *(FLOAT*)Data;
+		if( !Packed )
+			*this << *(FLOAT*)Data;
+		else if( ReadBits(1) )
+			*(FLOAT*)Data = ReadInt();
+		else
+			*(DWORD*)Data = ReadBits( 32 );
 		unguard;
 	}
 	else if( Property->IsA(UObjectProperty::StaticClass) )
 	{
 		guard(Object);
-		UObject* Obj;
+		UObject* Obj=NULL;
 		*this << Obj;
 		*(UObject**)Data = NULL;
 		UClass* Class = ((UObjectProperty*)Property)->PropertyClass;
@@ -251,28 +440,61 @@ UBOOL FInBunch::ReceiveProperty( UProperty* Property, BYTE* InData, BYTE* Recent
 		UStructProperty* StructProperty = CastChecked<UStructProperty>( Property );
 		if( StructProperty->Struct->GetFName()==NAME_Vector )
 		{
-			SWORD X,Y,Z;
-			*this << X << Y << Z;
-			((FVector*)Data)->X = X;
-			((FVector*)Data)->Y = Y;
-			((FVector*)Data)->Z = Z;
+			SWORD V[3];
+			INT   Window;
+			if( !Packed )
+			{
+				*this << V[0] << V[1] << V[2];
+			}
+			else if( Recent && IsDeltaLocation(Property) && (Window=ReadBits(2))!=0 )
+			{
+				// Low bits of each component; take the value with those bits
+				// that's nearest the Location last received.
+				FVector& Base = ((AActor*)Recent)->Location;
+				SWORD    B[3] = { (SWORD)Base.X, (SWORD)Base.Y, (SWORD)Base.Z };
+				INT      Bits = DeltaBits[Window];
+				for( INT i=0; i<3; i++ )
+				{
+					INT Delta = (ReadBits(Bits) - B[i]) & ((1<<Bits)-1);
+					if( Delta >= (1<<(Bits-1)) )
+						Delta -= 1<<Bits;
+					V[i] = B[i] + Delta;
+				}
+			}
+			else ReadComponents( *this, V, 3 );
+			((FVector*)Data)->X = V[0];
+			((FVector*)Data)->Y = V[1];
+			((FVector*)Data)->Z = V[2];
 		}
 		else if( StructProperty->Struct->GetFName()==NAME_Rotator )
 		{
-			BYTE Pitch, Yaw, Roll;
-			*this << Pitch << Yaw << Roll;
+			BYTE Pitch=0, Yaw=0, Roll=0;
+			if( !Packed )
+			{
+				*this << Pitch << Yaw << Roll;
+			}
+			else
+			{
+				// Zero components, usually Pitch and Roll, are one bit.
+				if( ReadBits(1) ) Pitch = ReadBits( 8 );
+				if( ReadBits(1) ) Yaw   = ReadBits( 8 );
+				if( ReadBits(1) ) Roll  = ReadBits( 8 );
+			}
 			((FRotator*)Data)->Pitch = Pitch << 8;
 			((FRotator*)Data)->Yaw   = Yaw   << 8;
 			((FRotator*)Data)->Roll  = Roll  << 8;
 		}
 		else if( StructProperty->Struct->GetFName()==NAME_Plane )
 		{
-			SWORD X,Y,Z,W;
-			*this << X << Y << Z << W;
-			((FPlane*)Data)->X = X;
-			((FPlane*)Data)->Y = Y;
-			((FPlane*)Data)->Z = Z;
-			((FPlane*)Data)->W = W;
+			SWORD P[4];
+			if( Packed )
+				ReadComponents( *this, P, 4 );
+			else
+				*this << P[0] << P[1] << P[2] << P[3];
+			((FPlane*)Data)->X = P[0];
+			((FPlane*)Data)->Y = P[1];
+			((FPlane*)Data)->Z = P[2];
+			((FPlane*)Data)->W = P[3];
 		}
 		else
 		{
@@ -314,6 +536,8 @@ FOutBunch::FOutBunch( FChannel* InChannel, UBOOL bClose )
 	Header._ChType      = Channel->ChType;
 	Header.DataSize     = 0;
 	MaxDataSize         = sizeof(Data);
+	Packed              = Channel->ChType==CHTYPE_Actor && Channel->Connection->ProtocolVersion>=2;
+	OutBits             = 0;
 
 	// Reserve channel and set bunch info.
 	if( Channel->ReserveOutgoingIndex(bClose)==INDEX_NONE )
@@ -333,7 +557,12 @@ FOutBunch::FOutBunch( FChannel* InChannel, UBOOL bClose )
 FArchive& FOutBunch::Serialize( void* V, INT Length )
 {
 	guard(FOutBunch::Serialize);	
-	if( Header.DataSize+Length<=MaxDataSize && !Overflowed )
+	if( Packed )
+	{
+		for( INT i=0; i<Length; i++ )
+			WriteBits( ((BYTE*)V)[i], 8 );
+	}
+	else if( Header.DataSize+Length<=MaxDataSize && !Overflowed )
 	{
 		appMemcpy( &Data[Header.DataSize], V, Length );
 		Header.DataSize += Length;
@@ -350,6 +579,7 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 {
 	guard(FOutBunch::SendProperty);
 	INT SavedSize       = Header.DataSize;
+	INT SavedBits       = OutBits;
 	INT SavedOverflowed = Overflowed;
 
 	// Setup.
@@ -364,7 +594,10 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 		if( Property->ArrayDim != 1 )
 		{
 			BYTE Element = ArrayIndex;
-			*this << Element;
+			if( Packed )
+				WriteBits( Element, BitsFor(Property->ArrayDim) );
+			else
+				*this << Element;
 		}
 	}
 
@@ -372,26 +605,57 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 	if( Property->GetClass()==UByteProperty::StaticClass )
 	{
 		guard(Byte);
-		*this << *(BYTE*)Data;
+		UEnum* Enum = ((UByteProperty*)Property)->Enum;
+		if( !Packed )
+			*this << *(BYTE*)Data;
+		else if( Enum )
+		{
+			// Enums take as many bits as they have values.
+			INT   Bits = BitsFor( Enum->Names.Num() );
+			UBOOL Fits = *(BYTE*)Data < (1<<Bits);
+			WriteBits( Fits, 1 );
+			WriteBits( *(BYTE*)Data, Fits ? Bits : 8 );
+		}
+		else WriteBits( *(BYTE*)Data, 8 );
 		unguard;
 	}
 	else if( Property->GetClass()==UIntProperty::StaticClass )
 	{
 		guard(Int);
-		*this << *(INT*)Data;
+		if( Packed )
+			WriteInt( *(INT*)Data );
+		else
+			*this << *(INT*)Data;
 		unguard;
 	}
 	else if( Property->GetClass()==UBoolProperty::StaticClass )
 	{
 		guard(Bool);
 		BYTE BoolValue = (*(DWORD*)Data & CastChecked<UBoolProperty>(Property)->BitMask) ? 1 : 0;
-		*this << BoolValue;
+		if( Packed )
+			WriteBits( BoolValue, 1 );
+		else
+			*this << BoolValue;
 		unguard;
 	}
 	else if( Property->GetClass()==UFloatProperty::StaticClass )
 	{
 		guard(Float);
-		*this << *(FLOAT*)Data;
+		FLOAT Value = *(FLOAT*)Data;
+		if( !Packed )
+			*this << *(FLOAT*)Data;
+		else if( Value>-524288.f && Value<524288.f && (FLOAT)(INT)Value==Value && *(DWORD*)Data!=0x80000000 )
+		{
+			// Whole numbers, which most replicated floats are, as packed
+			// ints. Anything else is sent as is.
+			WriteBits( 1, 1 );
+			WriteInt( (INT)Value );
+		}
+		else
+		{
+			WriteBits( 0, 1 );
+			WriteBits( *(DWORD*)Data, 32 );
+		}
 		unguard;
 	}
 	else if( Property->IsA(UObjectProperty::StaticClass) )
@@ -420,25 +684,65 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 		UStructProperty* StructProperty = CastChecked<UStructProperty>( Property );
 		if( StructProperty->Struct->GetFName()==NAME_Vector )
 		{
-			SWORD X = ((FVector*)Data)->X;
-			SWORD Y = ((FVector*)Data)->Y;
-			SWORD Z = ((FVector*)Data)->Z;
-			*this << X << Y << Z;
+			SWORD V[3];
+			V[0] = ((FVector*)Data)->X;
+			V[1] = ((FVector*)Data)->Y;
+			V[2] = ((FVector*)Data)->Z;
+			if( !Packed )
+			{
+				*this << V[0] << V[1] << V[2];
+			}
+			else if( Defaults && Named && IsDeltaLocation(Property) )
+			{
+				// When Location is near the value last sent, send only the low
+				// bits of each component. The receiver picks the value with
+				// those bits nearest the Location it last received, so missed
+				// unreliable updates don't matter as long as it's within half
+				// the window; the window is picked with 4x headroom for that,
+				// and every 16th bunch sends it whole.
+				FVector& Base  = ((AActor*)Defaults)->Location;
+				INT      D[3]  = { V[0]-(SWORD)Base.X, V[1]-(SWORD)Base.Y, V[2]-(SWORD)Base.Z };
+				INT      Range = Max( Max(Abs(D[0]),Abs(D[1])), Abs(D[2]) );
+				INT      Window;
+				for( Window=1; Window<4 && Range>=(1<<(DeltaBits[Window]-3)); Window++ );
+				if( Window<4 && (Header.Sequence & 15)!=0 )
+				{
+					WriteBits( Window, 2 );
+					for( INT i=0; i<3; i++ )
+						WriteBits( V[i] & ((1<<DeltaBits[Window])-1), DeltaBits[Window] );
+				}
+				else
+				{
+					WriteBits( 0, 2 );
+					WriteComponents( *this, V, 3 );
+				}
+			}
+			else WriteComponents( *this, V, 3 );
 		}
 		else if( StructProperty->Struct->GetFName()==NAME_Rotator )
 		{
 			BYTE Pitch = ((FRotator*)Data)->Pitch >> 8;
 			BYTE Yaw   = ((FRotator*)Data)->Yaw   >> 8;
 			BYTE Roll  = ((FRotator*)Data)->Roll  >> 8;
-			*this << Pitch << Yaw << Roll;
+			if( Packed )
+			{
+				WriteBits( Pitch!=0, 1 ); if( Pitch ) WriteBits( Pitch, 8 );
+				WriteBits( Yaw  !=0, 1 ); if( Yaw   ) WriteBits( Yaw,   8 );
+				WriteBits( Roll !=0, 1 ); if( Roll  ) WriteBits( Roll,  8 );
+			}
+			else *this << Pitch << Yaw << Roll;
 		}
 		else if( StructProperty->Struct->GetFName()==NAME_Plane )
 		{
-			SWORD X = ((FPlane*)Data)->X;
-			SWORD Y = ((FPlane*)Data)->Y;
-			SWORD Z = ((FPlane*)Data)->Z;
-			SWORD W = ((FPlane*)Data)->W;
-			*this << X << Y << Z << W;
+			SWORD P[4];
+			P[0] = ((FPlane*)Data)->X;
+			P[1] = ((FPlane*)Data)->Y;
+			P[2] = ((FPlane*)Data)->Z;
+			P[3] = ((FPlane*)Data)->W;
+			if( Packed )
+				WriteComponents( *this, P, 4 );
+			else
+				*this << P[0] << P[1] << P[2] << P[3];
 		}
 		else
 		{
@@ -452,6 +756,8 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 		guard(Overflowed);
 		Header.DataSize = SavedSize;
 		Overflowed      = SavedOverflowed;
+		if( Packed )
+			SetBits( SavedBits );
 		return 1;
 		unguard;
 	}
@@ -473,6 +779,240 @@ UBOOL FOutBunch::SendProperty( UProperty* Property, INT ArrayIndex, BYTE* InData
 	unguardf(( "(%s)", Property->GetName() ));
 }
 
+/*-----------------------------------------------------------------------------
+	FNetBenchmark implementation.
+-----------------------------------------------------------------------------*/
+
+ENGINE_API FNetBenchmark GNetBenchmark;
+
+//
+// Constructor.
+//
+FNetBenchmark::FNetBenchmark()
+:	Recording	( 0 )
+,	Level		( NULL )
+,	FramesLeft	( 0 )
+,	NumFrames	( 0 )
+,	NumStreams	( 0 )
+,	NumPending	( 0 )
+{}
+
+//
+// Forget everything recorded.
+//
+void FNetBenchmark::Reset()
+{
+	guard(FNetBenchmark::Reset);
+	Recording  = 0;
+	NumStreams = 0;
+	NumPending = 0;
+	Updates.Empty();
+	Properties.Empty();
+	Snapshots.Empty();
+	Streams.Empty();
+	unguard;
+}
+
+//
+// Start recording the updates sent by a server.
+//
+void FNetBenchmark::Start( ULevel* InLevel, INT InNumFrames, FOutputDevice* Out )
+{
+	guard(FNetBenchmark::Start);
+	Reset();
+	if( !InLevel->NetDriver || InLevel->NetDriver->ServerConnection || !InLevel->NetDriver->Connections.Num() )
+	{
+		Out->Logf( "NETBENCH needs a server with clients connected" );
+		return;
+	}
+	Level      = InLevel;
+	NumFrames  = FramesLeft = Max( InNumFrames, 1 );
+	Recording  = 1;
+	Out->Logf( "NETBENCH: Recording %i frames of actor updates", NumFrames );
+	unguard;
+}
+
+//
+// Count a server tick, and replay what was recorded after the last one.
+//
+void FNetBenchmark::Tick( ULevel* InLevel )
+{
+	guard(FNetBenchmark::Tick);
+	if( Recording && InLevel==Level && --FramesLeft<=0 )
+	{
+		Recording = 0;
+		Replay();
+		Reset();
+	}
+	unguard;
+}
+
+//
+// Append a copy of some data to the snapshots.
+//
+INT FNetBenchmark::AddSnapshot( BYTE* Data, INT Size )
+{
+	guard(FNetBenchmark::AddSnapshot);
+	INT Index = Snapshots.Add( Size );
+	appMemcpy( &Snapshots(Index), Data, Size );
+	return Index;
+	unguard;
+}
+
+//
+// Note that a property of the actor being replicated went into its bunch.
+//
+void FNetBenchmark::NoteProperty( UProperty* Property, INT Index, BYTE* Data )
+{
+	guard(FNetBenchmark::NoteProperty);
+	FSentProperty& Sent = Properties( Properties.Add() );
+	Sent.Property = Property;
+	Sent.Index    = Index;
+	Sent.Value    = AddSnapshot( Data + Property->Offset + Index*Property->GetElementSize(), Property->GetElementSize() );
+	NumPending++;
+	unguard;
+}
+
+//
+// Finish recording an actor update, after its bunch has been sent or
+// discarded.
+//
+void FNetBenchmark::NoteUpdate( FActorChannel* Channel, UBOOL Sent )
+{
+	guard(FNetBenchmark::NoteUpdate);
+	AActor* Actor = Channel->Actor;
+	INT     Size  = Actor->GetClass()->Defaults.Num();
+	if( !Sent )
+	{
+		Properties.Remove( Properties.Num()-NumPending, NumPending );
+		NumPending = 0;
+	}
+	INT  Snapshot = INDEX_NONE;
+	UBOOL Seed    = 0;
+	INT* Stream   = Streams.Find( Channel );
+	if( !Stream || Actor->bNetInitial )
+	{
+		// New stream. Channels that were open before recording started are
+		// replayed from the values last sent on them, so their first update
+		// is only a seed.
+		Stream = Streams.Add( Channel, NumStreams++ );
+		Seed   = !Actor->bNetInitial;
+		if( Seed )
+		{
+			Properties.Remove( Properties.Num()-NumPending, NumPending );
+			NumPending = 0;
+			Snapshot   = AddSnapshot( Channel->Recent, Size );
+		}
+		else Snapshot = AddSnapshot( (BYTE*)Actor, Size );
+	}
+	if( NumPending || Seed )
+	{
+		FUpdate& Update      = Updates( Updates.Add() );
+		Update.Connection    = Channel->Connection;
+		Update.Class         = Actor->GetClass();
+		Update.Stream        = *Stream;
+		Update.Snapshot      = Snapshot;
+		Update.Seed          = Seed;
+		Update.FirstProperty = Properties.Num()-NumPending;
+		Update.NumProperties = NumPending;
+	}
+	NumPending = 0;
+	unguard;
+}
+
+//
+// Encode the recorded updates with and without bit packing, on each
+// update's connection, and log the bytes per update of each.
+//
+void FNetBenchmark::Replay()
+{
+	guard(FNetBenchmark::Replay);
+	INT i, Bytes[2]={0,0}, NumUpdates=0, NumProperties=0;
+	for( INT Mode=0; Mode<2; Mode++ )
+	{
+		// Per stream actor values, values last sent and bunch sequence.
+		TArray<BYTE*> Values, Recent;
+		TArray<INT>   Sequence;
+		Values.AddZeroed( NumStreams );
+		Recent.AddZeroed( NumStreams );
+		Sequence.AddZeroed( NumStreams );
+		for( i=0; i<Updates.Num(); i++ )
+		{
+			FUpdate& Update = Updates(i);
+			INT      Size   = Update.Class->Defaults.Num();
+			INT      Stream = Update.Stream;
+			if( Update.Snapshot!=INDEX_NONE && !Values(Stream) )
+			{
+				// Start the stream the way ReplicateActor starts a channel.
+				Values(Stream) = (BYTE*)appMalloc( Size, "NetBenchValues" );
+				Recent(Stream) = (BYTE*)appMalloc( Size, "NetBenchRecent" );
+				appMemcpy( Values(Stream), &Snapshots(Update.Snapshot), Size );
+				if( Update.Seed )
+				{
+					appMemcpy( Recent(Stream), Values(Stream), Size );
+				}
+				else
+				{
+					AActor* Actor = (AActor*)Values(Stream);
+					appMemcpy( Recent(Stream), &Update.Class->Defaults(0), Size );
+					if( !Actor->bStatic && !Actor->bNoDelete )
+						((AActor*)Recent(Stream))->Location = Actor->Location;
+				}
+			}
+			INT iConnection;
+			if
+			(	Update.Seed
+			||	!Values(Stream)
+			||	!Level->NetDriver
+			||	!Level->NetDriver->Connections.FindItem( Update.Connection, iConnection )
+			||	!Update.Connection->Channels[0]
+			||	Update.Connection->Channels[0]->State!=UCHAN_Open )
+				continue;
+
+			// Build the update's bunch on the control channel, which is always
+			// open, with the encoding being measured.
+			FOutBunch Bunch( Update.Connection->Channels[0] );
+			Bunch.Overflowed      = 0;
+			Bunch.Packed          = Mode;
+			Bunch.Header.Sequence = ++Sequence(Stream);
+			for( INT j=0; j<Update.NumProperties; j++ )
+			{
+				FSentProperty& Sent    = Properties(Update.FirstProperty+j);
+				INT            Offset  = Sent.Property->Offset + Sent.Index*Sent.Property->GetElementSize();
+				UBoolProperty* Bool    = Cast<UBoolProperty>( Sent.Property );
+				if( Bool )
+					*(DWORD*)(Values(Stream)+Offset) = (*(DWORD*)(Values(Stream)+Offset) & ~Bool->BitMask) | (*(DWORD*)&Snapshots(Sent.Value) & Bool->BitMask);
+				else
+					appMemcpy( Values(Stream)+Offset, &Snapshots(Sent.Value), Sent.Property->GetElementSize() );
+				if( Bunch.SendProperty( Sent.Property, Sent.Index, Values(Stream), Recent(Stream), 1 ) )
+					break;
+			}
+			Bytes[Mode] += FBunch::GetHeaderSize() + Bunch.Header.DataSize;
+			if( Mode==0 )
+			{
+				NumUpdates++;
+				NumProperties += Update.NumProperties;
+			}
+		}
+		for( i=0; i<NumStreams; i++ )
+		{
+			if( Values(i) )
+				appFree( Values(i) );
+			if( Recent(i) )
+				appFree( Recent(i) );
+		}
+	}
+
+	// Report.
+	FLOAT PerUpdate[2];
+	for( i=0; i<2; i++ )
+		PerUpdate[i] = (FLOAT)Bytes[i] / Max(NumUpdates,1);
+	debugf( NAME_Log, "NETBENCH: %i frames, %i actor updates, %i properties", NumFrames, NumUpdates, NumProperties );
+	debugf( NAME_Log, "NETBENCH: Byte-aligned (protocol 1): %i bytes, %.1f bytes/update", Bytes[0], PerUpdate[0] );
+	debugf( NAME_Log, "NETBENCH: Bit-packed (protocol 2): %i bytes, %.1f bytes/update, %.1f%%", Bytes[1], PerUpdate[1], 100.0 * Bytes[1] / Max(Bytes[0],1) );
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -609,6 +609,9 @@ FActorChannel::FActorChannel( UNetConnection* InConnection, INT InChannelIndex,
 ,	Recent			( NULL )
 ,	RelevantTime	( Connection->Driver->Time )
 ,	LastUpdateTime	( Connection->Driver->Time - Connection->Driver->SpawnPrioritySeconds )
+,	Changed			( NULL )
+,	Pending			( NULL )
+,	CheckedFrame	( 0 )
 {
 	guard(FActorChannel::FActorChannel);
 	unguard;
@@ -638,6 +641,8 @@ FActorChannel::~FActorChannel()
 	guard(FreeRecent);
 	if( Recent )
 		appFree( Recent );
+	if( Pending )
+		appFree( Pending );
 	unguard;
 
 	// If we're the client, destroy this actor.
@@ -674,6 +679,7 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 
 		// Read class.
 		UObject* Object;
+		FVector  Location(0,0,0);
 		Bunch << Object;
 		Actor = Cast<AActor>( Object );
 		if( Actor==NULL )
@@ -684,7 +690,6 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 			check(ActorClass);
 			check(ActorClass->IsChildOf(AActor::StaticClass));
 #endif
-			FVector Location;
 			Bunch << Location;
 			Actor = Level->SpawnActor( ActorClass, NAME_None, NULL, NULL, Location, FRotator(0,0,0), NULL, 1, 1, 1 );
 #if CHECK_ALL
@@ -694,6 +699,18 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 #endif
 		}
 		debugfSlow( NAME_DevNetTraffic, "      Net spawn %s:", Actor->GetFullName() );
+
+		// Packed bunches may send only the low bits of Location, which are
+		// rebuilt from the Location last received, so keep our own Recent
+		// values like the server keeps the values sent.
+		if( Bunch.Packed && !Recent )
+		{
+			INT Size = Actor->GetClass()->Defaults.Num();
+			Recent   = (BYTE*)appMalloc( Size, "FActorChannelRecent" );
+			appMemcpy( Recent, &Actor->GetClass()->Defaults(0), Size );
+			if( Actor!=Object )
+				((AActor*)Recent)->Location = Location;
+		}
 		unguard;
 	}
 	debugfSlow( NAME_DevNetTraffic, "      Actor %s:", Actor->GetFullName() );
@@ -719,6 +736,9 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 	}
 	unguard;
 
+	// Received values go into Recent, so compare everything next time.
+	CheckedFrame = 0;
+
 	// Handle the data stream.
 	guard(HandleStream);
 	FName PropertyName;
@@ -939,6 +959,286 @@ void FActorChannel::ReceivedBunch( FInBunch& Bunch )
 	unguardf(( "(Actor %s)", Actor ? Actor->GetName() : "null"));
 }
 
+//
+// Whether a replicated property may read differently while the actor is
+// being replicated than before: ReplicateActor changes the actor's
+// RemoteRole and net flags for each connection. These are always compared
+// when replicating.
+//
+static inline UBOOL IsLiveRepProperty( UProperty* Property )
+{
+	return Property->Offset==STRUCT_OFFSET(AActor,RemoteRole) || Property->IsA(UBoolProperty::StaticClass);
+}
+
+//
+// Whether a replicated property matches its most recently sent value. Bit
+// numbers the property's element among all of the class's replicated ones.
+//
+static inline UBOOL PropertyMatches( FActorChannel* Channel, UProperty* Property, INT Index, INT Bit )
+{
+	if( Channel->Changed && !IsLiveRepProperty(Property) )
+		return !(Channel->Changed[Bit>>5] & (1<<(Bit&31)));
+	return Property->Matches( Channel->Actor, Channel->Recent, Index );
+}
+
+//
+// Count the replicated property elements of a class, which is the number
+// of bits FindChangedProperties needs in Changed.
+//
+INT FActorChannel::CountRepProperties( UClass* Class )
+{
+	guard(FActorChannel::CountRepProperties);
+	INT Count = 0;
+	for( UClass* RepClass=Class; RepClass; RepClass=RepClass->GetSuperClass() )
+		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+			Count += Link->Property->ArrayDim;
+	return Count;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FActorShadows implementation.
+-----------------------------------------------------------------------------*/
+
+//
+// Constructor.
+//
+FActorShadows::FActorShadows( ULevel* InLevel )
+:	Frame	( 0 )
+,	Level	( InLevel )
+{}
+
+//
+// Destructor.
+//
+FActorShadows::~FActorShadows()
+{
+	guard(FActorShadows::~FActorShadows);
+	for( INT i=0; i<Map.Size(); i++ )
+		appFree( Map[i] );
+	unguard;
+}
+
+//
+// Make a shadow of an actor, all of whose properties count as changed in
+// the current frame.
+//
+FActorShadow* FActorShadows::CreateShadow( AActor* Actor )
+{
+	guard(FActorShadows::CreateShadow);
+	UClass* Class    = Actor->GetClass();
+	INT     NumLinks = 0;
+	for( UClass* RepClass=Class; RepClass; RepClass=RepClass->GetSuperClass() )
+		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+			NumLinks++;
+
+	// Allocate the shadow and its arrays together.
+	INT NumBits    = FActorChannel::CountRepProperties( Class );
+	INT Size       = Class->Defaults.Num();
+	INT HeaderSize = Align( (INT)sizeof(FActorShadow), 8 );
+	INT ValuesSize = Align( Size, 8 );
+	BYTE* Mem      = (BYTE*)appMalloc( HeaderSize + ValuesSize + NumBits*sizeof(INT) + 2*NumLinks*sizeof(DWORD), "FActorShadow" );
+
+	FActorShadow* Shadow   = (FActorShadow*)Mem;
+	Shadow->Class          = Class;
+	Shadow->Frame          = Frame;
+	Shadow->NumBits        = NumBits;
+	Shadow->NumLinks       = NumLinks;
+	Shadow->Values         = Mem + HeaderSize;
+	Shadow->ChangeFrame    = (INT*)(Shadow->Values + ValuesSize);
+	Shadow->ConditionFrame = 0;
+	Shadow->ConditionKnown = (DWORD*)(Shadow->ChangeFrame + NumBits);
+	Shadow->ConditionTrue  = Shadow->ConditionKnown + NumLinks;
+	appMemcpy( Shadow->Values, Actor, Size );
+	for( INT i=0; i<NumBits; i++ )
+		Shadow->ChangeFrame[i] = Frame;
+	return Shadow;
+	unguard;
+}
+
+//
+// Actors whose shadows need comparing.
+//
+struct FActorShadowUpdate
+{
+	AActor**		Actors;
+	FActorShadow**	Shadows;
+	INT				Frame;
+};
+
+//
+// Compare a range of actors with their shadows, noting and copying the
+// properties that have changed.
+//
+static void UpdateShadowsJob( void* Arg, INT Start, INT End )
+{
+	guard(UpdateShadowsJob);
+	FActorShadowUpdate* Update = (FActorShadowUpdate*)Arg;
+	for( INT i=Start; i<End; i++ )
+	{
+		AActor*       Actor  = Update->Actors[i];
+		FActorShadow* Shadow = Update->Shadows[i];
+		INT           Bit    = 0;
+		for( UClass* RepClass=Actor->GetClass(); RepClass; RepClass=RepClass->GetSuperClass() )
+		{
+			for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+			{
+				UProperty* It = Link->Property;
+				if( !IsLiveRepProperty(It) )
+				{
+					for( INT Index=0; Index<It->ArrayDim; Index++ )
+					{
+						if( !It->Matches(Actor,Shadow->Values,Index) )
+						{
+							INT Ofs = It->Offset + Index * It->GetElementSize();
+							appMemcpy( Shadow->Values + Ofs, (BYTE*)Actor + Ofs, It->GetElementSize() );
+							Shadow->ChangeFrame[Bit+Index] = Update->Frame;
+						}
+					}
+				}
+				Bit += It->ArrayDim;
+			}
+		}
+	}
+	unguard;
+}
+
+//
+// Start a new frame, finding which replicated properties of the level's
+// actors have changed since the last one.
+//
+void FActorShadows::Update()
+{
+	guard(FActorShadows::Update);
+	Frame++;
+
+	// Find the shadows of actors that can be replicated, making new ones for
+	// actors that are new or whose address has been reused.
+	FMemMark Mark(GMem);
+	FActorShadowUpdate Update;
+	Update.Actors  = new(GMem,Level->Num())AActor*;
+	Update.Shadows = new(GMem,Level->Num())FActorShadow*;
+	Update.Frame   = Frame;
+	INT Num        = 0;
+	for( INT i=0; i<Level->Num(); i++ )
+	{
+		AActor* Actor = Level->Actors(i);
+		if( Actor && Actor->RemoteRole!=ROLE_None && !Actor->bDeleteMe )
+		{
+			FActorShadow* Shadow = Find( Actor );
+			if( !Shadow )
+			{
+				FActorShadow** Stale = Map.Find( Actor );
+				if( Stale )
+					appFree( *Stale );
+				Shadow = *Map.Add( Actor, CreateShadow(Actor) );
+			}
+			else
+			{
+				Update.Actors [Num] = Actor;
+				Update.Shadows[Num] = Shadow;
+				Num++;
+			}
+			Shadow->Frame = Frame;
+		}
+	}
+
+	// Forget actors that are gone.
+	for( INT i=Map.Size()-1; i>=0; i-- )
+	{
+		if( Map[i]->Frame!=Frame )
+		{
+			AActor* Actor = Map.GetKey(i);
+			appFree( Map[i] );
+			Map.Remove( Actor );
+		}
+	}
+
+	// Compare the rest.
+	GJobs.ParallelFor( Num, 16, UpdateShadowsJob, &Update );
+	Mark.Pop();
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FActorChannel replication.
+-----------------------------------------------------------------------------*/
+
+//
+// Compare the actor's replicated properties with Recent ahead of
+// ReplicateActor, setting a bit in Changed for each one that differs.
+// If the actor has a shadow, only the properties that have changed since
+// this channel last compared them, or that differed then, are compared.
+// Only reads the actor and this channel, so channels can do this on
+// worker threads while the actors are not changing.
+//
+void FActorChannel::FindChangedProperties()
+{
+	guard(FActorChannel::FindChangedProperties);
+	check(Changed);
+	check(Recent);
+	FActorShadow* Shadow = Level->ActorShadows ? Level->ActorShadows->Find( Actor ) : NULL;
+	UBOOL   Everything   = !Shadow || !Pending || !CheckedFrame;
+	INT     Bit          = 0;
+	for( UClass* RepClass=Actor->GetClass(); RepClass; RepClass=RepClass->GetSuperClass() )
+	{
+		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+		{
+			UProperty* It = Link->Property;
+			for( INT Index=0; Index<It->ArrayDim; Index++, Bit++ )
+			{
+				DWORD Mask = 1<<(Bit&31);
+				if
+				(	!IsLiveRepProperty(It)
+				&&	!(It->PropertyFlags & CPF_NetAlways)
+				&&	(Everything || Shadow->ChangeFrame[Bit]>CheckedFrame || (Pending[Bit>>5] & Mask))
+				&&	!It->Matches(Actor,Recent,Index) )
+					Changed[Bit>>5] |= Mask;
+				else
+					Changed[Bit>>5] &= ~Mask;
+			}
+		}
+	}
+	unguard;
+}
+
+//
+// Evaluate a property's replication condition for the actor. The result
+// only depends on the connection through the net variables ReplicateActor
+// sets, so it is cached in the actor's shadow for the rest of the frame.
+//
+static UBOOL EvalRepCondition( AActor* Actor, UProperty* It, FActorShadow* Shadow, INT iLink, INT Frame )
+{
+	guard(EvalRepCondition);
+	DWORD Variant = FActorShadows::GetNetVariant( Actor );
+	if( Shadow )
+	{
+		if( Shadow->ConditionFrame != Frame )
+		{
+			Shadow->ConditionFrame = Frame;
+			appMemset( Shadow->ConditionKnown, 0, Shadow->NumLinks*sizeof(DWORD) );
+		}
+		if( Shadow->ConditionKnown[iLink] & Variant )
+			return (Shadow->ConditionTrue[iLink] & Variant)!=0;
+	}
+
+	// Evaluate replication condition.
+	FFrame EvalStack( Actor, It->GetOwnerClass(), It->RepOffset, NULL );
+	BYTE Buffer[MAX_CONST_SIZE], *Val=Buffer;
+	EvalStack.Step( Actor, Val );
+	UBOOL Result = *(DWORD*)Val!=0;
+	if( Shadow )
+	{
+		Shadow->ConditionKnown[iLink] |= Variant;
+		if( Result )
+			Shadow->ConditionTrue[iLink] |= Variant;
+		else
+			Shadow->ConditionTrue[iLink] &= ~Variant;
+	}
+	return Result;
+	unguard;
+}
+
 //
 // Replicate this channel's actor differences.
 //
@@ -964,6 +1264,7 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 		Recent   = (BYTE*)appMalloc( Size, "FActorChannelRecent" );
 		appMemcpy( Recent, &Actor->GetClass()->Defaults(0), Size );
 		Actor->bNetInitial = 1;
+		CheckedFrame       = 0;
 	}
 
 	// Create an outgoing bunch, and skip this actor if the channel is saturated.
@@ -1022,10 +1323,23 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 		Actor->RemoteRole=ROLE_SimulatedProxy;
 	Actor->bSimulatedPawn = Actor->IsA(APawn::StaticClass) && (Actor->RemoteRole == ROLE_SimulatedProxy);
 
+	// If the actor has a shadow, find the properties that may differ from
+	// Recent unless they have already been found this tick.
+	FMemMark Mark(GMem);
+	FActorShadows* Shadows   = Level->ActorShadows;
+	FActorShadow*  Shadow    = Shadows ? Shadows->Find( Actor ) : NULL;
+	UBOOL          OwnChanged = Shadow && !Changed;
+	if( OwnChanged )
+	{
+		Changed = new(GMem,(Shadow->NumBits+31)/32)DWORD;
+		FindChangedProperties();
+	}
+
 	// Replicate all applicable properties.
+	INT Bit = 0, iLink = 0;
 	for( UClass* RepClass=Actor->GetClass(); RepClass; RepClass=RepClass->GetSuperClass() )
 	{
-		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next )
+		for( FRepLink* Link=RepClass->Reps; Link; Link=Link->Next, iLink++ )
 		{
 			FRepLink*  Condition = Link->Condition;
 			UProperty* It        = Link->Property;
@@ -1039,7 +1353,7 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 				{
 					UBOOL RandomForce=0;
 					if
-					(	!It->Matches(Actor,Recent,Index)
+					(	!PropertyMatches(this,It,Index,Bit+Index)
 					||	(It->PropertyFlags & CPF_NetAlways)
 					||	(RandomForce=(appFrand()<1.0/1000.0))!=0 )
 					{
@@ -1048,12 +1362,9 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 						||	Condition->LastStamp!=Actor->OtherTag )
 						{
 							// Evaluate replication condition.
-							FFrame EvalStack( Actor, It->GetOwnerClass(), It->RepOffset, NULL );
-							BYTE Buffer[MAX_CONST_SIZE], *Val=Buffer;
-							EvalStack.Step( Actor, Val );
 							Condition->LastObject = Actor;
 							Condition->LastStamp  = Actor->OtherTag;
-							Condition->LastResult = *(DWORD*)Val!=0;
+							Condition->LastResult = EvalRepCondition( Actor, It, Shadow, iLink, Shadows ? Shadows->Frame : 0 );
 						}
 						if( Condition->LastResult )
 						{
@@ -1064,23 +1375,48 @@ void FActorChannel::ReplicateActor( UBOOL FullReplication )
 							if( Bunch.SendProperty( It, Index, (BYTE*)Actor, Recent, 1 ) )
 								goto FilledUp;
 							Actor->XLevel->NumReps++;
+							if( GNetBenchmark.Recording )
+								GNetBenchmark.NoteProperty( It, Index, (BYTE*)Actor );
+
+							// Recent is now up to date, unless the value changed
+							// after the shadow was taken.
+							if( Shadow && It->Matches(Actor,Shadow->Values,Index) )
+								Changed[(Bit+Index)>>5] &= ~(1<<((Bit+Index)&31));
 						}
 					}
 				}
 			}
+			Bit += It->ArrayDim;
 		}
 	}
 	FilledUp:
 	check(!Bunch.Overflowed);
 
+	// Remember what still differs from Recent: properties whose condition
+	// was false, and any after the bunch filled up.
+	if( Shadow )
+	{
+		INT Size = ((Shadow->NumBits+31)/32) * sizeof(DWORD);
+		if( !Pending )
+			Pending = (DWORD*)appMalloc( Size, "FActorChannelPending" );
+		appMemcpy( Pending, Changed, Size );
+		CheckedFrame = Shadows->Frame;
+	}
+	if( OwnChanged )
+		Changed = NULL;
+	Mark.Pop();
+
 	// If not overflowed, send and mark as updated.
+	UBOOL Sent = 0;
 	if( !Bunch.Overflowed )
 	{
 		if( Bunch.Header.DataSize )
-			if( SendBunch( Bunch, 1 ) )
+			if( (Sent=SendBunch( Bunch, 1 ))!=0 )
 				LastUpdateTime = Connection->Driver->Time;
 	}
 	else check(!Actor->bNetInitial);
+	if( GNetBenchmark.Recording )
+		GNetBenchmark.NoteUpdate( this, Sent );
 
 	// Reset temporary net info.
 	Actor->bNetOwner  = 0;
@@ -53,6 +53,7 @@ void UNetDriver::InternalClassInitializer( UClass* Class )
 		new(Class,"MaxClientByteLimit",   RF_Public)UIntProperty  (CPP_PROPERTY(MaxClientByteLimit   ), "Client", CPF_Config );
 		new(Class,"MaxTicksPerSecond",    RF_Public)UIntProperty  (CPP_PROPERTY(MaxTicksPerSecond    ), "Client", CPF_Config );
 		new(Class,"DuplicateClientMoves", RF_Public)UBoolProperty (CPP_PROPERTY(DuplicateClientMoves ), "Client", CPF_Config );
+		new(Class,"ParallelReplication",  RF_Public)UBoolProperty (CPP_PROPERTY(ParallelReplication  ), "Client", CPF_Config );
 	}
 	unguard;
 }
@@ -106,7 +107,7 @@ UPendingLevel::UPendingLevel( UEngine* InEngine, const FURL& InURL )
 	if( NetDriver->Init( 1, this, URL, Error256) )
 	{
 		// Send initial message.
-		NetDriver->ServerConnection->Logf( "HELLO REVISION=1", NET_REVISION );
+		NetDriver->ServerConnection->Logf( "HELLO REVISION=%i PROTOCOL=%i", NET_REVISION, UNetConnection::MAX_PROTOCOL_VERSION );
 		NetDriver->ServerConnection->FlushNet();
 	}
 	else
@@ -175,8 +176,12 @@ void UPendingLevel::NotifyReceivedText( UNetConnection* Connection, const char*
 	}
 	else if( ParseCommand( &Text, "CHALLENGE" ) )
 	{
-		// Challenged by server.
+		// Challenged by server. Servers that don't say which protocol to
+		// use only know the first.
+		INT Protocol=UNetConnection::MIN_PROTOCOL_VERSION;
 		Parse( Text,"CHALLENGE=", Connection->Challenge );
+		Parse( Text,"PROTOCOL=", Protocol );
+		Connection->ProtocolVersion = Clamp<INT>( Protocol, UNetConnection::MIN_PROTOCOL_VERSION, UNetConnection::MAX_PROTOCOL_VERSION );
 		FString Str;
 		URL.String( Str );
 		NetDriver->ServerConnection->Logf( "LOGIN RESPONSE=%i URL=%s", Engine->ChallengeResponse(Connection->Challenge), *Str );
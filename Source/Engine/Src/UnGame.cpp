@@ -806,6 +806,18 @@ ULevel* UGameEngine::LoadMap( const FURL& URL, UPendingLevel* Pending, char* Err
 		GLevel->Element(i) = Actors(i);
 	unguard;
 
+	// Start building route tables for the level's pawns.
+	guard(PrepareRouteTables);
+	if( GLevel->IsServer() )
+		GLevel->PrepareRouteTables();
+	unguard;
+
+	// Start building the relevancy visibility if we're serving clients.
+	guard(PrepareRelevancy);
+	if( GLevel->NetDriver && !GLevel->NetDriver->ServerConnection )
+		GLevel->PrepareRelevancy();
+	unguard;
+
 	// Cleanup profiling.
 #if DO_SLOW_GUARD
 	guard(CleanupProfiling);
@@ -843,6 +855,10 @@ ULevel* UGameEngine::LoadMap( const FURL& URL, UPendingLevel* Pending, char* Err
 	LastURL = URL;
 	unguard;
 
+	// Report the load benchmark started by -LOADBENCH.
+	if( appStricmp( *URL.Map, "Entry" )!=0 )
+		GLoadBenchmark.NoteMapLoaded( GSystem );
+
 	// Successfully started local level.
 	return GLevel;
 	unguard;
@@ -1150,6 +1150,7 @@ FCheckResult* ULevel::MultiPointCheck( FMemStack& Mem, FVector Location, FVector
 {
 	guard(ULevel::MultiPointCheck);
 	FCheckResult* Result=NULL;
+	uclock(CollisionCycles);
 
 	// Check with actors.
 	if( bActors && Hash )
@@ -1167,6 +1168,7 @@ FCheckResult* ULevel::MultiPointCheck( FMemStack& Mem, FVector Location, FVector
 			Result->Actor     = Level;
 		}
 	}
+	uunclock(CollisionCycles);
 	return Result;
 	unguard;
 }
@@ -1277,6 +1279,7 @@ FCheckResult* ULevel::MultiLineCheck
 	guard(ULevel::MultiLineCheck);
 	INT NumHits=0;
 	FCheckResult Hits[64];
+	uclock(CollisionCycles);
 
 	// Check for collision with the level, and cull by the end point for speed.
 	FLOAT Dilation = 1.0;
@@ -1335,6 +1338,7 @@ FCheckResult* ULevel::MultiLineCheck
 			Result[i].Next = (i+1<NumHits) ? &Result[i+1] : NULL;
 		}
 	}
+	uunclock(CollisionCycles);
 	return Result;
 	unguard;
 }
@@ -406,39 +406,26 @@ void ULevel::TickNetClient( FLOAT DeltaSeconds )
 	Network server ticking individual client.
 -----------------------------------------------------------------------------*/
 
-INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
+//
+// Update a connection's actor channels given the actors that are relevant
+// to it now, which are tagged with the level's NetTag. Closes channels whose
+// relevance has timed out, and adds the actors of the others to Relevant.
+// If RepCounts is given, open channels also get a Changed buffer for
+// FindChangedProperties.
+//
+static INT UpdateActorChannels( ULevel* Level, UNetConnection* Connection, AActor** Relevant, INT NumRelevant, INT MaxRelevant, TMap<UClass*,INT>* RepCounts )
 {
-	guard(ULevel::ServerTickClient);
-	check(Connection->State==USOCK_Pending || Connection->State==USOCK_Open || Connection->State==USOCK_Closed);
-	INT Updated=0;
-
-	// Handle closed channel.
-	if( Connection->State==USOCK_Closed )
-	{
-		debugf( NAME_DevNet, "Destroying %s because connection closed", Connection->GetName() );
-		delete Connection;
-		return 0;
-	}
-
-	// Handle not ready channel.
-	if
-	(	!Connection->Actor
-	||	!Connection->IsNetReady()
-	||	Connection->State!=USOCK_Open )
-		return 0;
-
-	// Get list of visible/relevant actors.
-	AActor* Relevant[256];
-	INT NumRelevant = GetRelevantActors( Connection->Actor, Relevant, ARRAY_COUNT(Relevant) );
+	guard(UpdateActorChannels);
 
 	// If an actor's relevence has timed out, delete its channel; otherwise
 	// treat it as relevant for now.
+	UNetDriver* NetDriver = Level->NetDriver;
 	for( FTypedChannelIterator<FActorChannel> It(Connection); It; ++It )
 	{
 		AActor* Actor=It->Actor;
 		if( It->State==UCHAN_Open && Actor )
 		{
-			if( Actor->NetTag==NetTag )
+			if( Actor->NetTag==Level->NetTag )
 			{
 				// This actor is relevant, so update the channel.
 				It->RelevantTime = NetDriver->Time;
@@ -449,7 +436,7 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 			:	(NetDriver->Time-It->RelevantTime<NetDriver->DumbProxyTimeout) )
 			{
 				// This actor's relevence hasn't timed out yet.
-				if( NumRelevant<ARRAY_COUNT(Relevant) )
+				if( NumRelevant<MaxRelevant )
 					Relevant[NumRelevant++] = Actor;
 			}
 			else
@@ -459,25 +446,47 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 				check(Actor!=Connection->Actor);
 				debugfSlow( NAME_DevNetTraffic, "Irrelevant %s", Actor->GetFullName() );
 				It->Close();
+				continue;
+			}
+			if( RepCounts && It->Recent )
+			{
+				// Make room to record which properties have changed.
+				INT* Count = RepCounts->Find( Actor->GetClass() );
+				if( !Count )
+					Count = RepCounts->Add( Actor->GetClass(), FActorChannel::CountRepProperties(Actor->GetClass()) );
+				It->Changed = new(GMem,(*Count+31)/32)DWORD;
 			}
 		}
 	}
+	return NumRelevant;
+	unguard;
+}
 
-	// Make priority-sorted list.
-	FMemMark Mark(GMem);
-	FActorPriority* PriorityActors = new(GMem,NumRelevant)FActorPriority;
-	INT j;
-	for( j=0; j<NumRelevant; j++ )
+//
+// Make a priority-sorted list of relevant actors.
+//
+static void PrioritizeActors( UNetConnection* Connection, AActor** Relevant, INT NumRelevant, FActorPriority* PriorityActors )
+{
+	guard(PrioritizeActors);
+	for( INT j=0; j<NumRelevant; j++ )
 		PriorityActors[j] = FActorPriority( Connection, Relevant[j] );
 	appSort( PriorityActors, NumRelevant );
+	unguard;
+}
 
-	// Update all relevant actors in sorted order.
-	for( j=0; j<NumRelevant && Connection->IsNetReady(); j++ )
+//
+// Replicate actors to a connection in priority order until it's saturated.
+//
+static INT ReplicateActors( ULevel* Level, UNetConnection* Connection, FActorPriority* PriorityActors, INT NumRelevant )
+{
+	guard(ReplicateActors);
+	INT Updated=0;
+	for( INT j=0; j<NumRelevant && Connection->IsNetReady(); j++ )
 	{
 		// Find or create the channel for this actor.
 		//debugf("%i...%f...%f",j,PriorityActors[j].Priority,PriorityActors[j].Channel ? PriorityActors[j].Channel->LastUpdateTime:0);
 		FActorChannel* Channel = PriorityActors[j].Channel;
-		if( !Channel && NetDriver->Map.ObjectToIndex(PriorityActors[j].Actor->GetClass())!=INDEX_NONE )
+		if( !Channel && Level->NetDriver->Map.ObjectToIndex(PriorityActors[j].Actor->GetClass())!=INDEX_NONE )
 		{
 			// Create a new channel for this actor.
 			Channel = (FActorChannel *)Connection->CreateChannel( CHTYPE_Actor, 1 );
@@ -497,12 +506,193 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 			}
 		}
 	}
+	return Updated;
+	unguard;
+}
+
+INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
+{
+	guard(ULevel::ServerTickClient);
+	check(Connection->State==USOCK_Pending || Connection->State==USOCK_Open || Connection->State==USOCK_Closed);
+
+	// Handle closed channel.
+	if( Connection->State==USOCK_Closed )
+	{
+		debugf( NAME_DevNet, "Destroying %s because connection closed", Connection->GetName() );
+		delete Connection;
+		return 0;
+	}
+
+	// Handle not ready channel.
+	if
+	(	!Connection->Actor
+	||	!Connection->IsNetReady()
+	||	Connection->State!=USOCK_Open )
+		return 0;
+
+	// Get list of visible/relevant actors. Each actor can only be added
+	// once, either here or by UpdateActorChannels, so the list never needs
+	// more than Num().
+	FMemMark Mark(GMem);
+	INT MaxRelevant = Num();
+	AActor** Relevant = new(GMem,MaxRelevant)AActor*;
+	INT NumRelevant = GetRelevantActors( Connection->Actor, Relevant, MaxRelevant );
+	NumRelevant = UpdateActorChannels( this, Connection, Relevant, NumRelevant, MaxRelevant, NULL );
+
+	// Make priority-sorted list.
+	FActorPriority* PriorityActors = new(GMem,NumRelevant)FActorPriority;
+	PrioritizeActors( Connection, Relevant, NumRelevant, PriorityActors );
+
+	// Update all relevant actors in sorted order.
+	INT Updated = ReplicateActors( this, Connection, PriorityActors, NumRelevant );
 	Mark.Pop();
 
 	return Updated;
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Network server ticking clients in parallel.
+-----------------------------------------------------------------------------*/
+
+//
+// Replication work for one connection.
+//
+struct FNetReplicationJob
+{
+	UNetConnection*	Connection;
+	FNetViewer		View;
+	AActor**		Relevant;
+	INT				NumRelevant;
+	FActorPriority*	PriorityActors;
+};
+
+//
+// Replication work for all connections.
+//
+struct FNetReplicationJobs
+{
+	ULevel*				Level;
+	FNetReplicationJob*	Jobs;
+	INT					MaxRelevant;
+};
+
+//
+// Find the actors relevant to a range of connections.
+//
+static void CollectRelevantActorsJob( void* Arg, INT Start, INT End )
+{
+	guard(CollectRelevantActorsJob);
+	FNetReplicationJobs* Jobs = (FNetReplicationJobs*)Arg;
+	for( INT i=Start; i<End; i++ )
+	{
+		FNetReplicationJob& Job = Jobs->Jobs[i];
+		Job.NumRelevant = Jobs->Level->CollectRelevantActors( Job.View, Job.Relevant, Jobs->MaxRelevant );
+	}
+	unguard;
+}
+
+//
+// Prioritize the actors of a range of connections and find what has changed
+// since each of their channels last replicated.
+//
+static void PrioritizeActorsJob( void* Arg, INT Start, INT End )
+{
+	guard(PrioritizeActorsJob);
+	FNetReplicationJobs* Jobs = (FNetReplicationJobs*)Arg;
+	for( INT i=Start; i<End; i++ )
+	{
+		FNetReplicationJob& Job = Jobs->Jobs[i];
+		PrioritizeActors( Job.Connection, Job.Relevant, Job.NumRelevant, Job.PriorityActors );
+		for( INT j=0; j<Job.NumRelevant; j++ )
+			if( Job.PriorityActors[j].Channel && Job.PriorityActors[j].Channel->Changed )
+				Job.PriorityActors[j].Channel->FindChangedProperties();
+	}
+	unguard;
+}
+
+//
+// Tick all clients, doing the parts of replication that only read actors
+// for all connections at once on the job system: relevancy, prioritizing
+// and comparing properties. Script calls, channel changes and sending stay
+// on the game thread, in connection order, so the result is the same as
+// calling ServerTickClient for each connection. Relevancy uses its own
+// random numbers, seeded per connection and net frame, rather than appFrand.
+//
+INT ULevel::ServerTickClientsParallel( FLOAT DeltaSeconds )
+{
+	guard(ULevel::ServerTickClientsParallel);
+
+	// Destroy closed connections.
+	for( INT i=NetDriver->Connections.Num()-1; i>=0; i-- )
+		if( NetDriver->Connections(i)->State==USOCK_Closed )
+			ServerTickClient( NetDriver->Connections(i), DeltaSeconds );
+
+	// Find where each ready connection is viewing from, which calls script.
+	uclock(NetPrepCycles);
+	FMemMark Mark(GMem);
+	FNetReplicationJobs Jobs;
+	Jobs.Level       = this;
+	Jobs.Jobs        = new(GMem,NetDriver->Connections.Num())FNetReplicationJob;
+	Jobs.MaxRelevant = Num();
+	INT NumJobs      = 0;
+	for( INT i=0; i<NetDriver->Connections.Num(); i++ )
+	{
+		UNetConnection* Connection = NetDriver->Connections(i);
+		check(Connection->State==USOCK_Pending || Connection->State==USOCK_Open);
+		if( Connection->Actor && Connection->IsNetReady() && Connection->State==USOCK_Open )
+		{
+			FNetReplicationJob& Job = Jobs.Jobs[NumJobs++];
+			Job.Connection = Connection;
+			Job.Relevant   = new(GMem,Jobs.MaxRelevant)AActor*;
+			GetNetViewer( Connection->Actor, Job.View );
+		}
+	}
+	PrepareRelevancy();
+	uunclock(NetPrepCycles);
+
+	// Find relevant actors.
+	uclock(GetRelevantCycles);
+	GJobs.ParallelFor( NumJobs, 1, CollectRelevantActorsJob, &Jobs );
+	uunclock(GetRelevantCycles);
+
+	// Update channels.
+	uclock(NetPrepCycles);
+	TMap<UClass*,INT> RepCounts;
+	for( INT i=0; i<NumJobs; i++ )
+	{
+		FNetReplicationJob& Job = Jobs.Jobs[i];
+		NetTag++;
+		for( INT j=0; j<Job.NumRelevant; j++ )
+			Job.Relevant[j]->NetTag = NetTag;
+		NumPV += Job.NumRelevant;
+		Job.NumRelevant    = UpdateActorChannels( this, Job.Connection, Job.Relevant, Job.NumRelevant, Jobs.MaxRelevant, &RepCounts );
+		Job.PriorityActors = new(GMem,Job.NumRelevant)FActorPriority;
+	}
+	uunclock(NetPrepCycles);
+
+	// Prioritize and compare properties.
+	uclock(NetDiffCycles);
+	GJobs.ParallelFor( NumJobs, 1, PrioritizeActorsJob, &Jobs );
+	uunclock(NetDiffCycles);
+
+	// Send.
+	uclock(NetSendCycles);
+	INT Updated=0;
+	for( INT i=0; i<NumJobs; i++ )
+		Updated += ReplicateActors( this, Jobs.Jobs[i].Connection, Jobs.Jobs[i].PriorityActors, Jobs.Jobs[i].NumRelevant );
+	uunclock(NetSendCycles);
+
+	// Forget the changes, which are on GMem.
+	for( INT i=0; i<NumJobs; i++ )
+		for( FTypedChannelIterator<FActorChannel> It(Jobs.Jobs[i].Connection); It; ++It )
+			It->Changed = NULL;
+
+	Mark.Pop();
+	return Updated;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	Network server tick.
 -----------------------------------------------------------------------------*/
@@ -511,13 +701,25 @@ void ULevel::TickNetServer( FLOAT DeltaSeconds )
 {
 	guard(ULevel::TickNetServer);
 
-	// Update all clients.
+	// Find what has changed since the last tick, once for all clients.
 	uclock(NetTickCycles);
+	uclock(NetDiffCycles);
+	if( !ActorShadows )
+		ActorShadows = new FActorShadows( this );
+	ActorShadows->Update();
+	uunclock(NetDiffCycles);
+
+	// Update all clients.
 	INT Updated=0;
 	INT i;
-	for( i=0; i<NetDriver->Connections.Num(); i++ )
+	NetFrame++;
+	UBOOL Parallel = NetDriver->ParallelReplication && GJobs.GetNumThreads()>1;
+	if( Parallel )
+		Updated = ServerTickClientsParallel( DeltaSeconds );
+	else for( i=0; i<NetDriver->Connections.Num(); i++ )
 		Updated += ServerTickClient( NetDriver->Connections(i), DeltaSeconds );
 	uunclock(NetTickCycles);
+	GNetBenchmark.Tick( this );
 
 	// Stats.
 	if( Updated ) for( i=0; i<NetDriver->Connections.Num(); i++ )
@@ -545,6 +747,15 @@ void ULevel::TickNetServer( FLOAT DeltaSeconds )
 				NumPV/NetDriver->Connections.Num(),
 				NumReps/NetDriver->Connections.Num()
 			);
+			if( Parallel ) appSprintf
+			(
+				Stats + appStrlen(Stats),
+				" thr=%i prep=%03.1f diff=%03.1f send=%03.1f",
+				GJobs.GetNumThreads(),
+				GSecondsPerCycle*1000 * NetPrepCycles,
+				GSecondsPerCycle*1000 * NetDiffCycles,
+				GSecondsPerCycle*1000 * NetSendCycles
+			);
 			Connection->Actor->eventClientMessage(Stats);
 		}
 	}
@@ -639,6 +850,10 @@ void ULevel::Tick( ELevelTick TickType, FLOAT DeltaSeconds )
 	if( NetDriver && !NetDriver->ServerConnection )
 		TickNetServer( DeltaSeconds );
 
+	// Send the packets the driver held back during the tick.
+	if( NetDriver )
+		NetDriver->TickFlush();
+
 	// Finish up.
 	Ticked = !Ticked;
 	InTick = 0;
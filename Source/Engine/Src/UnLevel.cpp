@@ -215,6 +215,27 @@ void ULevel::Destroy()
 		BrushTracker = NULL; /* Required because brushes may clean themselves up */
 	}
 
+	// Free the relevancy visibility.
+	if( RelevancyPVS )
+	{
+		delete RelevancyPVS;
+		RelevancyPVS = NULL;
+	}
+
+	// Free the replication shadows.
+	if( ActorShadows )
+	{
+		delete ActorShadows;
+		ActorShadows = NULL;
+	}
+
+	// Free the navigation graph.
+	if( NavGraph )
+	{
+		delete NavGraph;
+		NavGraph = NULL;
+	}
+
 	ULevelBase::Destroy();
 	unguard;
 }
@@ -337,6 +358,33 @@ UBOOL ULevel::Exec( const char* Cmd, FOutputDevice* Out )
 	guard(ULevel::Exec);
 	const char* Str = Cmd;
 	if( NetDriver && NetDriver->Exec( Cmd, Out ) ) return 1;
+	else if( ParseCommand(&Str,"COLLISIONBENCH") )
+	{
+		INT NumActors=2000, NumFrames=100;
+		Parse( Str, "ACTORS=", NumActors );
+		Parse( Str, "FRAMES=", NumFrames );
+		GCollisionBenchmark( this, NumActors, NumFrames, Out );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"TRACEBENCH") )
+	{
+		INT NumRays=100000;
+		Parse( Str, "RAYS=", NumRays );
+		GTraceBenchmark( this, NumRays, Out );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"NETBENCH") )
+	{
+		INT NumFrames=300;
+		Parse( Str, "FRAMES=", NumFrames );
+		GNetBenchmark.Start( this, NumFrames, Out );
+		return 1;
+	}
+	else if( ParseCommand(&Str,"ROUTETABLES") )
+	{
+		GetNavGraph()->DumpRouteTables( Out );
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
@@ -566,7 +614,13 @@ void ULevel::NotifyReceivedText( UNetConnection* Connection, const char* Text )
 			// Get byte limit.
 			Connection->ByteLimit = NetDriver->DefaultByteLimit;
 			Connection->Challenge = appCycles();
-			Connection->Logf( "CHALLENGE CHALLENGE=%i", Connection->Challenge );
+
+			// Use the newest protocol both sides support. Clients that
+			// don't say which they support only know the first.
+			INT Protocol=UNetConnection::MIN_PROTOCOL_VERSION;
+			Parse( Text, "PROTOCOL=", Protocol );
+			Connection->ProtocolVersion = Clamp<INT>( Protocol, UNetConnection::MIN_PROTOCOL_VERSION, UNetConnection::MAX_PROTOCOL_VERSION );
+			Connection->Logf( "CHALLENGE CHALLENGE=%i PROTOCOL=%i", Connection->Challenge, Connection->ProtocolVersion );
 			Connection->FlushNet();
 		}
 		else if( ParseCommand(&Text,"LOGIN") )
@@ -684,7 +738,8 @@ void ULevel::InitStats()
 	guard(ULevel::InitStats);
 	NetTickCycles = ActorTickCycles = AudioTickCycles = FindPathCycles
 	= MoveCycles = NumMoves = NumReps = NumPV = GetRelevantCycles = NumRPC = SeePlayer
-	= Spawning = Unused = 0;
+	= Spawning = CollisionCycles = Unused = 0;
+	NetPrepCycles = NetDiffCycles = NetSendCycles = 0;
 	GScriptEntryTag = GScriptCycles = 0;
 	unguard;
 }
@@ -694,7 +749,7 @@ void ULevel::GetStats( char* Result )
 	appSprintf
 	(
 		Result,
-		"Script=%05.1f Actor=%04.1f Path=%04.1f See=%04.1f Spawn=%04.1f Audio=%04.1f Un=%04.1f Move=%04.1f (%i) Net=%04.1f",
+		"Script=%05.1f Actor=%04.1f Path=%04.1f See=%04.1f Spawn=%04.1f Audio=%04.1f Un=%04.1f Move=%04.1f (%i) Coll=%04.1f Net=%04.1f",
 		GSecondsPerCycle*1000 * GScriptCycles,
 		GSecondsPerCycle*1000 * ActorTickCycles,
 		GSecondsPerCycle*1000 * FindPathCycles,
@@ -704,6 +759,7 @@ void ULevel::GetStats( char* Result )
 		GSecondsPerCycle*1000 * Unused,
 		GSecondsPerCycle*1000 * MoveCycles,
 		NumMoves,
+		GSecondsPerCycle*1000 * CollisionCycles,
 		GSecondsPerCycle*1000 * NetTickCycles
 	);
 	unguard;
@@ -713,6 +769,28 @@ void ULevel::GetStats( char* Result )
 	Actors relevant to a viewer.
 -----------------------------------------------------------------------------*/
 
+//
+// Random numbers for relevancy. Relevancy runs on job workers, so it can't
+// use appFrand, and this only depends on the view's seed and the actor, so
+// serial and parallel replication pick the same points.
+//
+struct FRelevancyRand
+{
+	DWORD Seed;
+	FRelevancyRand( DWORD ViewSeed, DWORD iActor )
+	:	Seed( ViewSeed ^ (iActor * 0x9E3779B9U) )
+	{
+		Seed ^= Seed >> 16;
+		Seed *= 0x7FEB352DU;
+		Seed ^= Seed >> 15;
+	}
+	FLOAT Frand()
+	{
+		Seed = Seed * 1664525U + 1013904223U;
+		return (Seed >> 8) * (1.f / 16777216.f);
+	}
+};
+
 //
 // Check visibility.
 //
@@ -721,14 +799,15 @@ static UBOOL CanSee
 	AActor*		Viewer,
 	FVector		Location,
 	AActor*		Target,
-	FVector		Ahead
+	FVector		Ahead,
+	DWORD		Seed
 )
 {
 	guardSlow(CanSee);
 	if( Target->IsOwnedBy( Viewer ) )
 		return 1;
 	if( Target->Owner && Target->Owner->IsA(APawn::StaticClass) && ((APawn*)Target->Owner)->Weapon==Target )
-		return CanSee( Viewer, Location, Target->Owner, Ahead );
+		return CanSee( Viewer, Location, Target->Owner, Ahead, Seed );
 	if( Target->IsA(AZoneInfo::StaticClass) )
 		return 1;
 	if( Target->bHidden && !Target->bBlockPlayers && !Target->AmbientSound )
@@ -752,11 +831,12 @@ static UBOOL CanSee
 	{
 		// Near, so trace from current location to box vertices.
 		FBox Box = Target->GetPrimitive()->GetRenderBoundingBox( Target, 0 );
+		FRelevancyRand Rand( Seed, Target->GetIndex() );
 		FVector V
 		(
-			Box.Min.X + appFrand()*(Box.Max.X-Box.Min.X),
-			Box.Min.Y + appFrand()*(Box.Max.Y-Box.Min.Y),
-			Box.Min.Z + appFrand()*(Box.Max.Z-Box.Min.Z)
+			Box.Min.X + Rand.Frand()*(Box.Max.X-Box.Min.X),
+			Box.Min.Y + Rand.Frand()*(Box.Max.Y-Box.Min.Y),
+			Box.Min.Z + Rand.Frand()*(Box.Max.Z-Box.Min.Z)
 		);
 		if( Viewer->XLevel->Model->LineCheck(Hit,NULL,V,Location,FVector(0,0,0),NF_NotVisBlocking) )
 			return 1;
@@ -767,15 +847,22 @@ static UBOOL CanSee
 }
 
 //
-// Get a list of actors that are relevant to a given network player pawn.
-// These actors are replicated over the net.
+// Check whether an actor is relevant to a viewer.
 //
-INT ULevel::GetRelevantActors( APlayerPawn* InViewer, AActor** List, INT Max )
+static inline UBOOL IsRelevant( const FNetViewer& View, AActor* Actor )
 {
-	guard(ULevel::GetRelevantActors);
-	uclock(GetRelevantCycles);
-	debug(Max>0);
-	NetTag++;
+	return
+	(	Actor->RemoteRole!=ROLE_None
+	&&	!Actor->bDeleteMe
+	&&	(Actor==View.InViewer || CanSee(View.Viewer,View.Location,Actor,View.Ahead,View.Seed)) );
+}
+
+//
+// Find where a network player pawn is viewing from. This calls script.
+//
+void ULevel::GetNetViewer( APlayerPawn* InViewer, FNetViewer& View )
+{
+	guard(ULevel::GetNetViewer);
 
 	// Get viewer coordinates.
 	FVector  Location  = InViewer->Location;
@@ -802,21 +889,100 @@ INT ULevel::GetRelevantActors( APlayerPawn* InViewer, AActor** List, INT Max )
 	Hit.Location = Location + Ahead;
 	Viewer->XLevel->Model->LineCheck(Hit,NULL,Hit.Location,Location,FVector(0,0,0),NF_NotVisBlocking);
 
-	// Slow version which doesn't use any precomputed visibility.
+	View.InViewer = InViewer;
+	View.Viewer   = Viewer;
+	View.Location = Location;
+	View.Ahead    = Hit.Location;
+
+	// Seed the relevancy checks from the connection and the net frame.
+	DWORD iConnection = InViewer->Player ? InViewer->Player->GetIndex() : InViewer->GetIndex();
+	View.Seed = (iConnection * 0x85EBCA6BU) ^ ((DWORD)NetFrame * 0xC2B2AE35U);
+	unguard;
+}
+
+//
+// Get the level's relevancy visibility ready for this tick. Must be called
+// before CollectRelevantActors.
+//
+void ULevel::PrepareRelevancy()
+{
+	guard(ULevel::PrepareRelevancy);
+	if( !RelevancyPVS )
+		RelevancyPVS = new FRelevancyPVS( this );
+	RelevancyPVS->Update();
+	if( RelevancyPVS->NumClusters )
+		RelevancyPVS->UpdateActorLists();
+	unguard;
+}
+
+//
+// Get a list of actors that are relevant from a view. Only reads the level,
+// so it may be called for several views at once from any thread. Each actor
+// is listed at most once.
+//
+INT ULevel::CollectRelevantActors( const FNetViewer& View, AActor** List, INT Max )
+{
+	guard(ULevel::CollectRelevantActors);
+	debug(Max>0);
+
+	// Find the clusters potentially visible from here or from ahead.
+	FRelevancyPVS* PVS = RelevancyPVS;
+	INT iHere  = PVS->NumClusters ? PVS->GetCluster( Model->PointRegion( GetLevelInfo(), View.Location ).iLeaf ) : INDEX_NONE;
+	INT iAhead = PVS->NumClusters ? PVS->GetCluster( Model->PointRegion( GetLevelInfo(), View.Ahead    ).iLeaf ) : INDEX_NONE;
+
 	INT Count=0;
-	for( INT i=iFirstDynamicActor; i<Num(); i++ )
+	if( iHere!=INDEX_NONE || iAhead!=INDEX_NONE )
 	{
-		if
-		(	Actors(i)
-		&&	Actors(i)->RemoteRole!=ROLE_None
-		&&	(Actors(i)==InViewer || CanSee(Viewer,Location,Actors(i),Hit.Location)) )
-		{
-			Actors(i)->NetTag = NetTag;
-			List[Count++] = Actors(i);
-			if( Count == Max )
-				break;
-		}
+		// Only check the actors in those clusters, and the ones that can't be culled.
+		FMemStack& Mem = GJobs.GetThreadMem();
+		FMemMark Mark(Mem);
+		DWORD* Visible = new(Mem,PVS->RowDwords)DWORD;
+		for( INT k=0; k<PVS->RowDwords; k++ )
+			Visible[k] = (iHere!=INDEX_NONE ? PVS->GetRow(iHere)[k] : 0) | (iAhead!=INDEX_NONE ? PVS->GetRow(iAhead)[k] : 0);
+		for( INT i=0; i<PVS->OtherActors.Num() && Count<Max; i++ )
+			if( IsRelevant( View, PVS->OtherActors(i) ) )
+				List[Count++] = PVS->OtherActors(i);
+		for( INT iCluster=0; iCluster<PVS->NumClusters && Count<Max; iCluster++ )
+			if( Visible[iCluster>>5] & (1<<(iCluster&31)) )
+				for( INT i=PVS->ClusterFirst(iCluster); i<PVS->ClusterFirst(iCluster+1) && Count<Max; i++ )
+					if( IsRelevant( View, PVS->ClusterActors(i) ) )
+						List[Count++] = PVS->ClusterActors(i);
+
+		// The player is always relevant to itself, wherever it is.
+		INT i;
+		for( i=0; i<Count && List[i]!=View.InViewer; i++ );
+		if( i==Count && Count<Max && IsRelevant( View, View.InViewer ) )
+			List[Count++] = View.InViewer;
+		Mark.Pop();
 	}
+	else
+	{
+		// No visibility for this view point, so check every actor.
+		for( INT i=iFirstDynamicActor; i<Num() && Count<Max; i++ )
+			if( Actors(i) && IsRelevant( View, Actors(i) ) )
+				List[Count++] = Actors(i);
+	}
+	return Count;
+	unguard;
+}
+
+//
+// Get a list of actors that are relevant to a given network player pawn.
+// These actors are replicated over the net.
+//
+INT ULevel::GetRelevantActors( APlayerPawn* InViewer, AActor** List, INT Max )
+{
+	guard(ULevel::GetRelevantActors);
+	uclock(GetRelevantCycles);
+	NetTag++;
+
+	FNetViewer View;
+	GetNetViewer( InViewer, View );
+	PrepareRelevancy();
+	INT Count = CollectRelevantActors( View, List, Max );
+	for( INT i=0; i<Count; i++ )
+		List[i]->NetTag = NetTag;
+
 	NumPV += Count;
 	uunclock(GetRelevantCycles);
 	return Count;
@@ -0,0 +1,475 @@
+/*=============================================================================
+	UnPVS.cpp: Potentially visible set for network relevancy.
+
+Design goal:
+	Make ULevel::GetRelevantActors cost proportional to the actors a viewer
+	might see rather than to every actor in the level. Only actors in
+	clusters that the viewer's cluster row allows are traced.
+
+	Maps built without leaf visibility get a sampled set, built by a job
+	in the background when it isn't cached. Clusters are
+	leaves grouped by zone and grid cell, and two clusters see each other
+	if any line between their sample points is clear. Sampling can miss a
+	view through a narrow gap, so the result is widened by one grid cell on
+	both the viewer's and the target's side before it is used. Even so it
+	isn't Conservative, and path searches don't cull with it.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	Definitions.
+-----------------------------------------------------------------------------*/
+
+#define RELEVANCY_PVS_MAGIC		0x53565055 /* "UPVS" */
+#define RELEVANCY_PVS_VERSION	1
+
+enum {MAX_PVS_CLUSTERS=512};		// Most clusters in a sampled set.
+enum {MAX_PVS_LEAF_SAMPLES=32};		// Most sample points kept per leaf.
+enum {MAX_PVS_CLUSTER_SAMPLES=8};	// Most sample points traced per cluster.
+
+//
+// A cluster being built by BuildSampled.
+//
+struct FPVSCluster
+{
+	INT		Zone;
+	INT		X, Y, Z;
+	INT		NumSamples;
+	FVector	Samples[MAX_PVS_CLUSTER_SAMPLES];
+};
+
+/*-----------------------------------------------------------------------------
+	FRelevancyPVS init.
+-----------------------------------------------------------------------------*/
+
+//
+// Build the PVS for a level, or load it from the cache. A sampled set that
+// isn't cached is built in the background, and NumClusters stays 0 until
+// Update finds it done.
+//
+FRelevancyPVS::FRelevancyPVS( ULevel* InLevel )
+:	NumClusters		( 0 )
+,	RowDwords		( 0 )
+,	Conservative	( 0 )
+,	Level			( InLevel )
+,	ListTime		( -1.0 )
+,	ListNum			( 0 )
+,	Building		( 0 )
+,	Key				( 0 )
+,	StartTime		( appSeconds() )
+,	BuiltClusters	( 0 )
+,	BuiltRowDwords	( 0 )
+,	BuiltTraces		( 0 )
+{
+	guard(FRelevancyPVS::FRelevancyPVS);
+	UModel* Model = Level->Model;
+	if( ParseParam(appCmdLine(),"NOPVS") || !Model || !Model->Nodes->Num() || !Model->Leaves.Num() )
+		return;
+
+	if( Model->LeafLeaf && Model->LeafLeaf->Side==(DWORD)Model->Leaves.Num() )
+	{
+		// The map has leaf visibility.
+		BuildFromLeafLeaf();
+	}
+	else
+	{
+		// Use the cached set if it matches this Bsp, otherwise sample a new one.
+		appSprintf( Filename, "%s/%s.pvs", GSys->CachePath, Level->GetParent()->GetName() );
+		Key = GetKey();
+		if( !Load( Filename, Key ) )
+		{
+			Building = 1;
+			GJobs.Dispatch( BuildJob, this, &Counter );
+			return;
+		}
+	}
+	debugf( NAME_Init, "Relevancy PVS: %i leaves, %i clusters, %.2f sec", Model->Leaves.Num(), NumClusters, appSeconds()-StartTime );
+	unguard;
+}
+
+//
+// Destroy a PVS, waiting for it to be built first.
+//
+FRelevancyPVS::~FRelevancyPVS()
+{
+	guard(FRelevancyPVS::~FRelevancyPVS);
+	GJobs.Wait( Counter );
+	unguard;
+}
+
+//
+// Start using a sampled set once its build is done, and save it to the
+// cache. Call once per tick before using the set.
+//
+void FRelevancyPVS::Update()
+{
+	guard(FRelevancyPVS::Update);
+	if( Building && Counter.IsDone() )
+	{
+		Building    = 0;
+		NumClusters = BuiltClusters;
+		RowDwords   = BuiltRowDwords;
+		LeafCluster = BuiltLeafCluster;
+		Bits        = BuiltBits;
+		BuiltLeafCluster.Empty();
+		BuiltBits.Empty();
+		Save( Filename, Key );
+		debugf( NAME_Init, "Relevancy PVS: %i leaves, %i clusters, %i traces, %.2f sec", Level->Model->Leaves.Num(), NumClusters, BuiltTraces, appSeconds()-StartTime );
+	}
+	unguard;
+}
+
+//
+// Job entry point.
+//
+void FRelevancyPVS::BuildJob( void* Arg )
+{
+	((FRelevancyPVS*)Arg)->BuildSampled();
+}
+
+//
+// Use the map's leaf-to-leaf visibility, with one cluster per leaf.
+//
+void FRelevancyPVS::BuildFromLeafLeaf()
+{
+	guard(FRelevancyPVS::BuildFromLeafLeaf);
+	UModel*     Model  = Level->Model;
+	UBitMatrix* Matrix = Model->LeafLeaf;
+	NumClusters  = Model->Leaves.Num();
+	RowDwords    = (NumClusters+31)/32;
+	Conservative = 1;
+	LeafCluster.Empty();
+	for( INT i=0; i<NumClusters; i++ )
+		LeafCluster.AddItem( i );
+	Bits.Empty();
+	Bits.AddZeroed( NumClusters * RowDwords );
+	for( INT i=0; i<NumClusters; i++ )
+		for( INT j=0; j<NumClusters; j++ )
+			if( i==j || Matrix->Get(i,j) )
+				Bits(i*RowDwords + (j>>5)) |= 1<<(j&31);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRelevancyPVS sampling.
+-----------------------------------------------------------------------------*/
+
+//
+// Sample the PVS with line traces, into the Built variables. Runs as a job,
+// so it only reads the level.
+//
+void FRelevancyPVS::BuildSampled()
+{
+	guard(FRelevancyPVS::BuildSampled);
+	UModel*    Model     = Level->Model;
+	AZoneInfo* LevelZone = Level->GetLevelInfo();
+	INT        NumLeaves = Model->Leaves.Num();
+
+	// Take points just in front of and behind every Bsp polygon, near its
+	// center and its vertices, and keep the ones that land in a leaf.
+	TArray<FVector> Samples;
+	TArray<INT>     SampleLeaf;
+	TArray<INT>     LeafSamples;
+	LeafSamples.AddZeroed( NumLeaves );
+	for( INT iNode=0; iNode<Model->Nodes->Num(); iNode++ )
+	{
+		const FBspNode& Node = Model->Nodes->Element(iNode);
+		if( Node.NumVertices < 3 )
+			continue;
+		const FVert* Verts = &Model->Verts->Element(Node.iVertPool);
+		FVector Center(0,0,0);
+		for( INT i=0; i<Node.NumVertices; i++ )
+			Center += Model->Points->Element(Verts[i].pVertex);
+		Center /= Node.NumVertices;
+		INT Step = Max( 1, Node.NumVertices/4 );
+		for( INT Side=0; Side<2; Side++ )
+		{
+			FVector Offset = FVector(Node.Plane) * (Side ? 4.0 : -4.0);
+			for( INT i=-Step; i<Node.NumVertices; i+=Step )
+			{
+				FVector Point = (i<0 ? Center : (Center + Model->Points->Element(Verts[i].pVertex)) * 0.5) + Offset;
+				INT     iLeaf = Model->PointRegion( LevelZone, Point ).iLeaf;
+				if( iLeaf>=0 && iLeaf<NumLeaves && LeafSamples(iLeaf)<MAX_PVS_LEAF_SAMPLES )
+				{
+					Samples.AddItem( Point );
+					SampleLeaf.AddItem( iLeaf );
+					LeafSamples(iLeaf)++;
+				}
+			}
+		}
+	}
+
+	// Find the center of each leaf.
+	TArray<FVector> LeafCenter;
+	LeafCenter.AddZeroed( NumLeaves );
+	for( INT i=0; i<Samples.Num(); i++ )
+		LeafCenter(SampleLeaf(i)) += Samples(i);
+	for( INT i=0; i<NumLeaves; i++ )
+		if( LeafSamples(i) )
+			LeafCenter(i) /= LeafSamples(i);
+
+	// Group leaves by zone and grid cell, growing the cells until there
+	// are few enough clusters.
+	TArray<FPVSCluster> Clusters;
+	for( FLOAT CellSize=512.0; ; CellSize*=2.0 )
+	{
+		TMap<DWORD,INT> CellMap;
+		Clusters.Empty();
+		BuiltLeafCluster.Empty();
+		for( INT i=0; i<NumLeaves; i++ )
+		{
+			if( !LeafSamples(i) )
+			{
+				BuiltLeafCluster.AddItem( INDEX_NONE );
+				continue;
+			}
+			INT  Zone = Model->Leaves(i).iZone & 255;
+			INT  X    = appFloor( LeafCenter(i).X / CellSize );
+			INT  Y    = appFloor( LeafCenter(i).Y / CellSize );
+			INT  Z    = appFloor( LeafCenter(i).Z / CellSize );
+			DWORD Key = (Zone<<24) + ((X&255)<<16) + ((Y&255)<<8) + (Z&255);
+			INT* Found = CellMap.Find( Key );
+			if( !Found )
+			{
+				FPVSCluster* Cluster = new(Clusters)FPVSCluster;
+				Cluster->Zone       = Zone;
+				Cluster->X          = X;
+				Cluster->Y          = Y;
+				Cluster->Z          = Z;
+				Cluster->NumSamples = 0;
+				Found = CellMap.Add( Key, Clusters.Num()-1 );
+			}
+			BuiltLeafCluster.AddItem( *Found );
+		}
+		if( Clusters.Num() <= MAX_PVS_CLUSTERS )
+			break;
+	}
+	BuiltClusters = Clusters.Num();
+	BuiltRowDwords = (BuiltClusters+31)/32;
+
+	// Pick evenly spaced samples for each cluster.
+	TArray<INT> ClusterTotal, ClusterSeen;
+	ClusterTotal.AddZeroed( BuiltClusters );
+	ClusterSeen.AddZeroed( BuiltClusters );
+	for( INT i=0; i<Samples.Num(); i++ )
+		ClusterTotal(BuiltLeafCluster(SampleLeaf(i)))++;
+	for( INT i=0; i<Samples.Num(); i++ )
+	{
+		INT          iCluster = BuiltLeafCluster(SampleLeaf(i));
+		FPVSCluster& Cluster  = Clusters(iCluster);
+		INT          Stride   = (ClusterTotal(iCluster) + MAX_PVS_CLUSTER_SAMPLES - 1) / MAX_PVS_CLUSTER_SAMPLES;
+		if( (ClusterSeen(iCluster)++ % Stride)==0 && Cluster.NumSamples<MAX_PVS_CLUSTER_SAMPLES )
+			Cluster.Samples[Cluster.NumSamples++] = Samples(i);
+	}
+
+	// Trace between the samples of every pair of clusters.
+	TArray<DWORD> Seen;
+	Seen.AddZeroed( BuiltClusters * BuiltRowDwords );
+	FCheckResult Hits   [MAX_PVS_CLUSTER_SAMPLES];
+	FVector      Starts [MAX_PVS_CLUSTER_SAMPLES];
+	UBOOL        Results[MAX_PVS_CLUSTER_SAMPLES];
+	INT          NumTraces = 0;
+	UBOOL        HaveZoneVis = Model->Nodes->NumZones>0;
+	for( INT A=0; A<BuiltClusters; A++ )
+	{
+		Seen(A*BuiltRowDwords + (A>>5)) |= 1<<(A&31);
+		for( INT B=A+1; B<BuiltClusters; B++ )
+		{
+			const FPVSCluster& CA = Clusters(A);
+			const FPVSCluster& CB = Clusters(B);
+			if( HaveZoneVis && !(Model->Nodes->Zones[CA.Zone&63].Visibility & (((QWORD)1)<<(CB.Zone&63))) )
+				continue;
+			UBOOL Visible = 0;
+			for( INT i=0; i<CA.NumSamples && !Visible; i++ )
+			{
+				for( INT j=0; j<CB.NumSamples; j++ )
+					Starts[j] = CA.Samples[i];
+				Visible = Model->LineCheckBatch( Hits, Starts, CB.Samples, CB.NumSamples, Results, NULL, FVector(0,0,0), NF_NotVisBlocking ) < CB.NumSamples;
+				NumTraces += CB.NumSamples;
+			}
+			if( Visible )
+			{
+				Seen(A*BuiltRowDwords + (B>>5)) |= 1<<(B&31);
+				Seen(B*BuiltRowDwords + (A>>5)) |= 1<<(A&31);
+			}
+		}
+	}
+
+	// Find the clusters in neighbouring cells, including each cluster itself.
+	TArray<INT> NeighbourFirst, Neighbours;
+	for( INT A=0; A<BuiltClusters; A++ )
+	{
+		NeighbourFirst.AddItem( Neighbours.Num() );
+		for( INT N=0; N<BuiltClusters; N++ )
+			if
+			(	Abs(Clusters(A).X-Clusters(N).X)<=1
+			&&	Abs(Clusters(A).Y-Clusters(N).Y)<=1
+			&&	Abs(Clusters(A).Z-Clusters(N).Z)<=1 )
+				Neighbours.AddItem( N );
+	}
+	NeighbourFirst.AddItem( Neighbours.Num() );
+
+	// Widen the set by the neighbouring cells on the viewer's side, then
+	// on the target's side.
+	TArray<DWORD> Widened;
+	Widened.AddZeroed( BuiltClusters * BuiltRowDwords );
+	for( INT A=0; A<BuiltClusters; A++ )
+		for( INT n=NeighbourFirst(A); n<NeighbourFirst(A+1); n++ )
+			for( INT k=0; k<BuiltRowDwords; k++ )
+				Widened(A*BuiltRowDwords+k) |= Seen(Neighbours(n)*BuiltRowDwords+k);
+	BuiltBits.Empty();
+	BuiltBits.AddZeroed( BuiltClusters * BuiltRowDwords );
+	for( INT A=0; A<BuiltClusters; A++ )
+		for( INT B=0; B<BuiltClusters; B++ )
+			if( Widened(A*BuiltRowDwords + (B>>5)) & (1<<(B&31)) )
+				for( INT n=NeighbourFirst(B); n<NeighbourFirst(B+1); n++ )
+					BuiltBits(A*BuiltRowDwords + (Neighbours(n)>>5)) |= 1<<(Neighbours(n)&31);
+
+	BuiltTraces = NumTraces;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRelevancyPVS cache.
+-----------------------------------------------------------------------------*/
+
+//
+// Identify the Bsp a cached set was built from.
+//
+DWORD FRelevancyPVS::GetKey()
+{
+	guard(FRelevancyPVS::GetKey);
+	UModel* Model = Level->Model;
+	TArray<FPlane> Planes;
+	for( INT i=0; i<Model->Nodes->Num(); i++ )
+		Planes.AddItem( Model->Nodes->Element(i).Plane );
+	return appMemCrc( (BYTE*)&Planes(0), Planes.Num()*sizeof(FPlane) ) ^ Model->Leaves.Num();
+	unguard;
+}
+
+//
+// Load a cached set. Returns 0 if there is none for this Bsp.
+//
+UBOOL FRelevancyPVS::Load( const char* Filename, DWORD Key )
+{
+	guard(FRelevancyPVS::Load);
+	FILE* File = appFopen( Filename, "rb" );
+	if( !File )
+		return 0;
+	DWORD Header[5];
+	UBOOL Ok
+	=	appFread( Header, sizeof(Header), 1, File )==1
+	&&	Header[0]==RELEVANCY_PVS_MAGIC
+	&&	Header[1]==RELEVANCY_PVS_VERSION
+	&&	Header[2]==Key
+	&&	Header[3]==(DWORD)Level->Model->Leaves.Num()
+	&&	Header[4]<=MAX_PVS_CLUSTERS;
+	if( Ok )
+	{
+		NumClusters = Header[4];
+		RowDwords   = (NumClusters+31)/32;
+		LeafCluster.Empty();
+		LeafCluster.Add( Header[3] );
+		Bits.Empty();
+		Bits.Add( NumClusters * RowDwords );
+		Ok
+		=	appFread( &LeafCluster(0), sizeof(INT),   LeafCluster.Num(), File )==LeafCluster.Num()
+		&&	appFread( &Bits(0),        sizeof(DWORD), Bits.Num(),        File )==Bits.Num();
+		for( INT i=0; Ok && i<LeafCluster.Num(); i++ )
+			Ok = LeafCluster(i)>=INDEX_NONE && LeafCluster(i)<NumClusters;
+		if( !Ok )
+		{
+			NumClusters = RowDwords = 0;
+			LeafCluster.Empty();
+			Bits.Empty();
+		}
+	}
+	appFclose( File );
+	return Ok;
+	unguard;
+}
+
+//
+// Save the set to the cache.
+//
+void FRelevancyPVS::Save( const char* Filename, DWORD Key )
+{
+	guard(FRelevancyPVS::Save);
+	if( !NumClusters )
+		return;
+	appMkdir( GSys->CachePath );
+	FILE* File = appFopen( Filename, "wb" );
+	if( !File )
+	{
+		debugf( NAME_Warning, "Can't write relevancy PVS to %s", Filename );
+		return;
+	}
+	DWORD Header[5] = { RELEVANCY_PVS_MAGIC, RELEVANCY_PVS_VERSION, Key, (DWORD)LeafCluster.Num(), (DWORD)NumClusters };
+	appFwrite( Header,          sizeof(Header), 1,                 File );
+	appFwrite( &LeafCluster(0), sizeof(INT),    LeafCluster.Num(), File );
+	appFwrite( &Bits(0),        sizeof(DWORD),  Bits.Num(),        File );
+	appFclose( File );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRelevancyPVS actor lists.
+-----------------------------------------------------------------------------*/
+
+//
+// Sort the level's dynamic actors into clusters, once per tick. Actors whose
+// relevancy doesn't depend on where they are go into OtherActors.
+//
+void FRelevancyPVS::UpdateActorLists()
+{
+	guard(FRelevancyPVS::UpdateActorLists);
+	if( ListTime==Level->TimeSeconds && ListNum==Level->Num() )
+		return;
+	ListTime = Level->TimeSeconds;
+	ListNum  = Level->Num();
+
+	// Count the actors in each cluster.
+	ClusterFirst.Reset();
+	ClusterFirst.AddZeroed( NumClusters+1 );
+	ClusterActors.Reset();
+	OtherActors.Reset();
+	INT Total = 0;
+	for( INT i=Level->iFirstDynamicActor; i<Level->Num(); i++ )
+	{
+		AActor* Actor = Level->Actors(i);
+		if( !Actor )
+			continue;
+		INT iCluster = (Actor->Owner || Actor->Brush || Actor->IsA(AZoneInfo::StaticClass)) ? INDEX_NONE : GetCluster(Actor->Region.iLeaf);
+		if( iCluster==INDEX_NONE )
+			OtherActors.AddItem( Actor );
+		else
+		{
+			ClusterFirst(iCluster+1)++;
+			Total++;
+		}
+	}
+	for( INT i=0; i<NumClusters; i++ )
+		ClusterFirst(i+1) += ClusterFirst(i);
+
+	// Fill them in, advancing each cluster's start to its end, then shift back.
+	ClusterActors.Add( Total );
+	for( INT i=Level->iFirstDynamicActor; i<Level->Num(); i++ )
+	{
+		AActor* Actor = Level->Actors(i);
+		if( Actor && !Actor->Owner && !Actor->Brush && !Actor->IsA(AZoneInfo::StaticClass) )
+		{
+			INT iCluster = GetCluster(Actor->Region.iLeaf);
+			if( iCluster!=INDEX_NONE )
+				ClusterActors(ClusterFirst(iCluster)++) = Actor;
+		}
+	}
+	for( INT i=NumClusters; i>0; i-- )
+		ClusterFirst(i) = ClusterFirst(i-1);
+	ClusterFirst(0) = 0;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
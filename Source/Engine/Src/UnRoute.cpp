@@ -54,8 +54,6 @@ void FSortedPathList::FindVisiblePaths(APawn *Searcher, FVector Dest, FSortedPat
 	//uclock(XLevel->FindPathCycles);
 
 	// find paths visible from this pawn
-	//FIXME - PVS check here
-	
 	if ( Searcher->MoveTarget && Searcher->MoveTarget->IsA(ANavigationPoint::StaticClass) 
 		&& (Abs(Searcher->MoveTarget->Location.Z - Searcher->Location.Z) < Searcher->CollisionHeight) )
 	{
@@ -71,26 +69,53 @@ void FSortedPathList::FindVisiblePaths(APawn *Searcher, FVector Dest, FSortedPat
 		}
 	}
 
-	FCheckResult Hit(1.0);
-	ANavigationPoint *Nav = Searcher->GetLevel()->GetLevelInfo()->NavigationPointList;
-	int dist;
-	while (Nav)
+	ULevel *MyLevel = Searcher->GetLevel();
+	FNavGraph *Graph = MyLevel->GetNavGraph();
+	if (bClearPaths)
+		for ( INT i=0; i<Graph->Nodes.Num(); i++ )
+			Searcher->clearPath(Graph->Nodes(i));
+
+	// find the nearest paths from the level's navigation grid
+	FNavNear Near[MAXSORTED];
+	INT i;
+	if ( !startanchor )
 	{
-		if (bClearPaths)
-			Searcher->clearPath(Nav);
-		if ( !startanchor )
+		// an end point must be visible from the pawn's eyes, so skip paths 
+		// the relevancy PVS says can't be seen, if the level has one from
+		// leaf visibility (a sampled one can miss a narrow view)
+		FMemMark Mark(GMem);
+		FRelevancyPVS *PVS = MyLevel->RelevancyPVS;
+		DWORD *Visible = NULL;
+		if ( PVS && PVS->NumClusters && PVS->Conservative )
 		{
-			dist = (int)(Searcher->Location - Nav->Location).SizeSquared();
-			if ( dist < 640000 )
-				addPath(Nav, dist);
+			FVector	ViewPoint = Searcher->Location;
+			ViewPoint.Z += Searcher->BaseEyeHeight;
+			INT iHere = PVS->GetCluster(Searcher->Region.iLeaf);
+			INT iEyes = PVS->GetCluster(MyLevel->Model->PointRegion(MyLevel->GetLevelInfo(), ViewPoint).iLeaf);
+			if ( (iHere != INDEX_NONE) && (iEyes != INDEX_NONE) )
+			{
+				Visible = new(GMem,PVS->RowDwords)DWORD;
+				for ( INT k=0; k<PVS->RowDwords; k++ )
+					Visible[k] = PVS->GetRow(iHere)[k] | PVS->GetRow(iEyes)[k];
+			}
 		}
-		if ( !endanchor )
+		numPoints = Graph->FindNear(Searcher->Location, 800.0, Near, MAXSORTED, PVS, Visible);
+		for ( i=0; i<numPoints; i++ )
 		{
-			dist = (int)(Dest - Nav->Location).SizeSquared();
-			if ( dist < 640000 )
-				DestPoints->addPath(Nav, dist);
+			Path[i] = Graph->Nodes(Near[i].Node);
+			Dist[i] = (int)Near[i].DistSquared;
+		}
+		Mark.Pop();
+	}
+	if ( !endanchor )
+	{
+		// not culled, as hunters fall back on the nearest path whether it's visible or not
+		DestPoints->numPoints = Graph->FindNear(Dest, 800.0, Near, MAXSORTED);
+		for ( i=0; i<DestPoints->numPoints; i++ )
+		{
+			DestPoints->Path[i] = Graph->Nodes(Near[i].Node);
+			DestPoints->Dist[i] = (int)Near[i].DistSquared;
 		}
-		Nav = Nav->nextNavigationPoint;
 	}
 
 	//uunclock(XLevel->FindPathCycles);
@@ -398,7 +423,7 @@ int APawn::findPathToward(AActor *goal, INT bSinglePath, AActor *&bestPath, INT
 		AActor *newPath = NULL;
 		int moveFlags = calcMoveFlags();
 		((ANavigationPoint *)DestPoints.Path[0])->visitedWeight = DestPoints.Dist[0];
-		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags))
+		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags, (!startanchor && !bSinglePath) ? &EndPoints : NULL))
 		{
 			bestPath = newPath;
 			GetLevel()->FarMoveActor(this, RealLocation, 1, 1);
@@ -563,7 +588,7 @@ int APawn::findPathTo(FVector Dest, INT bSinglePath, AActor *&bestPath, INT bCle
 		AActor *newPath = NULL;
 		int moveFlags = calcMoveFlags(); 
 		((ANavigationPoint *)DestPoints.Path[0])->visitedWeight = DestPoints.Dist[0];
-		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags))
+		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags, (!startanchor && !bSinglePath) ? &EndPoints : NULL))
 		{
 			//uunclock(XLevel->FindPathCycles);
 			//debugf("BFS time was %f", XLevel->FindPathCycles * GSystem->MSecPerCycle);
@@ -688,131 +713,546 @@ int APawn::TraverseFrom(AActor *start, int moveFlags)
 	unguard;
 }
 
-/* breadthPathFrom()
-Breadth First Search through navigation network
-startnode is the starting path
-*/
-int APawn::breadthPathFrom(AActor *start, AActor *&bestPath, int bSinglePath, int moveFlags)
+/*-----------------------------------------------------------------------------
+	FNavGraph implementation.
+-----------------------------------------------------------------------------*/
+
+enum {MAX_NAV_TARGETS=64}; // Most targets the search heuristic looks at.
+
+//
+// Navigation grid cell coordinate of a location component.
+//
+static inline INT NavGridCoord( FLOAT Value )
 {
-	guard(APawn::breadthPathFrom);
-	//FIXME - perhaps track and bound number of edges to search or max depth?
-	ANavigationPoint* currentnode = (ANavigationPoint *)start;
-	ANavigationPoint* nextnode;
-	ANavigationPoint* BinTree = currentnode;
+	return appFloor( Value * (1.0/NAV_GRID_CELL) );
+}
 
-	int iRadius = (int)CollisionRadius;
-	int iHeight = (int)CollisionHeight;
-	int p = 0;
-	int n = 0;
-	int realSplit = 1;
-	FReachSpec *spec;
-	while ( currentnode )
+//
+// Navigation grid hash bucket of a cell.
+//
+static inline INT NavGridBucket( INT X, INT Y, INT Z, INT Mask )
+{
+	return ((DWORD)X*73856093 ^ (DWORD)Y*19349663 ^ (DWORD)Z*83492791) & Mask;
+}
+static inline INT NavGridBucket( const FVector& Location, INT Mask )
+{
+	return NavGridBucket( NavGridCoord(Location.X), NavGridCoord(Location.Y), NavGridCoord(Location.Z), Mask );
+}
+
+//
+// Add a node to a FindNear result, which is kept sorted nearest first and
+// then by the node's order in the NavigationPointList, latest first.
+//
+static inline INT AddNavNear( FNavNear* Out, INT Count, INT MaxOut, INT Node, FLOAT DistSquared )
+{
+	INT n;
+	for( n=Count; n>0 && (Out[n-1].DistSquared>DistSquared || (Out[n-1].DistSquared==DistSquared && Out[n-1].Node<Node)); n-- )
+		if( n<MaxOut )
+			Out[n] = Out[n-1];
+	if( n<MaxOut )
 	{
-		if ( currentnode->bEndPoint )
+		Out[n].Node        = Node;
+		Out[n].DistSquared = DistSquared;
+		if( Count<MaxOut )
+			Count++;
+	}
+	return Count;
+}
+
+//
+// Extract the level's navigation network.
+//
+FNavGraph::FNavGraph( ULevel* InLevel )
+:	MinSpeed		( 1.0 )
+,	UseRouteTables	( ParseParam(appCmdLine(),"ROUTETABLES") )
+,	Level			( InLevel )
+,	FirstNav		( InLevel->GetLevelInfo()->NavigationPointList )
+,	NumSpecs		( InLevel->ReachSpecs.Num() )
+{
+	guard(FNavGraph::FNavGraph);
+	if( !UseRouteTables )
+		GetConfigBool( "Engine.Engine", "RouteTables", UseRouteTables );
+	ANavigationPoint* Nav;
+	for( Nav=FirstNav; Nav; Nav=Nav->nextNavigationPoint )
+	{
+		NodeMap.Add( Nav, Nodes.Num() );
+		Nodes.AddItem( Nav );
+		Positions.AddItem( Nav->Location );
+	}
+	PathEdges.Add( Nodes.Num()*16 );
+	for( INT i=0; i<PathEdges.Num(); i++ )
+		PathEdges(i) = INDEX_NONE;
+	for( INT i=0; i<Nodes.Num(); i++ )
+	{
+		FirstEdge.AddItem( Edges.Num() );
+		for( INT j=0; j<16 && Nodes(i)->upstreamPaths[j]!=-1; j++ )
 		{
-			bestPath = currentnode;
-			return 1;
+			FReachSpec& Spec = InLevel->ReachSpecs( Nodes(i)->upstreamPaths[j] );
+			INT*        From = NodeMap.Find( Spec.Start );
+			if( !From )
+				continue;
+			for( INT k=0; k<16; k++ )
+				if( Nodes(*From)->Paths[k]==Nodes(i)->upstreamPaths[j] )
+					PathEdges(*From*16 + k) = Edges.Num();
+			FEdge& Edge     = Edges( Edges.Add() );
+			Edge.From       = *From;
+			Edge.To         = i;
+			Edge.Distance   = Spec.distance;
+			Edge.Radius     = Spec.CollisionRadius;
+			Edge.Height     = Spec.CollisionHeight;
+			Edge.ReachFlags = Spec.reachFlags;
+			SpecRadii.AddUniqueItem( Edge.Radius );
+			SpecHeights.AddUniqueItem( Edge.Height );
+
+			// Teleporters and lifts have reach specs much shorter than the
+			// distance they cover, which the search heuristic must allow for.
+			FLOAT Length = (Positions(i) - Positions(*From)).Size();
+			if( Length > 1.0 )
+				MinSpeed = Min( MinSpeed, Max(0.f,(FLOAT)Spec.distance) / Length );
 		}
-		if ( (!currentnode->bPlayerOnly || bIsPlayer) || (currentnode == start) )
+	}
+	FirstEdge.AddItem( Edges.Num() );
+	MinSpeed *= 0.999;
+
+	// Bucket the nodes that can't move into the grid.
+	INT NumBuckets = 1;
+	while( NumBuckets < Nodes.Num() )
+		NumBuckets *= 2;
+	BucketMask = NumBuckets - 1;
+	GridFirst.AddZeroed( NumBuckets+1 );
+	for( INT i=0; i<Nodes.Num(); i++ )
+	{
+		Leaves.AddItem( Nodes(i)->Region.iLeaf );
+		if( !Nodes(i)->bStatic )
+			LooseNodes.AddItem( i );
+		else
+			GridFirst( NavGridBucket(Positions(i),BucketMask) + 1 )++;
+	}
+	for( INT i=0; i<NumBuckets; i++ )
+		GridFirst(i+1) += GridFirst(i);
+
+	// Fill them in, advancing each bucket's start to its end, then shift back.
+	GridNodes.Add( GridFirst(NumBuckets) );
+	for( INT i=0; i<Nodes.Num(); i++ )
+	{
+		if( Nodes(i)->bStatic )
 		{
-			int i = 0;
-			while ( i<16 )
+			FGridNode& Entry = GridNodes( GridFirst(NavGridBucket(Positions(i),BucketMask))++ );
+			Entry.Node = i;
+			Entry.X    = NavGridCoord( Positions(i).X );
+			Entry.Y    = NavGridCoord( Positions(i).Y );
+			Entry.Z    = NavGridCoord( Positions(i).Z );
+		}
+	}
+	for( INT i=NumBuckets; i>0; i-- )
+		GridFirst(i) = GridFirst(i-1);
+	GridFirst(0) = 0;
+	debugf( NAME_DevPath, "Navigation graph: %i nodes, %i edges, heuristic scale %f", Nodes.Num(), Edges.Num(), MinSpeed );
+	unguard;
+}
+
+//
+// Destroy the graph, waiting for any route tables being built.
+//
+FNavGraph::~FNavGraph()
+{
+	guard(FNavGraph::~FNavGraph);
+	for( INT i=0; i<RouteTables.Num(); i++ )
+		delete RouteTables(i);
+	unguard;
+}
+
+//
+// Whether the graph still matches the level's paths.
+//
+UBOOL FNavGraph::IsCurrent( ULevel* InLevel ) const
+{
+	guardSlow(FNavGraph::IsCurrent);
+	return FirstNav==InLevel->GetLevelInfo()->NavigationPointList && NumSpecs==InLevel->ReachSpecs.Num();
+	unguardSlow;
+}
+
+//
+// Find the nodes less than Radius from Point, and return up to MaxOut of
+// the nearest in Out, nearest first. If a PVS and a row of visible
+// clusters are given, nodes in clusters that aren't visible are skipped.
+//
+INT FNavGraph::FindNear( const FVector& Point, FLOAT Radius, FNavNear* Out, INT MaxOut, const FRelevancyPVS* PVS, const DWORD* Visible ) const
+{
+	guard(FNavGraph::FindNear);
+	FLOAT RadiusSquared = Radius * Radius;
+	INT   Count         = 0;
+
+	// Nodes in the grid. A query covering more cells than there are buckets
+	// checks every bucket once instead.
+	INT MinX = NavGridCoord(Point.X-Radius), MaxX = NavGridCoord(Point.X+Radius);
+	INT MinY = NavGridCoord(Point.Y-Radius), MaxY = NavGridCoord(Point.Y+Radius);
+	INT MinZ = NavGridCoord(Point.Z-Radius), MaxZ = NavGridCoord(Point.Z+Radius);
+	UBOOL All = (FLOAT)(MaxX-MinX+1) * (MaxY-MinY+1) * (MaxZ-MinZ+1) > BucketMask+1;
+	if( All )
+		MinX = MaxX = MinY = MaxY = MinZ = MaxZ = 0;
+	for( INT X=MinX; X<=MaxX; X++ )
+	{
+		for( INT Y=MinY; Y<=MaxY; Y++ )
+		{
+			for( INT Z=MinZ; Z<=MaxZ; Z++ )
 			{
-				if (currentnode->upstreamPaths[i] == -1)
-					i = 16;
-				else
+				INT iBucket = NavGridBucket( X, Y, Z, BucketMask );
+				INT First   = All ? 0                : GridFirst(iBucket);
+				INT Last    = All ? GridNodes.Num()  : GridFirst(iBucket+1);
+				for( INT i=First; i<Last; i++ )
 				{
-					spec = &GetLevel()->ReachSpecs(currentnode->upstreamPaths[i]);
-					//debugf("check path from %s to %s with %d, %d",spec->Start->GetName(), spec->End->GetName(), spec->CollisionRadius, spec->CollisionHeight);
-					if (spec->supports(iRadius, iHeight, moveFlags))
-					{
-						ANavigationPoint* startnode = (ANavigationPoint* )spec->Start;
-						int nextweight = spec->distance + startnode->cost;
-						int newVisit = nextweight + currentnode->visitedWeight + startnode->bEndPoint * startnode->bestPathWeight; 
-						//debugf("Path from %s to %s costs %d total %d", spec->Start->GetName(), spec->End->GetName(), nextweight, newVisit);
-						if ( startnode->visitedWeight > newVisit )
-						{
-							if ( startnode->prevOrdered ) //remove from old position
-							{
-								startnode->prevOrdered->nextOrdered = startnode->nextOrdered;
-								if (startnode->nextOrdered)
-									startnode->nextOrdered->prevOrdered = startnode->prevOrdered;
-								if ( BinTree == startnode )
-								{
-									if ( startnode->prevOrdered->visitedWeight > newVisit )
-										BinTree = startnode->prevOrdered;
-								}
-								else if ( (startnode->visitedWeight > BinTree->visitedWeight)
-									&& (newVisit < BinTree->visitedWeight) )
-									realSplit--;	
-							}
-							else if ( newVisit > BinTree->visitedWeight )
-								realSplit++;
-							else
-								realSplit--;
-							//debugf("find spot for %s with BinTree = %s",startnode->GetName(), BinTree->GetName());
-							startnode->visitedWeight = newVisit;
-							if (  BinTree->visitedWeight < startnode->visitedWeight )
-								nextnode = BinTree;
-							else
-								nextnode = currentnode;
-							//debugf(" start at %s with %d to place %s with %d",nextnode->GetName(),nextnode->visitedWeight, startnode->GetName(), startnode->visitedWeight);
-							int numList = 0; //TEMP FIXME
-							while ( nextnode->nextOrdered && (nextnode->nextOrdered->visitedWeight < startnode->visitedWeight) )
-							{
-								numList++;
-								if ( numList > 500 )
-								{
-									//debugf("Breadth path list overflow");
-									return 0;
-								}
-								nextnode = nextnode->nextOrdered;
-							}
-							if (nextnode->nextOrdered != startnode)
-							{
-								if (nextnode->nextOrdered)
-									nextnode->nextOrdered->prevOrdered = startnode;
-								startnode->nextOrdered = nextnode->nextOrdered;
-								nextnode->nextOrdered = startnode;
-								startnode->prevOrdered = nextnode;
-							}
-							//if (startnode->nextOrdered)
-							//	debugf(" place %s after %s before %s ", startnode->GetName(), nextnode->GetName(), startnode->nextOrdered->GetName());
-							//else
-							//	debugf(" place %s after %s at end ", startnode->GetName(), nextnode->GetName());
-						}
-					}
-					i++;
+					const FGridNode& Entry = GridNodes(i);
+					if( !All && (Entry.X!=X || Entry.Y!=Y || Entry.Z!=Z) )
+						continue;
+					FLOAT DistSquared = (Positions(Entry.Node) - Point).SizeSquared();
+					if( DistSquared >= RadiusSquared )
+						continue;
+					INT iCluster = Visible ? PVS->GetCluster( Leaves(Entry.Node) ) : INDEX_NONE;
+					if( iCluster!=INDEX_NONE && !(Visible[iCluster>>5] & (1<<(iCluster&31))) )
+						continue;
+					Count = AddNavNear( Out, Count, MaxOut, Entry.Node, DistSquared );
 				}
 			}
-			realSplit++;
-			int move = (int)(0.5 * realSplit);
-			while ( p < move )
+		}
+	}
+
+	// Nodes that may have moved.
+	for( INT i=0; i<LooseNodes.Num(); i++ )
+	{
+		ANavigationPoint* Nav = Nodes(LooseNodes(i));
+		FLOAT DistSquared = (Nav->Location - Point).SizeSquared();
+		if( DistSquared >= RadiusSquared )
+			continue;
+		INT iCluster = Visible ? PVS->GetCluster( Nav->Region.iLeaf ) : INDEX_NONE;
+		if( iCluster!=INDEX_NONE && !(Visible[iCluster>>5] & (1<<(iCluster&31))) )
+			continue;
+		Count = AddNavNear( Out, Count, MaxOut, LooseNodes(i), DistSquared );
+	}
+	return Count;
+	unguard;
+}
+
+//
+// Return the level's navigation graph, building it if needed.
+//
+FNavGraph* ULevel::GetNavGraph()
+{
+	guard(ULevel::GetNavGraph);
+	if( NavGraph && !NavGraph->IsCurrent(this) )
+	{
+		delete NavGraph;
+		NavGraph = NULL;
+	}
+	if( !NavGraph )
+		NavGraph = new FNavGraph( this );
+	return NavGraph;
+	unguard;
+}
+
+//
+// Start building route tables for the pawns in the level, if they're enabled.
+//
+void ULevel::PrepareRouteTables()
+{
+	guard(ULevel::PrepareRouteTables);
+	if( !GetLevelInfo()->NavigationPointList || !ReachSpecs.Num() )
+		return;
+	FNavGraph* Graph = GetNavGraph();
+	for( INT i=iFirstDynamicActor; i<Num(); i++ )
+	{
+		APawn* Pawn = Cast<APawn>( Actors(i) );
+		if( Pawn && !Pawn->IsA(APlayerPawn::StaticClass) )
+			Graph->GetRouteTable( (int)Pawn->CollisionRadius, (int)Pawn->CollisionHeight, Pawn->calcMoveFlags() );
+	}
+	unguard;
+}
+
+//
+// An open list entry. Entries whose Weight is no longer their node's are
+// stale and skipped.
+//
+struct FNavOpen
+{
+	INT Estimate;
+	INT Weight;
+	INT Order;
+	INT Node;
+};
+
+//
+// Whether open entry A comes out before B: lowest estimate first, and of
+// equal ones the most recently added, as the old sorted list did.
+//
+static inline UBOOL NavOpenBefore( const FNavOpen& A, const FNavOpen& B )
+{
+	return A.Estimate<B.Estimate || (A.Estimate==B.Estimate && A.Order>B.Order);
+}
+
+//
+// Add a node to the open heap and return the new number of entries. The
+// node is dropped if the heap is full.
+//
+static inline INT AddNavOpen( FNavOpen* Open, INT NumOpen, INT MaxOpen, INT Node, INT Weight, INT Estimate, INT Order )
+{
+	if( NumOpen<MaxOpen )
+	{
+		FNavOpen Entry;
+		Entry.Estimate = Weight + Estimate;
+		Entry.Weight   = Weight;
+		Entry.Order    = Order;
+		Entry.Node     = Node;
+		INT Hole;
+		for( Hole=NumOpen++; Hole>0 && NavOpenBefore(Entry,Open[(Hole-1)/2]); Hole=(Hole-1)/2 )
+			Open[Hole] = Open[(Hole-1)/2];
+		Open[Hole] = Entry;
+	}
+	return NumOpen;
+}
+
+//
+// The heuristic for a node: the least straight-line distance to a target,
+// scaled by MinSpeed, plus that target's end weight.
+//
+static inline INT NavEstimate( const TArray<FVector>& Positions, FLOAT MinSpeed, INT Node, const INT* Targets, const INT* TargetAdds, INT NumTargets )
+{
+	INT Best = 0;
+	for( INT t=0; t<NumTargets; t++ )
+	{
+		INT H = (INT)(MinSpeed * (Positions(Node) - Positions(Targets[t])).Size()) + TargetAdds[t];
+		if( t==0 || H<Best )
+			Best = H;
+	}
+	return Best;
+}
+
+//
+// A* search from Query.Start along upstream reach specs, until an end
+// point comes off the open list. Returns the end point's node, or
+// INDEX_NONE if there is none within reach.
+//
+// The heuristic is the straight-line distance to the nearest target, scaled
+// by MinSpeed so it never overestimates, plus the target's end weight. The
+// nodes in Query.Nearby are targets with no end weight, so any of them
+// nearer than the end point found are settled with their exact weight.
+//
+INT FNavGraph::FindPath( const FNavQuery& Query, FMemStack& Mem ) const
+{
+	guard(FNavGraph::FindPath);
+	FMemMark Mark(Mem);
+	INT  i, NumNodes=Nodes.Num();
+	INT* Weights   = Query.Weights;
+	INT* Estimates = new(Mem,NumNodes)INT;
+	BYTE* Closed   = new(Mem,NumNodes)BYTE;
+	for( i=0; i<NumNodes; i++ )
+	{
+		Weights[i]   = NAV_UNREACHED;
+		Estimates[i] = -1;
+		Closed[i]    = 0;
+	}
+
+	// Gather the heuristic's targets.
+	INT* Targets    = new(Mem,MAX_NAV_TARGETS)INT;
+	INT* TargetAdds = new(Mem,MAX_NAV_TARGETS)INT;
+	INT  NumTargets = 0;
+	for( i=0; i<NumNodes && NumTargets<=MAX_NAV_TARGETS; i++ )
+		if( Query.EndWeights[i]>=0 )
+		{
+			if( NumTargets<MAX_NAV_TARGETS )
 			{
-				p++;
-				if (BinTree->nextOrdered)
-					BinTree = BinTree->nextOrdered;
+				Targets   [NumTargets] = i;
+				TargetAdds[NumTargets] = Query.EndWeights[i];
 			}
+			NumTargets++;
 		}
-		n++;
-		if ( bSinglePath && ( n > 4) )
-			return 0;
-		if ( n > 1000 )
+	for( i=0; i<Query.NumNearby && NumTargets<=MAX_NAV_TARGETS; i++ )
+	{
+		if( NumTargets<MAX_NAV_TARGETS )
+		{
+			Targets   [NumTargets] = Query.Nearby[i];
+			TargetAdds[NumTargets] = 0;
+		}
+		NumTargets++;
+	}
+	if( NumTargets>MAX_NAV_TARGETS || MinSpeed<=0.0 )
+		NumTargets = 0;
+
+	// Open list, as a binary heap. A node is only added again if its weight
+	// drops, which it can't after it's closed unless costs are negative.
+	INT       MaxOpen = Edges.Num() + NumNodes + 1;
+	FNavOpen* Open    = new(Mem,MaxOpen)FNavOpen;
+	INT       NumOpen = 0, Order = 0, Expanded = 0, Result = INDEX_NONE;
+
+	Weights  [Query.Start] = Query.StartWeight;
+	Estimates[Query.Start] = Query.EndWeights[Query.Start]<0 ? NavEstimate( Positions, MinSpeed, Query.Start, Targets, TargetAdds, NumTargets ) : 0;
+	NumOpen = AddNavOpen( Open, NumOpen, MaxOpen, Query.Start, Weights[Query.Start], Estimates[Query.Start], Order++ );
+	while( NumOpen )
+	{
+		// Take the best entry off the heap.
+		FNavOpen Top  = Open[0];
+		FNavOpen Last = Open[--NumOpen];
+		INT Hole=0;
+		for( ;; )
+		{
+			INT Child = Hole*2 + 1;
+			if( Child>=NumOpen )
+				break;
+			if( Child+1<NumOpen && NavOpenBefore(Open[Child+1],Open[Child]) )
+				Child++;
+			if( !NavOpenBefore(Open[Child],Last) )
+				break;
+			Open[Hole] = Open[Child];
+			Hole       = Child;
+		}
+		if( NumOpen )
+			Open[Hole] = Last;
+		INT Node = Top.Node;
+		if( Closed[Node] || Top.Weight!=Weights[Node] )
+			continue;
+		Closed[Node] = 1;
+
+		// Done if it's an end point.
+		if( Query.EndWeights[Node]>=0 )
+		{
+			Result = Node;
+			break;
+		}
+
+		// Relax the paths leading here.
+		if( !Query.NoExpand || !Query.NoExpand[Node] || Node==Query.Start )
+		{
+			for( INT e=FirstEdge(Node); e<FirstEdge(Node+1); e++ )
+			{
+				const FEdge& Edge = Edges(e);
+				if
+				(	Edge.Radius>=Query.Radius
+				&&	Edge.Height>=Query.Height
+				&&	(Edge.ReachFlags & Query.MoveFlags)==Edge.ReachFlags )
+				{
+					INT From   = Edge.From;
+					INT Weight = Edge.Distance + Query.Costs[From] + Weights[Node] + Max(Query.EndWeights[From],0);
+					if( Weights[From] > Weight )
+					{
+						Weights[From] = Weight;
+						Closed[From]  = 0;
+						if( Estimates[From]<0 )
+							Estimates[From] = Query.EndWeights[From]<0 ? NavEstimate( Positions, MinSpeed, From, Targets, TargetAdds, NumTargets ) : 0;
+						NumOpen = AddNavOpen( Open, NumOpen, MaxOpen, From, Weights[From], Estimates[From], Order++ );
+					}
+				}
+			}
+		}
+		if( Query.MaxExpand && ++Expanded>=Query.MaxExpand )
+			break;
+	}
+
+	Mark.Pop();
+	return Result;
+	unguard;
+}
+
+/* breadthPathFrom()
+Search backwards through the navigation network from startnode, the path
+nearest the destination, for a path marked bEndPoint near the pawn. Uses the
+level's FNavGraph; the weights found are copied back into visitedWeight, as
+findAltEndPoint() and scripts use them. AltPoints are the other paths
+near the pawn whose weights findAltEndPoint() will compare. If there's a
+single end point and no costs it looks the route up in the level's route 
+table instead, when there is one.
+*/
+int APawn::breadthPathFrom(AActor *start, AActor *&bestPath, int bSinglePath, int moveFlags, FSortedPathList *AltPoints)
+{
+	guard(APawn::breadthPathFrom);
+	FNavGraph* Graph = GetLevel()->GetNavGraph();
+	INT iStart = Graph->FindNode( start );
+	if ( iStart == INDEX_NONE )
+		return 0;
+
+	FMemMark Mark(GMem);
+	INT NumNodes = Graph->Nodes.Num();
+	INT* Costs = new(GMem,NumNodes)INT;
+	INT* EndWeights = new(GMem,NumNodes)INT;
+	BYTE* NoExpand = new(GMem,NumNodes)BYTE;
+	INT* Nearby = new(GMem,MAXSORTED)INT;
+	INT i, iOnlyEnd = INDEX_NONE, NumEnds = 0, bCosts = 0;
+	for ( i=0; i<NumNodes; i++ )
+	{
+		ANavigationPoint *Nav = Graph->Nodes(i);
+		Costs[i] = Nav->cost;
+		EndWeights[i] = Nav->bEndPoint ? Nav->bestPathWeight : -1;
+		NoExpand[i] = Nav->bPlayerOnly && !bIsPlayer;
+		bCosts |= (Costs[i] != 0);
+		if ( Nav->bEndPoint )
 		{
-			//debugf(NAME_DevPath,"2000 navigation nodes searched!");
+			iOnlyEnd = i;
+			NumEnds++;
+		}
+	}
+
+	// With one end point and no costs, the route table knows the way.
+	FRouteTable *Table = (bSinglePath || bCosts || (NumEnds != 1)) ? NULL 
+		: Graph->GetRouteTable((int)CollisionRadius, (int)CollisionHeight, moveFlags);
+	if ( Table )
+	{
+		Table->Lookups++;
+		INT StartWeight = ((ANavigationPoint *)start)->visitedWeight;
+		INT EndDist = Table->Distance(iOnlyEnd, iStart);
+		if ( EndDist == NAV_UNREACHED )
+		{
+			Mark.Pop();
 			return 0;
 		}
-		//debugf("Done with %s",currentnode->GetName());
-		currentnode = currentnode->nextOrdered;
-		//nextnode = currentnode;
-		//while (nextnode)
-		//{
-		//	debugf("Next %s",nextnode->GetName());
-		//	nextnode = nextnode->nextOrdered;
-		//}
+		Graph->Nodes(iOnlyEnd)->visitedWeight = StartWeight + EndDist + EndWeights[iOnlyEnd];
+
+		// A search would stop at the end point, so it never finds routes 
+		// through it for the alternatives.
+		if ( AltPoints )
+			for ( i=1; i<AltPoints->numPoints; i++ )
+			{
+				INT iNode = Graph->FindNode( AltPoints->Path[i] );
+				if ( (iNode == INDEX_NONE) || (iNode == iOnlyEnd) )
+					continue;
+				INT AltDist = Table->Distance(iNode, iStart);
+				INT ViaEnd = Table->Distance(iNode, iOnlyEnd);
+				if ( (AltDist != NAV_UNREACHED) && ((ViaEnd == NAV_UNREACHED) || (ViaEnd + EndDist != AltDist)) )
+					Graph->Nodes(iNode)->visitedWeight = StartWeight + AltDist;
+			}
+		Mark.Pop();
+		bestPath = Graph->Nodes(iOnlyEnd);
+		return 1;
 	}
-	return 0;
-	
+
+	FNavQuery Query;
+	Query.Start = iStart;
+	Query.StartWeight = ((ANavigationPoint *)start)->visitedWeight;
+	Query.Radius = (int)CollisionRadius;
+	Query.Height = (int)CollisionHeight;
+	Query.MoveFlags = moveFlags;
+	Query.MaxExpand = bSinglePath ? 5 : 0;
+	Query.Costs = Costs;
+	Query.EndWeights = EndWeights;
+	Query.NoExpand = NoExpand;
+	Query.Nearby = Nearby;
+	Query.NumNearby = 0;
+	Query.Weights = new(GMem,NumNodes)INT;
+	if ( AltPoints )
+		for ( i=1; i<AltPoints->numPoints; i++ )
+		{
+			INT iNode = Graph->FindNode( AltPoints->Path[i] );
+			if ( iNode != INDEX_NONE )
+				Nearby[Query.NumNearby++] = iNode;
+		}
+
+	INT iEnd = Graph->FindPath( Query, GMem );
+	for ( i=0; i<NumNodes; i++ )
+		if ( Query.Weights[i] != NAV_UNREACHED )
+			Graph->Nodes(i)->visitedWeight = Query.Weights[i];
+	Mark.Pop();
+
+	if ( iEnd == INDEX_NONE )
+		return 0;
+	bestPath = Graph->Nodes(iEnd);
+	return 1;
 	unguard;
 }
 
@@ -0,0 +1,370 @@
+/*=============================================================================
+	UnRouteTable.cpp: Precomputed routes through the navigation network.
+
+Design goal:
+	Answer the common path query, a single end point near the pawn and no
+	extra costs on the network, by walking a precomputed route instead of
+	searching. The network doesn't change while a level is played, so the
+	routes for each kind of pawn only have to be found once.
+
+	A route table holds, for every destination and every node, which of the
+	node's Paths[] leads towards the destination on a shortest route. Tables
+	are built with one FNavGraph::FindPath search backwards from each
+	destination, a batch of destinations per job, while the level plays.
+	Queries the table can't answer exactly, such as those from an anchor
+	whose reach specs have been checked for movers, still search.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	Definitions.
+-----------------------------------------------------------------------------*/
+
+#define ROUTE_TABLE_MAGIC	0x54525455 /* "UTRT" */
+#define ROUTE_TABLE_VERSION	1
+
+enum {ROUTE_BATCH=8};	// Destinations built per job.
+
+/*-----------------------------------------------------------------------------
+	FNavGraph route tables.
+-----------------------------------------------------------------------------*/
+
+//
+// Return the route table for pawns of a size and set of movement flags,
+// or NULL if tables are disabled or it isn't built yet, in which case it
+// is started. Sizes are rounded up to the next reach spec size, since
+// only that decides which specs the pawns can use.
+//
+FRouteTable* FNavGraph::GetRouteTable( INT Radius, INT Height, INT MoveFlags )
+{
+	guard(FNavGraph::GetRouteTable);
+	if( !UseRouteTables || !Nodes.Num() || Nodes.Num()>MAX_ROUTE_NODES )
+		return NULL;
+
+	INT BestRadius=MAXINT, BestHeight=MAXINT, i;
+	for( i=0; i<SpecRadii.Num(); i++ )
+		if( SpecRadii(i)>=Radius && SpecRadii(i)<BestRadius )
+			BestRadius = SpecRadii(i);
+	for( i=0; i<SpecHeights.Num(); i++ )
+		if( SpecHeights(i)>=Height && SpecHeights(i)<BestHeight )
+			BestHeight = SpecHeights(i);
+	Radius = BestRadius;
+	Height = BestHeight;
+
+	FRouteTable* Table = NULL;
+	for( i=0; i<RouteTables.Num() && !Table; i++ )
+		if( RouteTables(i)->Radius==Radius && RouteTables(i)->Height==Height && RouteTables(i)->MoveFlags==MoveFlags )
+			Table = RouteTables(i);
+	if( !Table )
+	{
+		Table = new FRouteTable( this, Radius, Height, MoveFlags );
+		RouteTables.AddItem( Table );
+	}
+	return Table->IsReady() ? Table : NULL;
+	unguard;
+}
+
+//
+// Log the route tables and what they cost.
+//
+void FNavGraph::DumpRouteTables( FOutputDevice* Out )
+{
+	guard(FNavGraph::DumpRouteTables);
+	if( !UseRouteTables )
+	{
+		Out->Logf( "Route tables are disabled" );
+		return;
+	}
+	INT Total=0;
+	Out->Logf( "Route tables for %i nodes, %i edges:", Nodes.Num(), Edges.Num() );
+	for( INT i=0; i<RouteTables.Num(); i++ )
+	{
+		FRouteTable* Table = RouteTables(i);
+		if( !Table->IsReady() )
+			Out->Logf( "   Radius %i height %i flags %i: building", Table->Radius, Table->Height, Table->MoveFlags );
+		else
+			Out->Logf
+			(
+				"   Radius %i height %i flags %i: %i KB, %s in %.2f sec, %i lookups",
+				Table->Radius,
+				Table->Height,
+				Table->MoveFlags,
+				Table->GetMemory()/1024,
+				Table->Loaded ? "loaded" : "built",
+				Table->BuildTime,
+				Table->Lookups
+			);
+		Total += Table->GetMemory();
+	}
+	Out->Logf( "%i tables, %i KB", RouteTables.Num(), Total/1024 );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRouteTable init.
+-----------------------------------------------------------------------------*/
+
+//
+// Load a table from the cache, or start building it.
+//
+FRouteTable::FRouteTable( FNavGraph* InGraph, INT InRadius, INT InHeight, INT InMoveFlags )
+:	Radius		( InRadius )
+,	Height		( InHeight )
+,	MoveFlags	( InMoveFlags )
+,	Lookups		( 0 )
+,	BuildTime	( 0.0 )
+,	Loaded		( 0 )
+,	Graph		( InGraph )
+,	StartTime	( appSeconds() )
+,	Ready		( 0 )
+{
+	guard(FRouteTable::FRouteTable);
+	INT NumNodes = Graph->Nodes.Num();
+	NoCosts.AddZeroed( NumNodes );
+	NoEnds.Add( NumNodes );
+	NoExpand.Add( NumNodes );
+	for( INT i=0; i<NumNodes; i++ )
+	{
+		NoEnds(i)   = -1;
+		NoExpand(i) = Graph->Nodes(i)->bPlayerOnly && !(MoveFlags & R_PLAYERONLY);
+	}
+	Hops.Add( NumNodes * NumNodes );
+	if( Load() )
+	{
+		Loaded    = 1;
+		Ready     = 1;
+		BuildTime = appSeconds() - StartTime;
+		return;
+	}
+
+	// Build it in the background.
+	appMemset( &Hops(0), ROUTE_NO_HOP, Hops.Num() );
+	for( INT First=0; First<NumNodes; First+=ROUTE_BATCH )
+	{
+		FBatch& Batch = Batches( Batches.Add() );
+		Batch.Table   = this;
+		Batch.First   = First;
+		Batch.Last    = Min( First+ROUTE_BATCH, NumNodes );
+	}
+	for( INT i=0; i<Batches.Num(); i++ )
+		GJobs.Dispatch( BuildJob, &Batches(i), &Counter );
+	unguard;
+}
+
+//
+// Destroy a table, waiting for it to be built first.
+//
+FRouteTable::~FRouteTable()
+{
+	guard(FRouteTable::~FRouteTable);
+	GJobs.Wait( Counter );
+	unguard;
+}
+
+//
+// Return whether the table has been built. The first time it has, it's
+// saved to the cache.
+//
+UBOOL FRouteTable::IsReady()
+{
+	guardSlow(FRouteTable::IsReady);
+	if( !Ready && Counter.IsDone() )
+	{
+		Ready     = 1;
+		BuildTime = appSeconds() - StartTime;
+		Batches.Empty();
+		debugf( NAME_DevPath, "Built route table for radius %i height %i flags %i: %i KB in %.2f sec", Radius, Height, MoveFlags, GetMemory()/1024, BuildTime );
+		Save();
+	}
+	return Ready;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FRouteTable building.
+-----------------------------------------------------------------------------*/
+
+//
+// Job entry point.
+//
+void FRouteTable::BuildJob( void* Arg )
+{
+	FBatch* Batch = (FBatch*)Arg;
+	Batch->Table->Build( Batch->First, Batch->Last );
+}
+
+//
+// Find the next hops from every node to the destinations First to Last-1.
+// Only writes those destinations' rows, so batches can be built at once.
+//
+void FRouteTable::Build( INT First, INT Last )
+{
+	guard(FRouteTable::Build);
+	FMemStack& Mem = GJobs.GetThreadMem();
+	FMemMark Mark(Mem);
+	INT NumNodes = Graph->Nodes.Num();
+
+	FNavQuery Query;
+	Query.StartWeight = 0;
+	Query.Radius      = Radius;
+	Query.Height      = Height;
+	Query.MoveFlags   = MoveFlags;
+	Query.MaxExpand   = 0;
+	Query.Costs       = &NoCosts(0);
+	Query.EndWeights  = &NoEnds(0);
+	Query.NoExpand    = &NoExpand(0);
+	Query.Nearby      = NULL;
+	Query.NumNearby   = 0;
+	Query.Weights     = new(Mem,NumNodes)INT;
+	const INT* Weights = Query.Weights;
+
+	for( INT To=First; To<Last; To++ )
+	{
+		// Find every node's distance to here, then the first of its paths
+		// that is on a shortest route.
+		Query.Start = To;
+		Graph->FindPath( Query, Mem );
+		BYTE* Row = &Hops( To*NumNodes );
+		for( INT From=0; From<NumNodes; From++ )
+		{
+			if( From==To || Weights[From]==NAV_UNREACHED )
+				continue;
+			for( INT k=0; k<16; k++ )
+			{
+				INT iEdge = Graph->PathEdges( From*16 + k );
+				if( iEdge==INDEX_NONE )
+					continue;
+				const FNavGraph::FEdge& Edge = Graph->Edges(iEdge);
+				if
+				(	Edge.Radius>=Radius
+				&&	Edge.Height>=Height
+				&&	(Edge.ReachFlags & MoveFlags)==Edge.ReachFlags
+				&&	(Edge.To==To || !NoExpand(Edge.To))
+				&&	Weights[Edge.To]!=NAV_UNREACHED
+				&&	Weights[Edge.To]+Edge.Distance==Weights[From] )
+				{
+					Row[From] = k;
+					break;
+				}
+			}
+		}
+	}
+	Mark.Pop();
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRouteTable queries.
+-----------------------------------------------------------------------------*/
+
+//
+// Return the distance of the shortest route from one node to another, or
+// NAV_UNREACHED if there is none.
+//
+INT FRouteTable::Distance( INT From, INT To ) const
+{
+	guardSlow(FRouteTable::Distance);
+	INT Total=0;
+	for( INT Steps=0; From!=To; Steps++ )
+	{
+		INT Hop = NextHop( From, To );
+		if( Hop==ROUTE_NO_HOP || Steps>=Graph->Nodes.Num() )
+			return NAV_UNREACHED;
+		const FNavGraph::FEdge& Edge = Graph->Edges( Graph->PathEdges(From*16 + Hop) );
+		Total += Edge.Distance;
+		From   = Edge.To;
+	}
+	return Total;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FRouteTable cache.
+-----------------------------------------------------------------------------*/
+
+//
+// Get the name of the table's cache file.
+//
+void FRouteTable::GetFilename( char* Result )
+{
+	guard(FRouteTable::GetFilename);
+	appSprintf( Result, "%s/%s_%i_%i_%i.route", GSys->CachePath, Graph->Level->GetParent()->GetName(), Radius, Height, MoveFlags );
+	unguard;
+}
+
+//
+// Identify the network a cached table was built from.
+//
+DWORD FRouteTable::GetKey()
+{
+	guard(FRouteTable::GetKey);
+	DWORD Key = Graph->Nodes.Num();
+	if( Graph->Edges.Num() )
+		Key ^= appMemCrc( (BYTE*)&Graph->Edges(0), Graph->Edges.Num()*sizeof(FNavGraph::FEdge) );
+	if( Graph->PathEdges.Num() )
+		Key ^= appMemCrc( (BYTE*)&Graph->PathEdges(0), Graph->PathEdges.Num()*sizeof(INT) ) * 3;
+	Key += appMemCrc( &NoExpand(0), NoExpand.Num() );
+	return Key;
+	unguard;
+}
+
+//
+// Load a cached table. Returns 0 if there is none for this network.
+//
+UBOOL FRouteTable::Load()
+{
+	guard(FRouteTable::Load);
+	char Filename[256];
+	GetFilename( Filename );
+	FILE* File = appFopen( Filename, "rb" );
+	if( !File )
+		return 0;
+	INT   NumNodes = Graph->Nodes.Num();
+	DWORD Header[7];
+	UBOOL Ok
+	=	appFread( Header, sizeof(Header), 1, File )==1
+	&&	Header[0]==ROUTE_TABLE_MAGIC
+	&&	Header[1]==ROUTE_TABLE_VERSION
+	&&	Header[2]==GetKey()
+	&&	Header[3]==(DWORD)NumNodes
+	&&	Header[4]==(DWORD)Radius
+	&&	Header[5]==(DWORD)Height
+	&&	Header[6]==(DWORD)MoveFlags
+	&&	appFread( &Hops(0), 1, Hops.Num(), File )==Hops.Num();
+
+	// Every hop must be one of the node's paths.
+	for( INT i=0; Ok && i<Hops.Num(); i++ )
+		Ok = Hops(i)==ROUTE_NO_HOP || (Hops(i)<16 && Graph->PathEdges((i%NumNodes)*16 + Hops(i))!=INDEX_NONE);
+	appFclose( File );
+	if( Ok )
+		debugf( NAME_DevPath, "Loaded route table for radius %i height %i flags %i from %s", Radius, Height, MoveFlags, Filename );
+	return Ok;
+	unguard;
+}
+
+//
+// Save the table to the cache.
+//
+void FRouteTable::Save()
+{
+	guard(FRouteTable::Save);
+	char Filename[256];
+	GetFilename( Filename );
+	appMkdir( GSys->CachePath );
+	FILE* File = appFopen( Filename, "wb" );
+	if( !File )
+	{
+		debugf( NAME_Warning, "Can't write route table to %s", Filename );
+		return;
+	}
+	DWORD Header[7] = { ROUTE_TABLE_MAGIC, ROUTE_TABLE_VERSION, GetKey(), (DWORD)Graph->Nodes.Num(), (DWORD)Radius, (DWORD)Height, (DWORD)MoveFlags };
+	appFwrite( Header,   sizeof(Header), 1,          File );
+	appFwrite( &Hops(0), 1,              Hops.Num(), File );
+	appFclose( File );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -1943,6 +1943,9 @@ void AActor::ProcessState( FLOAT DeltaSeconds )
 	{
 		if( ++GScriptEntryTag==1 )
 			uclock(GScriptCycles);
+		UBOOL Profiled = GScriptProfiler.Active;
+		if( Profiled )
+			GScriptProfiler.Enter( GetMainFrame()->StateNode );
 
 		// Create a work area for UnrealScript.
 		BYTE Buffer[MAX_CONST_SIZE], *Addr;
@@ -1967,6 +1970,8 @@ void AActor::ProcessState( FLOAT DeltaSeconds )
 				}
 			}
 		}
+		if( Profiled )
+			GScriptProfiler.Leave();
 		if( --GScriptEntryTag==0 )
 			uunclock(GScriptCycles);
 	}
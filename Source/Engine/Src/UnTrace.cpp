@@ -8,6 +8,15 @@
 
 #include "EnginePrivate.h"
 
+// SIMD support for batched traces.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=1)
+	#include <xmmintrin.h>
+	#define TRACE_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define TRACE_NEON 1
+#endif
+
 /*---------------------------------------------------------------------------------------
    Primitive bounding boxes.
 ---------------------------------------------------------------------------------------*/
@@ -330,75 +339,121 @@ UBOOL UModel::PointCheck
 ---------------------------------------------------------------------------------------*/
 
 //
-// Recursive minion of UModel::LineCheck.
+// Pending back half of a split line, for LineCheckIterative.
+//
+struct FLineCheckFrame
+{
+	INT		iHit;
+	INT		iNode;
+	FVector	End;
+	FVector	Start;
+	UBOOL	Outside;
+};
+
 //
-UBOOL GOutOfCorner;
-UBOOL LineCheck
+// Minion of UModel::LineCheck. Walks the Bsp with an explicit stack of the
+// back halves of split lines, and keeps the out-of-corner state in
+// OutOfCorner rather than a global, so traces can run on any thread.
+//
+static UBOOL LineCheckIterative
 (
 	FCheckResult&	Hit,
 	UModel&			Model,
 	const FCoords*	Coords,
 	INT  			iHit,
 	INT				iNode,
-	FVector			End, 
+	FVector			End,
 	FVector			Start,
 	UBOOL			Outside,
-	DWORD			InNodeFlags
+	DWORD			InNodeFlags,
+	UBOOL&			OutOfCorner
 )
 {
-	guardSlow(LineCheck);
-	while( iNode != INDEX_NONE )
+	guardSlow(LineCheckIterative);
+	enum {MAX_STACK=64};
+	FLineCheckFrame Stack[MAX_STACK];
+	INT StackTop = 0;
+	for( ;; )
 	{
-		const FBspNode*	Node = &Model.Nodes->Element(iNode);
-
-		// Check side-of-plane for both points.
-		FLOAT Dist1	= Coords ? Node->Plane.TransformPlaneByOrtho(*Coords).PlaneDot(Start) : Node->Plane.PlaneDot(Start);
-		FLOAT Dist2	= Coords ? Node->Plane.TransformPlaneByOrtho(*Coords).PlaneDot(End)   : Node->Plane.PlaneDot(End);
-
-		// Classify line based on both distances.
-		if( Dist1 > -0.001 && Dist2 > -0.001 )
-		{
-			// Both points are in front.
-			Outside |= Node->IsCsg(InNodeFlags & ~NF_BrightCorners);
-			iNode    = Node->iFront;
-		}
-		else if( Dist1 < 0.001 && Dist2 < 0.001 )
-		{
-			// Both points are in back.
-			Outside &= !Node->IsCsg(InNodeFlags & ~NF_BrightCorners);
-			iNode    = Node->iBack;
-		}
-		else
+		while( iNode != INDEX_NONE )
 		{
-			// Line is split and guranteed to be non-parallel to plane, so TimeDenominator != 0.
-			FVector Middle     = Start + (Start-End) * (Dist1/(Dist2-Dist1));
-			INT     FrontFirst = Dist1 > 0.0;
+			const FBspNode*	Node = &Model.Nodes->Element(iNode);
 
-			// Recurse with front part.
-			if( !LineCheck( Hit, Model, Coords, iHit, Node->iChild[FrontFirst], Middle, Start, Node->ChildOutside(FrontFirst,Outside,InNodeFlags), InNodeFlags ) )
-				return 0;
+			// Check side-of-plane for both points.
+			FLOAT Dist1	= Coords ? Node->Plane.TransformPlaneByOrtho(*Coords).PlaneDot(Start) : Node->Plane.PlaneDot(Start);
+			FLOAT Dist2	= Coords ? Node->Plane.TransformPlaneByOrtho(*Coords).PlaneDot(End)   : Node->Plane.PlaneDot(End);
+
+			// Classify line based on both distances.
+			if( Dist1 > -0.001 && Dist2 > -0.001 )
+			{
+				// Both points are in front.
+				Outside |= Node->IsCsg(InNodeFlags & ~NF_BrightCorners);
+				iNode    = Node->iFront;
+			}
+			else if( Dist1 < 0.001 && Dist2 < 0.001 )
+			{
+				// Both points are in back.
+				Outside &= !Node->IsCsg(InNodeFlags & ~NF_BrightCorners);
+				iNode    = Node->iBack;
+			}
+			else
+			{
+				// Line is split.
+				FVector Middle      = Start + (Start-End) * (Dist1/(Dist2-Dist1));
+				INT     FrontFirst  = Dist1 > 0.0;
+				UBOOL   BackOutside = Node->ChildOutside( 1-FrontFirst, Outside, InNodeFlags );
+				if( StackTop < MAX_STACK )
+				{
+					// Save the back part and go on with the front part.
+					FLineCheckFrame& Frame = Stack[StackTop++];
+					Frame.iHit    = iNode;
+					Frame.iNode   = Node->iChild[1-FrontFirst];
+					Frame.End     = End;
+					Frame.Start   = Middle;
+					Frame.Outside = BackOutside;
+					Outside       = Node->ChildOutside( FrontFirst, Outside, InNodeFlags );
+					iNode         = Node->iChild[FrontFirst];
+					End           = Middle;
+				}
+				else
+				{
+					// Out of stack, so recurse with the front part.
+					if( !LineCheckIterative( Hit, Model, Coords, iHit, Node->iChild[FrontFirst], Middle, Start, Node->ChildOutside(FrontFirst,Outside,InNodeFlags), InNodeFlags, OutOfCorner ) )
+						return 0;
 
-			// Loop with back part.
-			Outside = Node->ChildOutside( 1-FrontFirst, Outside, InNodeFlags );
-			iHit    = iNode;
-			iNode   = Node->iChild[1-FrontFirst];
-			Start   = Middle;
+					// Loop with back part.
+					Outside = BackOutside;
+					iHit    = iNode;
+					iNode   = Node->iChild[1-FrontFirst];
+					Start   = Middle;
+				}
+			}
 		}
-	}
-	if( !Outside )
-	{
-		// We have encountered the first collision.
-		if( GOutOfCorner || !(InNodeFlags&NF_BrightCorners) )
+		if( !Outside )
 		{
-			Hit.Location  = Start;
-			Hit.Normal    = Model.Nodes->Element(iHit).Plane;
-			Hit.Primitive = &Model;
-			Hit.Item      = iHit;		
+			// We have encountered the first collision.
+			if( OutOfCorner || !(InNodeFlags&NF_BrightCorners) )
+			{
+				Hit.Location  = Start;
+				Hit.Normal    = Model.Nodes->Element(iHit).Plane;
+				Hit.Primitive = &Model;
+				Hit.Item      = iHit;
+				return 0;
+			}
+			Outside = 1;
 		}
-		else Outside=1;
+		else OutOfCorner = 1;
+
+		// Go on with the last saved back part.
+		if( !StackTop )
+			return Outside;
+		FLineCheckFrame& Frame = Stack[--StackTop];
+		iHit    = Frame.iHit;
+		iNode   = Frame.iNode;
+		End     = Frame.End;
+		Start   = Frame.Start;
+		Outside = Frame.Outside;
 	}
-	else GOutOfCorner=1;
-	return Outside;
 	unguardSlow;
 }
 
@@ -536,17 +591,17 @@ UBOOL UModel::LineCheck
 		if( Extent == FVector(0,0,0) )
 		{
 			// Perform simple line trace.
-			GOutOfCorner = 0;
+			UBOOL OutOfCorner = 0;
 			UBOOL Outside;
 			if( Owner )
 			{
 				// shut up compiler
 				const FCoords CheckCoords = Owner->ToWorld();
-				Outside = ::LineCheck( Hit, *this, &CheckCoords, 0, 0, End, Start, RootOutside, ExtraNodeFlags );
+				Outside = LineCheckIterative( Hit, *this, &CheckCoords, 0, 0, End, Start, RootOutside, ExtraNodeFlags, OutOfCorner );
 			}
 			else
 			{
-				Outside = ::LineCheck( Hit, *this, NULL, 0, 0, End, Start, RootOutside, ExtraNodeFlags );
+				Outside = LineCheckIterative( Hit, *this, NULL, 0, 0, End, Start, RootOutside, ExtraNodeFlags, OutOfCorner );
 			}
 			if( !Outside )
 			{
@@ -581,6 +636,247 @@ UBOOL UModel::LineCheck
 	unguard;
 }
 
+/*---------------------------------------------------------------------------------------
+   Batched LineCheck.
+---------------------------------------------------------------------------------------*/
+
+//
+// A packet of up to four zero-extent rays, stored by component.
+//
+struct FLineCheckPacket
+{
+	enum {NUM_LANES=4};
+	FLOAT SX[NUM_LANES], SY[NUM_LANES], SZ[NUM_LANES];
+	FLOAT EX[NUM_LANES], EY[NUM_LANES], EZ[NUM_LANES];
+	FLOAT Margin[NUM_LANES];
+};
+
+// Packets only classify a ray when it's this far away from LineCheck's
+// thresholds, relative to the size of the terms, so that float rounding
+// differences can't change the outcome. Closer rays leave the packet.
+#define TRACE_MARGIN_BASE	0.002f
+#define TRACE_MARGIN_SCALE	0.00002f
+
+//
+// Classify a packet against a plane. Sets a bit in FrontMask for each ray
+// that LineCheck would certainly send to the front, and in BackMask for
+// each ray it would certainly send to the back.
+//
+static inline void ClassifyLineCheckPacket( const FLineCheckPacket& P, const FPlane& Plane, INT& FrontMask, INT& BackMask )
+{
+	FLOAT PlaneMargin = Abs(Plane.W) * TRACE_MARGIN_SCALE;
+#if TRACE_SSE
+	__m128 PX = _mm_set1_ps( Plane.X ), PY = _mm_set1_ps( Plane.Y ), PZ = _mm_set1_ps( Plane.Z ), PW = _mm_set1_ps( Plane.W );
+	__m128 D1 = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps(PX,_mm_loadu_ps(P.SX)), _mm_mul_ps(PY,_mm_loadu_ps(P.SY)) ), _mm_mul_ps(PZ,_mm_loadu_ps(P.SZ)) ), PW );
+	__m128 D2 = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps(PX,_mm_loadu_ps(P.EX)), _mm_mul_ps(PY,_mm_loadu_ps(P.EY)) ), _mm_mul_ps(PZ,_mm_loadu_ps(P.EZ)) ), PW );
+	__m128 M  = _mm_add_ps( _mm_loadu_ps(P.Margin), _mm_set1_ps(PlaneMargin) );
+	__m128 Lo = _mm_set1_ps( -0.001f ), Hi = _mm_set1_ps( 0.001f );
+	__m128 FrontLo = _mm_add_ps( Lo, M ), BackLo = _mm_sub_ps( Lo, M ), BackHi = _mm_sub_ps( Hi, M );
+	__m128 Front   = _mm_and_ps( _mm_cmpgt_ps(D1,FrontLo), _mm_cmpgt_ps(D2,FrontLo) );
+	__m128 Back    = _mm_and_ps
+	(
+		_mm_or_ps ( _mm_cmplt_ps(D1,BackLo), _mm_cmplt_ps(D2,BackLo) ),
+		_mm_and_ps( _mm_cmplt_ps(D1,BackHi), _mm_cmplt_ps(D2,BackHi) )
+	);
+	FrontMask = _mm_movemask_ps( Front );
+	BackMask  = _mm_movemask_ps( Back );
+#elif TRACE_NEON
+	float32x4_t PX = vdupq_n_f32( Plane.X ), PY = vdupq_n_f32( Plane.Y ), PZ = vdupq_n_f32( Plane.Z ), PW = vdupq_n_f32( Plane.W );
+	float32x4_t D1 = vsubq_f32( vaddq_f32( vaddq_f32( vmulq_f32(PX,vld1q_f32(P.SX)), vmulq_f32(PY,vld1q_f32(P.SY)) ), vmulq_f32(PZ,vld1q_f32(P.SZ)) ), PW );
+	float32x4_t D2 = vsubq_f32( vaddq_f32( vaddq_f32( vmulq_f32(PX,vld1q_f32(P.EX)), vmulq_f32(PY,vld1q_f32(P.EY)) ), vmulq_f32(PZ,vld1q_f32(P.EZ)) ), PW );
+	float32x4_t M  = vaddq_f32( vld1q_f32(P.Margin), vdupq_n_f32(PlaneMargin) );
+	float32x4_t Lo = vdupq_n_f32( -0.001f ), Hi = vdupq_n_f32( 0.001f );
+	float32x4_t FrontLo = vaddq_f32( Lo, M ), BackLo = vsubq_f32( Lo, M ), BackHi = vsubq_f32( Hi, M );
+	uint32x4_t  Front   = vandq_u32( vcgtq_f32(D1,FrontLo), vcgtq_f32(D2,FrontLo) );
+	uint32x4_t  Back    = vandq_u32
+	(
+		vorrq_u32( vcltq_f32(D1,BackLo), vcltq_f32(D2,BackLo) ),
+		vandq_u32( vcltq_f32(D1,BackHi), vcltq_f32(D2,BackHi) )
+	);
+	DWORD F[4], B[4];
+	vst1q_u32( F, Front );
+	vst1q_u32( B, Back );
+	FrontMask = (F[0]&1) | (F[1]&2) | (F[2]&4) | (F[3]&8);
+	BackMask  = (B[0]&1) | (B[1]&2) | (B[2]&4) | (B[3]&8);
+#else
+	FrontMask = BackMask = 0;
+	for( INT i=0; i<FLineCheckPacket::NUM_LANES; i++ )
+	{
+		FLOAT D1 = Plane.X*P.SX[i] + Plane.Y*P.SY[i] + Plane.Z*P.SZ[i] - Plane.W;
+		FLOAT D2 = Plane.X*P.EX[i] + Plane.Y*P.EY[i] + Plane.Z*P.EZ[i] - Plane.W;
+		FLOAT M  = P.Margin[i] + PlaneMargin;
+		if( D1 > -0.001f+M && D2 > -0.001f+M )
+			FrontMask |= 1<<i;
+		else if( (D1 < -0.001f-M || D2 < -0.001f-M) && D1 < 0.001f-M && D2 < 0.001f-M )
+			BackMask  |= 1<<i;
+	}
+#endif
+}
+
+//
+// Trace a packet of rays down the Bsp together for as long as they agree
+// on every node. Rays which would split at a node, or which are too close
+// to call, continue on their own with LineCheckIterative.
+//
+static void LineCheckPacket
+(
+	FCheckResult*		Hits,
+	UBOOL*				Results,
+	UModel&				Model,
+	const FCoords*		Coords,
+	const FVector*		Starts,
+	const FVector*		Ends,
+	INT					NumRays,
+	UBOOL				RootOutside,
+	DWORD				InNodeFlags
+)
+{
+	guardSlow(LineCheckPacket);
+
+	// Set up the packet. Unused lanes repeat the first ray.
+	FLineCheckPacket P;
+	for( INT i=0; i<FLineCheckPacket::NUM_LANES; i++ )
+	{
+		const FVector& S = Starts[i<NumRays ? i : 0];
+		const FVector& E = Ends  [i<NumRays ? i : 0];
+		P.SX[i] = S.X; P.SY[i] = S.Y; P.SZ[i] = S.Z;
+		P.EX[i] = E.X; P.EY[i] = E.Y; P.EZ[i] = E.Z;
+		P.Margin[i] = TRACE_MARGIN_BASE + TRACE_MARGIN_SCALE * (Max(Abs(S.X),Abs(E.X)) + Max(Abs(S.Y),Abs(E.Y)) + Max(Abs(S.Z),Abs(E.Z)));
+	}
+
+	// Subpackets waiting to be traced.
+	struct FSubPacket
+	{
+		INT		iNode;
+		INT		Mask;
+		UBOOL	Outside;
+	} Stack[FLineCheckPacket::NUM_LANES];
+	INT StackTop = 0;
+	Stack[StackTop].iNode   = 0;
+	Stack[StackTop].Mask    = (1<<NumRays)-1;
+	Stack[StackTop].Outside = RootOutside;
+	StackTop++;
+
+	while( StackTop )
+	{
+		FSubPacket Sub = Stack[--StackTop];
+		while( Sub.iNode != INDEX_NONE && Sub.Mask )
+		{
+			const FBspNode* Node = &Model.Nodes->Element(Sub.iNode);
+			INT FrontMask, BackMask;
+			ClassifyLineCheckPacket( P, Coords ? Node->Plane.TransformPlaneByOrtho(*Coords) : Node->Plane, FrontMask, BackMask );
+			FrontMask &= Sub.Mask;
+			BackMask  &= Sub.Mask;
+
+			// Rays that don't clearly go one way are traced from here on their own.
+			// Nothing has split yet, so iHit is 0 and no leaf has been reached.
+			INT Alone = Sub.Mask & ~(FrontMask|BackMask);
+			for( INT i=0; Alone; i++,Alone>>=1 )
+			{
+				if( Alone & 1 )
+				{
+					UBOOL OutOfCorner = 0;
+					Results[i] = LineCheckIterative( Hits[i], Model, Coords, 0, Sub.iNode, Ends[i], Starts[i], Sub.Outside, InNodeFlags, OutOfCorner );
+				}
+			}
+
+			// Rays that agree go on together.
+			UBOOL IsCsg = Node->IsCsg(InNodeFlags & ~NF_BrightCorners);
+			if( FrontMask && BackMask )
+			{
+				FSubPacket& Back = Stack[StackTop++];
+				Back.iNode   = Node->iBack;
+				Back.Mask    = BackMask;
+				Back.Outside = Sub.Outside & !IsCsg;
+			}
+			if( FrontMask )
+			{
+				Sub.Outside |= IsCsg;
+				Sub.iNode    = Node->iFront;
+				Sub.Mask     = FrontMask;
+			}
+			else
+			{
+				Sub.Outside &= !IsCsg;
+				Sub.iNode    = Node->iBack;
+				Sub.Mask     = BackMask;
+			}
+		}
+
+		// Rays that reached a leaf together never split, so the hit node is the root.
+		for( INT i=0; Sub.Mask; i++,Sub.Mask>>=1 )
+		{
+			if( Sub.Mask & 1 )
+			{
+				Results[i] = 1;
+				if( !Sub.Outside && !(InNodeFlags&NF_BrightCorners) )
+				{
+					Hits[i].Location  = Starts[i];
+					Hits[i].Normal    = Model.Nodes->Element(0).Plane;
+					Hits[i].Primitive = &Model;
+					Hits[i].Item      = 0;
+					Results[i]        = 0;
+				}
+			}
+		}
+	}
+	unguardSlow;
+}
+
+//
+// Trace many lines at once. Hits and Results each receive what LineCheck
+// would have set and returned for the same line, in the same order as
+// Starts and Ends. Zero-extent lines are traced down the Bsp in packets;
+// box traces are done one at a time. Returns the number of blocked lines.
+//
+INT UModel::LineCheckBatch
+(
+	FCheckResult*	Hits,
+	const FVector*	Starts,
+	const FVector*	Ends,
+	INT				Count,
+	UBOOL*			Results,
+	AActor*			Owner,
+	FVector			Extent,
+	DWORD			ExtraNodeFlags
+)
+{
+	guard(UModel::LineCheckBatch);
+	INT NumBlocked = 0;
+	if( !Nodes->Num() || Extent!=FVector(0,0,0) )
+	{
+		for( INT i=0; i<Count; i++ )
+			NumBlocked += !(Results[i] = LineCheck( Hits[i], Owner, Ends[i], Starts[i], Extent, ExtraNodeFlags ));
+		return NumBlocked;
+	}
+
+	// Trace in packets.
+	FCoords CheckCoords;
+	if( Owner )
+		CheckCoords = Owner->ToWorld();
+	for( INT First=0; First<Count; First+=FLineCheckPacket::NUM_LANES )
+		LineCheckPacket( Hits+First, Results+First, *this, Owner ? &CheckCoords : NULL, Starts+First, Ends+First, Min(Count-First,(INT)FLineCheckPacket::NUM_LANES), RootOutside, ExtraNodeFlags );
+
+	// Finish the hits the same way LineCheck does.
+	for( INT i=0; i<Count; i++ )
+	{
+		if( !Results[i] )
+		{
+			FCheckResult& Hit = Hits[i];
+			FVector V         = Ends[i]-Starts[i];
+			Hit.Time          = ((Hit.Location-Starts[i])|V)/(V|V);
+			Hit.Time          = Clamp( Hit.Time - 0.5f / V.Size(), 0.f, 1.f );
+			Hit.Location      = Starts[i] + V * Hit.Time;
+			Hit.Actor         = Owner;
+			if ( Owner )
+				Hit.Normal = Hit.Normal.TransformVectorBy(Owner->ToWorld());
+			NumBlocked++;
+		}
+	}
+	return NumBlocked;
+	unguard;
+}
+
 /*---------------------------------------------------------------------------------------
    Region determination.
 ---------------------------------------------------------------------------------------*/
@@ -759,6 +1055,92 @@ void UModel::PrecomputeSphereFilter( const FPlane &Sphere )
 	unguard;
 }
 
+/*---------------------------------------------------------------------------------------
+   Trace benchmark.
+---------------------------------------------------------------------------------------*/
+
+//
+// Trace random lines through the level's Bsp one at a time and in a batch,
+// log the rate of each and check that they agree.
+//
+ENGINE_API void GTraceBenchmark( ULevel* Level, INT NumRays, FOutputDevice* Out )
+{
+	guard(GTraceBenchmark);
+	UModel* Model = Level->Model;
+	if( !Model || !Model->Nodes->Num() || NumRays<=0 )
+	{
+		Out->Logf( NAME_ExecWarning, "No Bsp to trace" );
+		return;
+	}
+
+	// Center the lines on a pawn if there is one.
+	FVector Center(0,0,0);
+	for( INT i=0; i<Level->Num(); i++ )
+	{
+		if( Level->Actors(i) && Level->Actors(i)->IsA(APawn::StaticClass) )
+		{
+			Center = Level->Actors(i)->Location;
+			break;
+		}
+	}
+
+	// Make the lines.
+	TArray<FVector> Starts, Ends;
+	for( INT i=0; i<NumRays; i++ )
+	{
+		Starts.AddItem( Center + FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ) * 8192.0 );
+		Ends  .AddItem( Center + FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ) * 8192.0 );
+	}
+
+	// Trace them one at a time.
+	TArray<FCheckResult> ScalarHits, BatchHits;
+	TArray<UBOOL> ScalarResults, BatchResults;
+	for( INT i=0; i<NumRays; i++ )
+	{
+		new(ScalarHits)FCheckResult(1.0);
+		new(BatchHits)FCheckResult(1.0);
+		ScalarResults.AddItem( 1 );
+		BatchResults.AddItem( 1 );
+	}
+	DOUBLE StartTime = appSeconds();
+	INT ScalarBlocked = 0;
+	for( INT i=0; i<NumRays; i++ )
+		ScalarBlocked += !(ScalarResults(i) = Model->LineCheck( ScalarHits(i), NULL, Ends(i), Starts(i), FVector(0,0,0), 0 ));
+	DOUBLE ScalarTime = appSeconds() - StartTime;
+
+	// Trace them in a batch.
+	StartTime = appSeconds();
+	INT BatchBlocked = Model->LineCheckBatch( &BatchHits(0), &Starts(0), &Ends(0), NumRays, &BatchResults(0) );
+	DOUBLE BatchTime = appSeconds() - StartTime;
+
+	// Compare.
+	INT Mismatches = 0;
+	for( INT i=0; i<NumRays; i++ )
+	{
+		if( ScalarResults(i)!=BatchResults(i) )
+			Mismatches++;
+		else if( !ScalarResults(i) )
+		{
+			const FCheckResult& A = ScalarHits(i);
+			const FCheckResult& B = BatchHits(i);
+			if
+			(	appMemcmp( &A.Location, &B.Location, sizeof(FVector) )
+			||	appMemcmp( &A.Normal,   &B.Normal,   sizeof(FVector) )
+			||	appMemcmp( &A.Time,     &B.Time,     sizeof(FLOAT) )
+			||	A.Item!=B.Item )
+				Mismatches++;
+		}
+	}
+	Out->Logf( "Scalar: %i lines, %i blocked, %.0f lines/sec", NumRays, ScalarBlocked, NumRays / Max(ScalarTime,0.000001) );
+	Out->Logf( "Batch:  %i lines, %i blocked, %.0f lines/sec", NumRays, BatchBlocked,  NumRays / Max(BatchTime, 0.000001) );
+	if( Mismatches )
+		Out->Logf( NAME_ExecWarning, "Batch traces disagree with scalar traces on %i lines", Mismatches );
+	else
+		Out->Logf( "Batch traces agree" );
+
+	unguard;
+}
+
 /*---------------------------------------------------------------------------------------
    The End.
 ---------------------------------------------------------------------------------------*/
@@ -24,6 +24,16 @@ class UTcpipConnection;
 #define UDP_HEADER_SIZE    (IP_HEADER_SIZE+8)
 #define WINSOCK_MAX_PACKET (512)
 
+// Whether recvmmsg and sendmmsg can move several packets per call.
+#if defined(__linux__) && !defined(PLATFORM_PSVITA)
+#define IPDRV_MMSG 1
+#else
+#define IPDRV_MMSG 0
+#endif
+
+// Most packets moved per batched socket call.
+enum {NET_BATCH=64};
+
 // Linked list of drivers.
 static TArray<UTcpNetDriver*> GDrivers;
 UBOOL GInitialized;
@@ -79,12 +89,45 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 {
 	DECLARE_CLASS(UTcpNetDriver,UNetDriver,CLASS_Transient|CLASS_Config)
 
+	// A packet waiting to be sent.
+	struct FOutPacket
+	{
+		sockaddr_in	Addr;
+		INT			Num;
+		BYTE		Data[UNetConnection::MAX_PACKET_SIZE];
+	};
+
+	// A received packet.
+	struct FInPacket
+	{
+		sockaddr_in	Addr;
+		INT			Num;
+		BYTE		Data[UNetConnection::MAX_PACKET_SIZE];
+	};
+
 	// Variables.
 	sockaddr_in	LocalAddr;
 	SOCKET		Socket;
 	in_addr		HostAddr;
 	char		HostName[256];
 
+	// Client connections by address.
+	TMap<QWORD,UTcpipConnection*> ConnectionMap;
+
+	// Batched packets.
+	UBOOL		UseMmsg;
+	UBOOL		BatchSends;
+	FInPacket*	InPackets;
+	FOutPacket*	OutPackets;
+	INT			NumOutPackets;
+
+	// Stats since the last SOCKETSTATS.
+	INT			PacketsIn, PacketsOut, RecvCalls, SendCalls, StatTicks;
+	DOUBLE		StatTime;
+
+	// Loopback load generator.
+	class FNetLoadGenerator* Load;
+
 	// Constructor.
 
 	// UObject interface.
@@ -93,6 +136,7 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 	// UNetDriver interface.
 	UBOOL Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& ConnectURL, char* Error256 );
 	void Tick();
+	void TickFlush();
 	UBOOL IsInternet() {return 1;}
 
 	// FExec interface.
@@ -100,6 +144,16 @@ class DLL_EXPORT UTcpNetDriver : public UNetDriver
 
 	// UTcpNetDriver interface.
 	UTcpipConnection* GetServerConnection() {return (UTcpipConnection*)ServerConnection;}
+	UBOOL SendPacket( sockaddr_in& Addr, BYTE* Data, INT Num );
+	void FlushPackets();
+	INT ReceivePackets();
+	void DispatchPacket( FInPacket& Packet );
+	static QWORD AddrKey( const sockaddr_in& Addr )
+	{
+		DWORD Ip;
+		IpGetInt( Addr.sin_addr, Ip );
+		return ((QWORD)Ip << 16) | ntohs(Addr.sin_port);
+	}
 };
 IMPLEMENT_CLASS(UTcpNetDriver);
 
@@ -171,6 +225,9 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 			Channels[0]->Close();
 			FlushNet();
 		}
+		UTcpipConnection** Mapped = GetDriver()->ConnectionMap.Find( UTcpNetDriver::AddrKey(RemoteAddr) );
+		if( Mapped && *Mapped==this )
+			GetDriver()->ConnectionMap.Remove( UTcpNetDriver::AddrKey(RemoteAddr) );
 		Super::Destroy();
 		unguard;
 	}
@@ -188,7 +245,7 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 		{
 			if( Driver->Time - (*Q)->Time > SimLatency/1000.0 )
 			{
-				sendto( GetDriver()->Socket, (char*)(*Q)->Data, (*Q)->Num, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) );
+				GetDriver()->SendPacket( RemoteAddr, (*Q)->Data, (*Q)->Num );
 				FLatentQueue* Next = (*Q)->Next;
 				delete *Q;
 				*Q = Next;
@@ -249,14 +306,14 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 				// Send now.
 				if(	!SimPacketLoss || 100*appFrand()>SimPacketLoss )
 				{
-					if( sendto( GetDriver()->Socket, (char*)OutData, OutNum, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) )!=OutNum )
+					if( !GetDriver()->SendPacket( RemoteAddr, OutData, OutNum ) )
 						debugf( NAME_DevNet, "Failed to send UDP packet" );
 				}
 				if( Duplicate )
 				{
 					// Send a copy in case packets were lost.
 					if(	!SimPacketLoss || 100*appFrand()>SimPacketLoss )
-						sendto( GetDriver()->Socket, (char*)OutData, OutNum, 0, (sockaddr*)&RemoteAddr, sizeof(RemoteAddr) );
+						GetDriver()->SendPacket( RemoteAddr, OutData, OutNum );
 					QueuedBytes += OutNum + UDP_HEADER_SIZE;
 				}
 			}
@@ -310,6 +367,94 @@ class DLL_EXPORT UTcpipConnection : public UNetConnection
 };
 IMPLEMENT_CLASS(UTcpipConnection);
 
+/*-----------------------------------------------------------------------------
+	FNetLoadGenerator.
+-----------------------------------------------------------------------------*/
+
+//
+// Loopback load generator for measuring a server's socket code without a
+// network. Each fake client has its own socket and sends packets to the
+// server every tick. A packet holds a close request for a channel that was
+// never opened, which the server acknowledges, so each client also gets a
+// reply every tick.
+//
+class FNetLoadGenerator
+{
+public:
+	// Variables.
+	TArray<SOCKET>	Sockets;
+	sockaddr_in		ServerAddr;
+	INT				Rate;
+	INT				Sent;
+	INT				Received;
+
+	// Constructor.
+	FNetLoadGenerator( const sockaddr_in& InServerAddr, INT NumClients, INT InRate )
+	:	ServerAddr	( InServerAddr )
+	,	Rate		( InRate )
+	,	Sent		( 0 )
+	,	Received	( 0 )
+	{
+		guard(FNetLoadGenerator::FNetLoadGenerator);
+		for( INT i=0; i<NumClients; i++ )
+		{
+			SOCKET Client = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+			if( Client==(SOCKET)-1 )
+			{
+				debugf( NAME_Warning, "NETLOAD: socket failed (%s)", SocketError() );
+				break;
+			}
+			sockaddr_in Addr;
+			appMemset( &Addr, 0, sizeof(Addr) );
+			Addr.sin_family = AF_INET;
+			IpSetInt( Addr.sin_addr, htonl(INADDR_LOOPBACK) );
+			DWORD NoBlock=1;
+			if( bind( Client, (sockaddr*)&Addr, sizeof(Addr) )
+#ifndef PSP
+			||	ioctlsocket( Client, FIONBIO, &NoBlock )
+#endif
+			)
+			{
+				debugf( NAME_Warning, "NETLOAD: bind failed (%s)", SocketError() );
+				closesocket( Client );
+				break;
+			}
+			Sockets.AddItem( Client );
+		}
+		unguard;
+	}
+
+	// Destructor.
+	~FNetLoadGenerator()
+	{
+		guard(FNetLoadGenerator::~FNetLoadGenerator);
+		for( INT i=0; i<Sockets.Num(); i++ )
+			closesocket( Sockets(i) );
+		unguard;
+	}
+
+	// Send this tick's packets and drain the replies.
+	void Tick()
+	{
+		guard(FNetLoadGenerator::Tick);
+		FBunch Close;
+		appMemset( &Close, 0, sizeof(Close) );
+		Close.ChIndex  = 1 | CHF_Close;
+		Close.Sequence = SEQ_None;
+		Close._ChType  = CHTYPE_Actor;
+		BYTE Data[UNetConnection::MAX_PACKET_SIZE];
+		for( INT i=0; i<Sockets.Num(); i++ )
+		{
+			for( INT j=0; j<Rate; j++ )
+				if( sendto( Sockets(i), (char*)&Close, sizeof(Close), 0, (sockaddr*)&ServerAddr, sizeof(ServerAddr) )==sizeof(Close) )
+					Sent++;
+			while( recv( Sockets(i), (char*)Data, sizeof(Data), 0 )>=0 )
+				Received++;
+		}
+		unguard;
+	}
+};
+
 /*-----------------------------------------------------------------------------
 	UTcpNetDriver init and exit.
 -----------------------------------------------------------------------------*/
@@ -429,6 +574,17 @@ UBOOL UTcpNetDriver::Init( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, c
 #ifndef PSP
 	}
 #endif
+	// Batch packets where the platform can, and queue a server's outgoing
+	// packets until the end of the tick.
+	UseMmsg       = IPDRV_MMSG && !ParseParam(appCmdLine(),"NOMMSG");
+	BatchSends    = !Connect;
+	InPackets     = (FInPacket *)appMalloc( NET_BATCH*sizeof(FInPacket ), "UTcpNetDriverIn"  );
+	OutPackets    = (FOutPacket*)appMalloc( NET_BATCH*sizeof(FOutPacket), "UTcpNetDriverOut" );
+	NumOutPackets = 0;
+	PacketsIn     = PacketsOut = RecvCalls = SendCalls = StatTicks = 0;
+	StatTime      = appSeconds();
+	Load          = NULL;
+
 	// Connect to remote.
 	if( Connect )
 	{
@@ -519,6 +675,21 @@ void UTcpNetDriver::Destroy()
 		delete Connections( 0 );
 	unguard;
 
+	// Stop generating load, and send any goodbyes.
+	if( Load )
+	{
+		delete Load;
+		Load = NULL;
+	}
+	if( Socket )
+		FlushPackets();
+	if( InPackets )
+		appFree( InPackets );
+	if( OutPackets )
+		appFree( OutPackets );
+	InPackets  = NULL;
+	OutPackets = NULL;
+
 	// Remove from linked list of drivers.
 	GDrivers.RemoveItem( this );
 
@@ -548,70 +719,22 @@ void UTcpNetDriver::Tick()
 
 	// Get new time.
 	Time = appSeconds();
+	StatTicks++;
+
+	// Send anything left over from outside the tick.
+	FlushPackets();
+	if( Load )
+		Load->Tick();
 
 	// Process all incoming packets.
-	BYTE Data[UNetConnection::MAX_PACKET_SIZE];
-	sockaddr_in FromAddr;
-	INT Count=0;
-	while( 1 )
+	INT Num;
+	while( (Num=ReceivePackets())>0 )
 	{
-		// Get data, if any.
-		socklen_t FromSize = sizeof(FromAddr);
-		INT Size = recvfrom( Socket, (char*)Data, sizeof(Data), 0, (sockaddr*)&FromAddr, &FromSize );
-
-		// Handle result.
-		if( Size==SOCKET_ERROR && WSAGetLastError()==WSAEWOULDBLOCK )
-		{
+		for( INT i=0; i<Num; i++ )
+			DispatchPacket( InPackets[i] );
+		if( UseMmsg && Num<NET_BATCH )
 			break;
-		}
-		else if( Size==SOCKET_ERROR )
-		{
-			static UBOOL FirstError=1;
-			if( FirstError )
-				debugf( "UDP recvfrom error: %s", SocketError() );
-			FirstError=0;
-		}
-		Count++;
-
-		// Figure out which socket it came from.
-		UTcpipConnection* Connection=NULL;
-		if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,FromAddr) )
-			Connection = GetServerConnection();
-		for( INT i=0; i<Connections.Num() && !Connection; i++ )
-			if( IpMatches( ((UTcpipConnection*)Connections(i))->RemoteAddr, FromAddr ) )
-				Connection = (UTcpipConnection*)Connections(i);
-
-		// If we didn't find a connection, maybe create a new one.		
-		if( Connection==NULL )
-		{
-			// Notify the server that the connection was created.
-			if( Notify->NotifyAcceptingConnection()!=ACCEPTC_Accept )
-				continue;
-
-			// Create connection.
-			Connection = new UTcpipConnection( this, FromAddr, USOCK_Open, 0 );
-			char Temp[256];
-			appSprintf
-			(
-				Temp,
-				"%i.%i.%i.%i",
-				IPBYTE(FromAddr.sin_addr, 1),
-				IPBYTE(FromAddr.sin_addr, 2),
-				IPBYTE(FromAddr.sin_addr, 3),
-				IPBYTE(FromAddr.sin_addr, 4)
-			);
-			Connection->URL.Host = Temp;//!!format
-			Notify->NotifyAcceptedConnection( Connection );
-			Connections.AddItem( Connection );
-		}
-
-		// Send the packet to the connection for processing.
-		//warning: ReceivedPacket may destroy Connection.
-		debugfSlow( NAME_DevNetTraffic, "%03i: Received %i", (INT)(appSeconds()*1000)%1000, Size );
-		Connection->LastReceiveTime = Time;
-		Connection->ReceivedPacket( Data, Size );
 	}
-	//debugf( "%i", Count );
 
 	// Poll all sockets.
 	if( GetServerConnection() )
@@ -622,6 +745,235 @@ void UTcpNetDriver::Tick()
 	unguard;
 }
 
+//
+// Send the packets that were queued during the tick.
+//
+void UTcpNetDriver::TickFlush()
+{
+	guard(UTcpNetDriver::TickFlush);
+	FlushPackets();
+	unguard;
+}
+
+//
+// Hand a received packet to the connection it came from, creating the
+// connection if it's new.
+//
+void UTcpNetDriver::DispatchPacket( FInPacket& Packet )
+{
+	guard(UTcpNetDriver::DispatchPacket);
+
+	// Figure out which socket it came from.
+	UTcpipConnection* Connection=NULL;
+	if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,Packet.Addr) )
+		Connection = GetServerConnection();
+	if( !Connection )
+	{
+		UTcpipConnection** Mapped = ConnectionMap.Find( AddrKey(Packet.Addr) );
+		if( Mapped )
+			Connection = *Mapped;
+	}
+
+	// If we didn't find a connection, maybe create a new one.
+	if( Connection==NULL )
+	{
+		// Notify the server that the connection was created.
+		if( Notify->NotifyAcceptingConnection()!=ACCEPTC_Accept )
+			return;
+
+		// Create connection.
+		Connection = new UTcpipConnection( this, Packet.Addr, USOCK_Open, 0 );
+		char Temp[256];
+		appSprintf
+		(
+			Temp,
+			"%i.%i.%i.%i",
+			IPBYTE(Packet.Addr.sin_addr, 1),
+			IPBYTE(Packet.Addr.sin_addr, 2),
+			IPBYTE(Packet.Addr.sin_addr, 3),
+			IPBYTE(Packet.Addr.sin_addr, 4)
+		);
+		Connection->URL.Host = Temp;//!!format
+		Notify->NotifyAcceptedConnection( Connection );
+		Connections.AddItem( Connection );
+		ConnectionMap.Add( AddrKey(Packet.Addr), Connection );
+	}
+
+	// Send the packet to the connection for processing.
+	//warning: ReceivedPacket may destroy Connection.
+	debugfSlow( NAME_DevNetTraffic, "%03i: Received %i", (INT)(appSeconds()*1000)%1000, Packet.Num );
+	Connection->LastReceiveTime = Time;
+	Connection->ReceivedPacket( Packet.Data, Packet.Num );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	UTcpNetDriver packet batching.
+-----------------------------------------------------------------------------*/
+
+//
+// Whether the last socket call failed only because it would have blocked.
+//
+static UBOOL SocketWouldBlock()
+{
+#ifdef PLATFORM_WIN32
+	return WSAGetLastError()==WSAEWOULDBLOCK;
+#else
+	return errno==EAGAIN || errno==EWOULDBLOCK;
+#endif
+}
+
+//
+// Read up to NET_BATCH packets into InPackets, returning how many were read.
+//
+INT UTcpNetDriver::ReceivePackets()
+{
+	guard(UTcpNetDriver::ReceivePackets);
+	for( ;; )
+	{
+#if IPDRV_MMSG
+		if( UseMmsg )
+		{
+			mmsghdr Headers[NET_BATCH];
+			iovec   Vectors[NET_BATCH];
+			appMemset( Headers, 0, sizeof(Headers) );
+			for( INT i=0; i<NET_BATCH; i++ )
+			{
+				Vectors[i].iov_base            = InPackets[i].Data;
+				Vectors[i].iov_len             = sizeof(InPackets[i].Data);
+				Headers[i].msg_hdr.msg_name    = &InPackets[i].Addr;
+				Headers[i].msg_hdr.msg_namelen = sizeof(InPackets[i].Addr);
+				Headers[i].msg_hdr.msg_iov     = &Vectors[i];
+				Headers[i].msg_hdr.msg_iovlen  = 1;
+			}
+			RecvCalls++;
+			INT Num = recvmmsg( Socket, Headers, NET_BATCH, MSG_DONTWAIT, NULL );
+			if( Num>=0 )
+			{
+				for( INT i=0; i<Num; i++ )
+					InPackets[i].Num = Headers[i].msg_len;
+				PacketsIn += Num;
+				return Num;
+			}
+			if( errno==ENOSYS )
+			{
+				debugf( NAME_Log, "UDP recvmmsg unavailable, receiving one packet at a time" );
+				UseMmsg = 0;
+				continue;
+			}
+		}
+		else
+#endif
+		{
+			socklen_t FromSize = sizeof(InPackets[0].Addr);
+			RecvCalls++;
+			INT Size = recvfrom( Socket, (char*)InPackets[0].Data, sizeof(InPackets[0].Data), 0, (sockaddr*)&InPackets[0].Addr, &FromSize );
+			if( Size>=0 )
+			{
+				InPackets[0].Num = Size;
+				PacketsIn++;
+				return 1;
+			}
+		}
+
+		// Handle errors. Errors reported for earlier packets, such as
+		// unreachable ports, are skipped.
+		if( SocketWouldBlock() )
+			return 0;
+		static UBOOL FirstError=1;
+		if( FirstError )
+			debugf( "UDP recvfrom error: %s", SocketError() );
+		FirstError=0;
+#ifdef PLATFORM_WIN32
+		if( WSAGetLastError()!=WSAECONNRESET )
+			return 0;
+#else
+		if( errno!=ECONNREFUSED )
+			return 0;
+#endif
+	}
+	unguard;
+}
+
+//
+// Send a packet, or queue it if this driver batches its sends.
+//
+UBOOL UTcpNetDriver::SendPacket( sockaddr_in& Addr, BYTE* Data, INT Num )
+{
+	guard(UTcpNetDriver::SendPacket);
+	check(Num<=UNetConnection::MAX_PACKET_SIZE);
+	if( !BatchSends )
+	{
+		SendCalls++;
+		PacketsOut++;
+		return sendto( Socket, (char*)Data, Num, 0, (sockaddr*)&Addr, sizeof(Addr) )==Num;
+	}
+	if( NumOutPackets==NET_BATCH )
+		FlushPackets();
+	FOutPacket& Packet = OutPackets[NumOutPackets++];
+	Packet.Addr = Addr;
+	Packet.Num  = Num;
+	appMemcpy( Packet.Data, Data, Num );
+	return 1;
+	unguard;
+}
+
+//
+// Send all queued packets.
+//
+void UTcpNetDriver::FlushPackets()
+{
+	guard(UTcpNetDriver::FlushPackets);
+	INT Sent = 0;
+#if IPDRV_MMSG
+	if( UseMmsg && NumOutPackets>0 )
+	{
+		mmsghdr Headers[NET_BATCH];
+		iovec   Vectors[NET_BATCH];
+		appMemset( Headers, 0, sizeof(Headers) );
+		for( INT i=0; i<NumOutPackets; i++ )
+		{
+			Vectors[i].iov_base            = OutPackets[i].Data;
+			Vectors[i].iov_len             = OutPackets[i].Num;
+			Headers[i].msg_hdr.msg_name    = &OutPackets[i].Addr;
+			Headers[i].msg_hdr.msg_namelen = sizeof(OutPackets[i].Addr);
+			Headers[i].msg_hdr.msg_iov     = &Vectors[i];
+			Headers[i].msg_hdr.msg_iovlen  = 1;
+		}
+		while( Sent<NumOutPackets )
+		{
+			SendCalls++;
+			INT Num = sendmmsg( Socket, Headers+Sent, NumOutPackets-Sent, 0 );
+			if( Num>0 )
+			{
+				Sent += Num;
+			}
+			else if( errno==ENOSYS )
+			{
+				debugf( NAME_Log, "UDP sendmmsg unavailable, sending one packet at a time" );
+				UseMmsg = 0;
+				break;
+			}
+			else
+			{
+				// Drop the packet that failed, as sendto would.
+				debugfSlow( NAME_DevNet, "Failed to send UDP packet" );
+				Sent++;
+			}
+		}
+	}
+#endif
+	for( ; Sent<NumOutPackets; Sent++ )
+	{
+		SendCalls++;
+		if( sendto( Socket, (char*)OutPackets[Sent].Data, OutPackets[Sent].Num, 0, (sockaddr*)&OutPackets[Sent].Addr, sizeof(OutPackets[Sent].Addr) )!=OutPackets[Sent].Num )
+			debugfSlow( NAME_DevNet, "Failed to send UDP packet" );
+	}
+	PacketsOut   += NumOutPackets;
+	NumOutPackets = 0;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	UTcpNetDriver command line.
 -----------------------------------------------------------------------------*/
@@ -656,6 +1008,54 @@ INT UTcpNetDriver::Exec( const char* Cmd, FOutputDevice* Out )
 		}
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,"SOCKETSTATS") )
+	{
+		DOUBLE Seconds = Max( appSeconds()-StatTime, 0.001 );
+		INT    Ticks   = Max( StatTicks, 1 );
+		Out->Logf
+		(
+			"UDP: %i connections, %.0f packets/sec in, %.0f out, %.2f recv + %.2f send calls/tick, batching %s",
+			Connections.Num(),
+			PacketsIn/Seconds,
+			PacketsOut/Seconds,
+			(FLOAT)RecvCalls/Ticks,
+			(FLOAT)SendCalls/Ticks,
+			UseMmsg ? "recvmmsg/sendmmsg" : "off"
+		);
+		if( Load )
+			Out->Logf( "NETLOAD: %i clients sent %i packets, got %i replies", Load->Sockets.Num(), Load->Sent, Load->Received );
+		PacketsIn = PacketsOut = RecvCalls = SendCalls = StatTicks = 0;
+		StatTime  = appSeconds();
+		if( Load )
+			Load->Sent = Load->Received = 0;
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,"NETLOAD") )
+	{
+		if( Load )
+		{
+			delete Load;
+			Load = NULL;
+		}
+		if( ParseCommand(&Cmd,"STOP") )
+		{
+			Out->Logf( "NETLOAD stopped" );
+			return 1;
+		}
+		if( ServerConnection )
+		{
+			Out->Logf( "NETLOAD only works on a server" );
+			return 1;
+		}
+		INT NumClients=16, Rate=1;
+		Parse( Cmd, "CLIENTS=", NumClients );
+		Parse( Cmd, "RATE=", Rate );
+		sockaddr_in ServerAddr = LocalAddr;
+		IpSetInt( ServerAddr.sin_addr, htonl(INADDR_LOOPBACK) );
+		Load = new FNetLoadGenerator( ServerAddr, Clamp(NumClients,1,1024), Clamp(Rate,1,64) );
+		Out->Logf( "NETLOAD: %i fake clients sending %i packets/tick each to port %i", Load->Sockets.Num(), Load->Rate, ntohs(ServerAddr.sin_port) );
+		return 1;
+	}
 	else if( ParseCommand(&Cmd,"URL") )
 	{
 		FURL URL(NULL,Cmd,TRAVEL_Absolute);
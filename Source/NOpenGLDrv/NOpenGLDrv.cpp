@@ -34,6 +34,15 @@ IMPLEMENT_CLASS(UNOpenGLRenderDevice);
 
 // and it also would be nice to overbright them
 #define LIGHTMAP_OVERBRIGHT 1.4f
+// max vertices in a single draw call
+#define MAX_VERTS 16384
+
+// lightmap/fogmap atlas pages; bound pages are tagged with an otherwise unused cache bit
+#define ATLAS_TEXTURE_TAG (1ULL << 61)
+#define ATLAS_PAGE_SIZE 1024
+#define ATLAS_MAX_PAGES 8
+#define ATLAS_PADDING 1
+
 #ifndef PSP
 #define GL_CHECK_EXT(ext) GLAD_GL_ ## ext
 #define GL_CHECK_VER(maj, min) (((maj) * 10 + (min)) <= (GLVersion.major * 10 + GLVersion.minor))
@@ -44,6 +53,7 @@ void UNOpenGLRenderDevice::InternalClassInitializer( UClass* Class )
 	new(Class, "NoFiltering",  RF_Public)UBoolProperty( CPP_PROPERTY(NoFiltering),  "Options", CPF_Config );
 	new(Class, "UseHwPalette", RF_Public)UBoolProperty( CPP_PROPERTY(UseHwPalette), "Options", CPF_Config );
 	new(Class, "UseBGRA",      RF_Public)UBoolProperty( CPP_PROPERTY(UseBGRA),      "Options", CPF_Config );
+	new(Class, "UseLightmapAtlas", RF_Public)UBoolProperty( CPP_PROPERTY(UseLightmapAtlas), "Options", CPF_Config );
 	unguardSlow;
 }
 
@@ -52,6 +62,7 @@ UNOpenGLRenderDevice::UNOpenGLRenderDevice()
 	NoFiltering = false;
 	UseHwPalette = true;
 	UseBGRA = true;
+	UseLightmapAtlas = true;
 }
 
 UBOOL UNOpenGLRenderDevice::Init( UViewport* InViewport )
@@ -97,6 +108,30 @@ UBOOL UNOpenGLRenderDevice::Init( UViewport* InViewport )
 	Compose = (BYTE*)appMalloc( ComposeSize, "GLComposeBuf" );
 	verify( Compose );
 
+	VtxData = (FGLVertex*)appMalloc( MAX_VERTS * sizeof(FGLVertex), "GLVtxDataBuf" );
+	verify( VtxData );
+	VtxDataEnd = VtxData + MAX_VERTS;
+	VtxDataPtr = VtxData;
+
+	// A fan of N verts makes N-2 triangles, so this covers any mix of polys.
+	IdxData = (GLushort*)appMalloc( MAX_VERTS * 3 * sizeof(GLushort), "GLIdxDataBuf" );
+	verify( IdxData );
+	IdxDataEnd = IdxData + MAX_VERTS * 3;
+	IdxDataPtr = IdxData;
+	IdxCount = 0;
+	VtxColor = FPlane( 1.f, 1.f, 1.f, 1.f );
+	appMemset( &Stats, 0, sizeof(Stats) );
+	appMemset( &LastStats, 0, sizeof(LastStats) );
+
+	GLint MaxTextureSize = 0;
+	glGetIntegerv( GL_MAX_TEXTURE_SIZE, &MaxTextureSize );
+	AtlasSize = Min( (INT)MaxTextureSize, ATLAS_PAGE_SIZE );
+	if( UseLightmapAtlas && AtlasSize < 256 )
+	{
+		debugf( NAME_Warning, "Max texture size %d too small for lightmap atlas, disabling UseLightmapAtlas", MaxTextureSize );
+		UseLightmapAtlas = false;
+	}
+
 	// Set modelview matrix to flip stuff into our coordinate system.
 	const FLOAT Matrix[16] =
 	{
@@ -119,6 +154,14 @@ UBOOL UNOpenGLRenderDevice::Init( UViewport* InViewport )
 	glEnable( GL_BLEND );
 	glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
 
+	// The arrays never move, so point GL at them once.
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, sizeof(FGLVertex), &VtxData->X );
+	glTexCoordPointer( 2, GL_FLOAT, sizeof(FGLVertex), &VtxData->U );
+	glColorPointer( 4, GL_FLOAT, sizeof(FGLVertex), &VtxData->R );
+
 	CurrentPolyFlags = PF_Occlude;
 	Viewport = InViewport;
 
@@ -141,6 +184,17 @@ void UNOpenGLRenderDevice::Exit()
 	}
 	ComposeSize = 0;
 
+	if( VtxData )
+	{
+		appFree( VtxData );
+		VtxData = VtxDataPtr = VtxDataEnd = NULL;
+	}
+	if( IdxData )
+	{
+		appFree( IdxData );
+		IdxData = IdxDataPtr = IdxDataEnd = NULL;
+	}
+
 	unguard;
 }
 
@@ -148,18 +202,34 @@ void UNOpenGLRenderDevice::Flush()
 {
 	guard(UNOpenGLRenderDevice::Flush);
 
-	if( TexAlloc.Num() )
+	if( VtxData )
+		FlushTriangles();
+
+	if( TexAlloc.Num() || AtlasPages.Num() )
 	{
-		debugf( NAME_Log, "Flushing %d/%d textures", TexAlloc.Num(), BindMap.Size() );
 		ResetTexture( 0 );
 		ResetTexture( 1 );
 		ResetTexture( 2 );
 		glFinish();
+	}
+
+	if( TexAlloc.Num() )
+	{
+		debugf( NAME_Log, "Flushing %d/%d textures", TexAlloc.Num(), BindMap.Size() );
 		glDeleteTextures( TexAlloc.Num(), &TexAlloc(0) );
 		TexAlloc.Empty();
 		BindMap.Empty();
 	}
 
+	if( AtlasPages.Num() )
+	{
+		debugf( NAME_Log, "Flushing %d lightmap atlas pages", AtlasPages.Num() );
+		FlushAtlas();
+		for( INT i = 0; i < AtlasPages.Num(); i++ )
+			glDeleteTextures( 1, &AtlasPages(i).Id );
+		AtlasPages.Empty();
+	}
+
 	unguard;
 }
 
@@ -172,6 +242,10 @@ void UNOpenGLRenderDevice::Lock( FPlane FlashScale, FPlane FlashFog, FPlane Scre
 {
 	guard(UNOpenGLRenderDevice::Lock);
 
+	FlushTriangles();
+	LastStats = Stats;
+	appMemset( &Stats, 0, sizeof(Stats) );
+
 	glClearColor( 1.f, ScreenClear.Y, ScreenClear.Z, ScreenClear.W );
 	glClearDepth( 1.0 );
 	glDepthFunc( GL_LEQUAL );
@@ -194,6 +268,7 @@ void UNOpenGLRenderDevice::Unlock( UBOOL Blit )
 {
 	guard(UNOpenGLRenderDevice::Unlock);
 
+	FlushTriangles();
 	glFlush();
 
 	unguard;
@@ -213,42 +288,19 @@ void UNOpenGLRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo&
 	// Draw texture.
 	SetBlend( Surface.PolyFlags );
 	SetTexture( 0, *Surface.Texture, ( Surface.PolyFlags & PF_Masked ), 0.f );
-	glColor4f( 1.f, 1.f, 1.f, 1.f );
-	for( FSavedPoly* Poly = Facet.Polys; Poly; Poly = Poly->Next )
-	{
-		glBegin( GL_TRIANGLE_FAN );
-		for( INT i = 0; i < Poly->NumPts; i++ )
-		{
-			FLOAT U = Facet.MapCoords.XAxis | Poly->Pts[i]->Point;
-			FLOAT V = Facet.MapCoords.YAxis | Poly->Pts[i]->Point;
-			glTexCoord2f( (U-UDot-TexInfo[0].UPan)*TexInfo[0].UMult, (V-VDot-TexInfo[0].VPan)*TexInfo[0].VMult );
-			glVertex3f( Poly->Pts[i]->Point.X, Poly->Pts[i]->Point.Y, Poly->Pts[i]->Point.Z );
-		}
-		glEnd();
-	}
+	VtxColor = FPlane( 1.f, 1.f, 1.f, 1.f );
+	BufferFacet( Facet, UDot, VDot );
 
 	// Draw lightmap.
 	if( Surface.LightMap )
 	{
 		SetBlend( PF_Modulated );
 		if( Surface.PolyFlags & PF_Masked )
-			glDepthFunc( GL_EQUAL );
-		SetTexture( 0, *Surface.LightMap, 0, -0.5 );
-		glColor4f( 1.f, 1.f, 1.f, 1.f );
-		for( FSavedPoly* Poly = Facet.Polys; Poly; Poly = Poly->Next )
-		{
-			glBegin( GL_TRIANGLE_FAN );
-			for( INT i = 0; i < Poly->NumPts; i++ )
-			{
-				FLOAT U = Facet.MapCoords.XAxis | Poly->Pts[i]->Point;
-				FLOAT V = Facet.MapCoords.YAxis | Poly->Pts[i]->Point;
-				glTexCoord2f( (U-UDot-TexInfo[0].UPan)*TexInfo[0].UMult, (V-VDot-TexInfo[0].VPan)*TexInfo[0].VMult );
-				glVertex3f( Poly->Pts[i]->Point.X, Poly->Pts[i]->Point.Y, Poly->Pts[i]->Point.Z );
-			}
-			glEnd();
-		}
+			SetDepthFunc( GL_EQUAL );
+		SetAtlasTexture( 0, *Surface.LightMap, -0.5 );
+		BufferFacet( Facet, UDot, VDot );
 		if( Surface.PolyFlags & PF_Masked )
-			glDepthFunc( GL_LEQUAL );
+			SetDepthFunc( GL_LEQUAL );
 	}
 
 	// Draw fog.
@@ -256,22 +308,11 @@ void UNOpenGLRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo&
 	{
 		SetBlend( PF_Highlighted );
 		if( Surface.PolyFlags & PF_Masked )
-			glDepthFunc( GL_EQUAL );
-		SetTexture( 0, *Surface.FogMap, 0, -0.5 );
-		for( FSavedPoly* Poly = Facet.Polys; Poly; Poly = Poly->Next )
-		{
-			glBegin( GL_TRIANGLE_FAN );
-			for( INT i = 0; i < Poly->NumPts; i++ )
-			{
-				FLOAT U = Facet.MapCoords.XAxis | Poly->Pts[i]->Point;
-				FLOAT V = Facet.MapCoords.YAxis | Poly->Pts[i]->Point;
-				glTexCoord2f( (U-UDot-TexInfo[0].UPan)*TexInfo[0].UMult, (V-VDot-TexInfo[0].VPan)*TexInfo[0].VMult );
-				glVertex3f( Poly->Pts[i]->Point.X, Poly->Pts[i]->Point.Y, Poly->Pts[i]->Point.Z );
-			}
-			glEnd();
-		}
+			SetDepthFunc( GL_EQUAL );
+		SetAtlasTexture( 0, *Surface.FogMap, -0.5 );
+		BufferFacet( Facet, UDot, VDot );
 		if( Surface.PolyFlags & PF_Masked )
-			glDepthFunc( GL_LEQUAL );
+			SetDepthFunc( GL_LEQUAL );
 	}
 
 	unguard;
@@ -288,31 +329,30 @@ void UNOpenGLRenderDevice::DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo&
 		const UBOOL IsModulated = ( PolyFlags & PF_Modulated );
 
 		if( IsModulated )
-			glColor4f( 1.f, 1.f, 1.f, 1.f );
+			VtxColor = FPlane( 1.f, 1.f, 1.f, 1.f );
 
-		glBegin( GL_TRIANGLE_FAN  );
+		BeginPoly( NumPts );
 		for( INT i=0; i<NumPts; i++ )
 		{
 			FTransTexture* P = Pts[i];
 			if( !IsModulated )
-				glColor4f( P->Light.X, P->Light.Y, P->Light.Z, 1.f );
-			glTexCoord2f( P->U*TexInfo[0].UMult, P->V*TexInfo[0].VMult );
-			glVertex3f( P->Point.X, P->Point.Y, P->Point.Z );
+				VtxColor = FPlane( P->Light.X, P->Light.Y, P->Light.Z, 1.f );
+			PolyVertex( P->Point.X, P->Point.Y, P->Point.Z, P->U*TexInfo[0].UMult, P->V*TexInfo[0].VMult );
 		}
-		glEnd();
+		EndPoly();
 
 		if( (PolyFlags & (PF_RenderFog|PF_Translucent|PF_Modulated)) == PF_RenderFog )
 		{
 			ResetTexture( 0 );
 			SetBlend( PF_Highlighted );
-			glBegin( GL_TRIANGLE_FAN );
+			BeginPoly( NumPts );
 			for( INT i = 0; i < NumPts; i++ )
 			{
 				FTransTexture* P = Pts[i];
-				glColor4f( P->Fog.X, P->Fog.Y, P->Fog.Z, P->Fog.W );
-				glVertex3f( P->Point.X, P->Point.Y, P->Point.Z );
+				VtxColor = P->Fog;
+				PolyVertex( P->Point.X, P->Point.Y, P->Point.Z, 0.f, 0.f );
 			}
-			glEnd();
+			EndPoly();
 		}
 
 		unguard;
@@ -327,20 +367,16 @@ void UNOpenGLRenderDevice::DrawTile( FSceneNode* Frame, FTextureInfo& Texture, F
 	SetTexture( 0, Texture, ( PolyFlags & PF_Masked ), 0.f );
 
 	if( PolyFlags & PF_Modulated )
-		glColor4f( 1.f, 1.f, 1.f, 1.f );
+		VtxColor = FPlane( 1.f, 1.f, 1.f, 1.f );
 	else
-		glColor4f( Light.X, Light.Y, Light.Z, 1.f );
-
-	glBegin( GL_TRIANGLE_FAN );
-		glTexCoord2f( (U   )*TexInfo[0].UMult, (V   )*TexInfo[0].VMult );
-		glVertex3f( RFX2*Z*(X   -Frame->FX2), RFY2*Z*(Y   -Frame->FY2), Z );
-		glTexCoord2f( (U+UL)*TexInfo[0].UMult, (V   )*TexInfo[0].VMult );
-		glVertex3f( RFX2*Z*(X+XL-Frame->FX2), RFY2*Z*(Y   -Frame->FY2), Z );
-		glTexCoord2f( (U+UL)*TexInfo[0].UMult, (V+VL)*TexInfo[0].VMult );
-		glVertex3f( RFX2*Z*(X+XL-Frame->FX2), RFY2*Z*(Y+YL-Frame->FY2), Z );
-		glTexCoord2f( (U   )*TexInfo[0].UMult, (V+VL)*TexInfo[0].VMult );
-		glVertex3f( RFX2*Z*(X   -Frame->FX2), RFY2*Z*(Y+YL-Frame->FY2), Z );
-	glEnd();
+		VtxColor = FPlane( Light.X, Light.Y, Light.Z, 1.f );
+
+	BeginPoly( 4 );
+		PolyVertex( RFX2*Z*(X   -Frame->FX2), RFY2*Z*(Y   -Frame->FY2), Z, (U   )*TexInfo[0].UMult, (V   )*TexInfo[0].VMult );
+		PolyVertex( RFX2*Z*(X+XL-Frame->FX2), RFY2*Z*(Y   -Frame->FY2), Z, (U+UL)*TexInfo[0].UMult, (V   )*TexInfo[0].VMult );
+		PolyVertex( RFX2*Z*(X+XL-Frame->FX2), RFY2*Z*(Y+YL-Frame->FY2), Z, (U+UL)*TexInfo[0].UMult, (V+VL)*TexInfo[0].VMult );
+		PolyVertex( RFX2*Z*(X   -Frame->FX2), RFY2*Z*(Y+YL-Frame->FY2), Z, (U   )*TexInfo[0].UMult, (V+VL)*TexInfo[0].VMult );
+	EndPoly();
 
 	unguard;
 }
@@ -371,15 +407,17 @@ void UNOpenGLRenderDevice::EndFlash( )
 	const FLOAT RFX2 = RProjZ;
 	const FLOAT RFY2 = RProjZ * Aspect;
 
+	FlushTriangles();
 	glDisable( GL_DEPTH_TEST );
 
-	glColor4fv( &ColorMod.R );
-	glBegin( GL_TRIANGLE_FAN );
-		glVertex3f( RFX2 * -Z, RFY2 * -Z, Z );
-		glVertex3f( RFX2 * +Z, RFY2 * -Z, Z );
-		glVertex3f( RFX2 * +Z, RFY2 * +Z, Z );
-		glVertex3f( RFX2 * -Z, RFY2 * +Z, Z );
-	glEnd();
+	VtxColor = ColorMod;
+	BeginPoly( 4 );
+		PolyVertex( RFX2 * -Z, RFY2 * -Z, Z, 0.f, 0.f );
+		PolyVertex( RFX2 * +Z, RFY2 * -Z, Z, 0.f, 0.f );
+		PolyVertex( RFX2 * +Z, RFY2 * +Z, Z, 0.f, 0.f );
+		PolyVertex( RFX2 * -Z, RFY2 * +Z, Z, 0.f, 0.f );
+	EndPoly();
+	FlushTriangles();
 
 	glEnable( GL_DEPTH_TEST );
 
@@ -400,7 +438,22 @@ void UNOpenGLRenderDevice::GetStats( char* Result )
 {
 	guard(UNOpenGLRenderDevice::GetStats)
 
-	if( Result ) *Result = '\0';
+	if( Result )
+	{
+		appSprintf
+		(
+			Result,
+			"GL: Draws=%i Binds=%i Verts=%i Tris=%i Polys=%i Atlas=%i/%i Uploads=%i",
+			LastStats.DrawCalls,
+			LastStats.Binds,
+			LastStats.Vertices,
+			LastStats.Triangles,
+			LastStats.Polys,
+			AtlasPages.Num(),
+			ATLAS_MAX_PAGES,
+			LastStats.AtlasUploads
+		);
+	}
 
 	unguard;
 }
@@ -409,6 +462,8 @@ void UNOpenGLRenderDevice::ReadPixels( FColor* Pixels )
 {
 	guard(UNOpenGLRenderDevice::ReadPixels);
 
+	FlushTriangles();
+
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 0 );
 	glReadPixels( 0, 0, Viewport->SizeX, Viewport->SizeY, GL_BGRA, GL_UNSIGNED_BYTE, (void*)Pixels );
 
@@ -419,6 +474,7 @@ void UNOpenGLRenderDevice::ClearZ( FSceneNode* Frame )
 {
 	guard(UNOpenGLRenderDevice::ClearZ);
 
+	FlushTriangles();
 	SetBlend( PF_Occlude );
 	glClear( GL_DEPTH_BUFFER_BIT );
 
@@ -444,6 +500,7 @@ void UNOpenGLRenderDevice::SetSceneNode( FSceneNode* Frame )
 			Frame->XB != CurrentSceneNode.XB || Frame->YB != CurrentSceneNode.YB ||
 			Viewport->SizeX != CurrentSceneNode.SizeX || Viewport->SizeY != CurrentSceneNode.SizeY )
 	{
+		FlushTriangles();
 		glViewport( Frame->XB, Viewport->SizeY - Frame->Y - Frame->YB, Frame->X, Frame->Y );
 		CurrentSceneNode.X = Frame->X;
 		CurrentSceneNode.Y = Frame->Y;
@@ -456,6 +513,7 @@ void UNOpenGLRenderDevice::SetSceneNode( FSceneNode* Frame )
 	if( Frame->FX != CurrentSceneNode.FX || Frame->FY != CurrentSceneNode.FY ||
 			Viewport->Actor->FovAngle != CurrentSceneNode.FovAngle )
 	{
+		FlushTriangles();
 		RProjZ = appTan( Viewport->Actor->FovAngle * PI / 360.0 );
 		Aspect = Frame->FY / Frame->FX;
 		RFX2 = 2.0f * RProjZ / Frame->FX;
@@ -471,6 +529,35 @@ void UNOpenGLRenderDevice::SetSceneNode( FSceneNode* Frame )
 	unguard;
 }
 
+void UNOpenGLRenderDevice::SetDepthFunc( GLenum Func )
+{
+	FlushTriangles();
+	glDepthFunc( Func );
+}
+
+void UNOpenGLRenderDevice::BufferFacet( FSurfaceFacet& Facet, FLOAT UDot, FLOAT VDot )
+{
+	guard(UNOpenGLRenderDevice::BufferFacet);
+
+	for( FSavedPoly* Poly = Facet.Polys; Poly; Poly = Poly->Next )
+	{
+		BeginPoly( Poly->NumPts );
+		for( INT i = 0; i < Poly->NumPts; i++ )
+		{
+			FLOAT U = Facet.MapCoords.XAxis | Poly->Pts[i]->Point;
+			FLOAT V = Facet.MapCoords.YAxis | Poly->Pts[i]->Point;
+			PolyVertex
+			(
+				Poly->Pts[i]->Point.X, Poly->Pts[i]->Point.Y, Poly->Pts[i]->Point.Z,
+				(U-UDot-TexInfo[0].UPan)*TexInfo[0].UMult + TexInfo[0].UOffset, (V-VDot-TexInfo[0].VPan)*TexInfo[0].VMult + TexInfo[0].VOffset
+			);
+		}
+		EndPoly();
+	}
+
+	unguard;
+}
+
 void UNOpenGLRenderDevice::SetBlend( DWORD PolyFlags, UBOOL InverseOrder )
 {
 	guard(UNOpenGLRenderDevice::SetBlend);
@@ -485,6 +572,7 @@ void UNOpenGLRenderDevice::SetBlend( DWORD PolyFlags, UBOOL InverseOrder )
 	DWORD Xor = CurrentPolyFlags ^ PolyFlags;
 	if( Xor & (PF_Translucent|PF_Modulated|PF_Invisible|PF_Occlude|PF_Masked|PF_Highlighted) )
 	{
+		FlushTriangles();
 		if( Xor&(PF_Translucent|PF_Modulated|PF_Highlighted) )
 		{
 			glEnable( GL_BLEND );
@@ -535,6 +623,7 @@ void UNOpenGLRenderDevice::ResetTexture( INT TMU )
 
 	if( TexInfo[TMU].CurrentCacheID != 0 )
 	{
+		FlushTriangles();
 		glActiveTexture( GL_TEXTURE0 + TMU );
 		glBindTexture( GL_TEXTURE_2D, 0 );
 		glDisable( GL_TEXTURE_2D );
@@ -556,6 +645,8 @@ void UNOpenGLRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFl
 	// Account for all the impact on scale normalization.
 	Tex.UMult = 1.f / (Info.UScale * static_cast<FLOAT>(Info.USize));
 	Tex.VMult = 1.f / (Info.VScale * static_cast<FLOAT>(Info.VSize));
+	Tex.UOffset = 0.f;
+	Tex.VOffset = 0.f;
 
 	// Find in cache.
 	QWORD NewCacheID = Info.CacheID;
@@ -566,6 +657,7 @@ void UNOpenGLRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFl
 		return;
 
 	// Make current.
+	FlushTriangles();
 	Tex.CurrentCacheID = NewCacheID;
 	FCachedTexture* Bind = BindMap.Find( NewCacheID );
 	FCachedTexture* OldBind = Bind;
@@ -580,6 +672,7 @@ void UNOpenGLRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFl
 	glActiveTexture( GL_TEXTURE0 + TMU );
 	glEnable( GL_TEXTURE_2D );
 	glBindTexture( GL_TEXTURE_2D, Bind->Id );
+	Stats.Binds++;
 
 	if( !OldBind || RealtimeChanged )
 	{
@@ -602,6 +695,219 @@ void UNOpenGLRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFl
 	unguard;
 }
 
+void UNOpenGLRenderDevice::SetAtlasTexture( INT TMU, FTextureInfo& Info, FLOAT PanBias )
+{
+	guard(UNOpenGLRenderDevice::SetAtlasTexture);
+
+	// Paletted, mipmapped or oversized maps go through the regular cache.
+	const FMipmap* Mip = Info.Mips[0];
+	if( !UseLightmapAtlas || Info.Palette || Info.NumMips != 1 || !Mip || !Mip->DataPtr ||
+		Mip->USize + 2*ATLAS_PADDING > AtlasSize || Mip->VSize + 2*ATLAS_PADDING > AtlasSize )
+	{
+		SetTexture( TMU, Info, 0, PanBias );
+		return;
+	}
+
+	// Find its region, allocating one if needed. If every page is full,
+	// empty the least recently used one.
+	FAtlasRegion* Region = AtlasMap.Find( Info.CacheID );
+	const UBOOL NewRegion = ( Region == NULL );
+	if( NewRegion )
+	{
+		FAtlasRegion NewRgn;
+		while( !AllocAtlasRegion( TMU, Mip->USize, Mip->VSize, NewRgn ) )
+			verify( EvictAtlasPage( TMU ) );
+		Region = AtlasMap.Add( Info.CacheID, NewRgn );
+	}
+	AtlasPages(Region->Page).LastUsed = ++AtlasClock;
+
+	// Set panning, scaled to the page and offset to the region.
+	FTexInfo& Tex = TexInfo[TMU];
+	Tex.UPan    = Info.Pan.X + PanBias*Info.UScale;
+	Tex.VPan    = Info.Pan.Y + PanBias*Info.VScale;
+	Tex.UMult   = 1.f / (Info.UScale * static_cast<FLOAT>(AtlasSize));
+	Tex.VMult   = 1.f / (Info.VScale * static_cast<FLOAT>(AtlasSize));
+	Tex.UOffset = static_cast<FLOAT>(Region->X) / static_cast<FLOAT>(AtlasSize);
+	Tex.VOffset = static_cast<FLOAT>(Region->Y) / static_cast<FLOAT>(AtlasSize);
+
+	// Bind the page if it isn't already.
+	const QWORD PageCacheID = ATLAS_TEXTURE_TAG | Region->Page;
+	if( Tex.CurrentCacheID != PageCacheID )
+	{
+		FlushTriangles();
+		glActiveTexture( GL_TEXTURE0 + TMU );
+		glEnable( GL_TEXTURE_2D );
+		glBindTexture( GL_TEXTURE_2D, AtlasPages(Region->Page).Id );
+		Tex.CurrentCacheID = PageCacheID;
+		Stats.Binds++;
+	}
+
+	// Copy new or changed maps into their region. Other regions of the page
+	// may still be referenced by batched triangles, which is fine.
+	if( NewRegion || ( Info.TextureFlags & TF_RealtimeChanged ) )
+	{
+		BYTE* UploadBuf;
+		GLenum UploadFormat;
+		GLenum InternalFormat;
+		Info.TextureFlags &= ~TF_RealtimeChanged;
+		ConvertTextureMipBGRA7777( Mip, UploadBuf, UploadFormat, InternalFormat );
+		UploadAtlasRegion( TMU, *Region, Mip->USize, Mip->VSize, UploadBuf, UploadFormat );
+		Stats.AtlasUploads++;
+	}
+
+	unguard;
+}
+
+UBOOL UNOpenGLRenderDevice::AllocAtlasRegion( INT TMU, INT USize, INT VSize, FAtlasRegion& Region )
+{
+	guard(UNOpenGLRenderDevice::AllocAtlasRegion);
+
+	// Leave a gutter all round for UploadAtlasRegion's copies of the edges.
+	const INT W = USize + 2*ATLAS_PADDING;
+	const INT H = VSize + 2*ATLAS_PADDING;
+
+	// Find the shortest shelf this fits on.
+	INT Best = INDEX_NONE;
+	for( INT i = 0; i < AtlasShelves.Num(); i++ )
+	{
+		const FAtlasShelf& Shelf = AtlasShelves(i);
+		if( Shelf.Height >= H && Shelf.X + W <= AtlasSize && ( Best == INDEX_NONE || Shelf.Height < AtlasShelves(Best).Height ) )
+			Best = i;
+	}
+
+	// Open a new shelf rather than waste most of a tall one.
+	if( Best == INDEX_NONE || AtlasShelves(Best).Height >= H * 2 )
+	{
+		INT Page = INDEX_NONE;
+		for( INT i = 0; i < AtlasPages.Num(); i++ )
+		{
+			if( AtlasPages(i).NextY + H <= AtlasSize )
+			{
+				Page = i;
+				break;
+			}
+		}
+		if( Page == INDEX_NONE && AtlasPages.Num() < ATLAS_MAX_PAGES )
+		{
+			// Create a new empty page. This disturbs the binding on TMU,
+			// so make SetAtlasTexture rebind it.
+			FlushTriangles();
+			Page = AtlasPages.Num();
+			FAtlasPage* NewPage = new(AtlasPages)FAtlasPage;
+			NewPage->NextY = 0;
+			NewPage->LastUsed = AtlasClock;
+			glGenTextures( 1, &NewPage->Id );
+			glActiveTexture( GL_TEXTURE0 + TMU );
+			glBindTexture( GL_TEXTURE_2D, NewPage->Id );
+			glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, AtlasSize, AtlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+			TexInfo[TMU].CurrentCacheID = 0;
+			debugf( NAME_Log, "Allocated lightmap atlas page %d (%dx%d)", Page, AtlasSize, AtlasSize );
+		}
+		if( Page != INDEX_NONE )
+		{
+			FAtlasShelf* Shelf = new(AtlasShelves)FAtlasShelf;
+			Shelf->Page = Page;
+			Shelf->Y = AtlasPages(Page).NextY;
+			Shelf->X = 0;
+			Shelf->Height = H;
+			AtlasPages(Page).NextY += H;
+			Best = AtlasShelves.Num() - 1;
+		}
+	}
+
+	if( Best == INDEX_NONE )
+		return false;
+
+	FAtlasShelf& Shelf = AtlasShelves(Best);
+	Region.Page = Shelf.Page;
+	Region.X = Shelf.X + ATLAS_PADDING;
+	Region.Y = Shelf.Y + ATLAS_PADDING;
+	Shelf.X += W;
+	return true;
+
+	unguard;
+}
+
+UBOOL UNOpenGLRenderDevice::EvictAtlasPage( INT TMU )
+{
+	guard(UNOpenGLRenderDevice::EvictAtlasPage);
+
+	// Pick the least recently used page that no other TMU has bound, since
+	// the surface being set up may be using regions on those.
+	INT Page = INDEX_NONE;
+	for( INT i = 0; i < AtlasPages.Num(); i++ )
+	{
+		UBOOL Bound = false;
+		for( INT t = 0; t < MaxTexUnits; t++ )
+			if( t != TMU && TexInfo[t].CurrentCacheID == ( ATLAS_TEXTURE_TAG | i ) )
+				Bound = true;
+		if( !Bound && ( Page == INDEX_NONE || AtlasPages(i).LastUsed < AtlasPages(Page).LastUsed ) )
+			Page = i;
+	}
+	if( Page == INDEX_NONE )
+		return false;
+
+	// Batched triangles may still use it. Forget its maps and shelves.
+	FlushTriangles();
+	for( INT i = AtlasMap.Size() - 1; i >= 0; i-- )
+	{
+		if( AtlasMap[i].Page == Page )
+		{
+			const QWORD CacheID = AtlasMap.GetKey( i );
+			AtlasMap.Remove( CacheID );
+		}
+	}
+	for( INT i = AtlasShelves.Num() - 1; i >= 0; i-- )
+		if( AtlasShelves(i).Page == Page )
+			AtlasShelves.Remove( i );
+	AtlasPages(Page).NextY = 0;
+	return true;
+
+	unguard;
+}
+
+void UNOpenGLRenderDevice::UploadAtlasRegion( INT TMU, const FAtlasRegion& Region, INT USize, INT VSize, const BYTE* Data, GLenum Format )
+{
+	guard(UNOpenGLRenderDevice::UploadAtlasRegion);
+
+	// Repeat the edge texels into the gutter, so bilinear filtering at the
+	// edges of the region never reads its neighbours.
+	const INT W = USize + 2*ATLAS_PADDING;
+	const INT H = VSize + 2*ATLAS_PADDING;
+	if( AtlasUpload.Num() < W * H )
+		AtlasUpload.Add( W * H - AtlasUpload.Num() );
+	const DWORD* Src = (const DWORD*)Data;
+	for( INT Y = 0; Y < H; Y++ )
+	{
+		const DWORD* SrcRow = Src + Clamp( Y - ATLAS_PADDING, 0, VSize - 1 ) * USize;
+		DWORD* DstRow = &AtlasUpload( Y * W );
+		for( INT X = 0; X < W; X++ )
+			DstRow[X] = SrcRow[Clamp( X - ATLAS_PADDING, 0, USize - 1 )];
+	}
+	glActiveTexture( GL_TEXTURE0 + TMU );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, Region.X - ATLAS_PADDING, Region.Y - ATLAS_PADDING, W, H, Format, GL_UNSIGNED_BYTE, (void*)&AtlasUpload(0) );
+
+	unguard;
+}
+
+void UNOpenGLRenderDevice::FlushAtlas()
+{
+	guard(UNOpenGLRenderDevice::FlushAtlas);
+
+	// Pages stay allocated, only their contents are forgotten.
+	FlushTriangles();
+	AtlasMap.Empty();
+	AtlasShelves.Empty();
+	for( INT i = 0; i < AtlasPages.Num(); i++ )
+		AtlasPages(i).NextY = 0;
+
+	unguard;
+}
+
 void UNOpenGLRenderDevice::EnsureComposeSize( const DWORD NewSize )
 {
 	if( NewSize > ComposeSize )
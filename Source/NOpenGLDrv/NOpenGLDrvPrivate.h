@@ -28,6 +28,7 @@ class DLL_EXPORT UNOpenGLRenderDevice : public URenderDevice
 	UBOOL NoFiltering;
 	UBOOL UseHwPalette;
 	UBOOL UseBGRA;
+	UBOOL UseLightmapAtlas;
 
 	// All currently cached textures.
 	struct FCachedTexture
@@ -46,12 +47,72 @@ class DLL_EXPORT UNOpenGLRenderDevice : public URenderDevice
 		FLOAT VMult;
 		FLOAT UPan;
 		FLOAT VPan;
+		FLOAT UOffset;
+		FLOAT VOffset;
 	} TexInfo[MaxTexUnits];
 
+	// Lightmap and fogmap atlas. Small light/fog maps are packed into a few
+	// large pages with a shelf allocator so that surfaces sharing a page
+	// don't need a texture bind between them.
+	struct FAtlasPage
+	{
+		GLuint Id;
+		INT NextY;
+		INT LastUsed;
+	};
+	struct FAtlasShelf
+	{
+		INT Page;
+		INT Y;
+		INT X;
+		INT Height;
+	};
+	struct FAtlasRegion
+	{
+		INT Page;
+		INT X;
+		INT Y;
+	};
+	TArray<FAtlasPage> AtlasPages;
+	TArray<FAtlasShelf> AtlasShelves;
+	TMap<QWORD, FAtlasRegion> AtlasMap;
+	INT AtlasSize;
+	INT AtlasClock;
+	TArray<DWORD> AtlasUpload;
+
 	// Texture upload buffer;
 	BYTE* Compose;
 	DWORD ComposeSize;
 
+	// Batched vertex data. Polygons are fan-triangulated into client arrays
+	// and drawn in one call whenever render state changes.
+	struct FGLVertex
+	{
+		FLOAT X, Y, Z;
+		FLOAT U, V;
+		FLOAT R, G, B, A;
+	};
+	FGLVertex* VtxData;
+	FGLVertex* VtxDataPtr;
+	FGLVertex* VtxDataEnd;
+	GLushort* IdxData;
+	GLushort* IdxDataPtr;
+	GLushort* IdxDataEnd;
+	GLushort IdxCount;
+	GLushort IdxBase;
+	FPlane VtxColor;
+
+	// Stats. GetStats is called mid-frame, so it reports the last full frame.
+	struct FGLStats
+	{
+		INT DrawCalls;
+		INT Vertices;
+		INT Triangles;
+		INT Polys;
+		INT Binds;
+		INT AtlasUploads;
+	} Stats, LastStats;
+
 	DWORD CurrentPolyFlags;
 	FLOAT RProjZ, Aspect;
 	FLOAT RFX2, RFY2;
@@ -92,10 +153,68 @@ class DLL_EXPORT UNOpenGLRenderDevice : public URenderDevice
 	// UNOpenGLRenderDevice interface.
 	void SetSceneNode( FSceneNode* Frame );
 	void SetBlend( DWORD PolyFlags, UBOOL InverseOrder = false );
+	void SetDepthFunc( GLenum Func );
+	void BufferFacet( FSurfaceFacet& Facet, FLOAT UDot, FLOAT VDot );
 	void SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFlags, FLOAT PanBias );
 	void ResetTexture( INT TMU );
+	void SetAtlasTexture( INT TMU, FTextureInfo& Info, FLOAT PanBias );
+	UBOOL AllocAtlasRegion( INT TMU, INT USize, INT VSize, FAtlasRegion& Region );
+	UBOOL EvictAtlasPage( INT TMU );
+	void UploadAtlasRegion( INT TMU, const FAtlasRegion& Region, INT USize, INT VSize, const BYTE* Data, GLenum Format );
+	void FlushAtlas();
 	void UploadTexture( FTextureInfo& Info, UBOOL Masked, UBOOL NewTexture );
 	void EnsureComposeSize( const DWORD NewSize );
 	void ConvertTextureMipI8( const FMipmap* Mip, const FColor* Palette, const UBOOL Masked, BYTE*& UploadBuf, GLenum& UploadFormat, GLenum& InternalFormat );
 	void ConvertTextureMipBGRA7777( const FMipmap* Mip, BYTE*& UploadBuf, GLenum& UploadFormat, GLenum& InternalFormat );
+
+	inline void FlushTriangles()
+	{
+		if( IdxDataPtr != IdxData )
+		{
+			check( IdxDataPtr <= IdxDataEnd );
+			check( VtxDataPtr <= VtxDataEnd );
+			glDrawElements( GL_TRIANGLES, IdxDataPtr - IdxData, GL_UNSIGNED_SHORT, IdxData );
+			Stats.DrawCalls++;
+			Stats.Vertices += IdxCount;
+			Stats.Triangles += ( IdxDataPtr - IdxData ) / 3;
+		}
+		VtxDataPtr = VtxData;
+		IdxDataPtr = IdxData;
+		IdxCount = 0;
+	}
+
+	inline void BeginPoly( INT NumPts )
+	{
+		// Make room for the whole fan.
+		if( VtxDataPtr + NumPts > VtxDataEnd || IdxDataPtr + ( NumPts - 2 ) * 3 > IdxDataEnd )
+			FlushTriangles();
+		IdxBase = IdxCount;
+	}
+
+	inline void PolyVertex( FLOAT X, FLOAT Y, FLOAT Z, FLOAT U, FLOAT V )
+	{
+		FGLVertex* Vtx = VtxDataPtr++;
+		Vtx->X = X;
+		Vtx->Y = Y;
+		Vtx->Z = Z;
+		Vtx->U = U;
+		Vtx->V = V;
+		Vtx->R = VtxColor.X;
+		Vtx->G = VtxColor.Y;
+		Vtx->B = VtxColor.Z;
+		Vtx->A = VtxColor.W;
+	}
+
+	inline void EndPoly()
+	{
+		const GLushort NumVerts = ( VtxDataPtr - VtxData ) - IdxCount;
+		for( GLushort i = 2; i < NumVerts; ++i )
+		{
+			*IdxDataPtr++ = IdxBase;
+			*IdxDataPtr++ = IdxBase + i - 1;
+			*IdxDataPtr++ = IdxBase + i;
+		}
+		IdxCount += NumVerts;
+		Stats.Polys++;
+	}
 };
@@ -60,6 +60,12 @@ static constexpr DWORD AttribSizes[AT_Count] = {
 // max vertices in a single draw call
 #define MAX_VERTS 32768
 
+// lightmap/fogmap atlas pages; bound pages are tagged with an otherwise unused cache bit
+#define ATLAS_TEXTURE_TAG (1ULL << 61ULL)
+#define ATLAS_PAGE_SIZE 1024
+#define ATLAS_MAX_PAGES 8
+#define ATLAS_PADDING 1
+
 void UNOpenGLESRenderDevice::InternalClassInitializer( UClass* Class )
 {
 	guardSlow(UNOpenGLESRenderDevice::InternalClassInitializer);
@@ -68,6 +74,7 @@ void UNOpenGLESRenderDevice::InternalClassInitializer( UClass* Class )
 	new(Class, "DetailTextures", RF_Public)UBoolProperty( CPP_PROPERTY(DetailTextures), "Options", CPF_Config );
 	new(Class, "UseVAO",         RF_Public)UBoolProperty( CPP_PROPERTY(UseVAO),         "Options", CPF_Config );
 	new(Class, "UseBGRA",        RF_Public)UBoolProperty( CPP_PROPERTY(UseBGRA),        "Options", CPF_Config );
+	new(Class, "UseLightmapAtlas", RF_Public)UBoolProperty( CPP_PROPERTY(UseLightmapAtlas), "Options", CPF_Config );
 	unguardSlow;
 }
 
@@ -78,6 +85,7 @@ UNOpenGLESRenderDevice::UNOpenGLESRenderDevice()
 	NoFiltering = false;
 	UseVAO = false;
 	UseBGRA = true;
+	UseLightmapAtlas = true;
 	CurrentBrightness = -1.f;
 }
 
@@ -135,6 +143,18 @@ UBOOL UNOpenGLESRenderDevice::Init( UViewport* InViewport )
 		}
 	}
 
+	GLint MaxTextureSize = 0;
+	glGetIntegerv( GL_MAX_TEXTURE_SIZE, &MaxTextureSize );
+	AtlasSize = Min( (INT)MaxTextureSize, ATLAS_PAGE_SIZE );
+	if( UseLightmapAtlas && AtlasSize < 256 )
+	{
+		debugf( NAME_Warning, "GLES2: Max texture size %d too small for lightmap atlas, disabling UseLightmapAtlas", MaxTextureSize );
+		UseLightmapAtlas = false;
+	}
+
+	appMemset( &Stats, 0, sizeof(Stats) );
+	appMemset( &LastStats, 0, sizeof(LastStats) );
+
 	// Set permanent state.
 	glEnable( GL_DEPTH_TEST );
 	glDepthMask( GL_TRUE );
@@ -199,19 +219,32 @@ void UNOpenGLESRenderDevice::Flush()
 {
 	guard(UNOpenGLESRenderDevice::Flush);
 
-	if( TexAlloc.Num() )
+	if( TexAlloc.Num() || AtlasPages.Num() )
 	{
-		debugf( NAME_Log, "Flushing %d/%d textures", TexAlloc.Num(), BindMap.Size() );
 		ResetTexture( 0 );
 		ResetTexture( 1 );
 		ResetTexture( 2 );
 		ResetTexture( 3 );
 		glFinish();
+	}
+
+	if( TexAlloc.Num() )
+	{
+		debugf( NAME_Log, "Flushing %d/%d textures", TexAlloc.Num(), BindMap.Size() );
 		glDeleteTextures( TexAlloc.Num(), &TexAlloc(0) );
 		TexAlloc.Empty();
 		BindMap.Empty();
 	}
 
+	if( AtlasPages.Num() )
+	{
+		debugf( NAME_Log, "Flushing %d lightmap atlas pages", AtlasPages.Num() );
+		FlushAtlas();
+		for( INT i = 0; i < AtlasPages.Num(); i++ )
+			glDeleteTextures( 1, &AtlasPages(i).Id );
+		AtlasPages.Empty();
+	}
+
 	unguard;
 }
 
@@ -228,6 +261,9 @@ void UNOpenGLESRenderDevice::Lock( FPlane FlashScale, FPlane FlashFog, FPlane Sc
 	glClearDepthf( 1.f );
 	glDepthFunc( GL_LEQUAL );
 
+	LastStats = Stats;
+	appMemset( &Stats, 0, sizeof(Stats) );
+
 	FLOAT TargetBrightness = CurrentBrightness;
 	if( Viewport && Viewport->Client )
 		TargetBrightness = Viewport->Client->Brightness;
@@ -278,12 +314,12 @@ void UNOpenGLESRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo
 	SetTexture( 0, *Surface.Texture, ( Surface.PolyFlags & PF_Masked ), 0.f );
 	if( Surface.LightMap )
 	{
-		SetTexture( 1, *Surface.LightMap, 0, -0.5f );
+		SetAtlasTexture( 1, *Surface.LightMap, -0.5f );
 		CurrentShaderFlags |= SF_Lightmap;
 	}
 	if( Surface.FogMap )
 	{
-		SetTexture( 2, *Surface.FogMap, 0, -0.5f );
+		SetAtlasTexture( 2, *Surface.FogMap, -0.5f );
 		CurrentShaderFlags |= SF_Fogmap;
 	}
 	if( Surface.DetailTexture && DetailTextures )
@@ -305,9 +341,9 @@ void UNOpenGLESRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo
 			AttribFloat3( &Poly->Pts[i]->Point.X );
 			AttribFloat2( (U-UDot-TexInfo[0].UPan)*TexInfo[0].UMult, (V-VDot-TexInfo[0].VPan)*TexInfo[0].VMult );
 			if( Surface.LightMap )
-				AttribFloat2( (U-UDot-TexInfo[1].UPan)*TexInfo[1].UMult, (V-VDot-TexInfo[1].VPan)*TexInfo[1].VMult );
+				AttribFloat2( (U-UDot-TexInfo[1].UPan)*TexInfo[1].UMult + TexInfo[1].UOffset, (V-VDot-TexInfo[1].VPan)*TexInfo[1].VMult + TexInfo[1].VOffset );
 			if( Surface.FogMap )
-				AttribFloat2( (U-UDot-TexInfo[2].UPan)*TexInfo[2].UMult, (V-VDot-TexInfo[2].VPan)*TexInfo[2].VMult );
+				AttribFloat2( (U-UDot-TexInfo[2].UPan)*TexInfo[2].UMult + TexInfo[2].UOffset, (V-VDot-TexInfo[2].VPan)*TexInfo[2].VMult + TexInfo[2].VOffset );
 			if( Surface.DetailTexture && DetailTextures )
 				AttribFloat2( (U-UDot-TexInfo[3].UPan)*TexInfo[3].UMult, (V-VDot-TexInfo[3].VPan)*TexInfo[3].VMult );
 			PolyVertex();
@@ -315,11 +351,9 @@ void UNOpenGLESRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo
 		EndPoly();
 	}
 
-	CurrentShaderFlags &= ~( SF_Lightmap|SF_Fogmap|SF_Detail );
-
-	ResetTexture( 1 );
-	ResetTexture( 2 );
-	ResetTexture( 3 );
+	// Leave the light/fog/detail textures bound so the next surface on the
+	// same atlas page doesn't have to flush; just stop sampling them.
+	CurrentShaderFlags &= ~( SF_Texture1|SF_Texture2|SF_Texture3|SF_Lightmap|SF_Fogmap|SF_Detail );
 
 	unguard;
 }
@@ -477,7 +511,19 @@ void UNOpenGLESRenderDevice::GetStats( char* Result )
 {
 	guard(UNOpenGLESRenderDevice::GetStats)
 
-	if( Result ) *Result = '\0';
+	if( Result )
+	{
+		appSprintf
+		(
+			Result,
+			"GLES2: Draws=%i Binds=%i Atlas=%i/%i Uploads=%i",
+			LastStats.DrawCalls,
+			LastStats.Binds,
+			AtlasPages.Num(),
+			ATLAS_MAX_PAGES,
+			LastStats.AtlasUploads
+		);
+	}
 
 	unguard;
 }
@@ -869,6 +915,8 @@ void UNOpenGLESRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD Poly
 	// Account for all the impact on scale normalization.
 	Tex.UMult = 1.f / (Info.UScale * static_cast<FLOAT>(Info.USize));
 	Tex.VMult = 1.f / (Info.VScale * static_cast<FLOAT>(Info.VSize));
+	Tex.UOffset = 0.f;
+	Tex.VOffset = 0.f;
 
 	// Find in cache.
 	QWORD NewCacheID = Info.CacheID;
@@ -894,6 +942,7 @@ void UNOpenGLESRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD Poly
 
 	glActiveTexture( GL_TEXTURE0 + TMU );
 	glBindTexture( GL_TEXTURE_2D, Bind->Id );
+	Stats.Binds++;
 
 	if( !OldBind || RealtimeChanged )
 	{
@@ -907,6 +956,246 @@ void UNOpenGLESRenderDevice::SetTexture( INT TMU, FTextureInfo& Info, DWORD Poly
 	unguard;
 }
 
+void UNOpenGLESRenderDevice::SetAtlasTexture( INT TMU, FTextureInfo& Info, FLOAT PanBias )
+{
+	guard(UNOpenGLESRenderDevice::SetAtlasTexture);
+
+	// Paletted, mipmapped or oversized maps go through the regular cache.
+	const FMipmap* Mip = Info.Mips[0];
+	if( !UseLightmapAtlas || Info.Palette || Info.NumMips != 1 || !Mip || !Mip->DataPtr ||
+		Mip->USize + 2*ATLAS_PADDING > AtlasSize || Mip->VSize + 2*ATLAS_PADDING > AtlasSize )
+	{
+		SetTexture( TMU, Info, 0, PanBias );
+		return;
+	}
+
+	CurrentShaderFlags |= 1 << TMU;
+
+	// Find its region, allocating one if needed. If every page is full,
+	// empty the least recently used one.
+	FAtlasRegion* Region = AtlasMap.Find( Info.CacheID );
+	const UBOOL NewRegion = ( Region == NULL );
+	if( NewRegion )
+	{
+		FAtlasRegion NewRgn;
+		while( !AllocAtlasRegion( TMU, Mip->USize, Mip->VSize, NewRgn ) )
+			verify( EvictAtlasPage( TMU ) );
+		Region = AtlasMap.Add( Info.CacheID, NewRgn );
+	}
+	AtlasPages(Region->Page).LastUsed = ++AtlasClock;
+
+	// Set panning, scaled to the page and offset to the region.
+	FTexInfo& Tex = TexInfo[TMU];
+	Tex.UPan    = Info.Pan.X + PanBias*Info.UScale;
+	Tex.VPan    = Info.Pan.Y + PanBias*Info.VScale;
+	Tex.UMult   = 1.f / (Info.UScale * static_cast<FLOAT>(AtlasSize));
+	Tex.VMult   = 1.f / (Info.VScale * static_cast<FLOAT>(AtlasSize));
+	Tex.UOffset = static_cast<FLOAT>(Region->X) / static_cast<FLOAT>(AtlasSize);
+	Tex.VOffset = static_cast<FLOAT>(Region->Y) / static_cast<FLOAT>(AtlasSize);
+
+	// Bind the page if it isn't already.
+	const QWORD PageCacheID = ATLAS_TEXTURE_TAG | Region->Page;
+	if( Tex.CurrentCacheID != PageCacheID )
+	{
+		FlushTriangles();
+		glActiveTexture( GL_TEXTURE0 + TMU );
+		glBindTexture( GL_TEXTURE_2D, AtlasPages(Region->Page).Id );
+		Tex.CurrentCacheID = PageCacheID;
+		Stats.Binds++;
+	}
+
+	// Copy new or changed maps into their region. Other regions of the page
+	// may still be referenced by batched triangles, which is fine.
+	if( NewRegion || ( Info.TextureFlags & TF_RealtimeChanged ) )
+	{
+		Info.TextureFlags &= ~TF_RealtimeChanged;
+		BYTE* UploadBuf;
+		GLenum UploadFormat;
+		if( UseBGRA )
+		{
+			UploadBuf = Mip->DataPtr;
+			UploadFormat = GL_BGRA_EXT;
+		}
+		else
+		{
+			// Swap BGRA -> RGBA.
+			const DWORD Count = Mip->USize * Mip->VSize;
+			if( Count * 4 > ComposeSize )
+			{
+				ComposeSize = Count * 4;
+				Compose = (BYTE*)appRealloc( Compose, ComposeSize, "GLComposeBuf" );
+				verify( Compose );
+			}
+			UploadBuf = Compose;
+			UploadFormat = GL_RGBA;
+			BYTE* Dst = Compose;
+			const BYTE* Src = Mip->DataPtr;
+			for( DWORD i = 0; i < Count; ++i, Src += 4 )
+			{
+				*Dst++ = Src[2];
+				*Dst++ = Src[1];
+				*Dst++ = Src[0];
+				*Dst++ = Src[3];
+			}
+		}
+		UploadAtlasRegion( TMU, *Region, Mip->USize, Mip->VSize, UploadBuf, UploadFormat );
+		Stats.AtlasUploads++;
+	}
+
+	unguard;
+}
+
+UBOOL UNOpenGLESRenderDevice::AllocAtlasRegion( INT TMU, INT USize, INT VSize, FAtlasRegion& Region )
+{
+	guard(UNOpenGLESRenderDevice::AllocAtlasRegion);
+
+	// Leave a gutter all round for UploadAtlasRegion's copies of the edges.
+	const INT W = USize + 2*ATLAS_PADDING;
+	const INT H = VSize + 2*ATLAS_PADDING;
+
+	// Find the shortest shelf this fits on.
+	INT Best = INDEX_NONE;
+	for( INT i = 0; i < AtlasShelves.Num(); i++ )
+	{
+		const FAtlasShelf& Shelf = AtlasShelves(i);
+		if( Shelf.Height >= H && Shelf.X + W <= AtlasSize && ( Best == INDEX_NONE || Shelf.Height < AtlasShelves(Best).Height ) )
+			Best = i;
+	}
+
+	// Open a new shelf rather than waste most of a tall one.
+	if( Best == INDEX_NONE || AtlasShelves(Best).Height >= H * 2 )
+	{
+		INT Page = INDEX_NONE;
+		for( INT i = 0; i < AtlasPages.Num(); i++ )
+		{
+			if( AtlasPages(i).NextY + H <= AtlasSize )
+			{
+				Page = i;
+				break;
+			}
+		}
+		if( Page == INDEX_NONE && AtlasPages.Num() < ATLAS_MAX_PAGES )
+		{
+			// Create a new empty page. This disturbs the binding on TMU,
+			// so make SetAtlasTexture rebind it.
+			FlushTriangles();
+			const GLenum Format = UseBGRA ? GL_BGRA_EXT : GL_RGBA;
+			Page = AtlasPages.Num();
+			FAtlasPage* NewPage = new(AtlasPages)FAtlasPage;
+			NewPage->NextY = 0;
+			NewPage->LastUsed = AtlasClock;
+			glGenTextures( 1, &NewPage->Id );
+			glActiveTexture( GL_TEXTURE0 + TMU );
+			glBindTexture( GL_TEXTURE_2D, NewPage->Id );
+			glTexImage2D( GL_TEXTURE_2D, 0, Format, AtlasSize, AtlasSize, 0, Format, GL_UNSIGNED_BYTE, NULL );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+			TexInfo[TMU].CurrentCacheID = 0;
+			debugf( NAME_Log, "Allocated lightmap atlas page %d (%dx%d)", Page, AtlasSize, AtlasSize );
+		}
+		if( Page != INDEX_NONE )
+		{
+			FAtlasShelf* Shelf = new(AtlasShelves)FAtlasShelf;
+			Shelf->Page = Page;
+			Shelf->Y = AtlasPages(Page).NextY;
+			Shelf->X = 0;
+			Shelf->Height = H;
+			AtlasPages(Page).NextY += H;
+			Best = AtlasShelves.Num() - 1;
+		}
+	}
+
+	if( Best == INDEX_NONE )
+		return false;
+
+	FAtlasShelf& Shelf = AtlasShelves(Best);
+	Region.Page = Shelf.Page;
+	Region.X = Shelf.X + ATLAS_PADDING;
+	Region.Y = Shelf.Y + ATLAS_PADDING;
+	Shelf.X += W;
+	return true;
+
+	unguard;
+}
+
+UBOOL UNOpenGLESRenderDevice::EvictAtlasPage( INT TMU )
+{
+	guard(UNOpenGLESRenderDevice::EvictAtlasPage);
+
+	// Pick the least recently used page that no other TMU has bound, since
+	// the surface being set up may be using regions on those.
+	INT Page = INDEX_NONE;
+	for( INT i = 0; i < AtlasPages.Num(); i++ )
+	{
+		UBOOL Bound = false;
+		for( INT t = 0; t < MaxTexUnits; t++ )
+			if( t != TMU && TexInfo[t].CurrentCacheID == ( ATLAS_TEXTURE_TAG | i ) )
+				Bound = true;
+		if( !Bound && ( Page == INDEX_NONE || AtlasPages(i).LastUsed < AtlasPages(Page).LastUsed ) )
+			Page = i;
+	}
+	if( Page == INDEX_NONE )
+		return false;
+
+	// Batched triangles may still use it. Forget its maps and shelves.
+	FlushTriangles();
+	for( INT i = AtlasMap.Size() - 1; i >= 0; i-- )
+	{
+		if( AtlasMap[i].Page == Page )
+		{
+			const QWORD CacheID = AtlasMap.GetKey( i );
+			AtlasMap.Remove( CacheID );
+		}
+	}
+	for( INT i = AtlasShelves.Num() - 1; i >= 0; i-- )
+		if( AtlasShelves(i).Page == Page )
+			AtlasShelves.Remove( i );
+	AtlasPages(Page).NextY = 0;
+	return true;
+
+	unguard;
+}
+
+void UNOpenGLESRenderDevice::UploadAtlasRegion( INT TMU, const FAtlasRegion& Region, INT USize, INT VSize, const BYTE* Data, GLenum Format )
+{
+	guard(UNOpenGLESRenderDevice::UploadAtlasRegion);
+
+	// Repeat the edge texels into the gutter, so bilinear filtering at the
+	// edges of the region never reads its neighbours.
+	const INT W = USize + 2*ATLAS_PADDING;
+	const INT H = VSize + 2*ATLAS_PADDING;
+	if( AtlasUpload.Num() < W * H )
+		AtlasUpload.Add( W * H - AtlasUpload.Num() );
+	const DWORD* Src = (const DWORD*)Data;
+	for( INT Y = 0; Y < H; Y++ )
+	{
+		const DWORD* SrcRow = Src + Clamp( Y - ATLAS_PADDING, 0, VSize - 1 ) * USize;
+		DWORD* DstRow = &AtlasUpload( Y * W );
+		for( INT X = 0; X < W; X++ )
+			DstRow[X] = SrcRow[Clamp( X - ATLAS_PADDING, 0, USize - 1 )];
+	}
+	glActiveTexture( GL_TEXTURE0 + TMU );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, Region.X - ATLAS_PADDING, Region.Y - ATLAS_PADDING, W, H, Format, GL_UNSIGNED_BYTE, (void*)&AtlasUpload(0) );
+
+	unguard;
+}
+
+void UNOpenGLESRenderDevice::FlushAtlas()
+{
+	guard(UNOpenGLESRenderDevice::FlushAtlas);
+
+	// Pages stay allocated, only their contents are forgotten.
+	FlushTriangles();
+	AtlasMap.Empty();
+	AtlasShelves.Empty();
+	for( INT i = 0; i < AtlasPages.Num(); i++ )
+		AtlasPages(i).NextY = 0;
+
+	unguard;
+}
+
 void UNOpenGLESRenderDevice::UploadTexture( FTextureInfo& Info, UBOOL Masked, UBOOL NewTexture )
 {
 	guard(UNOpenGLESRenderDevice::UploadTexture);
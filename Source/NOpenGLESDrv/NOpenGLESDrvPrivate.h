@@ -64,6 +64,7 @@ class DLL_EXPORT UNOpenGLESRenderDevice : public URenderDevice
 	UBOOL Overbright;
 	UBOOL DetailTextures;
 	UBOOL UseVAO;
+	UBOOL UseLightmapAtlas;
 
 	// All currently cached textures.
 	struct FCachedTexture
@@ -83,8 +84,39 @@ class DLL_EXPORT UNOpenGLESRenderDevice : public URenderDevice
 		FLOAT VMult;
 		FLOAT UPan;
 		FLOAT VPan;
+		FLOAT UOffset;
+		FLOAT VOffset;
 	} TexInfo[MaxTexUnits];
 
+	// Lightmap and fogmap atlas. Small light/fog maps are packed into a few
+	// large pages with a shelf allocator so that surfaces sharing a page
+	// don't need a texture bind between them.
+	struct FAtlasPage
+	{
+		GLuint Id;
+		INT NextY;
+		INT LastUsed;
+	};
+	struct FAtlasShelf
+	{
+		INT Page;
+		INT Y;
+		INT X;
+		INT Height;
+	};
+	struct FAtlasRegion
+	{
+		INT Page;
+		INT X;
+		INT Y;
+	};
+	TArray<FAtlasPage> AtlasPages;
+	TArray<FAtlasShelf> AtlasShelves;
+	TMap<QWORD, FAtlasRegion> AtlasMap;
+	INT AtlasSize;
+	INT AtlasClock;
+	TArray<DWORD> AtlasUpload;
+
 	// All currently compiled shaders.
 	struct FCachedShader
 	{
@@ -132,6 +164,14 @@ class DLL_EXPORT UNOpenGLESRenderDevice : public URenderDevice
 	glm::mat4 MtxMVP;
 	FPlane ColorMod;
 
+	// Stats. GetStats is called mid-frame, so it reports the last full frame.
+	struct FGLStats
+	{
+		INT DrawCalls;
+		INT Binds;
+		INT AtlasUploads;
+	} Stats, LastStats;
+
 	struct FCachedSceneNode
 	{
 		FLOAT FovAngle;
@@ -174,6 +214,11 @@ class DLL_EXPORT UNOpenGLESRenderDevice : public URenderDevice
 	void SetBlend( DWORD PolyFlags, UBOOL InverseOrder = false );
 	void SetTexture( INT TMU, FTextureInfo& Info, DWORD PolyFlags, FLOAT PanBias );
 	void ResetTexture( INT TMU );
+	void SetAtlasTexture( INT TMU, FTextureInfo& Info, FLOAT PanBias );
+	UBOOL AllocAtlasRegion( INT TMU, INT USize, INT VSize, FAtlasRegion& Region );
+	UBOOL EvictAtlasPage( INT TMU );
+	void UploadAtlasRegion( INT TMU, const FAtlasRegion& Region, INT USize, INT VSize, const BYTE* Data, GLenum Format );
+	void FlushAtlas();
 	void UploadTexture( FTextureInfo& Info, UBOOL Masked, UBOOL NewTexture );
 	void UpdateTextureFilter( const FTextureInfo& Info, DWORD PolyFlags );
 
@@ -188,6 +233,7 @@ private:
 			if ( UseVAO )
 				glBufferSubData( GL_ARRAY_BUFFER, 0, ( (BYTE*)VtxDataPtr - (BYTE*)VtxData ), VtxData );
 			glDrawElements( GL_TRIANGLES, IdxDataPtr - IdxData, GL_UNSIGNED_SHORT, IdxData );
+			Stats.DrawCalls++;
 			IdxCount = 0;
 		}
 		VtxDataPtr = VtxData;
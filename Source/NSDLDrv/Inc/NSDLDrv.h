@@ -129,6 +129,7 @@ class NSDLDRV_API UNSDLClient : public UClient, public FNotifyHook
 
 	// UNSDLClient interface.
 	void TryRenderDevice( UViewport* Viewport, const char* ClassName, UBOOL Fullscreen );
+	UBOOL UseNullRenderDevice( const char* ClassName );
 	const TArray<SDL_Rect>& GetDisplayResolutions();
 	inline SDL_GameController* GetController() { return Controller; }
 	inline const SDL_DisplayMode& GetDefaultDisplayMode() const { return DefaultDisplayMode; }
@@ -1,9 +1,13 @@
 #include <stdlib.h>
 #include <ctype.h>
+#include <string.h>
 
 #include "NSDLDrv.h"
 // #include "UnRender.h"
 #include "../../NOpenGLDrv/NOpenGLDrvPrivate.h"
+#ifdef WITH_NULLRENDERDEV
+#include "../../NullRenderDev/Inc/NullRenderDev.h"
+#endif
 IMPLEMENT_CLASS( UNSDLClient );
 
 /*-----------------------------------------------------------------------------
@@ -324,6 +328,36 @@ void UNSDLClient::EndFullscreen()
 	FullscreenViewport = NULL;
 }
 
+//
+// Whether to use the null rendering device rather than a GL one: either
+// -nullrender was given, or the device class (or the ini entry it points
+// to) names NullRenderDev.
+//
+UBOOL UNSDLClient::UseNullRenderDevice( const char* ClassName )
+{
+	guard(UNSDLClient::UseNullRenderDevice);
+	if( ParseParam( appCmdLine(), "NULLRENDER" ) )
+		return 1;
+	char Temp[256]="";
+	appStrncpy( Temp, ClassName, ARRAY_COUNT(Temp) );
+	if( appStrnicmp( ClassName, "ini:", 4 )==0 )
+	{
+		// ini:Section.Key, where the section name itself contains dots.
+		char Section[256]="";
+		appStrncpy( Section, ClassName+4, ARRAY_COUNT(Section) );
+		char* Key = strrchr( Section, '.' );
+		Temp[0] = 0;
+		if( Key )
+		{
+			*Key++ = 0;
+			GetConfigString( Section, Key, Temp, ARRAY_COUNT(Temp) );
+		}
+	}
+	appStrupr( Temp );
+	return appStrstr( Temp, "NULLRENDERDEV" )!=NULL;
+	unguard;
+}
+
 //
 // Try switching to a new rendering device.
 //
@@ -343,6 +377,11 @@ void UNSDLClient::TryRenderDevice( UViewport* Viewport, const char* ClassName, U
 	// UClass* RenderClass = GObj.LoadClass( URenderDevice::StaticClass, NULL, ClassName, NULL, LOAD_KeepImports, NULL );
 	if( 1 )
 	{
+#ifdef WITH_NULLRENDERDEV
+		if( UseNullRenderDevice( ClassName ) )
+			Viewport->RenDev = new UNullRenderDevice;
+		else
+#endif
 		Viewport->RenDev = new UNOpenGLRenderDevice;//ConstructClassObject<URenderDevice>( RenderClass );
 		if( Viewport->Client->Engine->Audio && !GIsEditor )
 			Viewport->Client->Engine->Audio->SetViewport( NULL );
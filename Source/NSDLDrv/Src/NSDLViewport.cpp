@@ -288,6 +288,11 @@ void UNSDLViewport::OpenWindow( void* InParentWindow, UBOOL Temporary, INT NewX,
 		}
 		if( DoOpenGL && appStrstr( Temp, "GLES" ) )
 			GLProfile = SDL_GL_CONTEXT_PROFILE_COMPATIBILITY;
+#ifdef WITH_NULLRENDERDEV
+		// The null device draws nothing, so it doesn't need a GL context.
+		if( Client->UseNullRenderDevice( "ini:Engine.Engine.GameRenderDevice" ) )
+			DoOpenGL = 0;
+#endif
 	}
 
 	// User window of launcher if no parent window was specified.
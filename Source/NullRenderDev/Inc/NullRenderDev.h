@@ -0,0 +1,255 @@
+/*=============================================================================
+	NullRenderDev.h: Null rendering device and render traces.
+
+	UNullRenderDevice implements the whole URenderDevice interface without
+	a GPU. It counts every call it gets, so running it isolates the cost of
+	the Render module (occlusion, span buffers, lighting) from driver cost.
+
+	It can also record the calls into a compact binary render trace, which
+	FRenderTraceReplay feeds back into any other rendering device to give
+	driver work a reproducible input.
+
+	Include Engine.h and UnRender.h before this file.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	Defines.
+-----------------------------------------------------------------------------*/
+
+#ifdef NULLRENDERDEV_EXPORTS
+#define NULLRENDERDEV_API DLL_EXPORT
+#else
+#define NULLRENDERDEV_API DLL_IMPORT
+#endif
+
+/*-----------------------------------------------------------------------------
+	Render trace format.
+-----------------------------------------------------------------------------*/
+
+// Trace file header.
+#define RENDER_TRACE_MAGIC		0x52545255 /* "URTR" */
+#define RENDER_TRACE_VERSION	1
+
+//
+// Render trace records. Every record is a record byte followed by its
+// payload, in native byte order. Textures are written once per cache ID,
+// before the first record that uses them, and again whenever their palette
+// or contents change.
+//
+enum ERenderTraceRecord
+{
+	RTR_Lock			= 0,	// FlashScale, FlashFog, ScreenClear, RenderLockFlags.
+	RTR_Unlock			= 1,	// Blit.
+	RTR_SceneNode		= 2,	// FRenderTraceNode.
+	RTR_Texture			= 3,	// Texture header, palette and mipmaps.
+	RTR_ComplexSurface	= 4,	// Flags, texture refs, map coords and polys.
+	RTR_GouraudPolygon	= 5,	// Texture ref, flags and vertices.
+	RTR_Tile			= 6,	// Texture ref and tile parameters.
+	RTR_Line			= 7,	// Color, flags and end points.
+	RTR_Point			= 8,	// Color, flags and rectangle.
+	RTR_ClearZ			= 9,	// No payload.
+	RTR_EndFlash		= 10,	// No payload.
+	RTR_MAX				= 11,
+};
+
+// Texture slots of an RTR_ComplexSurface record.
+enum ERenderTraceSurfaceMaps
+{
+	RTS_Texture			= 0x01,
+	RTS_LightMap		= 0x02,
+	RTS_MacroTexture	= 0x04,
+	RTS_DetailTexture	= 0x08,
+	RTS_FogMap			= 0x10,
+};
+
+//
+// The parts of a scene node that rendering devices look at. A new one is
+// written whenever the frame being drawn changes.
+//
+struct FRenderTraceNode
+{
+	INT		X, Y;
+	INT		XB, YB;
+	FLOAT	FovAngle;
+	FCoords	Coords;
+};
+
+/*-----------------------------------------------------------------------------
+	FRenderTraceWriter.
+-----------------------------------------------------------------------------*/
+
+//
+// Records rendering device calls into a render trace file. Records are
+// buffered and written out once per frame.
+//
+class NULLRENDERDEV_API FRenderTraceWriter
+{
+public:
+	// Constructor/destructor.
+	FRenderTraceWriter();
+	~FRenderTraceWriter();
+
+	// Open/close.
+	UBOOL Open( const char* Filename, INT SizeX, INT SizeY );
+	void Close();
+	UBOOL IsOpen() const
+	{
+		return File!=NULL;
+	}
+	INT GetTotalBytes() const
+	{
+		return TotalBytes;
+	}
+
+	// Recording functions, matching the URenderDevice interface.
+	void Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags );
+	void Unlock( UBOOL Blit );
+	void DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet );
+	void DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Info, FTransTexture** Pts, INT NumPts, DWORD PolyFlags );
+	void DrawTile( FSceneNode* Frame, FTextureInfo& Info, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, FLOAT Z, FPlane Color, FPlane Fog, DWORD PolyFlags );
+	void Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 );
+	void Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2 );
+	void ClearZ( FSceneNode* Frame );
+	void EndFlash();
+
+private:
+	// Variables.
+	FILE*				File;
+	TArray<BYTE>		Buffer;
+	TMap<QWORD,QWORD>	Textures;		// Cache ID -> palette cache ID last written.
+	FRenderTraceNode	LastNode;
+	UBOOL				HaveNode;
+	INT					TotalBytes;
+
+	// Internal functions.
+	void Put( const void* Data, INT Size );
+	template<class T> void Put( const T& Value )
+	{
+		Put( &Value, sizeof(T) );
+	}
+	void PutRecord( BYTE Record )
+	{
+		Put( Record );
+	}
+	void PutSceneNode( FSceneNode* Frame );
+	void PutTexture( FTextureInfo& Info );
+	void PutTextureRef( FTextureInfo& Info );
+	void FlushBuffer();
+};
+
+/*-----------------------------------------------------------------------------
+	FRenderTraceReplay.
+-----------------------------------------------------------------------------*/
+
+//
+// Plays a render trace back into a viewport's rendering device, one frame
+// at a time. Span buffers are not recorded, so devices are always handed a
+// NULL span.
+//
+class NULLRENDERDEV_API FRenderTraceReplay
+{
+public:
+	// Trace info.
+	INT SizeX, SizeY;
+
+	// Constructor/destructor.
+	FRenderTraceReplay();
+	~FRenderTraceReplay();
+
+	// Load/free.
+	UBOOL Load( const char* Filename );
+	void Free();
+
+	// Start over from the first frame.
+	void Rewind();
+
+	// Replay one frame into Viewport->RenDev. Returns 0 at the end of the trace.
+	UBOOL ReplayFrame( UViewport* Viewport );
+
+private:
+	// A texture rebuilt from the trace.
+	struct FReplayTexture
+	{
+		FTextureInfo	Info;
+		FMipmap			Mips[MAX_MIPS];
+		FColor			Palette[256];
+		FColor			MaxColor;
+		BYTE*			MipData;
+		INT				MipDataSize;
+	};
+
+	// Variables.
+	BYTE*						Data;
+	INT							DataSize;
+	INT							Pos;
+	TMap<QWORD,FReplayTexture*>	Textures;
+	FSceneNode					Frame;
+	UBOOL						Locked;
+
+	// Internal functions.
+	void Get( void* Dest, INT Size );
+	template<class T> void Get( T& Value )
+	{
+		Get( &Value, sizeof(T) );
+	}
+	void GetSceneNode( UViewport* Viewport );
+	void GetTexture();
+	FTextureInfo& GetTextureRef();
+};
+
+/*-----------------------------------------------------------------------------
+	UNullRenderDevice.
+-----------------------------------------------------------------------------*/
+
+//
+// A rendering device that draws nothing.
+//
+class NULLRENDERDEV_API UNullRenderDevice : public URenderDevice
+{
+	DECLARE_CLASS_WITHOUT_CONSTRUCT(UNullRenderDevice, URenderDevice, CLASS_Config)
+
+	// Per-frame call counts. GetStats is called mid-frame, so it reports
+	// the last full frame.
+	struct FNullStats
+	{
+		INT Surfaces;
+		INT SurfacePolys;
+		INT SurfaceVerts;
+		INT GouraudPolys;
+		INT GouraudVerts;
+		INT Tiles;
+		INT Lines;
+		INT Points;
+		INT ClearZs;
+	} Stats, LastStats;
+
+	// Render trace being recorded, if any.
+	FRenderTraceWriter Trace;
+
+	// Constructors.
+	UNullRenderDevice();
+	static void InternalClassInitializer( UClass* Class );
+
+	// URenderDevice interface.
+	virtual UBOOL Init( UViewport* InViewport ) override;
+	virtual void Exit() override;
+	virtual void Flush() override;
+	virtual UBOOL Exec( const char* Cmd, FOutputDevice* Out ) override;
+	virtual void Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags, BYTE* InHitData, INT* InHitSize ) override;
+	virtual void Unlock( UBOOL Blit ) override;
+	virtual void DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet ) override;
+	virtual void DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Texture, FTransTexture** Pts, INT NumPts, DWORD PolyFlags, FSpanBuffer* SpanBuffer ) override;
+	virtual void DrawTile( FSceneNode* Frame, FTextureInfo& Texture, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, FSpanBuffer* Span, FLOAT Z, FPlane Light, FPlane Fog, DWORD PolyFlags ) override;
+	virtual void Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 ) override;
+	virtual void Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2 ) override;
+	virtual void ClearZ( FSceneNode* Frame ) override;
+	virtual void PushHit( const BYTE* Data, INT Count ) override;
+	virtual void PopHit( INT Count, UBOOL bForce ) override;
+	virtual void GetStats( char* Result ) override;
+	virtual void ReadPixels( FColor* Pixels ) override;
+	virtual void EndFlash() override;
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
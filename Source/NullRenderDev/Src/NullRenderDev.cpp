@@ -0,0 +1,261 @@
+/*=============================================================================
+	NullRenderDev.cpp: Null rendering device.
+=============================================================================*/
+
+#include "Engine.h"
+#include "UnRender.h"
+#include "NullRenderDev.h"
+
+/*-----------------------------------------------------------------------------
+	Global implementation.
+-----------------------------------------------------------------------------*/
+
+IMPLEMENT_PACKAGE(NullRenderDev);
+IMPLEMENT_CLASS(UNullRenderDevice);
+
+/*-----------------------------------------------------------------------------
+	UNullRenderDevice implementation.
+-----------------------------------------------------------------------------*/
+
+void UNullRenderDevice::InternalClassInitializer( UClass* Class )
+{
+	guardSlow(UNullRenderDevice::InternalClassInitializer);
+	unguardSlow;
+}
+
+UNullRenderDevice::UNullRenderDevice()
+{
+}
+
+UBOOL UNullRenderDevice::Init( UViewport* InViewport )
+{
+	guard(UNullRenderDevice::Init);
+
+	// Claim the same capabilities as the hardware devices so that Render
+	// takes the same paths it would with them.
+	SpanBased = false;
+	FrameBuffered = false;
+	SupportsFogMaps = true;
+	SupportsDistanceFog = true;
+
+	Viewport = InViewport;
+	appMemset( &Stats, 0, sizeof(Stats) );
+	appMemset( &LastStats, 0, sizeof(LastStats) );
+
+	char Filename[256]="";
+	if( Parse( appCmdLine(), "RENDERTRACE=", Filename, ARRAY_COUNT(Filename) ) && Filename[0] && !Trace.IsOpen() )
+		Trace.Open( Filename, Viewport->SizeX, Viewport->SizeY );
+
+	debugf( NAME_Log, "Null rendering device initialized" );
+	return true;
+	unguard;
+}
+
+void UNullRenderDevice::Exit()
+{
+	guard(UNullRenderDevice::Exit);
+
+	debugf( NAME_Log, "Shutting down null renderer" );
+	Trace.Close();
+
+	unguard;
+}
+
+void UNullRenderDevice::Flush()
+{
+}
+
+UBOOL UNullRenderDevice::Exec( const char* Cmd, FOutputDevice* Out )
+{
+	guard(UNullRenderDevice::Exec);
+
+	if( ParseCommand( &Cmd, "RENDERTRACE" ) )
+	{
+		if( ParseCommand( &Cmd, "START" ) )
+		{
+			char Filename[256]="RenderTrace.urt";
+			ParseToken( Cmd, Filename, ARRAY_COUNT(Filename), 0 );
+			Trace.Close();
+			if( Trace.Open( Filename, Viewport->SizeX, Viewport->SizeY ) )
+				Out->Logf( "Recording render trace to %s", Filename );
+			else
+				Out->Logf( "Couldn't open %s", Filename );
+		}
+		else if( ParseCommand( &Cmd, "STOP" ) )
+		{
+			if( Trace.IsOpen() )
+				Out->Logf( "Render trace stopped (%i bytes)", Trace.GetTotalBytes() );
+			Trace.Close();
+		}
+		else
+		{
+			Out->Logf( "Usage: RENDERTRACE START [file] | STOP" );
+		}
+		return 1;
+	}
+	return 0;
+
+	unguard;
+}
+
+void UNullRenderDevice::Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags, BYTE* InHitData, INT* InHitSize )
+{
+	guard(UNullRenderDevice::Lock);
+
+	LastStats = Stats;
+	appMemset( &Stats, 0, sizeof(Stats) );
+
+	// Nothing is hit.
+	if( InHitSize )
+		*InHitSize = 0;
+
+	if( Trace.IsOpen() )
+		Trace.Lock( FlashScale, FlashFog, ScreenClear, RenderLockFlags );
+
+	unguard;
+}
+
+void UNullRenderDevice::Unlock( UBOOL Blit )
+{
+	guard(UNullRenderDevice::Unlock);
+
+	if( Trace.IsOpen() )
+		Trace.Unlock( Blit );
+
+	unguard;
+}
+
+void UNullRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet )
+{
+	guard(UNullRenderDevice::DrawComplexSurface);
+
+	Stats.Surfaces++;
+	for( FSavedPoly* Poly = Facet.Polys; Poly; Poly = Poly->Next )
+	{
+		Stats.SurfacePolys++;
+		Stats.SurfaceVerts += Poly->NumPts;
+	}
+
+	if( Trace.IsOpen() )
+		Trace.DrawComplexSurface( Frame, Surface, Facet );
+
+	unguard;
+}
+
+void UNullRenderDevice::DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Texture, FTransTexture** Pts, INT NumPts, DWORD PolyFlags, FSpanBuffer* SpanBuffer )
+{
+	guard(UNullRenderDevice::DrawGouraudPolygon);
+
+	Stats.GouraudPolys++;
+	Stats.GouraudVerts += NumPts;
+
+	if( Trace.IsOpen() )
+		Trace.DrawGouraudPolygon( Frame, Texture, Pts, NumPts, PolyFlags );
+
+	unguard;
+}
+
+void UNullRenderDevice::DrawTile( FSceneNode* Frame, FTextureInfo& Texture, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, FSpanBuffer* Span, FLOAT Z, FPlane Light, FPlane Fog, DWORD PolyFlags )
+{
+	guard(UNullRenderDevice::DrawTile);
+
+	Stats.Tiles++;
+
+	if( Trace.IsOpen() )
+		Trace.DrawTile( Frame, Texture, X, Y, XL, YL, U, V, UL, VL, Z, Light, Fog, PolyFlags );
+
+	unguard;
+}
+
+void UNullRenderDevice::Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 )
+{
+	guard(UNullRenderDevice::Draw2DLine);
+
+	Stats.Lines++;
+
+	if( Trace.IsOpen() )
+		Trace.Draw2DLine( Frame, Color, LineFlags, P1, P2 );
+
+	unguard;
+}
+
+void UNullRenderDevice::Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2 )
+{
+	guard(UNullRenderDevice::Draw2DPoint);
+
+	Stats.Points++;
+
+	if( Trace.IsOpen() )
+		Trace.Draw2DPoint( Frame, Color, LineFlags, X1, Y1, X2, Y2 );
+
+	unguard;
+}
+
+void UNullRenderDevice::ClearZ( FSceneNode* Frame )
+{
+	guard(UNullRenderDevice::ClearZ);
+
+	Stats.ClearZs++;
+
+	if( Trace.IsOpen() )
+		Trace.ClearZ( Frame );
+
+	unguard;
+}
+
+void UNullRenderDevice::PushHit( const BYTE* Data, INT Count )
+{
+}
+
+void UNullRenderDevice::PopHit( INT Count, UBOOL bForce )
+{
+}
+
+void UNullRenderDevice::GetStats( char* Result )
+{
+	guard(UNullRenderDevice::GetStats);
+
+	if( Result )
+	{
+		appSprintf
+		(
+			Result,
+			"Null: Surfs=%i Polys=%i Verts=%i Gouraud=%i (%i verts) Tiles=%i Lines=%i Points=%i ClearZ=%i Trace=%iK",
+			LastStats.Surfaces,
+			LastStats.SurfacePolys,
+			LastStats.SurfaceVerts,
+			LastStats.GouraudPolys,
+			LastStats.GouraudVerts,
+			LastStats.Tiles,
+			LastStats.Lines,
+			LastStats.Points,
+			LastStats.ClearZs,
+			Trace.GetTotalBytes() / 1024
+		);
+	}
+
+	unguard;
+}
+
+void UNullRenderDevice::ReadPixels( FColor* Pixels )
+{
+	guard(UNullRenderDevice::ReadPixels);
+
+	appMemset( Pixels, 0, Viewport->SizeX * Viewport->SizeY * sizeof(FColor) );
+
+	unguard;
+}
+
+void UNullRenderDevice::EndFlash()
+{
+	guard(UNullRenderDevice::EndFlash);
+
+	if( Trace.IsOpen() )
+		Trace.EndFlash();
+
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
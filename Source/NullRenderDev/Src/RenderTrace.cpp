@@ -0,0 +1,739 @@
+/*=============================================================================
+	RenderTrace.cpp: Render trace recording and replay.
+=============================================================================*/
+
+#include "Engine.h"
+#include "UnRender.h"
+#include "NullRenderDev.h"
+
+/*-----------------------------------------------------------------------------
+	Helpers.
+-----------------------------------------------------------------------------*/
+
+//
+// Bytes per texel of a texture format.
+//
+static inline INT TraceTexelBytes( BYTE Format )
+{
+	return Format==TEXF_RGB64 ? 8 : Format==TEXF_RGB32 ? 4 : 1;
+}
+
+//
+// Trace layout of a vertex.
+//
+struct FRenderTraceVertex
+{
+	FVector	Point;
+	FLOAT	ScreenX, ScreenY, RZ;
+};
+struct FRenderTraceGouraudVertex
+{
+	FVector	Point;
+	FLOAT	ScreenX, ScreenY, RZ;
+	FPlane	Light, Fog;
+	FLOAT	U, V;
+};
+
+/*-----------------------------------------------------------------------------
+	FRenderTraceWriter.
+-----------------------------------------------------------------------------*/
+
+FRenderTraceWriter::FRenderTraceWriter()
+:	File		( NULL )
+,	HaveNode	( 0 )
+,	TotalBytes	( 0 )
+{}
+
+FRenderTraceWriter::~FRenderTraceWriter()
+{
+	Close();
+}
+
+UBOOL FRenderTraceWriter::Open( const char* Filename, INT SizeX, INT SizeY )
+{
+	guard(FRenderTraceWriter::Open);
+	check(!File);
+
+	File = appFopen( Filename, "wb" );
+	if( !File )
+	{
+		debugf( NAME_Warning, "Couldn't open render trace %s", Filename );
+		return 0;
+	}
+
+	Textures.Empty();
+	HaveNode   = 0;
+	TotalBytes = 0;
+
+	DWORD Magic=RENDER_TRACE_MAGIC, Version=RENDER_TRACE_VERSION;
+	Put( Magic );
+	Put( Version );
+	Put( SizeX );
+	Put( SizeY );
+	FlushBuffer();
+
+	debugf( NAME_Log, "Recording render trace to %s", Filename );
+	return 1;
+	unguard;
+}
+
+void FRenderTraceWriter::Close()
+{
+	guard(FRenderTraceWriter::Close);
+	if( File )
+	{
+		FlushBuffer();
+		appFclose( File );
+		File = NULL;
+		debugf( NAME_Log, "Closed render trace (%i bytes)", TotalBytes );
+	}
+	Textures.Empty();
+	Buffer.Empty();
+	unguard;
+}
+
+void FRenderTraceWriter::Put( const void* Data, INT Size )
+{
+	INT Index = Buffer.Add( Size );
+	appMemcpy( &Buffer(Index), Data, Size );
+}
+
+void FRenderTraceWriter::FlushBuffer()
+{
+	guard(FRenderTraceWriter::FlushBuffer);
+	if( File && Buffer.Num() )
+	{
+		appFwrite( &Buffer(0), 1, Buffer.Num(), File );
+		TotalBytes += Buffer.Num();
+	}
+	Buffer.Empty();
+	unguard;
+}
+
+//
+// Write the frame's scene node if it differs from the last one written.
+//
+void FRenderTraceWriter::PutSceneNode( FSceneNode* Frame )
+{
+	FRenderTraceNode Node;
+	appMemset( &Node, 0, sizeof(Node) );
+	Node.X        = Frame->X;
+	Node.Y        = Frame->Y;
+	Node.XB       = Frame->XB;
+	Node.YB       = Frame->YB;
+	Node.FovAngle = Frame->Viewport->Actor->FovAngle;
+	Node.Coords   = Frame->Coords;
+	if( !HaveNode || appMemcmp( &Node, &LastNode, sizeof(Node) )!=0 )
+	{
+		PutRecord( RTR_SceneNode );
+		Put( Node );
+		LastNode = Node;
+		HaveNode = 1;
+	}
+}
+
+//
+// Write a texture's contents unless the trace already has them.
+//
+void FRenderTraceWriter::PutTexture( FTextureInfo& Info )
+{
+	guardSlow(FRenderTraceWriter::PutTexture);
+
+	QWORD* PaletteCacheID = Textures.Find( Info.CacheID );
+	if( PaletteCacheID && *PaletteCacheID==Info.PaletteCacheID && !(Info.TextureFlags & TF_RealtimeChanged) )
+		return;
+	Textures.Add( Info.CacheID, Info.PaletteCacheID );
+
+	BYTE Format     = Info.Format;
+	BYTE NumMips    = Info.NumMips;
+	BYTE HasPalette = Info.Palette!=NULL;
+	BYTE HasMax     = Info.MaxColor!=NULL;
+	PutRecord( RTR_Texture );
+	Put( Info.CacheID );
+	Put( Info.PaletteCacheID );
+	Put( Format );
+	Put( NumMips );
+	Put( HasPalette );
+	Put( HasMax );
+	Put( Info.UScale );
+	Put( Info.VScale );
+	Put( Info.USize );
+	Put( Info.VSize );
+	Put( Info.UClamp );
+	Put( Info.VClamp );
+	Put( Info.TextureFlags );
+	if( HasPalette )
+		Put( Info.Palette, 256 * sizeof(FColor) );
+	if( HasMax )
+		Put( *Info.MaxColor );
+	for( INT i=0; i<NumMips; i++ )
+	{
+		FMipmap* Mip = Info.Mips[i];
+		Put( Mip->USize );
+		Put( Mip->VSize );
+		Put( Mip->UBits );
+		Put( Mip->VBits );
+		Put( Mip->DataPtr, Mip->USize * Mip->VSize * TraceTexelBytes(Format) );
+	}
+
+	// Written, so treat it like a device that just uploaded it.
+	Info.TextureFlags &= ~TF_RealtimeChanged;
+
+	unguardSlow;
+}
+
+void FRenderTraceWriter::PutTextureRef( FTextureInfo& Info )
+{
+	Put( Info.CacheID );
+	Put( Info.Pan );
+}
+
+void FRenderTraceWriter::Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags )
+{
+	PutRecord( RTR_Lock );
+	Put( FlashScale );
+	Put( FlashFog );
+	Put( ScreenClear );
+	Put( RenderLockFlags );
+}
+
+void FRenderTraceWriter::Unlock( UBOOL Blit )
+{
+	DWORD DoBlit = Blit;
+	PutRecord( RTR_Unlock );
+	Put( DoBlit );
+	FlushBuffer();
+}
+
+void FRenderTraceWriter::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet )
+{
+	guard(FRenderTraceWriter::DrawComplexSurface);
+
+	FTextureInfo* Maps[5] = { Surface.Texture, Surface.LightMap, Surface.MacroTexture, Surface.DetailTexture, Surface.FogMap };
+	BYTE MapMask = 0;
+	for( INT i=0; i<ARRAY_COUNT(Maps); i++ )
+	{
+		if( Maps[i] )
+		{
+			PutTexture( *Maps[i] );
+			MapMask |= 1<<i;
+		}
+	}
+	PutSceneNode( Frame );
+
+	INT NumPolys = 0;
+	for( FSavedPoly* Poly=Facet.Polys; Poly; Poly=Poly->Next )
+		NumPolys++;
+
+	PutRecord( RTR_ComplexSurface );
+	Put( Surface.PolyFlags );
+	Put( Surface.FlatColor );
+	Put( MapMask );
+	for( INT i=0; i<ARRAY_COUNT(Maps); i++ )
+		if( Maps[i] )
+			PutTextureRef( *Maps[i] );
+	Put( Facet.MapCoords );
+	Put( Facet.MapUncoords );
+	Put( NumPolys );
+	for( FSavedPoly* Poly=Facet.Polys; Poly; Poly=Poly->Next )
+	{
+		Put( Poly->NumPts );
+		for( INT i=0; i<Poly->NumPts; i++ )
+		{
+			FRenderTraceVertex V;
+			V.Point   = Poly->Pts[i]->Point;
+			V.ScreenX = Poly->Pts[i]->ScreenX;
+			V.ScreenY = Poly->Pts[i]->ScreenY;
+			V.RZ      = Poly->Pts[i]->RZ;
+			Put( V );
+		}
+	}
+
+	unguard;
+}
+
+void FRenderTraceWriter::DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Info, FTransTexture** Pts, INT NumPts, DWORD PolyFlags )
+{
+	guard(FRenderTraceWriter::DrawGouraudPolygon);
+
+	PutTexture( Info );
+	PutSceneNode( Frame );
+	PutRecord( RTR_GouraudPolygon );
+	PutTextureRef( Info );
+	Put( PolyFlags );
+	Put( NumPts );
+	for( INT i=0; i<NumPts; i++ )
+	{
+		FRenderTraceGouraudVertex V;
+		V.Point   = Pts[i]->Point;
+		V.ScreenX = Pts[i]->ScreenX;
+		V.ScreenY = Pts[i]->ScreenY;
+		V.RZ      = Pts[i]->RZ;
+		V.Light   = Pts[i]->Light;
+		V.Fog     = Pts[i]->Fog;
+		V.U       = Pts[i]->U;
+		V.V       = Pts[i]->V;
+		Put( V );
+	}
+
+	unguard;
+}
+
+void FRenderTraceWriter::DrawTile( FSceneNode* Frame, FTextureInfo& Info, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, FLOAT Z, FPlane Color, FPlane Fog, DWORD PolyFlags )
+{
+	guard(FRenderTraceWriter::DrawTile);
+
+	PutTexture( Info );
+	PutSceneNode( Frame );
+	PutRecord( RTR_Tile );
+	PutTextureRef( Info );
+	FLOAT Params[9] = { X, Y, XL, YL, U, V, UL, VL, Z };
+	Put( Params );
+	Put( Color );
+	Put( Fog );
+	Put( PolyFlags );
+
+	unguard;
+}
+
+void FRenderTraceWriter::Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 )
+{
+	PutSceneNode( Frame );
+	PutRecord( RTR_Line );
+	Put( Color );
+	Put( LineFlags );
+	Put( P1 );
+	Put( P2 );
+}
+
+void FRenderTraceWriter::Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2 )
+{
+	PutSceneNode( Frame );
+	PutRecord( RTR_Point );
+	Put( Color );
+	Put( LineFlags );
+	FLOAT Rect[4] = { X1, Y1, X2, Y2 };
+	Put( Rect );
+}
+
+void FRenderTraceWriter::ClearZ( FSceneNode* Frame )
+{
+	PutSceneNode( Frame );
+	PutRecord( RTR_ClearZ );
+}
+
+void FRenderTraceWriter::EndFlash()
+{
+	PutRecord( RTR_EndFlash );
+}
+
+/*-----------------------------------------------------------------------------
+	FRenderTraceReplay.
+-----------------------------------------------------------------------------*/
+
+FRenderTraceReplay::FRenderTraceReplay()
+:	SizeX		( 0 )
+,	SizeY		( 0 )
+,	Data		( NULL )
+,	DataSize	( 0 )
+,	Pos			( 0 )
+,	Locked		( 0 )
+{}
+
+FRenderTraceReplay::~FRenderTraceReplay()
+{
+	Free();
+}
+
+UBOOL FRenderTraceReplay::Load( const char* Filename )
+{
+	guard(FRenderTraceReplay::Load);
+	Free();
+
+	FILE* F = appFopen( Filename, "rb" );
+	if( !F )
+	{
+		debugf( NAME_Warning, "Couldn't open render trace %s", Filename );
+		return 0;
+	}
+	appFseek( F, 0, SEEK_END );
+	DataSize = appFtell( F );
+	appFseek( F, 0, SEEK_SET );
+	Data = (BYTE*)appMalloc( Max(DataSize,1), "RenderTrace" );
+	INT Read = appFread( Data, 1, DataSize, F );
+	appFclose( F );
+
+	DWORD Magic=0, Version=0;
+	Pos = 0;
+	if( Read==DataSize && DataSize>=4*sizeof(DWORD) )
+	{
+		Get( Magic );
+		Get( Version );
+		Get( SizeX );
+		Get( SizeY );
+	}
+	if( Magic!=RENDER_TRACE_MAGIC || Version!=RENDER_TRACE_VERSION )
+	{
+		debugf( NAME_Warning, "%s is not a version %i render trace", Filename, RENDER_TRACE_VERSION );
+		Free();
+		return 0;
+	}
+
+	debugf( NAME_Log, "Loaded render trace %s: %i bytes, %ix%i", Filename, DataSize, SizeX, SizeY );
+	Rewind();
+	return 1;
+	unguard;
+}
+
+void FRenderTraceReplay::Free()
+{
+	guard(FRenderTraceReplay::Free);
+	for( INT i=0; i<Textures.Size(); i++ )
+	{
+		if( Textures[i]->MipData )
+			appFree( Textures[i]->MipData );
+		delete Textures[i];
+	}
+	Textures.Empty();
+	if( Data )
+		appFree( Data );
+	Data     = NULL;
+	DataSize = 0;
+	Pos      = 0;
+	unguard;
+}
+
+void FRenderTraceReplay::Rewind()
+{
+	Pos = 4 * sizeof(DWORD);
+	Locked = 0;
+}
+
+void FRenderTraceReplay::Get( void* Dest, INT Size )
+{
+	if( Pos + Size > DataSize )
+		appErrorf( "Render trace is truncated" );
+	appMemcpy( Dest, Data + Pos, Size );
+	Pos += Size;
+}
+
+//
+// Set up the scene node that following records are drawn with.
+//
+void FRenderTraceReplay::GetSceneNode( UViewport* Viewport )
+{
+	FRenderTraceNode Node;
+	Get( Node );
+
+	appMemset( &Frame, 0, sizeof(Frame) );
+	Frame.Viewport = Viewport;
+	Frame.Level    = Viewport->Actor->XLevel;
+	Frame.Mirror   = 1.0;
+	Frame.X        = Node.X;
+	Frame.Y        = Node.Y;
+	Frame.XB       = Node.XB;
+	Frame.YB       = Node.YB;
+	Frame.Coords   = Node.Coords;
+	Frame.Uncoords = Node.Coords.Transpose();
+	Viewport->Actor->FovAngle = Node.FovAngle;
+	Frame.ComputeRenderSize();
+}
+
+//
+// Create or update a texture from the trace.
+//
+void FRenderTraceReplay::GetTexture()
+{
+	guard(FRenderTraceReplay::GetTexture);
+
+	QWORD CacheID;
+	Get( CacheID );
+	FReplayTexture** Found = Textures.Find( CacheID );
+	FReplayTexture* Tex;
+	if( Found )
+	{
+		Tex = *Found;
+	}
+	else
+	{
+		Tex = new FReplayTexture;
+		appMemset( &Tex->Info, 0, sizeof(Tex->Info) );
+		Tex->MipData     = NULL;
+		Tex->MipDataSize = 0;
+		Textures.Add( CacheID, Tex );
+	}
+
+	FTextureInfo& Info = Tex->Info;
+	BYTE Format, NumMips, HasPalette, HasMax;
+	Info.CacheID = CacheID;
+	Get( Info.PaletteCacheID );
+	Get( Format );
+	Get( NumMips );
+	Get( HasPalette );
+	Get( HasMax );
+	Get( Info.UScale );
+	Get( Info.VScale );
+	Get( Info.USize );
+	Get( Info.VSize );
+	Get( Info.UClamp );
+	Get( Info.VClamp );
+	Get( Info.TextureFlags );
+	check(NumMips<=MAX_MIPS);
+	Info.Format   = (ETextureFormat)Format;
+	Info.NumMips  = NumMips;
+	Info.Palette  = NULL;
+	Info.MaxColor = NULL;
+	if( HasPalette )
+	{
+		Get( Tex->Palette, sizeof(Tex->Palette) );
+		Info.Palette = Tex->Palette;
+	}
+	if( HasMax )
+	{
+		Get( Tex->MaxColor );
+		Info.MaxColor = &Tex->MaxColor;
+	}
+
+	// Read the mip headers first so all the data fits in one block.
+	INT Size = 0, Start = Pos;
+	for( INT i=0; i<NumMips; i++ )
+	{
+		FMipmap& Mip = Tex->Mips[i];
+		Get( Mip.USize );
+		Get( Mip.VSize );
+		Get( Mip.UBits );
+		Get( Mip.VBits );
+		Pos += Mip.USize * Mip.VSize * TraceTexelBytes(Format);
+		Size += Mip.USize * Mip.VSize * TraceTexelBytes(Format);
+	}
+	if( Size > Tex->MipDataSize )
+	{
+		Tex->MipData     = (BYTE*)appRealloc( Tex->MipData, Size, "RenderTraceMips" );
+		Tex->MipDataSize = Size;
+	}
+	Pos = Start;
+	BYTE* Dest = Tex->MipData;
+	for( INT i=0; i<NumMips; i++ )
+	{
+		FMipmap& Mip = Tex->Mips[i];
+		Pos += sizeof(Mip.USize) + sizeof(Mip.VSize) + sizeof(Mip.UBits) + sizeof(Mip.VBits);
+		INT MipSize = Mip.USize * Mip.VSize * TraceTexelBytes(Format);
+		Get( Dest, MipSize );
+		Mip.DataPtr = Dest;
+		Info.Mips[i] = &Mip;
+		Dest += MipSize;
+	}
+
+	// Make devices pick up the new contents of a texture they already cached.
+	if( Found )
+		Info.TextureFlags |= TF_RealtimeChanged;
+
+	unguard;
+}
+
+FTextureInfo& FRenderTraceReplay::GetTextureRef()
+{
+	QWORD CacheID;
+	FVector Pan;
+	Get( CacheID );
+	Get( Pan );
+	FReplayTexture** Found = Textures.Find( CacheID );
+	if( !Found )
+		appErrorf( "Render trace uses undefined texture %08X%08X", (DWORD)(CacheID>>32), (DWORD)CacheID );
+	(*Found)->Info.Pan = Pan;
+	return (*Found)->Info;
+}
+
+UBOOL FRenderTraceReplay::ReplayFrame( UViewport* Viewport )
+{
+	guard(FRenderTraceReplay::ReplayFrame);
+	check(Viewport->RenDev);
+
+	URenderDevice* RenDev = Viewport->RenDev;
+	FLOAT SavedFovAngle = Viewport->Actor->FovAngle;
+	while( Pos < DataSize )
+	{
+		FMemMark Mark(GMem);
+		BYTE Record;
+		Get( Record );
+		switch( Record )
+		{
+			case RTR_Lock:
+			{
+				FPlane FlashScale, FlashFog, ScreenClear;
+				DWORD RenderLockFlags;
+				Get( FlashScale );
+				Get( FlashFog );
+				Get( ScreenClear );
+				Get( RenderLockFlags );
+				Locked = Viewport->Lock( FlashScale, FlashFog, ScreenClear, RenderLockFlags );
+				break;
+			}
+			case RTR_Unlock:
+			{
+				DWORD Blit;
+				Get( Blit );
+				if( Locked )
+					Viewport->Unlock( Blit );
+				Locked = 0;
+				Viewport->Actor->FovAngle = SavedFovAngle;
+				Mark.Pop();
+				return 1;
+			}
+			case RTR_SceneNode:
+			{
+				GetSceneNode( Viewport );
+				break;
+			}
+			case RTR_Texture:
+			{
+				GetTexture();
+				break;
+			}
+			case RTR_ComplexSurface:
+			{
+				FSurfaceInfo Surface;
+				FSurfaceFacet Facet;
+				FTextureInfo** Maps[5] = { &Surface.Texture, &Surface.LightMap, &Surface.MacroTexture, &Surface.DetailTexture, &Surface.FogMap };
+				BYTE MapMask;
+				appMemset( &Surface, 0, sizeof(Surface) );
+				Get( Surface.PolyFlags );
+				Get( Surface.FlatColor );
+				Get( MapMask );
+				Surface.Level = Frame.Level;
+				for( INT i=0; i<ARRAY_COUNT(Maps); i++ )
+					if( MapMask & (1<<i) )
+						*Maps[i] = &GetTextureRef();
+				Get( Facet.MapCoords );
+				Get( Facet.MapUncoords );
+				Facet.Span  = NULL;
+				Facet.Polys = NULL;
+
+				// Rebuild the polys in their original order.
+				INT NumPolys;
+				Get( NumPolys );
+				FSavedPoly** Link = &Facet.Polys;
+				for( INT i=0; i<NumPolys; i++ )
+				{
+					INT NumPts;
+					Get( NumPts );
+					FSavedPoly* Poly = (FSavedPoly*)New<BYTE>(GMem,sizeof(FSavedPoly)+NumPts*sizeof(FTransform*));
+					FTransform* Pts  = New<FTransform>(GMem,NumPts);
+					Poly->Next   = NULL;
+					Poly->User   = NULL;
+					Poly->NumPts = NumPts;
+					for( INT j=0; j<NumPts; j++ )
+					{
+						FRenderTraceVertex V;
+						Get( V );
+						Pts[j].Point   = V.Point;
+						Pts[j].Flags   = 0;
+						Pts[j].ScreenX = V.ScreenX;
+						Pts[j].ScreenY = V.ScreenY;
+						Pts[j].IntY    = appFloor( V.ScreenY );
+						Pts[j].RZ      = V.RZ;
+						Poly->Pts[j]   = &Pts[j];
+					}
+					*Link = Poly;
+					Link  = &Poly->Next;
+				}
+				if( Locked )
+					RenDev->DrawComplexSurface( &Frame, Surface, Facet );
+				break;
+			}
+			case RTR_GouraudPolygon:
+			{
+				FTextureInfo& Info = GetTextureRef();
+				DWORD PolyFlags;
+				INT NumPts;
+				Get( PolyFlags );
+				Get( NumPts );
+				FTransTexture*  Pts  = New<FTransTexture>(GMem,NumPts);
+				FTransTexture** PPts = New<FTransTexture*>(GMem,NumPts);
+				for( INT i=0; i<NumPts; i++ )
+				{
+					FRenderTraceGouraudVertex V;
+					Get( V );
+					Pts[i].Point   = V.Point;
+					Pts[i].Flags   = 0;
+					Pts[i].ScreenX = V.ScreenX;
+					Pts[i].ScreenY = V.ScreenY;
+					Pts[i].IntY    = appFloor( V.ScreenY );
+					Pts[i].RZ      = V.RZ;
+					Pts[i].Normal  = FPlane(0,0,0,0);
+					Pts[i].Light   = V.Light;
+					Pts[i].Fog     = V.Fog;
+					Pts[i].U       = V.U;
+					Pts[i].V       = V.V;
+					PPts[i]        = &Pts[i];
+				}
+				if( Locked )
+					RenDev->DrawGouraudPolygon( &Frame, Info, PPts, NumPts, PolyFlags, NULL );
+				break;
+			}
+			case RTR_Tile:
+			{
+				FTextureInfo& Info = GetTextureRef();
+				FLOAT P[9];
+				FPlane Color, Fog;
+				DWORD PolyFlags;
+				Get( P );
+				Get( Color );
+				Get( Fog );
+				Get( PolyFlags );
+				if( Locked )
+					RenDev->DrawTile( &Frame, Info, P[0], P[1], P[2], P[3], P[4], P[5], P[6], P[7], NULL, P[8], Color, Fog, PolyFlags );
+				break;
+			}
+			case RTR_Line:
+			{
+				FPlane Color;
+				DWORD LineFlags;
+				FVector P1, P2;
+				Get( Color );
+				Get( LineFlags );
+				Get( P1 );
+				Get( P2 );
+				if( Locked )
+					RenDev->Draw2DLine( &Frame, Color, LineFlags, P1, P2 );
+				break;
+			}
+			case RTR_Point:
+			{
+				FPlane Color;
+				DWORD LineFlags;
+				FLOAT R[4];
+				Get( Color );
+				Get( LineFlags );
+				Get( R );
+				if( Locked )
+					RenDev->Draw2DPoint( &Frame, Color, LineFlags, R[0], R[1], R[2], R[3] );
+				break;
+			}
+			case RTR_ClearZ:
+			{
+				if( Locked )
+					RenDev->ClearZ( &Frame );
+				break;
+			}
+			case RTR_EndFlash:
+			{
+				if( Locked )
+					RenDev->EndFlash();
+				break;
+			}
+			default:
+			{
+				appErrorf( "Bad render trace record %i at offset %i", Record, Pos-1 );
+			}
+		}
+		Mark.Pop();
+	}
+	Viewport->Actor->FovAngle = SavedFovAngle;
+	return 0;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
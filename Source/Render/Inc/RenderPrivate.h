@@ -60,6 +60,7 @@ public:
 	virtual void FinishActor()=0;
 	virtual FPlane Light( FTransSample& Point, DWORD ExtraFlags )=0;
 	virtual FPlane Fog( FTransSample& Point, DWORD ExtraFlags )=0;
+	virtual UBOOL Exec( const char* Cmd, FOutputDevice* Out )=0;
 };
 
 /*------------------------------------------------------------------------------------
@@ -435,6 +436,7 @@ class RENDER_API URender : public URenderBase
 	void SetupDynamics( FSceneNode* Frame, AActor* Exclude );
 	UBOOL BoundVisible( FSceneNode* Frame, FBox* Bound, FSpanBuffer* SpanBuffer, FScreenBounds& Results );
 	void GlobalLighting( UBOOL Realtime, AActor* Owner, FLOAT& Brightness, FPlane& Color );
+	void GetRenderTimes( FRenderTimes& Times );
 	FSceneNode* CreateMasterFrame( UViewport* Viewport, FVector Location, FRotator Rotation, FScreenBounds* Bounds );
 	FSceneNode* CreateChildFrame( FSceneNode* Frame, FSpanBuffer* Span, ULevel* Level, INT iSurf, INT iZone, FLOAT Mirror, const FPlane& NearClip, const FCoords& Coords, FScreenBounds* Bounds );
 	void Draw2DClippedLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 );
@@ -468,6 +470,7 @@ class RENDER_API URender : public URenderBase
 	DOUBLE					LastEndTime;
 	DOUBLE					ThisStartTime;
 	DOUBLE					ThisEndTime;
+	FRenderTimes			LastTimes;
 	DWORD					NodesDraw;
 	DWORD					PolysDraw;
 
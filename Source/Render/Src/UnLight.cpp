@@ -100,6 +100,15 @@ Revision history:
 #include "RenderPrivate.h"
 #include <math.h>
 
+// SIMD support for lightmap rows.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+	#include <emmintrin.h>
+	#define LIGHT_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define LIGHT_NEON 1
+#endif
+
 #define SHADOW_SMOOTHING 1 /* Smooth shadows (should be 1) */
 #define ZERO_FLOAT_LIGHT (FLOAT)((3<<22) + 0x10)
 
@@ -132,10 +141,13 @@ public:
 	void FinishActor();
 	FPlane Light( FTransSample& Point, DWORD PolyFlags );
 	FPlane Fog( FTransSample& Point, DWORD PolyFlags );
+	UBOOL Exec( const char* Cmd, FOutputDevice* Out );
 
 	// Constants.
 	class FLightInfo;
 	enum {MAX_LIGHTS=256};
+	enum {MAX_ROW=1024};			// Longest row the SIMD distances are buffered for.
+	enum {MAX_WAVER_SCALES=256+3};	// One scale per random key, plus a four texel overrun.
 
 	// Function pointer types.
 	typedef void (*LIGHT_SPATIAL_FUNC)( FTextureInfo& Tex, FLightInfo* Info, BYTE* Src, BYTE* Dest );
@@ -216,6 +228,11 @@ public:
 	// FLightManager functions.
 	static void Merge( FTextureInfo& Tex, BYTE LightEffect, INT Key, FLightInfo* Light, DWORD* Stream, DWORD* Dest );
 	static FLOAT Volumetric( FLightInfo* Info, FVector& Vertex );
+	static void LightRow( BYTE* Src, BYTE* Dest, INT Count, DWORD Inner0, DWORD Inner1, INT Inner2, FLOAT Diffuse, UBOOL Simd );
+	static INT* DistanceRow( FVector Vertex, FVector VertexDU, FLOAT RRadiusMult, INT Count, INT* Result, UBOOL Simd );
+	static void WaverScales( BYTE Effect, DOUBLE* Scales );
+	static INT WaverRow( BYTE Effect, const DOUBLE* Scales, BYTE* Src, BYTE* Dest, INT Count, INT Key, UBOOL Simd );
+	static void MergeRow( DWORD* Stream, DWORD* Dest, BYTE* Src, FColor* Palette, INT Count, UBOOL Simd );
 	void ShadowMapGen( FTextureInfo& Tex, BYTE* SrcBits, BYTE* Dest1 );
 	UBOOL AddLight( AActor* Actor, AActor* Other );
 
@@ -239,6 +256,7 @@ public:
 	static INT              TemporaryTablesBuilt;
 	static FLOAT			BackdropBrightness;
 	static FLOAT            LightSqrt[4096];
+	static UBOOL			UseSimd;
 	static FILTER_TAB		FilterTab[128];
 	static BYTE				ByteMuck[0x4000];
 	static AActor*			Actor;
@@ -282,6 +300,7 @@ AActor*							FLightManager::Actor;
 INT								FLightManager::TemporaryTablesBuilt;
 FLOAT							FLightManager::BackdropBrightness;
 FLOAT							FLightManager::LightSqrt[4096];
+UBOOL							FLightManager::UseSimd;
 FCacheItem*						FLightManager::ItemsToUnlock[MAX_UNLOCKED_ITEMS];
 FCacheItem**					FLightManager::TopItemToUnlock;
 
@@ -431,6 +450,13 @@ void FLightManager::Init()
 	// Cache items.
 	TopItemToUnlock = &ItemsToUnlock[0];
 
+	// SIMD rows, unless told to stick to the scalar loops.
+#if LIGHT_SSE2 || LIGHT_NEON
+	UseSimd = !ParseParam( appCmdLine(), "NOLIGHTSIMD" );
+#else
+	UseSimd = 0;
+#endif
+
 	// Success.
 	debugf( NAME_Init, "Lighting subsystem initialized" );
 	unguard;
@@ -670,6 +696,293 @@ inline FPlane FLightManager::Fog(FTransSample& Vert, DWORD PolyFlags )
 }
 
 
+/*------------------------------------------------------------------------------------
+	Row kernels.
+------------------------------------------------------------------------------------*/
+
+//
+// The innermost loops of light accumulation, spatial distances and merging,
+// each working on one row of a map. The scalar versions are the original
+// loops; the SIMD versions handle four texels at a time and fall back to
+// the scalar loop for what's left of the row.
+//
+#if LIGHT_SSE2
+static inline __m128i LoadBytes4( const BYTE* P )
+{
+	INT V;
+	appMemcpy( &V, P, 4 );
+	__m128i Zero = _mm_setzero_si128();
+	return _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128(V), Zero ), Zero );
+}
+static inline void StoreBytes4( BYTE* P, __m128i V )
+{
+	INT R = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packs_epi32( V, V ), V ) );
+	appMemcpy( P, &R, 4 );
+}
+#elif LIGHT_NEON
+static inline uint32x4_t LoadBytes4( const BYTE* P )
+{
+	uint32_t V;
+	appMemcpy( &V, P, 4 );
+	return vmovl_u16( vget_low_u16( vmovl_u8( vreinterpret_u8_u32( vdup_n_u32(V) ) ) ) );
+}
+static inline void StoreBytes4( BYTE* P, uint32x4_t V )
+{
+	uint16x4_t H = vmovn_u32( V );
+	uint32_t   R = vget_lane_u32( vreinterpret_u32_u8( vmovn_u16( vcombine_u16(H,H) ) ), 0 );
+	appMemcpy( P, &R, 4 );
+}
+#endif
+
+//
+// Forward difference the squared distance along a row and light it.
+//
+void FLightManager::LightRow( BYTE* Src, BYTE* Dest, INT Count, DWORD Inner0, DWORD Inner1, INT Inner2, FLOAT Diffuse, UBOOL Simd )
+{
+	INT Hecker;
+#if LIGHT_SSE2 || LIGHT_NEON
+	if( Simd && Count>=4 )
+	{
+		// Step each lane four texels at a time: the squared distance moves
+		// by 4*Inner1 + 6*Inner2 and its difference by 4*Inner2.
+		DWORD D0[4], D1[4];
+		INT   Index[4];
+		for( INT k=0; k<4; k++ )
+		{
+			D0[k]   = Inner0;
+			D1[k]   = Inner1;
+			Inner0 += Inner1;
+			Inner1 += Inner2;
+		}
+		INT n = Count & ~3;
+#if LIGHT_SSE2
+		__m128i I0 = _mm_loadu_si128( (__m128i*)D0 ), I1 = _mm_loadu_si128( (__m128i*)D1 );
+		__m128i Step0 = _mm_set1_epi32( (DWORD)Inner2*6 ), Step1 = _mm_set1_epi32( (DWORD)Inner2*4 );
+		__m128i Zero = _mm_setzero_si128(), Mask = _mm_set1_epi32( 4095 ), Low = _mm_set1_epi32( 255 );
+		__m128  Diff = _mm_set1_ps( Diffuse ), Magic = _mm_set1_ps( 2<<22 );
+		for( INT i=0; i<n; i+=4 )
+		{
+			__m128i S  = LoadBytes4( Src+i );
+			__m128i Ok = _mm_andnot_si128( _mm_cmpeq_epi32(S,Zero), _mm_cmpeq_epi32(_mm_srli_epi32(I0,24),Zero) );
+			_mm_storeu_si128( (__m128i*)Index, _mm_and_si128(_mm_srli_epi32(I0,12),Mask) );
+			__m128  Sqrt = _mm_set_ps( LightSqrt[Index[3]], LightSqrt[Index[2]], LightSqrt[Index[1]], LightSqrt[Index[0]] );
+			__m128  F    = _mm_add_ps( _mm_mul_ps( _mm_mul_ps(_mm_cvtepi32_ps(S),Diff), Sqrt ), Magic );
+			StoreBytes4( Dest+i, _mm_and_si128( _mm_and_si128(_mm_castps_si128(F),Ok), Low ) );
+			I0 = _mm_add_epi32( _mm_add_epi32( I0, _mm_slli_epi32(I1,2) ), Step0 );
+			I1 = _mm_add_epi32( I1, Step1 );
+		}
+		Inner0 = _mm_cvtsi128_si32( I0 );
+		Inner1 = _mm_cvtsi128_si32( I1 );
+#else
+		uint32x4_t I0 = vld1q_u32( D0 ), I1 = vld1q_u32( D1 );
+		uint32x4_t Step0 = vdupq_n_u32( (DWORD)Inner2*6 ), Step1 = vdupq_n_u32( (DWORD)Inner2*4 );
+		uint32x4_t Zero = vdupq_n_u32( 0 ), Mask = vdupq_n_u32( 4095 ), Low = vdupq_n_u32( 255 );
+		float32x4_t Diff = vdupq_n_f32( Diffuse ), Magic = vdupq_n_f32( 2<<22 );
+		for( INT i=0; i<n; i+=4 )
+		{
+			uint32x4_t S  = LoadBytes4( Src+i );
+			uint32x4_t Ok = vandq_u32( vtstq_u32(S,S), vceqq_u32(vshrq_n_u32(I0,24),Zero) );
+			vst1q_u32( (uint32_t*)Index, vandq_u32(vshrq_n_u32(I0,12),Mask) );
+			FLOAT Lanes[4] = { LightSqrt[Index[0]], LightSqrt[Index[1]], LightSqrt[Index[2]], LightSqrt[Index[3]] };
+			float32x4_t F = vaddq_f32( vmulq_f32( vmulq_f32(vcvtq_f32_u32(S),Diff), vld1q_f32(Lanes) ), Magic );
+			StoreBytes4( Dest+i, vandq_u32( vandq_u32(vreinterpretq_u32_f32(F),Ok), Low ) );
+			I0 = vaddq_u32( vaddq_u32( I0, vshlq_n_u32(I1,2) ), Step0 );
+			I1 = vaddq_u32( I1, Step1 );
+		}
+		Inner0 = vgetq_lane_u32( I0, 0 );
+		Inner1 = vgetq_lane_u32( I1, 0 );
+#endif
+		Src   += n;
+		Dest  += n;
+		Count -= n;
+	}
+#endif
+	for( INT U=0; U<Count; U++ )
+	{
+		if( *Src!=0 && Inner0<4096*4096 ) 
+		{
+			*(FLOAT*)&Hecker = *Src * Diffuse * LightSqrt[Inner0>>12] + (2<<22);
+			*Dest = Hecker;
+		}
+		else *Dest = 0;
+		Src++;
+		Dest++;
+		Inner0 += Inner1;
+		Inner1 += Inner2;
+	}
+}
+
+//
+// Compute the light table offsets of a row of points relative to a light,
+// as the spatial effects use them. Returns NULL if the row should be done
+// per texel instead.
+//
+INT* FLightManager::DistanceRow( FVector Vertex, FVector VertexDU, FLOAT RRadiusMult, INT Count, INT* Result, UBOOL Simd )
+{
+#if LIGHT_SSE2 || LIGHT_NEON
+	if( !Simd || Count>MAX_ROW )
+		return NULL;
+
+	// Step the points exactly as the per texel loop does, a whole point to
+	// a register, then transpose them to square and round four at a time.
+	// The values are never negative, so truncating is the same as appFloor.
+	FLOAT Point[16];
+	INT i=0;
+#if LIGHT_SSE2
+	__m128 V  = _mm_setr_ps( Vertex.X, Vertex.Y, Vertex.Z, 0.0f );
+	__m128 DU = _mm_setr_ps( VertexDU.X, VertexDU.Y, VertexDU.Z, 0.0f );
+	__m128 Mult = _mm_set1_ps( RRadiusMult ), Half = _mm_set1_ps( 0.5f );
+	for( ; i+4<=Count; i+=4 )
+	{
+		__m128 X = V, Y = _mm_add_ps(X,DU), Z = _mm_add_ps(Y,DU), W = _mm_add_ps(Z,DU);
+		V = _mm_add_ps( W, DU );
+		_MM_TRANSPOSE4_PS( X, Y, Z, W );
+		__m128 D = _mm_add_ps( _mm_add_ps( _mm_mul_ps(X,X), _mm_mul_ps(Y,Y) ), _mm_mul_ps(Z,Z) );
+		_mm_storeu_si128( (__m128i*)(Result+i), _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps(D,Mult), Half ) ) );
+	}
+	_mm_storeu_ps( Point, V );
+#else
+	Point[0] = Vertex.X;   Point[1] = Vertex.Y;   Point[2] = Vertex.Z;   Point[3] = 0.0f;
+	Point[4] = VertexDU.X; Point[5] = VertexDU.Y; Point[6] = VertexDU.Z; Point[7] = 0.0f;
+	float32x4_t V  = vld1q_f32( Point   );
+	float32x4_t DU = vld1q_f32( Point+4 );
+	float32x4_t Mult = vdupq_n_f32( RRadiusMult ), Half = vdupq_n_f32( 0.5f );
+	for( ; i+4<=Count; i+=4 )
+	{
+		for( INT k=0; k<16; k+=4,V=vaddq_f32(V,DU) )
+			vst1q_f32( Point+k, V );
+		float32x4x4_t P = vld4q_f32( Point );
+		float32x4_t   D = vaddq_f32( vaddq_f32( vmulq_f32(P.val[0],P.val[0]), vmulq_f32(P.val[1],P.val[1]) ), vmulq_f32(P.val[2],P.val[2]) );
+		vst1q_s32( (int32_t*)(Result+i), vcvtq_s32_f32( vaddq_f32( vmulq_f32(D,Mult), Half ) ) );
+	}
+	vst1q_f32( Point, V );
+#endif
+	Vertex = FVector( Point[0], Point[1], Point[2] );
+	for( ; i<Count; i++,Vertex+=VertexDU )
+		Result[i] = appRound( Vertex.SizeSquared() * RRadiusMult );
+	return Result;
+#else
+	return NULL;
+#endif
+}
+
+//
+// Build the per-key brightness scales of a merge-time effect.
+//
+void FLightManager::WaverScales( BYTE Effect, DOUBLE* Scales )
+{
+	for( INT i=0; i<MAX_WAVER_SCALES; i++ )
+	{
+		if( Effect==LE_TorchWaver )
+			Scales[i] = 0.95 + 0.05 * GRandoms->RandomBase(i);
+		else if( Effect==LE_FireWaver )
+			Scales[i] = 0.80 + 0.20 * GRandoms->RandomBase(i);
+		else
+			Scales[i] = 0.60 + 0.40 * GRandoms->Random(i);
+	}
+}
+
+//
+// Apply a merge-time effect to a row of an illumination map, returning
+// the next key.
+//
+INT FLightManager::WaverRow( BYTE Effect, const DOUBLE* Scales, BYTE* Src, BYTE* Dest, INT Count, INT Key, UBOOL Simd )
+{
+	INT i=0;
+#if LIGHT_SSE2
+	// Same double precision product as the scalar loop, so it's exact.
+	if( Simd )
+	{
+		__m128i Low = _mm_set1_epi32( 255 );
+		for( ; i+4<=Count; i+=4,Key+=4 )
+		{
+			const DOUBLE* S = Scales + (Key & 255);
+			__m128i B  = LoadBytes4( Src+i );
+			__m128d Lo = _mm_mul_pd( _mm_cvtepi32_pd(B), _mm_loadu_pd(S) );
+			__m128d Hi = _mm_mul_pd( _mm_cvtepi32_pd(_mm_shuffle_epi32(B,_MM_SHUFFLE(1,0,3,2))), _mm_loadu_pd(S+2) );
+			__m128  F  = _mm_movelh_ps( _mm_cvtpd_ps(Lo), _mm_cvtpd_ps(Hi) );
+			StoreBytes4( Dest+i, _mm_and_si128(_mm_cvttps_epi32(F),Low) );
+		}
+	}
+#elif LIGHT_NEON
+	// Single precision, so a texel may come out one lower or higher.
+	if( Simd )
+	{
+		uint32x4_t Low = vdupq_n_u32( 255 );
+		for( ; i+4<=Count; i+=4,Key+=4 )
+		{
+			const DOUBLE* S = Scales + (Key & 255);
+			FLOAT Lanes[4] = { (FLOAT)S[0], (FLOAT)S[1], (FLOAT)S[2], (FLOAT)S[3] };
+			float32x4_t F  = vmulq_f32( vcvtq_f32_u32(LoadBytes4(Src+i)), vld1q_f32(Lanes) );
+			StoreBytes4( Dest+i, vandq_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(F)),Low) );
+		}
+	}
+#endif
+	if( Effect==LE_TorchWaver )
+	{
+		for( ; i<Count; i++ )
+			Dest[i] = appFloor((FLOAT)Src[i] * (0.95 + 0.05 * GRandoms->RandomBase(Key++)));
+	}
+	else if( Effect==LE_FireWaver )
+	{
+		for( ; i<Count; i++ )
+			Dest[i] = appFloor((FLOAT)Src[i] * (0.80 + 0.20 * GRandoms->RandomBase(Key++)));
+	}
+	else if( Effect==LE_WateryShimmer )
+	{
+		for( ; i<Count; i++ )
+			Dest[i] = appFloor((FLOAT)Src[i] * (0.60 + 0.40 * GRandoms->Random(Key++)));
+	}
+	return Key;
+}
+
+//
+// Scale a row of an illumination map by a palette and add it to a row of
+// light, saturating each byte at 0x7f.
+//
+void FLightManager::MergeRow( DWORD* Stream, DWORD* Dest, BYTE* Src, FColor* Palette, INT Count, UBOOL Simd )
+{
+	INT j=0;
+#if LIGHT_SSE2
+	if( Simd )
+	{
+		__m128i High = _mm_set1_epi32( 0x80808080 ), Rest = _mm_set1_epi32( 0x7f7f7f7f );
+		for( ; j+4<=Count; j+=4 )
+		{
+			__m128i P   = _mm_set_epi32( Palette[Src[j+3]].D, Palette[Src[j+2]].D, Palette[Src[j+1]].D, Palette[Src[j]].D );
+			__m128i D   = _mm_add_epi32( _mm_loadu_si128((__m128i*)(Stream+j)), P );
+			__m128i Sat = _mm_and_si128( D, High );
+			Sat = _mm_sub_epi32( Sat, _mm_srli_epi32(Sat,7) );
+			_mm_storeu_si128( (__m128i*)(Dest+j), _mm_or_si128(_mm_and_si128(D,Rest),Sat) );
+		}
+	}
+#elif LIGHT_NEON
+	if( Simd )
+	{
+		uint32x4_t High = vdupq_n_u32( 0x80808080 ), Rest = vdupq_n_u32( 0x7f7f7f7f );
+		for( ; j+4<=Count; j+=4 )
+		{
+			DWORD Lanes[4] = { Palette[Src[j]].D, Palette[Src[j+1]].D, Palette[Src[j+2]].D, Palette[Src[j+3]].D };
+			uint32x4_t D   = vaddq_u32( vld1q_u32((uint32_t*)(Stream+j)), vld1q_u32((uint32_t*)Lanes) );
+			uint32x4_t Sat = vandq_u32( D, High );
+			Sat = vsubq_u32( Sat, vshrq_n_u32(Sat,7) );
+			vst1q_u32( (uint32_t*)(Dest+j), vorrq_u32(vandq_u32(D,Rest),Sat) );
+		}
+	}
+#endif
+	for( ; j<Count; j++ )
+	{
+		Dest[j] = Stream[j] + Palette[Src[j]].D;
+		if( Dest[j] & 0x80808080 )
+		{
+			// Handle saturation.
+			DWORD SatMask = Dest[j] & 0x80808080;
+			SatMask -= (SatMask >>7);
+			Dest[j] = (Dest[j] & 0x7f7f7f7f) | SatMask;
+		}
+	}
+}
+
 /*------------------------------------------------------------------------------------
 	Light merging.
 ------------------------------------------------------------------------------------*/
@@ -696,45 +1009,25 @@ void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo*
 	Dest   += Info->MinV * Tex.USize;
 	Stream += Info->MinV * Tex.USize;
 
+	// Effect scales for the SIMD rows, once for the whole map.
+	DOUBLE Scales[MAX_WAVER_SCALES];
+	if( FXDetect && UseSimd )
+		WaverScales( Effect, Scales );
 
 	for( INT i=Info->MinV; i<Info->MaxV; i++ )
 	{
 		BYTE* NewSrc = Src;
+		BYTE  Temp[1024];
 
 		// Execute merge-time effects.
 		if( FXDetect )
 		{
-			BYTE Temp[1024];
 			NewSrc = Temp;
-			if( Effect==LE_TorchWaver )
-			{
-				for( INT i=Info->MinU; i<Info->MaxU; i++ )
-					Temp[i] = appFloor((FLOAT)Src[i] * (0.95 + 0.05 * GRandoms->RandomBase(Key++)));
-			}
-			else if( Effect==LE_FireWaver )
-			{
-				for( INT i=Info->MinU; i<Info->MaxU; i++ )
-					Temp[i] = appFloor((FLOAT)Src[i] * (0.80 + 0.20 * GRandoms->RandomBase(Key++)));
-			}
-			else if( Effect==LE_WateryShimmer )
-			{
-				for( INT i=Info->MinU; i<Info->MaxU; i++ )
-					Temp[i] = appFloor((FLOAT)Src[i] * (0.60 + 0.40 * GRandoms->Random(Key++)));
-			}
+			Key    = WaverRow( Effect, Scales, Src+Skip, Temp+Skip, Count, Key, UseSimd );
 		}
 
 		// Scale and merge the lighting.
-		for( INT j=Info->MinU; j<Info->MaxU; j++ )
-		{
-			Dest[j] = Stream[j] + Palette[NewSrc[j]].D;
-			if( Dest[j] & 0x80808080 )
-			{
-				// Handle saturation.
-				DWORD SatMask = Dest[j] & 0x80808080;
-				SatMask -= (SatMask >>7);
-				Dest[j] = (Dest[j] & 0x7f7f7f7f) | SatMask;
-			}
-		}
+		MergeRow( Stream+Skip, Dest+Skip, NewSrc+Skip, Palette, Count, UseSimd );
 
 		Src    += Tex.UClamp;
 		Stream += Tex.USize;
@@ -780,13 +1073,15 @@ void FLightManager::Merge( FTextureInfo& Tex, BYTE Effect, INT Key, FLightInfo*
 			if( SqrtOfs<4096 ) {
 
 #define SPATIAL_BEGIN1 \
+	INT SqrtRow[MAX_ROW]; \
 	SPATIAL_PRE \
 	FVector Vertex = Vertex1 - Info->Actor->Location; \
 	FLOAT	RRadiusMult = Info->RRadiusMult; \
 	FLOAT   Diffuse     = Info->Diffuse; \
+	INT*    RowOfs      = DistanceRow( Vertex, VertexDU, RRadiusMult, Info->MaxU-Info->MinU, SqrtRow, UseSimd ); \
 	for( INT UCounter=Info->MinU; UCounter<Info->MaxU; UCounter++,Vertex+=VertexDU,Src++,Dest++ ) { \
 		if( *Src ) { \
-			DWORD SqrtOfs = appRound( Vertex.SizeSquared() * RRadiusMult ); \
+			DWORD SqrtOfs = RowOfs ? RowOfs[UCounter-Info->MinU] : appRound( Vertex.SizeSquared() * RRadiusMult ); \
 			if( SqrtOfs<4096 ) {
 
 #define SPATIAL_END } else *Dest=0; } else *Dest=0; } SPATIAL_POST
@@ -803,7 +1098,6 @@ void FLightManager::spatial_None( FTextureInfo& Map, FLightInfo* Info, BYTE* Src
 	static FLOAT   Scale, Diffuse;
 	static INT     Dist, DistU, DistV, DistUU, DistVV, DistUV;
 	static INT     Interp00, Interp10, Interp20, Interp01, Interp11, Interp02;
-	static DWORD   Inner0, Inner1;
 	static INT     Hecker;
 
 	// Compute values for stepping through mesh points.
@@ -853,21 +1147,9 @@ void FLightManager::spatial_None( FTextureInfo& Map, FLightInfo* Info, BYTE* Src
 	for( INT VCounter=Info->MinV; VCounter<Info->MaxV; VCounter++ )
 	{
 		// Forward difference the square of the distance between the points.
-		Inner0 = Interp00;
-		Inner1 = Interp01;
-		for( INT U=Info->MinU; U<Info->MaxU; U++ )
-		{
-			if( *Src!=0 && Inner0<4096*4096 ) 
-			{
-				*(FLOAT*)&Hecker = *Src * Diffuse * LightSqrt[Inner0>>12] + (2<<22);
-				*Dest = Hecker;
-			}
-			else *Dest = 0;
-			Src++;
-			Dest++;
-			Inner0 += Inner1;
-			Inner1 += Interp02;
-		}
+		LightRow( Src, Dest, Info->MaxU-Info->MinU, Interp00, Interp01, Interp02, Diffuse, UseSimd );
+		Src  += Info->MaxU-Info->MinU;
+		Dest += Info->MaxU-Info->MinU;
 		Interp00 += Interp10;
 		Interp10 += Interp20;
 		Interp01 += Interp11;
@@ -2314,6 +2596,178 @@ void FLightManager::FinishActor()
 	unguard;
 }
 
+/*------------------------------------------------------------------------------------
+	Row kernel benchmark.
+------------------------------------------------------------------------------------*/
+
+// Texels per benchmark row, not a multiple of four so the scalar tails run too.
+enum {LIGHTBENCH_ROW=253};
+
+//
+// Count the values where two runs of a kernel disagree.
+//
+template<class T> static INT CompareRows( const T* A, const T* B, INT Count, INT& MaxDiff )
+{
+	INT Differ=0;
+	for( INT i=0; i<Count; i++ )
+	{
+		if( A[i]!=B[i] )
+		{
+			Differ++;
+			MaxDiff = Max( MaxDiff, Abs((INT)A[i]-(INT)B[i]) );
+		}
+	}
+	return Differ;
+}
+static void LogStage( FOutputDevice* Out, const char* Name, INT Count, DOUBLE ScalarTime, DOUBLE SimdTime, INT Differ, INT MaxDiff )
+{
+	Out->Logf
+	(
+		"%-9s %i values, scalar %.2f ms, SIMD %.2f ms, %i differ by up to %i",
+		Name,
+		Count,
+		ScalarTime * 1000.0,
+		SimdTime * 1000.0,
+		Differ,
+		MaxDiff
+	);
+}
+
+//
+// Run each row kernel on random rows with and without SIMD, log the time
+// of each and check that they agree.
+//
+UBOOL FLightManager::Exec( const char* Cmd, FOutputDevice* Out )
+{
+	guard(FLightManager::Exec);
+#if LIGHT_SSE2 || LIGHT_NEON
+	INT NumRows=4096;
+	Parse( Cmd, "ROWS=", NumRows );
+	NumRows = Max( NumRows, 1 );
+	INT      Texels  = NumRows * LIGHTBENCH_ROW;
+	BYTE*    Src     = (BYTE   *)appMalloc( Texels, "LightBench" );
+	BYTE*    Scalar  = (BYTE   *)appMalloc( Texels, "LightBench" );
+	BYTE*    Simd    = (BYTE   *)appMalloc( Texels, "LightBench" );
+	DWORD*   Stream  = (DWORD  *)appMalloc( Texels * sizeof(DWORD), "LightBench" );
+	DWORD*   Scalar4 = (DWORD  *)appMalloc( Texels * sizeof(DWORD), "LightBench" );
+	DWORD*   Simd4   = (DWORD  *)appMalloc( Texels * sizeof(DWORD), "LightBench" );
+	INT*     Inner   = (INT    *)appMalloc( NumRows * 3 * sizeof(INT), "LightBench" );
+	FVector* Points  = (FVector*)appMalloc( NumRows * 2 * sizeof(FVector), "LightBench" );
+	FColor   Palette[256];
+	DOUBLE   Scales[MAX_WAVER_SCALES], Start, ScalarTime, SimdTime;
+	INT      i, j, Differ, MaxDiff, TotalDiffer=0;
+
+	// Random illumination with one texel in eight unlit, and random light to merge into.
+	for( i=0; i<Texels; i++ )
+	{
+		Src[i]    = (appRand() & 7) ? appRand() : 0;
+		Stream[i] = ((DWORD)appRand()<<24) ^ ((DWORD)appRand()<<12) ^ appRand();
+	}
+	for( i=0; i<256; i++ )
+		Palette[i].D = ((DWORD)appRand()<<24) ^ ((DWORD)appRand()<<12) ^ appRand();
+
+	// Random rows around a light, set up the way spatial_None does it.
+	FLOAT Radius = 1024.0, Diffuse = 0.015f, RRadiusMult = 4093.0 / (Radius * Radius);
+	for( i=0; i<NumRows; i++ )
+	{
+		FVector Vertex   = FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ) * (2.0 * Radius);
+		FVector VertexDU = FVector( appFrand()-0.5, appFrand()-0.5, appFrand()-0.5 ) * (Radius / 32.0);
+		FLOAT   Scale    = RRadiusMult * 4096.0;
+		INT     DistUU   = appRound((VertexDU | VertexDU) * Scale);
+		Inner[i*3+0]     = appRound((Vertex   | Vertex  ) * Scale);
+		Inner[i*3+1]     = 2 * appRound((Vertex | VertexDU) * Scale) + DistUU;
+		Inner[i*3+2]     = 2 * DistUU;
+		Points[i*2+0]    = Vertex;
+		Points[i*2+1]    = VertexDU;
+	}
+
+	// Light accumulation.
+	for( INT Mode=0; Mode<2; Mode++ )
+	{
+		Start = appSeconds();
+		for( i=0; i<NumRows; i++ )
+			LightRow( Src+i*LIGHTBENCH_ROW, (Mode ? Simd : Scalar)+i*LIGHTBENCH_ROW, LIGHTBENCH_ROW, Inner[i*3+0], Inner[i*3+1], Inner[i*3+2], Diffuse, Mode );
+		(Mode ? SimdTime : ScalarTime) = appSeconds() - Start;
+	}
+	MaxDiff      = 0;
+	Differ       = CompareRows( Scalar, Simd, Texels, MaxDiff );
+	TotalDiffer += Differ;
+	LogStage( Out, "Light", Texels, ScalarTime, SimdTime, Differ, MaxDiff );
+
+	// Spatial effect distances.
+	INT* ScalarOfs = (INT*)Scalar4;
+	INT* SimdOfs   = (INT*)Simd4;
+	Start = appSeconds();
+	for( i=0; i<NumRows; i++ )
+	{
+		FVector Vertex = Points[i*2];
+		for( j=0; j<LIGHTBENCH_ROW; j++,Vertex+=Points[i*2+1] )
+			ScalarOfs[i*LIGHTBENCH_ROW+j] = appRound( Vertex.SizeSquared() * RRadiusMult );
+	}
+	ScalarTime = appSeconds() - Start;
+	Start = appSeconds();
+	for( i=0; i<NumRows; i++ )
+		DistanceRow( Points[i*2], Points[i*2+1], RRadiusMult, LIGHTBENCH_ROW, SimdOfs+i*LIGHTBENCH_ROW, 1 );
+	SimdTime     = appSeconds() - Start;
+	MaxDiff      = 0;
+	Differ       = CompareRows( ScalarOfs, SimdOfs, Texels, MaxDiff );
+	TotalDiffer += Differ;
+	LogStage( Out, "Distance", Texels, ScalarTime, SimdTime, Differ, MaxDiff );
+
+	// Merge-time effects.
+	static const BYTE WaverEffects[3] = { LE_TorchWaver, LE_FireWaver, LE_WateryShimmer };
+	ScalarTime = SimdTime = 0.0;
+	MaxDiff    = Differ   = 0;
+	for( INT e=0; e<3; e++ )
+	{
+		INT FirstKey = appRand();
+		WaverScales( WaverEffects[e], Scales );
+		for( INT Mode=0; Mode<2; Mode++ )
+		{
+			INT Key = FirstKey;
+			Start = appSeconds();
+			for( i=0; i<NumRows; i++ )
+				Key = WaverRow( WaverEffects[e], Scales, Src+i*LIGHTBENCH_ROW, (Mode ? Simd : Scalar)+i*LIGHTBENCH_ROW, LIGHTBENCH_ROW, Key, Mode );
+			(Mode ? SimdTime : ScalarTime) += appSeconds() - Start;
+		}
+		Differ += CompareRows( Scalar, Simd, Texels, MaxDiff );
+	}
+	TotalDiffer += Differ;
+	LogStage( Out, "Waver", Texels*3, ScalarTime, SimdTime, Differ, MaxDiff );
+
+	// Merging.
+	for( INT Mode=0; Mode<2; Mode++ )
+	{
+		Start = appSeconds();
+		for( i=0; i<NumRows; i++ )
+			MergeRow( Stream+i*LIGHTBENCH_ROW, (Mode ? Simd4 : Scalar4)+i*LIGHTBENCH_ROW, Src+i*LIGHTBENCH_ROW, Palette, LIGHTBENCH_ROW, Mode );
+		(Mode ? SimdTime : ScalarTime) = appSeconds() - Start;
+	}
+	MaxDiff      = 0;
+	Differ       = CompareRows( (BYTE*)Scalar4, (BYTE*)Simd4, Texels*4, MaxDiff );
+	TotalDiffer += Differ;
+	LogStage( Out, "Merge", Texels*4, ScalarTime, SimdTime, Differ, MaxDiff );
+
+	if( TotalDiffer )
+		Out->Logf( NAME_ExecWarning, "SIMD lighting disagrees with scalar lighting on %i values", TotalDiffer );
+	else
+		Out->Logf( "SIMD lighting agrees" );
+
+	appFree( Points );
+	appFree( Inner );
+	appFree( Simd4 );
+	appFree( Scalar4 );
+	appFree( Stream );
+	appFree( Simd );
+	appFree( Scalar );
+	appFree( Src );
+#else
+	Out->Log( "No SIMD lighting in this build" );
+#endif
+	return 1;
+	unguard;
+}
+
 /*------------------------------------------------------------------------------------
 	Light subsystem instantiation
 ------------------------------------------------------------------------------------*/
@@ -406,6 +406,15 @@ void URender::PostRender( FSceneNode* Frame )
 {
 	guard(URender::PostRender);
 
+	// Remember this frame's timings.
+	LastTimes.RenderCycles = appCycles() - (DWORD)ThisStartTime;
+#if STATS
+	LastTimes.OcclusionCycles = GStat.OcclusionTime;
+	LastTimes.SpanCycles      = GStat.SpanTime;
+	LastTimes.IllumCycles     = GStat.IllumTime;
+	LastTimes.MeshCycles      = GStat.MeshTime;
+#endif
+
 	// Draw whatever stats were requested.
 	if( Frame->Viewport->Actor->RendMap==REN_Polys || Frame->Viewport->Actor->RendMap==REN_PolyCuts || Frame->Viewport->Actor->RendMap==REN_DynLight || Frame->Viewport->Actor->RendMap==REN_PlainTex )
 		DrawStats( Frame );
@@ -415,6 +424,16 @@ void URender::PostRender( FSceneNode* Frame )
 	unguard;
 }
 
+//
+// Get the timings of the last frame rendered.
+//
+void URender::GetRenderTimes( FRenderTimes& Times )
+{
+	guard(URender::GetRenderTimes);
+	Times = LastTimes;
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	URender command line.
 -----------------------------------------------------------------------------*/
@@ -456,6 +475,10 @@ UBOOL URender::Exec(const char *Cmd,FOutputDevice *Out)
 		Out->Log( "Rendering option recognized" );
 		return 1;
 	}
+	else if( ParseCommand(&Str,"LIGHTBENCH") )
+	{
+		return GLightManager->Exec( Str, Out );
+	}
 	else return 0; // Not executed
 	unguard;
 }
@@ -13,6 +13,10 @@ PSP_HEAP_THRESHOLD_SIZE_KB(1024);
 #endif
 
 #include "Engine.h"
+#include "UnRender.h"
+#ifdef WITH_NULLRENDERDEV
+#include "../../NullRenderDev/Inc/NullRenderDev.h"
+#endif
 
 extern CORE_API FGlobalPlatform GTempPlatform;
 extern DLL_IMPORT UBOOL GTickDue;
@@ -121,6 +125,242 @@ void MainLoop( UEngine* Engine )
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Timedemo.
+-----------------------------------------------------------------------------*/
+
+//
+// Per-frame timings recorded by the timedemo, in milliseconds.
+//
+enum ETimeDemoStat
+{
+	TDS_Frame,
+	TDS_Game,
+	TDS_Script,
+	TDS_ActorTick,
+	TDS_Collision,
+	TDS_Move,
+	TDS_Net,
+	TDS_Client,
+	TDS_Render,
+	TDS_Occlusion,
+	TDS_Span,
+	TDS_Lighting,
+	TDS_Mesh,
+	TDS_Device,
+	TDS_MAX
+};
+static const char* TimeDemoStatNames[TDS_MAX] =
+{
+	"Frame", "Game", "Script", "ActorTick", "Collision", "Move", "Net",
+	"Client", "Render", "Occlusion", "Span", "Lighting", "Mesh", "Device"
+};
+
+// Fixed tick step so runs are reproducible regardless of speed.
+#define TIMEDEMO_DELTA (1.0/30.0)
+
+// Frames run before recording starts, to get texture uploads and such out of the way.
+#define TIMEDEMO_WARMUP 30
+
+static inline INT Compare( FLOAT A, FLOAT B )
+{
+	return (A<B) ? -1 : (A>B) ? 1 : 0;
+}
+
+//
+// Write the timedemo results as CSV (every frame) and JSON (summary).
+//
+static void WriteTimeDemoReport( const char* BaseName, const char* Map, const TArray<FLOAT>& Samples, DOUBLE TotalSeconds )
+{
+	guard(WriteTimeDemoReport);
+	INT NumFrames = Samples.Num() / TDS_MAX;
+	char Filename[256];
+
+	appSprintf( Filename, "%s.csv", BaseName );
+	FILE* F = appFopen( Filename, "wt" );
+	if( !F )
+	{
+		debugf( NAME_Warning, "Timedemo: Could not write %s", Filename );
+		return;
+	}
+	appFprintf( F, "FrameNum" );
+	for( INT i=0; i<TDS_MAX; i++ )
+		appFprintf( F, ",%s", TimeDemoStatNames[i] );
+	appFprintf( F, "\n" );
+	for( INT Frame=0; Frame<NumFrames; Frame++ )
+	{
+		appFprintf( F, "%i", Frame );
+		for( INT i=0; i<TDS_MAX; i++ )
+			appFprintf( F, ",%.3f", Samples(Frame*TDS_MAX+i) );
+		appFprintf( F, "\n" );
+	}
+	appFclose( F );
+
+	appSprintf( Filename, "%s.json", BaseName );
+	F = appFopen( Filename, "wt" );
+	if( !F )
+	{
+		debugf( NAME_Warning, "Timedemo: Could not write %s", Filename );
+		return;
+	}
+	appFprintf( F, "{\n\t\"map\": \"%s\",\n\t\"frames\": %i,\n\t\"seconds\": %.3f,\n\t\"fps\": %.2f,\n\t\"stats\": {\n", Map, NumFrames, TotalSeconds, TotalSeconds>0.0 ? NumFrames/TotalSeconds : 0.0 );
+	TArray<FLOAT> Sorted( NumFrames );
+	for( INT i=0; i<TDS_MAX; i++ )
+	{
+		DOUBLE Sum = 0.0;
+		for( INT Frame=0; Frame<NumFrames; Frame++ )
+		{
+			Sorted(Frame) = Samples(Frame*TDS_MAX+i);
+			Sum += Sorted(Frame);
+		}
+		appSort( &Sorted(0), NumFrames );
+		FLOAT MinTime = Sorted(0);
+		FLOAT MaxTime = Sorted(NumFrames-1);
+		FLOAT P99Time = Sorted(Min((NumFrames*99)/100, NumFrames-1));
+		appFprintf
+		(
+			F,
+			"\t\t\"%s\": { \"min\": %.3f, \"avg\": %.3f, \"p99\": %.3f, \"max\": %.3f }%s\n",
+			TimeDemoStatNames[i], MinTime, Sum/NumFrames, P99Time, MaxTime, i<TDS_MAX-1 ? "," : ""
+		);
+		if( i == TDS_Frame )
+			debugf( NAME_Log, "Timedemo: %i frames, frame time min=%.2f avg=%.2f p99=%.2f ms", NumFrames, MinTime, Sum/NumFrames, P99Time );
+	}
+	appFprintf( F, "\t}\n}\n" );
+	appFclose( F );
+	debugf( NAME_Log, "Timedemo: Wrote %s.csv and %s.json", BaseName, BaseName );
+	unguard;
+}
+
+//
+// Run a fixed number of frames at a fixed tick rate, turning the view one
+// full circle over the run, and record where the time went.
+//
+void TimeDemoLoop( UEngine* Engine, const char* Map, INT NumFrames, const char* BaseName )
+{
+	guard(TimeDemoLoop);
+
+	UGameEngine* GameEngine = Cast<UGameEngine>( Engine );
+	if( !GameEngine || NumFrames <= 0 )
+	{
+		debugf( NAME_Warning, "Timedemo: Needs the game engine and at least one frame" );
+		return;
+	}
+	debugf( NAME_Log, "Timedemo: %s, %i frames", Map, NumFrames );
+
+	TArray<FLOAT> Samples;
+	const FLOAT MsPerCycle = GSecondsPerCycle * 1000.0;
+	DOUBLE StartTime = 0.0;
+	GIsRunning = 1;
+	for( INT Frame=-TIMEDEMO_WARMUP; Frame<NumFrames && GIsRunning && !GIsRequestingExit; Frame++ )
+	{
+		UViewport* Viewport = ( Engine->Client && Engine->Client->Viewports.Num() ) ? Engine->Client->Viewports(0) : NULL;
+		if( Viewport && Viewport->Actor )
+			Viewport->Actor->ViewRotation = FRotator( 0, (Frame * 65536) / NumFrames, 0 );
+		if( Frame == 0 )
+			StartTime = appSeconds();
+
+		INT FrameCycles = 0;
+		uclock(FrameCycles);
+		Engine->Tick( TIMEDEMO_DELTA );
+		uunclock(FrameCycles);
+		if( Frame < 0 )
+			continue;
+
+		FRenderTimes RenderTimes;
+		if( Engine->Render )
+			Engine->Render->GetRenderTimes( RenderTimes );
+		else
+			appMemset( &RenderTimes, 0, sizeof(RenderTimes) );
+		ULevel* Level = GameEngine->GLevel;
+
+		FLOAT* Sample = &Samples( Samples.Add( TDS_MAX ) );
+		Sample[TDS_Frame]     = MsPerCycle * FrameCycles;
+		Sample[TDS_Game]      = MsPerCycle * Engine->GameCycles;
+		Sample[TDS_Script]    = MsPerCycle * GScriptCycles;
+		Sample[TDS_ActorTick] = Level ? MsPerCycle * Level->ActorTickCycles : 0.f;
+		Sample[TDS_Collision] = Level ? MsPerCycle * Level->CollisionCycles : 0.f;
+		Sample[TDS_Move]      = Level ? MsPerCycle * Level->MoveCycles      : 0.f;
+		Sample[TDS_Net]       = Level ? MsPerCycle * Level->NetTickCycles   : 0.f;
+		Sample[TDS_Client]    = MsPerCycle * Engine->ClientCycles;
+		Sample[TDS_Render]    = MsPerCycle * RenderTimes.RenderCycles;
+		Sample[TDS_Occlusion] = MsPerCycle * RenderTimes.OcclusionCycles;
+		Sample[TDS_Span]      = MsPerCycle * RenderTimes.SpanCycles;
+		Sample[TDS_Lighting]  = MsPerCycle * RenderTimes.IllumCycles;
+		Sample[TDS_Mesh]      = MsPerCycle * RenderTimes.MeshCycles;
+		Sample[TDS_Device]    = Engine->Client ? MsPerCycle * Engine->Client->DrawCycles : 0.f;
+	}
+	GIsRunning = 0;
+
+	if( Samples.Num() )
+		WriteTimeDemoReport( BaseName, Map, Samples, appSeconds() - StartTime );
+	unguard;
+}
+
+#ifdef WITH_NULLRENDERDEV
+//
+// Play a render trace back into the first viewport's rendering device and
+// log how long the device took per frame. Nothing is ticked, so the time
+// is spent in the device alone.
+//
+void ReplayTraceLoop( UEngine* Engine, const char* Filename, INT NumLoops )
+{
+	guard(ReplayTraceLoop);
+
+	UViewport* Viewport = ( Engine->Client && Engine->Client->Viewports.Num() ) ? Engine->Client->Viewports(0) : NULL;
+	if( !Viewport || !Viewport->RenDev )
+	{
+		debugf( NAME_Warning, "Replay: Needs a viewport with a rendering device" );
+		return;
+	}
+	FRenderTraceReplay Replay;
+	if( !Replay.Load( Filename ) )
+		return;
+	if( Replay.SizeX != Viewport->SizeX || Replay.SizeY != Viewport->SizeY )
+		debugf( NAME_Warning, "Replay: Trace is %ix%i but viewport is %ix%i", Replay.SizeX, Replay.SizeY, Viewport->SizeX, Viewport->SizeY );
+
+	TArray<FLOAT> Samples;
+	const FLOAT MsPerCycle = GSecondsPerCycle * 1000.0;
+	GIsRunning = 1;
+	for( INT Loop=0; Loop<NumLoops && GIsRunning && !GIsRequestingExit; Loop++ )
+	{
+		Replay.Rewind();
+		for( ; ; )
+		{
+			INT FrameCycles = 0;
+			uclock(FrameCycles);
+			UBOOL More = Replay.ReplayFrame( Viewport );
+			uunclock(FrameCycles);
+			if( !More )
+				break;
+			Samples.AddItem( MsPerCycle * FrameCycles );
+		}
+	}
+	GIsRunning = 0;
+
+	if( Samples.Num() )
+	{
+		FLOAT Sum = 0.f;
+		for( INT i=0; i<Samples.Num(); i++ )
+			Sum += Samples(i);
+		appSort( &Samples(0), Samples.Num() );
+		debugf
+		(
+			NAME_Log,
+			"Replay: %s, %i frames, %s: min %.3f avg %.3f p99 %.3f max %.3f ms",
+			Filename,
+			Samples.Num(),
+			Viewport->RenDev->GetClass()->GetName(),
+			Samples(0),
+			Sum / Samples.Num(),
+			Samples( Min( Samples.Num()-1, (INT)(Samples.Num() * 0.99f) ) ),
+			Samples( Samples.Num()-1 )
+		);
+	}
+	unguard;
+}
+#endif
+
 //
 // Exit the engine.
 //
@@ -128,6 +368,7 @@ void ExitEngine( UEngine* Engine )
 {
 	guard(ExitEngine);
 
+	GJobs.Exit();
 	GObj.Exit();
 	GMem.Exit();
 	GDynMem.Exit();
@@ -165,6 +406,16 @@ int main( int argc, const char** argv )
 	GIsClient = !ParseParam(appCmdLine(),"SERVER") && !ParseParam(appCmdLine(),"MAKE");
 	GIsEditor = ParseParam(appCmdLine(),"EDITOR") || ParseParam(appCmdLine(),"MAKE");
 
+	// Timedemo mode: load the map as if it were given as the URL.
+	char TimeDemoMap[256]="";
+	if( Parse( appCmdLine(), "TIMEDEMO=", TimeDemoMap, ARRAY_COUNT(TimeDemoMap) ) && TimeDemoMap[0] )
+	{
+		static char OldCmdLine[4096];
+		appStrncpy( OldCmdLine, appCmdLine(), ARRAY_COUNT(OldCmdLine) );
+		const char* NewArgv[] = { "", TimeDemoMap, OldCmdLine };
+		appSetCmdLine( ARRAY_COUNT(NewArgv), NewArgv );
+	}
+
 	// Init windowing.
 	appChdir( appBaseDir() );
 
@@ -181,8 +432,27 @@ int main( int argc, const char** argv )
 		GIsGuarded=1;
 		GSystem = &GTempPlatform;
 		UEngine* Engine = InitEngine();
+		char ReplayTrace[256]="";
 		if( !GIsRequestingExit )
-			MainLoop( Engine );
+		{
+			if( TimeDemoMap[0] )
+			{
+				INT TimeDemoFrames = 1000;
+				char TimeDemoOut[256]="TimeDemo";
+				Parse( appCmdLine(), "FRAMES=", TimeDemoFrames );
+				Parse( appCmdLine(), "TIMEDEMOOUT=", TimeDemoOut, ARRAY_COUNT(TimeDemoOut) );
+				TimeDemoLoop( Engine, TimeDemoMap, TimeDemoFrames, TimeDemoOut );
+			}
+#ifdef WITH_NULLRENDERDEV
+			else if( Parse( appCmdLine(), "REPLAYTRACE=", ReplayTrace, ARRAY_COUNT(ReplayTrace) ) && ReplayTrace[0] )
+			{
+				INT ReplayLoops = 1;
+				Parse( appCmdLine(), "REPLAYLOOPS=", ReplayLoops );
+				ReplayTraceLoop( Engine, ReplayTrace, ReplayLoops );
+			}
+#endif
+			else MainLoop( Engine );
+		}
 		ExitEngine( Engine );
 		GIsGuarded=0;
 #ifndef _DEBUG
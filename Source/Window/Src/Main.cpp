@@ -471,6 +471,7 @@ void ExitEngine( UEngine* Engine )
 {
 	guard(ExitEngine);
 
+	GJobs.Exit();
 	GObj.Exit();
 	GMem.Exit();
 	GDynMem.Exit();